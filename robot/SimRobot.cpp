@@ -10,7 +10,9 @@
 #include "transmitter/OffNao.hpp"
 #include "blackboard/Blackboard.hpp"
 #include "motion/MotionAdapter.hpp"
+#include "motion/SonarRecorder.hpp"
 #include "perception/PerceptionThread.hpp"
+#include "perception/kinematics/PoseService.hpp"
 #include "perception/vision/Vision.hpp"
 #include "perception/vision/SimCamera.hpp"
 
@@ -35,6 +37,10 @@ SimRobot::SimRobot() : offNaoInUse(false) {
 
    // Initialize blackboard for the sim robot
    simBlackboard = new Blackboard(vm);
+   simPoseService = new PoseService();
+   simBlackboard->kinematics.poseService = simPoseService;
+   simSonarWindow = new SonarWindow();
+   simBlackboard->motion.sonarWindow = simSonarWindow;
 
    // Initialize motion adapter for the sim robot
    motionAdapter = new MotionAdapter(simBlackboard);
@@ -62,6 +68,8 @@ SimRobot::~SimRobot() {
    delete simBlackboard;
    delete motionAdapter;
    delete perceptionThread;
+   delete simPoseService;
+   delete simSonarWindow;
 }
 
 void SimRobot::run() {
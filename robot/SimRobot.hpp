@@ -5,6 +5,8 @@
 class Blackboard;
 class MotionAdapter;
 class PerceptionThread;
+class PoseService;
+struct SonarWindow;
 
 class SimRobot {
    public:
@@ -19,6 +21,8 @@ class SimRobot {
 
       Oracle *simOracle;
       Blackboard *simBlackboard;
+      PoseService *simPoseService;
+      SonarWindow *simSonarWindow;
       MotionAdapter *motionAdapter;
       PerceptionThread *perceptionThread;
 };
@@ -0,0 +1,216 @@
+/**
+ * Replays a PerceptionDumper .bbd file through LocalisationAdapter::tick
+ * offline, reporting tick latency, the number of modes in the world
+ * distribution and how far the replayed output drifts from what was
+ * recorded on the robot.
+ *
+ * Dumps should be recorded with --vision.dumprate 0 so that every perception
+ * frame (and hence every odometry/vision update) is present in the file.
+ *
+ * Usage: benchlocalisation --dump match.bbd [--start N] [--frames N]
+ *                          [--tolerance mm]
+ *
+ * Exits non-zero if the mean position divergence exceeds --tolerance, so it
+ * can be used as a regression check for localisation changes.
+ */
+
+#include <math.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "blackboard/Blackboard.hpp"
+#include "perception/dumper/DumpFile.hpp"
+#include "perception/localisation/LocalisationAdapter.hpp"
+#include "perception/localisation/Localiser.hpp"
+#include "perception/localisation/MultiGaussianDistribution.hpp"
+#include "thread/Thread.hpp"
+#include "utils/angles.hpp"
+#include "utils/Logger.hpp"
+#include "utils/options.hpp"
+#include "utils/Timer.hpp"
+
+namespace po = boost::program_options;
+using namespace std;
+
+/* Frees the image buffers Blackboard::load allocates for each frame */
+static void freeFrame(Blackboard *frame, bool loaded) {
+   if (loaded && (frame->mask & SALIENCY_MASK)) {
+      delete[] frame->vision.topSaliency;
+      delete[] frame->vision.botSaliency;
+   }
+   if (loaded && (frame->mask & RAW_IMAGE_MASK)) {
+      delete[] frame->vision.topFrame;
+      delete[] frame->vision.botFrame;
+   }
+   delete frame;
+}
+
+static uint32_t percentile(const vector<uint32_t> &sorted, float p) {
+   if (sorted.empty()) {
+      return 0;
+   }
+   size_t i = (size_t)(p * (sorted.size() - 1) + 0.5f);
+   return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int main(int argc, char **argv) {
+   Thread::name = "BenchLocalisation";
+
+   po::variables_map vm;
+   po::options_description generic("Replay options");
+   generic.add_options()
+      ("help,h", "produce help message")
+      ("dump", po::value<string>(), "blackboard dump (.bbd) to replay")
+      ("start", po::value<int>()->default_value(0),
+       "frame to start replaying from")
+      ("frames", po::value<int>()->default_value(0),
+       "stop after arg frames, 0 replays the whole dump")
+      ("tolerance", po::value<float>()->default_value(0.0f),
+       "fail if mean position divergence (mm) exceeds arg, 0 disables");
+
+   try {
+      po::options_description cmdline_options =
+         store_and_notify(argc, argv, vm, &generic);
+
+      if (vm.count("help") || !vm.count("dump")) {
+         cout << cmdline_options << endl;
+         return 1;
+      }
+   } catch (po::error &e) {
+      cerr << "Error when parsing command line arguments: " << e.what() << endl;
+      return 1;
+   }
+   Logger::init(vm["debug.logpath"].as<string>(), vm["debug.log"].as<string>(),
+                vm["debug.log.motion"].as<bool>());
+
+   DumpFile dump;
+   string error;
+   if (!dump.open(vm["dump"].as<string>(), &error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   const int start = vm["start"].as<int>();
+   if (start > 0 && !dump.seek(start)) {
+      cerr << "Can not start from frame " << start << " of "
+           << dump.numFrames() << endl;
+      return 1;
+   }
+
+   const int maxFrames = vm["frames"].as<int>();
+   const float tolerance = vm["tolerance"].as<float>();
+
+   LocalisationAdapter *adapter = NULL;
+   Blackboard *frame = NULL;
+
+   vector<uint32_t> latencies;
+   map<size_t, unsigned> modeCounts;
+   size_t numParticles = 0;
+   double sumPosError = 0.0, maxPosError = 0.0;
+   double sumHeadingError = 0.0, maxHeadingError = 0.0;
+   double sumBallError = 0.0;
+
+   for (;;) {
+      if (maxFrames > 0 && (int)latencies.size() >= maxFrames) {
+         break;
+      }
+
+      Blackboard *next = new Blackboard(vm);
+      if (!dump.next(next)) {
+         freeFrame(next, false);
+         break;
+      }
+      if (frame) {
+         freeFrame(frame, true);
+      }
+      frame = next;
+
+      // the adapter overwrites these, so keep what the robot computed
+      const AbsCoord recordedPos = frame->localisation.robotPos;
+      const AbsCoord recordedBall = frame->localisation.ballPos;
+
+      if (adapter == NULL) {
+         adapter = new LocalisationAdapter(frame);
+      }
+      adapter->blackboard = frame;
+
+      Timer timer;
+      adapter->tick();
+      latencies.push_back(timer.elapsed_us());
+
+      if (adapter->L->worldDistribution) {
+         ++modeCounts[adapter->L->worldDistribution->modes.size()];
+      } else {
+         numParticles = adapter->L->particleFilter->getNumParticles();
+      }
+
+      const AbsCoord &pos = frame->localisation.robotPos;
+      const AbsCoord &ball = frame->localisation.ballPos;
+      double posError = hypot(pos.x() - recordedPos.x(),
+                              pos.y() - recordedPos.y());
+      double headingError = fabs(NORMALISE(pos.theta() - recordedPos.theta()));
+      sumPosError += posError;
+      sumHeadingError += headingError;
+      sumBallError += hypot(ball.x() - recordedBall.x(),
+                            ball.y() - recordedBall.y());
+      maxPosError = std::max(maxPosError, posError);
+      maxHeadingError = std::max(maxHeadingError, headingError);
+   }
+
+   delete adapter;
+   if (frame) {
+      freeFrame(frame, true);
+   }
+
+   const size_t n = latencies.size();
+   if (n == 0) {
+      cerr << "No frames could be read from the dump" << endl;
+      return 1;
+   }
+
+   vector<uint32_t> sorted(latencies);
+   std::sort(sorted.begin(), sorted.end());
+   double sum = 0.0;
+   for (size_t i = 0; i < n; ++i) {
+      sum += sorted[i];
+   }
+
+   cout << "Replayed " << n << " frames" << endl;
+   cout << "Tick latency (us): mean " << sum / n
+        << " p50 " << percentile(sorted, 0.5f)
+        << " p90 " << percentile(sorted, 0.9f)
+        << " p99 " << percentile(sorted, 0.99f)
+        << " max " << sorted.back() << endl;
+
+   if (numParticles) {
+      cout << "Particles: " << numParticles << endl;
+   } else {
+      cout << "Modes:";
+      for (map<size_t, unsigned>::const_iterator it = modeCounts.begin();
+           it != modeCounts.end(); ++it) {
+         cout << " " << it->first << "x" << it->second;
+      }
+      cout << endl;
+   }
+
+   const double meanPosError = sumPosError / n;
+   cout << fixed << setprecision(2);
+   cout << "Pose divergence: mean " << meanPosError << "mm"
+        << " max " << maxPosError << "mm"
+        << " heading mean " << RAD2DEG(sumHeadingError / n) << "deg"
+        << " max " << RAD2DEG(maxHeadingError) << "deg" << endl;
+   cout << "Ball divergence: mean " << sumBallError / n << "mm" << endl;
+
+   if (tolerance > 0.0f && meanPosError > tolerance) {
+      cerr << "Mean pose divergence exceeds tolerance of "
+           << tolerance << "mm" << endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,517 @@
+/**
+ * Drives the motion generators headlessly with a scripted sequence of
+ * ActionCommands, the same way MotionAdapter::tick does on the robot but
+ * without touch, effector or blackboard threads. Reports per-tick latency
+ * of BodyModel::update, the generators' makeJoints and (with --planner)
+ * RLPlanner::getAction, and can write or check the joint trajectories so
+ * walk changes can be validated off the robot.
+ *
+ * Sensors are synthetic by default: the joints read back exactly what was
+ * commanded on the previous tick, the IMU is level and the weight is split
+ * between the feet by how much more one knee is bent than the other, which
+ * is enough for the walk to change support foot on its own. With --sensors
+ * the SensorValues recorded in a .bbd dump are fed in instead, one per tick,
+ * looping.
+ *
+ * A script has one phase per line, '#' starts a comment:
+ *    <ticks> <STAND|WALK|KICK|LINE_UP|DRIBBLE> [forward left turn power foot]
+ * forward and left are in mm, turn in degrees, foot is LEFT or RIGHT.
+ *
+ * Usage: benchwalk --motion.path ../image/home/nao/data/pos/ [--script walk.txt]
+ *           [--trajectory out.tsv] [--reference old.tsv] [--tolerance deg]
+ *           [--overhead] [--ikcache]
+ *
+ * With --overhead a bare WalkEnginePreProcessor is driven alongside the
+ * generator pipeline with copies of the same inputs, so that what the
+ * pipeline costs on top of the walk engine itself can be read off the
+ * difference of the two during the walk phases.
+ *
+ * With --ikcache two more bare walk engines are driven the same way, one
+ * with walk.ikCache and one without, to compare their worst-case ticks and
+ * report how often the leg IK cache hits.
+ *
+ * Exits non-zero if a joint in the trajectory differs from --reference by
+ * more than --tolerance.
+ */
+
+#include <math.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "blackboard/Blackboard.hpp"
+#include "motion/generator/BodyModel.hpp"
+#include "motion/generator/ClippedGenerator.hpp"
+#include "motion/generator/RLPlanner.hpp"
+#include "motion/generator/WalkEnginePreProcessor.hpp"
+#include "perception/dumper/DumpFile.hpp"
+#include "perception/kinematics/Kinematics.hpp"
+#include "thread/Thread.hpp"
+#include "types/ActionCommand.hpp"
+#include "types/Odometry.hpp"
+#include "types/SensorValues.hpp"
+#include "utils/angles.hpp"
+#include "utils/body.hpp"
+#include "utils/Logger.hpp"
+#include "utils/options.hpp"
+#include "utils/Timer.hpp"
+
+namespace po = boost::program_options;
+using namespace std;
+using ActionCommand::Body;
+
+static const char *DEFAULT_SCRIPT =
+   "100 STAND\n"
+   "300 WALK 300 0 0\n"
+   "200 WALK 0 0 40\n"
+   "200 WALK 0 150 0\n"
+   "200 WALK 200 50 -20\n"
+   "150 LINE_UP 100 20 0\n"
+   "200 KICK 0 0 0 1.0 LEFT\n"
+   "200 KICK 0 0 0 1.0 RIGHT\n"
+   "100 WALK 0 0 0\n"
+   "100 STAND\n";
+
+struct Phase {
+   string name;
+   int ticks;
+   Body body;
+};
+
+/* Total knee difference (rad) at which all of the weight is on one foot */
+static const float FULL_SHIFT_KNEE = DEG2RAD(5.0f);
+/* Weight of the robot as the FSRs see it (kg) */
+static const float ROBOT_WEIGHT = 5.0f;
+
+static bool parseScript(istream &is, vector<Phase> *phases) {
+   string line;
+   int lineNumber = 0;
+   while (getline(is, line)) {
+      ++lineNumber;
+      line = line.substr(0, line.find('#'));
+      istringstream ls(line);
+      Phase phase;
+      if (!(ls >> phase.ticks)) {
+         continue;
+      }
+      string action;
+      float forward = 0, left = 0, turn = 0, power = 1.0f;
+      string foot = "LEFT";
+      ls >> action >> forward >> left >> turn >> power >> foot;
+
+      Body::ActionType type;
+      if (action == "STAND") {
+         type = Body::STAND;
+      } else if (action == "WALK") {
+         type = Body::WALK;
+      } else if (action == "KICK") {
+         type = Body::KICK;
+      } else if (action == "LINE_UP") {
+         type = Body::LINE_UP;
+      } else if (action == "DRIBBLE") {
+         type = Body::DRIBBLE;
+      } else {
+         cerr << "Unknown action '" << action << "' on line "
+              << lineNumber << endl;
+         return false;
+      }
+      phase.name = action;
+      phase.body = Body(type, forward, left, DEG2RAD(turn), power, 15.0,
+                        1.0, 0.0,
+                        foot == "RIGHT" ? Body::RIGHT : Body::LEFT);
+      phases->push_back(phase);
+   }
+   return true;
+}
+
+/* Loads motion.sensors from every frame of a dump */
+static bool loadSensors(const string &file, const po::variables_map &vm,
+                        vector<SensorValues> *sensors) {
+   DumpFile dump;
+   string error;
+   if (!dump.open(file, &error)) {
+      cerr << error << endl;
+      return false;
+   }
+   for (;;) {
+      Blackboard *frame = new Blackboard(vm);
+      if (!dump.next(frame)) {
+         delete frame;
+         break;
+      }
+      sensors->push_back(frame->motion.sensors.read());
+      if (frame->mask & SALIENCY_MASK) {
+         delete[] frame->vision.topSaliency;
+         delete[] frame->vision.botSaliency;
+      }
+      if (frame->mask & RAW_IMAGE_MASK) {
+         delete[] frame->vision.topFrame;
+         delete[] frame->vision.botFrame;
+      }
+      delete frame;
+   }
+   return !sensors->empty();
+}
+
+/* What the robot would read back after actuating joints */
+static SensorValues syntheticSensors(const JointValues &joints) {
+   SensorValues sensors(true);
+   sensors.joints = joints;
+
+   float shift = (joints.angles[Joints::RKneePitch] -
+                  joints.angles[Joints::LKneePitch]) / FULL_SHIFT_KNEE;
+   float leftWeight = 0.5f + 0.5f * std::max(-1.0f, std::min(1.0f, shift));
+   for (int i = 0; i < 4; ++i) {
+      sensors.sensors[Sensors::LFoot_FSR_FrontLeft + i] =
+         leftWeight * ROBOT_WEIGHT / 4;
+      sensors.sensors[Sensors::RFoot_FSR_FrontLeft + i] =
+         (1 - leftWeight) * ROBOT_WEIGHT / 4;
+   }
+   return sensors;
+}
+
+struct Latencies {
+   vector<uint32_t> bodyModel, generator, walk, planner, tick;
+   vector<uint32_t> walkCached, walkUncached;
+};
+
+static uint32_t percentile(const vector<uint32_t> &sorted, float p) {
+   if (sorted.empty()) {
+      return 0;
+   }
+   size_t i = (size_t)(p * (sorted.size() - 1) + 0.5f);
+   return sorted[std::min(i, sorted.size() - 1)];
+}
+
+static void report(const string &name, vector<uint32_t> latencies) {
+   if (latencies.empty()) {
+      return;
+   }
+   std::sort(latencies.begin(), latencies.end());
+   double sum = 0.0;
+   for (size_t i = 0; i < latencies.size(); ++i) {
+      sum += latencies[i];
+   }
+   uint32_t p50 = percentile(latencies, 0.5f);
+   cout << "  " << setw(10) << left << name << right
+        << " mean " << setw(7) << sum / latencies.size()
+        << " p50 " << setw(5) << p50
+        << " p90 " << setw(5) << percentile(latencies, 0.9f)
+        << " p99 " << setw(5) << percentile(latencies, 0.99f)
+        << " max " << setw(5) << latencies.back()
+        << " jitter " << setw(5) << latencies.back() - p50 << endl;
+}
+
+int main(int argc, char **argv) {
+   Thread::name = "BenchWalk";
+
+   po::variables_map vm;
+   po::options_description generic("Walk harness options");
+   generic.add_options()
+      ("help,h", "produce help message")
+      ("script", po::value<string>(),
+       "phases to run, the built in walk/turn/kick/line up script if absent")
+      ("sensors", po::value<string>(),
+       "replay motion.sensors from a blackboard dump (.bbd) instead of "
+       "synthesising them")
+      ("planner", po::value<string>(),
+       "also time RLPlanner::getAction with this planner table")
+      ("overhead", "also time a bare walk engine to compare the generator "
+       "pipeline against")
+      ("ikcache", "also time bare walk engines with and without the leg IK "
+       "cache")
+      ("repeat", po::value<int>()->default_value(1),
+       "run the script arg times")
+      ("trajectory", po::value<string>(),
+       "write the joint angles of every tick to arg")
+      ("reference", po::value<string>(),
+       "compare the joint angles against a trajectory written earlier")
+      ("tolerance", po::value<float>()->default_value(0.01f),
+       "fail if a joint differs from --reference by more than arg degrees");
+
+   try {
+      po::options_description cmdline_options =
+         store_and_notify(argc, argv, vm, &generic);
+
+      if (vm.count("help")) {
+         cout << cmdline_options << endl;
+         return 1;
+      }
+   } catch (po::error &e) {
+      cerr << "Error when parsing command line arguments: " << e.what() << endl;
+      return 1;
+   }
+   Logger::init(vm["debug.logpath"].as<string>(), vm["debug.log"].as<string>(),
+                vm["debug.log.motion"].as<bool>());
+
+   vector<Phase> phases;
+   bool parsed;
+   if (vm.count("script")) {
+      ifstream ifs(vm["script"].as<string>().c_str());
+      if (!ifs.is_open()) {
+         cerr << "Can not open " << vm["script"].as<string>() << endl;
+         return 1;
+      }
+      parsed = parseScript(ifs, &phases);
+   } else {
+      istringstream iss(DEFAULT_SCRIPT);
+      parsed = parseScript(iss, &phases);
+   }
+   if (!parsed || phases.empty()) {
+      cerr << "No phases to run" << endl;
+      return 1;
+   }
+
+   vector<SensorValues> recorded;
+   if (vm.count("sensors") &&
+       !loadSensors(vm["sensors"].as<string>(), vm, &recorded)) {
+      cerr << "No sensors could be read from the dump" << endl;
+      return 1;
+   }
+
+   vector<vector<float> > reference;
+   if (vm.count("reference")) {
+      ifstream ifs(vm["reference"].as<string>().c_str());
+      string line;
+      while (getline(ifs, line)) {
+         istringstream ls(line);
+         int tick;
+         string name;
+         vector<float> angles(Joints::NUMBER_OF_JOINTS);
+         ls >> tick >> name;
+         for (int i = 0; i < Joints::NUMBER_OF_JOINTS; ++i) {
+            ls >> angles[i];
+         }
+         if (ls) {
+            reference.push_back(angles);
+         }
+      }
+      if (reference.empty()) {
+         cerr << "No trajectory could be read from "
+              << vm["reference"].as<string>() << endl;
+         return 1;
+      }
+   }
+
+   ofstream trajectory;
+   if (vm.count("trajectory")) {
+      trajectory.open(vm["trajectory"].as<string>().c_str());
+      trajectory << fixed << setprecision(6);
+   }
+
+   RLPlanner *planner = NULL;
+   if (vm.count("planner")) {
+      planner = new RLPlanner(vm["planner"].as<string>());
+   }
+
+   Blackboard *blackboard = new Blackboard(vm);
+   ClippedGenerator *generator = new ClippedGenerator(blackboard);
+   generator->readOptions(vm);
+
+   WalkEnginePreProcessor *walk = NULL;
+   if (vm.count("overhead")) {
+      walk = new WalkEnginePreProcessor(blackboard);
+      walk->readOptions(vm);
+   }
+
+   WalkEnginePreProcessor *walkCached = NULL, *walkUncached = NULL;
+   uint32_t ikCacheLookups = 0, ikCacheHits = 0;
+   if (vm.count("ikcache")) {
+      po::variables_map cached = vm, uncached = vm;
+      cached.at("walk.ikCache").value() = true;
+      uncached.at("walk.ikCache").value() = false;
+      walkCached = new WalkEnginePreProcessor(blackboard);
+      walkCached->readOptions(cached);
+      walkUncached = new WalkEnginePreProcessor(blackboard);
+      walkUncached->readOptions(uncached);
+   }
+
+   Kinematics kinematics;
+   kinematics.parameters = blackboard->kinematics.parameters;
+   BodyModel bodyModel;
+   bodyModel.kinematics = &kinematics;
+   Odometry odometry;
+
+   JointValues joints(true);
+   vector<string> phaseNames;
+   vector<Latencies> latencies(phases.size());
+   float maxDifference = 0.0f;
+   int maxDifferenceTick = -1, maxDifferenceJoint = -1;
+   int tick = 0;
+   double walkSum = 0.0, pipelineSum = 0.0;
+
+   for (int r = 0; r < vm["repeat"].as<int>(); ++r) {
+      for (size_t p = 0; p < phases.size(); ++p) {
+         for (int i = 0; i < phases[p].ticks; ++i, ++tick) {
+            SensorValues sensors = recorded.empty()
+               ? syntheticSensors(joints)
+               : recorded[tick % recorded.size()];
+
+            ActionCommand::All request;
+            request.body = phases[p].body;
+
+            Timer total;
+            kinematics.setSensorValues(sensors);
+            kinematics.updateDHChain();
+
+            Timer t;
+            bodyModel.update(&odometry, sensors);
+            latencies[p].bodyModel.push_back(t.elapsed_us());
+
+            // STAND is the only scripted action not run by the walk engine
+            bool compareWalk =
+               walk && phases[p].body.actionType != Body::STAND;
+            if (compareWalk) {
+               ActionCommand::All walkRequest = request;
+               Odometry walkOdometry = odometry;
+               BodyModel walkBodyModel = bodyModel;
+               t.restart();
+               walk->makeJoints(&walkRequest, &walkOdometry, sensors,
+                                walkBodyModel, 0.0f, 0.0f);
+               latencies[p].walk.push_back(t.elapsed_us());
+            }
+
+            if (walkCached && phases[p].body.actionType != Body::STAND) {
+               ActionCommand::All walkRequest = request;
+               Odometry walkOdometry = odometry;
+               BodyModel walkBodyModel = bodyModel;
+               const uint32_t lookups = Walk2014Generator::ikCacheLookups;
+               const uint32_t hits = Walk2014Generator::ikCacheHits;
+               t.restart();
+               walkCached->makeJoints(&walkRequest, &walkOdometry, sensors,
+                                      walkBodyModel, 0.0f, 0.0f);
+               latencies[p].walkCached.push_back(t.elapsed_us());
+               ikCacheLookups += Walk2014Generator::ikCacheLookups - lookups;
+               ikCacheHits += Walk2014Generator::ikCacheHits - hits;
+
+               walkRequest = request;
+               walkOdometry = odometry;
+               walkBodyModel = bodyModel;
+               t.restart();
+               walkUncached->makeJoints(&walkRequest, &walkOdometry, sensors,
+                                        walkBodyModel, 0.0f, 0.0f);
+               latencies[p].walkUncached.push_back(t.elapsed_us());
+            }
+
+            t.restart();
+            joints = generator->makeJoints(&request, &odometry, sensors,
+                                           bodyModel, 0.0f, 0.0f);
+            latencies[p].generator.push_back(t.elapsed_us());
+            if (compareWalk) {
+               walkSum += latencies[p].walk.back();
+               pipelineSum += latencies[p].generator.back();
+            }
+
+            if (planner) {
+               t.restart();
+               planner->getAction(bodyModel, request);
+               latencies[p].planner.push_back(t.elapsed_us());
+            }
+            latencies[p].tick.push_back(total.elapsed_us());
+
+            if (trajectory.is_open()) {
+               trajectory << tick << "\t" << phases[p].name;
+               for (int j = 0; j < Joints::NUMBER_OF_JOINTS; ++j) {
+                  trajectory << "\t" << joints.angles[j];
+               }
+               trajectory << "\n";
+            }
+
+            if ((size_t)tick < reference.size()) {
+               for (int j = 0; j < Joints::NUMBER_OF_JOINTS; ++j) {
+                  float difference =
+                     fabsf(joints.angles[j] - reference[tick][j]);
+                  // NaN in either trajectory counts as a difference
+                  if (difference > maxDifference ||
+                      (isnan(joints.angles[j]) != isnan(reference[tick][j]))) {
+                     maxDifference = isnan(difference) ? INFINITY : difference;
+                     maxDifferenceTick = tick;
+                     maxDifferenceJoint = j;
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   delete generator;
+   delete walk;
+   delete walkCached;
+   delete walkUncached;
+   delete blackboard;
+   delete planner;
+
+   cout << "Ran " << tick << " ticks" << endl;
+   cout << "Latency (us):" << endl;
+   Latencies all;
+   for (size_t p = 0; p < phases.size(); ++p) {
+      all.tick.insert(all.tick.end(),
+                      latencies[p].tick.begin(), latencies[p].tick.end());
+      all.bodyModel.insert(all.bodyModel.end(), latencies[p].bodyModel.begin(),
+                           latencies[p].bodyModel.end());
+      all.generator.insert(all.generator.end(), latencies[p].generator.begin(),
+                           latencies[p].generator.end());
+      all.walk.insert(all.walk.end(),
+                      latencies[p].walk.begin(), latencies[p].walk.end());
+      all.planner.insert(all.planner.end(),
+                         latencies[p].planner.begin(), latencies[p].planner.end());
+      all.walkCached.insert(all.walkCached.end(),
+                            latencies[p].walkCached.begin(),
+                            latencies[p].walkCached.end());
+      all.walkUncached.insert(all.walkUncached.end(),
+                              latencies[p].walkUncached.begin(),
+                              latencies[p].walkUncached.end());
+      ostringstream name;
+      name << p << ":" << phases[p].name;
+      report(name.str(), latencies[p].tick);
+   }
+   report("tick", all.tick);
+   report("bodyModel", all.bodyModel);
+   report("makeJoints", all.generator);
+   report("walk", all.walk);
+   report("planner", all.planner);
+   report("ik cached", all.walkCached);
+   report("ik solved", all.walkUncached);
+   if (ikCacheLookups) {
+      cout << fixed << setprecision(1)
+           << "Leg IK cache: " << ikCacheHits << " hits in " << ikCacheLookups
+           << " lookups (" << 100.0 * ikCacheHits / ikCacheLookups << "%)"
+           << endl;
+      cout.unsetf(ios::fixed);
+   }
+   if (!all.walk.empty()) {
+      cout << fixed << setprecision(3)
+           << "Pipeline overhead over the walk engine: "
+           << (pipelineSum - walkSum) / all.walk.size() << "us per tick ("
+           << 100.0 * (pipelineSum - walkSum) / walkSum << "%)" << endl;
+      cout.unsetf(ios::fixed);
+   }
+
+   if (!reference.empty()) {
+      if ((size_t)tick != reference.size()) {
+         cerr << "Reference has " << reference.size() << " ticks, ran "
+              << tick << endl;
+         return 1;
+      }
+      cout << fixed << setprecision(4)
+           << "Max joint difference: " << RAD2DEG(maxDifference) << "deg";
+      if (maxDifferenceTick >= 0) {
+         cout << " (" << Joints::jointNames[maxDifferenceJoint]
+              << " at tick " << maxDifferenceTick << ")";
+      }
+      cout << endl;
+      if (RAD2DEG(maxDifference) > vm["tolerance"].as<float>()) {
+         cerr << "Trajectory differs from the reference by more than "
+              << vm["tolerance"].as<float>() << "deg" << endl;
+         return 1;
+      }
+   }
+   return 0;
+}
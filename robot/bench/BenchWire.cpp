@@ -0,0 +1,316 @@
+/**
+ * Compares how fast the OffNao stream can be serialised with boost
+ * serialization, as Connection::sync_write does it, and with the WireFrame
+ * encoders, then checks that a WireFrame decodes back to the same blackboard.
+ * Delta frames, holding only what changed since the last frame acknowledged,
+ * are then encoded and decoded against a baseline as a session would.
+ *
+ * The blackboard is synthetic, with a few of each vision feature and images
+ * of noise, unless --dump gives a .bbd whose first frame is used instead.
+ *
+ * Usage: benchwire [--dump frame.bbd] [--frames N] [--mask M]
+ *                  [--compress true|false]
+ *
+ * --mask is an OffNaoMask_t as offnao would send it, 7 streams the
+ * blackboard, saliency and raw images.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/program_options.hpp>
+
+#include "blackboard/Blackboard.hpp"
+#include "perception/dumper/DumpFile.hpp"
+#include "thread/Thread.hpp"
+#include "transmitter/WireFormat.hpp"
+#include "utils/Logger.hpp"
+#include "utils/options.hpp"
+#include "utils/Timer.hpp"
+
+namespace po = boost::program_options;
+using namespace std;
+
+static const size_t FRAME_BYTES = IMAGE_ROWS * IMAGE_COLS * 2;
+
+static void fillNoise(void *buffer, size_t length) {
+   uint8_t *bytes = (uint8_t *)buffer;
+   for (size_t i = 0; i < length; ++i) {
+      bytes[i] = rand() & 0xFF;
+   }
+}
+
+/* Puts a few of each feature on the blackboard so the vectors are not empty */
+static void fillSynthetic(Blackboard *blackboard) {
+   vector<BallInfo> balls;
+   BallInfo ball(RRCoord(1000, 0.2f, 0), 40, Point(320, 240),
+                 XYZ_Coord(1000, 200, 0));
+   ball.topCamera = true;
+   balls.push_back(ball);
+   blackboard->vision.balls.publish(balls);
+
+   for (int i = 0; i < 2; ++i) {
+      blackboard->vision.posts.push_back(
+         PostInfo(RRCoord(3000, 0.4f * i, 0), PostInfo::pLeft,
+                  BBox(Point(10 * i, 0), Point(10 * i + 20, 200)),
+                  3000, 3100, true, PostInfo::pToLeftOf));
+   }
+
+   vector<RobotInfo> robots;
+   for (int i = 0; i < 3; ++i) {
+      robots.push_back(RobotInfo(RRCoord(500 * (i + 1), -0.3f * i, 0),
+                                 RobotInfo::rRed,
+                                 BBox(Point(50 * i, 100), Point(50 * i + 40, 300)),
+                                 RobotInfo::TOP_CAMERA));
+   }
+   blackboard->vision.robots.publish(robots);
+
+   for (int i = 0; i < 2; ++i) {
+      blackboard->vision.fieldEdges.push_back(FieldEdgeInfo(
+         RANSACLine(Point(0, 100 + i), Point(640, 120 + i)),
+         RANSACLine(Point(0, 100 + i), Point(640, 120 + i))));
+   }
+
+   blackboard->vision.timestamp = 123456789;
+   blackboard->localisation.robotPos = AbsCoord(-1500, 800, 0.5f);
+   blackboard->localisation.ballPos = AbsCoord(200, -300, 0);
+   blackboard->localisation.havePendingIncomingSharedBundle.resize(5, false);
+   blackboard->perception.total = 12;
+
+   Colour *topSaliency = (Colour *)new Colour[IMAGE_COLS / TOP_SALIENCY_DENSITY]
+                                   [IMAGE_ROWS / TOP_SALIENCY_DENSITY];
+   Colour *botSaliency = (Colour *)new Colour[IMAGE_COLS / BOT_SALIENCY_DENSITY]
+                                   [IMAGE_ROWS / BOT_SALIENCY_DENSITY];
+   memset(topSaliency, cFIELD_GREEN,
+          sizeof(Colour[IMAGE_COLS / TOP_SALIENCY_DENSITY]
+                       [IMAGE_ROWS / TOP_SALIENCY_DENSITY]));
+   memset(botSaliency, cFIELD_GREEN,
+          sizeof(Colour[IMAGE_COLS / BOT_SALIENCY_DENSITY]
+                       [IMAGE_ROWS / BOT_SALIENCY_DENSITY]));
+   blackboard->vision.topSaliency = topSaliency;
+   blackboard->vision.botSaliency = botSaliency;
+
+   uint8_t *topFrame = new uint8_t[FRAME_BYTES];
+   uint8_t *botFrame = new uint8_t[FRAME_BYTES];
+   fillNoise(topFrame, FRAME_BYTES);
+   fillNoise(botFrame, FRAME_BYTES);
+   blackboard->vision.topFrame = topFrame;
+   blackboard->vision.botFrame = botFrame;
+}
+
+/**
+ * Serialises blackboard the way Connection::sync_write does, short of the
+ * socket write
+ *
+ * @return the bytes that would have been written
+ */
+static size_t serialiseBoost(const Blackboard &blackboard) {
+   std::ostringstream archive_stream;
+   boost::archive::binary_oarchive archive(archive_stream);
+   archive << blackboard;
+   std::string outbound_data = archive_stream.str();
+
+   uLongf size = 1024 * 1024;
+   static Bytef zlibOutput[1024 * 1024];
+   if (compress2(zlibOutput, &size, (const Bytef *)outbound_data.data(),
+                 outbound_data.size(), Z_BEST_SPEED) != Z_OK ||
+       size >= outbound_data.size()) {
+      size = 0;
+   }
+
+   std::ostringstream header_stream;
+   header_stream << std::setw(8) << std::hex << size <<
+   std::setw(8) << outbound_data.size();
+   std::string outbound_header = header_stream.str();
+
+   return outbound_header.size() + (size ? size : outbound_data.size());
+}
+
+/* Copies a finished frame into one buffer, as offnao receives it */
+static void gather(const WireFrame &frame, vector<char> *data) {
+   data->clear();
+   const vector<boost::asio::const_buffer> &buffers = frame.buffers();
+   for (size_t i = 0; i < buffers.size(); ++i) {
+      const char *bytes = boost::asio::buffer_cast<const char *>(buffers[i]);
+      data->insert(data->end(), bytes,
+                   bytes + boost::asio::buffer_size(buffers[i]));
+   }
+}
+
+static bool check(bool ok, const char *what) {
+   if (!ok) {
+      cerr << "Decoded frame differs in " << what << endl;
+   }
+   return ok;
+}
+
+/**
+ * @return whether the components the benchmark can compare survived a
+ *         round trip
+ */
+static bool sameFrame(Blackboard *sent, Blackboard *received,
+                      OffNaoMask_t mask) {
+   bool ok = true;
+   ok &= check(received->mask == mask, "mask");
+   ok &= check(received->localisation.robotPos.vec ==
+               sent->localisation.robotPos.vec, "localisation.robotPos");
+   if (mask & BLACKBOARD_MASK) {
+      ok &= check(received->vision.timestamp == sent->vision.timestamp,
+                  "vision.timestamp");
+      ok &= check(received->vision.balls.acquire() ==
+                  sent->vision.balls.acquire(), "vision.balls");
+      ok &= check(received->vision.posts == sent->vision.posts,
+                  "vision.posts");
+      ok &= check(received->vision.robots.acquire() ==
+                  sent->vision.robots.acquire(), "vision.robots");
+      ok &= check(received->vision.fieldEdges.size() ==
+                  sent->vision.fieldEdges.size(), "vision.fieldEdges");
+      ok &= check(memcmp(&received->motion.sensors.read(),
+                         &sent->motion.sensors.read(),
+                         sizeof(SensorValues)) == 0, "motion.sensors");
+      ok &= check(received->perception.total == sent->perception.total,
+                  "perception.total");
+   }
+   if (mask & RAW_IMAGE_MASK) {
+      ok &= check(memcmp(received->vision.topFrame, sent->vision.topFrame,
+                         FRAME_BYTES) == 0, "vision.topFrame");
+      ok &= check(memcmp(received->vision.botFrame, sent->vision.botFrame,
+                         FRAME_BYTES) == 0, "vision.botFrame");
+   }
+   return ok;
+}
+
+static void report(const char *name, double elapsedUs, size_t bytes,
+                   int frames) {
+   cout << name << ": " << elapsedUs / frames << "us per frame, "
+        << bytes << " bytes per frame, "
+        << (bytes * (double)frames) / elapsedUs << "MB/s" << endl;
+}
+
+int main(int argc, char **argv) {
+   Thread::name = "BenchWire";
+
+   po::variables_map vm;
+   po::options_description generic("Wire format options");
+   generic.add_options()
+      ("help,h", "produce help message")
+      ("dump", po::value<string>(), "take the blackboard from this .bbd")
+      ("frames", po::value<int>()->default_value(200),
+       "frames to serialise with each method")
+      ("mask", po::value<OffNaoMask_t>()->default_value(INITIAL_MASK),
+       "OffNaoMask_t to serialise")
+      ("compress", po::value<bool>()->default_value(true),
+       "compress the structured section of a WireFrame");
+
+   try {
+      po::options_description cmdline_options =
+         store_and_notify(argc, argv, vm, &generic);
+
+      if (vm.count("help")) {
+         cout << cmdline_options << endl;
+         return 1;
+      }
+   } catch (po::error &e) {
+      cerr << "Error when parsing command line arguments: " << e.what() << endl;
+      return 1;
+   }
+   Logger::init(vm["debug.logpath"].as<string>(), vm["debug.log"].as<string>(),
+                vm["debug.log.motion"].as<bool>());
+
+   const int frames = vm["frames"].as<int>();
+   const OffNaoMask_t mask = vm["mask"].as<OffNaoMask_t>();
+   const bool compress = vm["compress"].as<bool>();
+
+   Blackboard *blackboard = new Blackboard(vm);
+   if (vm.count("dump")) {
+      DumpFile dump;
+      string error;
+      if (!dump.open(vm["dump"].as<string>(), &error) ||
+          !dump.next(blackboard)) {
+         cerr << "Can not read a frame from the dump: " << error << endl;
+         return 1;
+      }
+   } else {
+      fillSynthetic(blackboard);
+   }
+   blackboard->mask = mask;
+
+   size_t boostBytes = 0;
+   Timer timer;
+   for (int i = 0; i < frames; ++i) {
+      boostBytes = serialiseBoost(*blackboard);
+   }
+   report("boost::serialization + zlib", timer.elapsed_us(), boostBytes,
+          frames);
+
+   WireFrame frame;
+   timer.restart();
+   for (int i = 0; i < frames; ++i) {
+      encodeWireFrame(blackboard, mask, compress, NULL, &frame);
+   }
+   report("WireFrame", timer.elapsed_us(), frame.size(), frames);
+
+   vector<char> data;
+   gather(frame, &data);
+   Blackboard *received = NULL;
+   string error;
+   timer.restart();
+   for (int i = 0; i < frames; ++i) {
+      if (received) {
+         delete[] received->vision.topSaliency;
+         delete[] received->vision.botSaliency;
+         delete[] received->vision.topFrame;
+         delete[] received->vision.botFrame;
+         delete received;
+      }
+      received = new Blackboard(vm);
+      if (!decodeWireFrame(&data[0], data.size(), received, NULL, &error)) {
+         cerr << "Failed to decode: " << error << endl;
+         return 1;
+      }
+   }
+   report("WireFrame decode", timer.elapsed_us(), data.size(), frames);
+   if (!sameFrame(blackboard, received, frame.header().mask)) {
+      return 1;
+   }
+
+   /* Only vision.timestamp changes between frames, as between two ticks of
+    * a robot that sees nothing new
+    */
+   WireBaseline sent, seen;
+   encodeWireFrame(blackboard, mask, compress, NULL, &frame);
+   frame.acknowledge(&sent);
+   gather(frame, &data);
+   if (!decodeWireFrame(&data[0], data.size(), received, &seen, &error)) {
+      cerr << "Failed to decode keyframe: " << error << endl;
+      return 1;
+   }
+   size_t deltaBytes = 0;
+   double deltaUs = 0;
+   for (int i = 0; i < frames; ++i) {
+      ++blackboard->vision.timestamp;
+      timer.restart();
+      encodeWireFrame(blackboard, mask, compress, &sent, &frame);
+      frame.acknowledge(&sent);
+      deltaUs += timer.elapsed_us();
+      deltaBytes += frame.size();
+
+      gather(frame, &data);
+      if (!(frame.header().flags & WIRE_DELTA) ||
+          !decodeWireFrame(&data[0], data.size(), received, &seen, &error)) {
+         cerr << "Failed to decode delta: " << error << endl;
+         return 1;
+      }
+   }
+   report("WireFrame delta", deltaUs, deltaBytes / frames, frames);
+
+   return sameFrame(blackboard, received, frame.header().mask) ? 0 : 1;
+}
@@ -23,3 +23,53 @@ SET ( RUNSWIFT_BOOST  ${Boost_SYSTEM_LIBRARY}
 
 TARGET_LINK_LIBRARIES( benchrunswift ${PTHREAD_LIBRARIES} ${RUNSWIFT_BOOST} ${PYTHON_LIBRARY} )
 
+
+############################ LOCALISATION REPLAY
+# Replays a .bbd dump through LocalisationAdapter, needs the whole soccer
+# library rather than the header-only pieces used by benchrunswift
+
+ADD_EXECUTABLE( benchlocalisation bench/BenchLocalisation.cpp )
+
+TARGET_LINK_LIBRARIES( benchlocalisation
+   soccer-static
+   ${PTHREAD_LIBRARIES}
+   ${RUNSWIFT_BOOST}
+   ${PYTHON_LIBRARY}
+   ${CTC_DIR}/bzip2/lib/libbz2.so
+   ${CTC_DIR}/zlib/lib/libz.so
+)
+
+
+############################ WALK HARNESS
+# Runs scripted ActionCommands through the motion generators headlessly
+
+# The walk engine is built again here to count leg IK cache hits for
+# --ikcache, which the robot's build does not pay for
+ADD_EXECUTABLE( benchwalk bench/BenchWalk.cpp
+                motion/generator/Walk2014Generator.cpp )
+SET_TARGET_PROPERTIES( benchwalk PROPERTIES
+                       COMPILE_DEFINITIONS WALK_IK_CACHE_STATS )
+
+TARGET_LINK_LIBRARIES( benchwalk
+   soccer-static
+   ${PTHREAD_LIBRARIES}
+   ${RUNSWIFT_BOOST}
+   ${PYTHON_LIBRARY}
+   ${CTC_DIR}/bzip2/lib/libbz2.so
+   ${CTC_DIR}/zlib/lib/libz.so
+)
+
+
+############################ WIRE FORMAT
+# Compares the OffNao WireFrame encoders against boost serialization
+
+ADD_EXECUTABLE( benchwire bench/BenchWire.cpp )
+
+TARGET_LINK_LIBRARIES( benchwire
+   soccer-static
+   ${PTHREAD_LIBRARIES}
+   ${RUNSWIFT_BOOST}
+   ${PYTHON_LIBRARY}
+   ${CTC_DIR}/bzip2/lib/libbz2.so
+   ${CTC_DIR}/zlib/lib/libz.so
+)
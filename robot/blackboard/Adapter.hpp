@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include "utils/Logger.hpp"
 
 class Blackboard;
+class Version;
 
 class Adapter {
    protected:
@@ -13,3 +15,15 @@ class Adapter {
       Blackboard *blackboard;
 };
 
+/**
+ * What a module wants to tick on besides its cycle. Specialise of() to
+ * return a component's changes() and the ThreadManager ticks the module
+ * as soon as that component is written.
+ */
+template <class T>
+struct WakeEvent {
+   static const Version *of(Blackboard *) {
+      return NULL;
+   }
+};
+
@@ -35,7 +35,6 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <limits>
-#include "motion/SonarRecorder.hpp"
 #include "utils/angles.hpp"
 #include "utils/Logger.hpp"
 #include "utils/options.hpp"
@@ -132,7 +131,6 @@ void BehaviourBlackboard::readOptions(const program_options::variables_map& conf
 
 LocalisationBlackboard::LocalisationBlackboard() {
    llog(INFO) << "Initialising blackboard: localisation" << endl;
-   robotObstacles.reserve(MAX_ROBOT_OBSTACLES);
    ballLostCount = numeric_limits<uint32_t>::max();
    ballPosRR = RRCoord();
    ballPosRRC = AbsCoord();
@@ -156,11 +154,8 @@ VisionBlackboard::VisionBlackboard()
    llog(INFO) << "Initialising blackboard: vision" << endl;
    landmarks.reserve(MAX_LANDMARKS);
    feetBoxes.reserve(MAX_FEET);
-   balls.reserve(MAX_BALLS);
    posts.reserve(MAX_POSTS);
-   robots.reserve(MAX_ROBOTS);
    fieldEdges.reserve(MAX_FIELD_EDGES);
-   fieldFeatures.reserve(MAX_FIELD_FEATURES);
    missedFrames = 0;
    dxdy = std::make_pair(0,0);
    goalArea = PostInfo::pNone;
@@ -169,6 +164,8 @@ VisionBlackboard::VisionBlackboard()
    awayMapSize = 0;
 
    saliency = NULL;
+   topSaliency = NULL;
+   botSaliency = NULL;
    currentFrame = NULL;
    topFrame = NULL;
    botFrame = NULL;
@@ -187,16 +184,7 @@ PerceptionBlackboard::PerceptionBlackboard() {
 MotionBlackboard::MotionBlackboard() {
    llog(INFO) << "Initialising blackboard: motion" << endl;
    uptime = 0;
-   std::vector<int> left;
-   left.reserve(Sonar::NUMBER_OF_READINGS/2*WINDOW_SIZE);
-   std::vector<int> middle;
-   middle.reserve(Sonar::NUMBER_OF_READINGS/2*WINDOW_SIZE);
-   std::vector<int> right;
-   right.reserve(Sonar::NUMBER_OF_READINGS/2*WINDOW_SIZE);
-   sonarWindow.reserve(3);
-   sonarWindow.push_back(left);
-   sonarWindow.push_back(middle);
-   sonarWindow.push_back(right);
+   sonarWindow = NULL;
 }
 
 RemoteControlBlackboard::RemoteControlBlackboard() {
@@ -206,16 +194,9 @@ RemoteControlBlackboard::RemoteControlBlackboard() {
 
 KinematicsBlackboard::KinematicsBlackboard() {
    llog(INFO) << "Initialising blackboard: kinematics" << endl;
-   std::vector<int> left;
-   left.reserve(Sonar::NUMBER_OF_READINGS/2*WINDOW_SIZE);
-   std::vector<int> middle;
-   middle.reserve(Sonar::NUMBER_OF_READINGS/2*WINDOW_SIZE);
-   std::vector<int> right;
-   right.reserve(Sonar::NUMBER_OF_READINGS/2*WINDOW_SIZE);
-   sonarFiltered.reserve(3);
-   sonarFiltered.push_back(left);
-   sonarFiltered.push_back(middle);
-   sonarFiltered.push_back(right);
+   // left, middle and right
+   sonarFiltered.publish(std::vector<std::vector<int> >(3));
+   poseService = NULL;
 }
 
 void KinematicsBlackboard::readOptions(const program_options::variables_map& config) {
@@ -295,6 +276,9 @@ ReceiverBlackboard::ReceiverBlackboard() {
    BOOST_FOREACH(time_t & lr, lastReceived) {
       lr = 0;
    }
+   BOOST_FOREACH(int64_t & lr, lastReceivedTimestamp) {
+      lr = 0;
+   }
    BOOST_FOREACH(bool &i, incapacitated) {
       i = true;
    }
@@ -304,8 +288,37 @@ void ReceiverBlackboard::readOptions(const program_options::variables_map& confi
    team = config["player.team"].as<int>();
 }
 
+ComponentVersions::ComponentVersions() {
+   for (uint32_t i = 0; i < SIZE; ++i) {
+      keys[i] = 0;
+   }
+}
+
+Version &ComponentVersions::find(const Blackboard *blackboard,
+                                 const void *component) {
+   const char *start = (const char *)blackboard;
+   const char *at = (const char *)component;
+   if (at < start || at >= start + sizeof(Blackboard)) {
+      return overflow;
+   }
+   const uint32_t offset = at - start;
+   const uint32_t key = offset + 1;
+   for (uint32_t probe = 0; probe < SIZE; ++probe) {
+      const uint32_t i = (offset / sizeof(int) + probe) % SIZE;
+      if (keys[i] == 0) {
+         // Whether this or another thread claims it, the key is set after
+         __sync_bool_compare_and_swap(&keys[i], 0, key);
+      }
+      if (keys[i] == key) {
+         return versions[i];
+      }
+   }
+   return overflow;
+}
+
 ThreadBlackboard::ThreadBlackboard() {
    llog(INFO) << "Initialising blackboard: thread" << endl;
+   numTimings = 0;
 }
 
 SynchronisationBlackboard::SynchronisationBlackboard() {
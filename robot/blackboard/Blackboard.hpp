@@ -54,6 +54,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "perception/kinematics/Pose.hpp"
 #include "gamecontroller/RoboCupGameControlData.hpp"
 #include "utils/Logger.hpp"
+#include "utils/Seqlock.hpp"
+#include "utils/SnapshotBuffer.hpp"
+#include "utils/Version.hpp"
 #include "transmitter/TransmitterDefs.hpp"
 #include "types/BehaviourRequest.hpp"
 
@@ -78,6 +81,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "types/Ipoint.hpp"
 #include "types/Odometry.hpp"
 #include "types/TeamBallInfo.hpp"
+#include "types/ThreadTiming.hpp"
 
 namespace VisionTest
 {
@@ -86,6 +90,8 @@ namespace VisionTest
 
 /**
  * Macro to wrap reads to module's blackboard.
+ * Components that are a Seqlock or SnapshotBuffer are read without locks,
+ * and the reference stays valid only until this thread reads them again.
  * @param module which module's blackboard to read
  * @param component the component to read
  */
@@ -137,6 +143,34 @@ namespace VisionTest
 #define releaseLock(name) \
    (blackboard->locks.name)->unlock();
 
+/**
+ * Macro to get how many times a component has been written with writeTo.
+ * @param module which module's blackboard to look at
+ * @param component the component to look at
+ */
+#define versionOf(module, component) \
+   blackboard->changes(&(blackboard->module.component)).number()
+
+/**
+ * Macro to get when a component was last written with writeTo, in
+ * micro-seconds, or 0 if it never was.
+ * @param module which module's blackboard to look at
+ * @param component the component to look at
+ */
+#define timestampOf(module, component) \
+   blackboard->changes(&(blackboard->module.component)).timestamp()
+
+/**
+ * Macro to wait for a component to be written with writeTo.
+ * @param module which module's blackboard to wait on
+ * @param component the component to wait on
+ * @param since versionOf the component when the caller last looked at it
+ * @param timeoutMs how long to wait at most, or -1 for ever
+ * @return whether the component was written after since
+ */
+#define waitForChange(module, component, since, timeoutMs) \
+   blackboard->changes(&(blackboard->module.component)).wait(since, timeoutMs)
+
 /**
  * Blackboard shared memory class, used for inter-module communication.
  * The Blackboard is friends with each of the module adapters
@@ -149,14 +183,23 @@ class NetworkReader;
 
 class OverviewTab;
 
+class PoseService;
+struct SonarWindow;
+
 struct KinematicsBlackboard {
    explicit KinematicsBlackboard();
    void readOptions(const boost::program_options::variables_map& config);
    // Sonar filter is in kinematics because it needs to be run before vision
-   std::vector< std::vector <int> > sonarFiltered; 
+   SnapshotBuffer<std::vector<std::vector<int> > > sonarFiltered;
    bool isCalibrating;
    Parameters<float> parameters;
    SensorValues sensorsLagged;
+   // Sensors interpolated to when the current image was captured, which its
+   // Pose was computed from. Written by Perception once per image
+   SensorValues sensorsAtCapture;
+   // Timestamped joint history from Motion, Perception computes the Pose.
+   // Owned by the process running them, NULL elsewhere
+   PoseService *poseService;
 };
 
 /* Data Behaviour module will be sharing with others */
@@ -216,7 +259,7 @@ struct LocalisationBlackboard {
    std::vector<bool> havePendingIncomingSharedBundle;
 
    /** filtered positions of visual robots */
-   std::vector<RobotObstacle> robotObstacles;
+   SnapshotBuffer<std::vector<RobotObstacle> > robotObstacles;
 };
 
 
@@ -230,12 +273,12 @@ struct VisionBlackboard {
    /* Detected features */
    std::vector<Ipoint>           landmarks;
    std::vector<FootInfo>		 feetBoxes;
-   std::vector<BallInfo>         balls;
+   SnapshotBuffer<std::vector<BallInfo> > balls;
    BallHint                      ballHint;
    std::vector<PostInfo>         posts;
-   std::vector<RobotInfo>        robots;
+   SnapshotBuffer<std::vector<RobotInfo> > robots;
    std::vector<FieldEdgeInfo>    fieldEdges;
-   std::vector<FieldFeatureInfo> fieldFeatures;	
+   SnapshotBuffer<std::vector<FieldFeatureInfo> > fieldFeatures;
    unsigned int                  missedFrames;
    std::pair<int, int>           dxdy;
    PostInfo::Type                goalArea;
@@ -290,12 +333,14 @@ struct GameControllerBlackboard {
 
 struct MotionBlackboard {
    explicit MotionBlackboard();
-   SensorValues sensors;
-   // A rolling list of recent observations of range (m) readings to potentially multiple obstacles
-   std::vector < std::vector <int> > sonarWindow; 
+   Seqlock<SensorValues> sensors;
+   // Recent pings of range (mm) readings to potentially multiple obstacles,
+   // filtered in place by Perception. Owned by the process running them,
+   // NULL elsewhere
+   SonarWindow *sonarWindow;
    float uptime;
    ActionCommand::All active;
-   Odometry odometry;
+   Seqlock<Odometry> odometry;
    ButtonPresses buttons;
    Pose pose;
    XYZ_Coord com;
@@ -317,6 +362,8 @@ struct ReceiverBlackboard {
    int team;
    void readOptions(const boost::program_options::variables_map& config);
    time_t lastReceived[ROBOTS_PER_TEAM];
+   // in micro-seconds, on the same clock as vision.timestamp
+   int64_t lastReceivedTimestamp[ROBOTS_PER_TEAM];
    bool incapacitated[ROBOTS_PER_TEAM];
 };
 
@@ -327,9 +374,43 @@ struct SynchronisationBlackboard {
    boost::mutex *serialization;
 };
 
+class Blackboard;
+
+/**
+ * Versions of the plain components written with writeTo, keyed by where they
+ * are in the Blackboard. An entry is claimed without locks the first time its
+ * component is written or asked about. Should the table ever fill up, the
+ * remaining components share one version, which only costs them spurious
+ * changes. So do components that live outside the Blackboard, such as the
+ * entries of a map in it, as they have no fixed place to key them by.
+ */
+class ComponentVersions {
+   public:
+      ComponentVersions();
+
+      /* @return the Version of a component of blackboard */
+      Version &find(const Blackboard *blackboard, const void *component);
+
+   private:
+      static const uint32_t SIZE = 256;
+
+      /* offset + 1 of the component each entry is for, or 0 if unclaimed */
+      volatile uint32_t keys[SIZE];
+      Version versions[SIZE];
+      Version overflow;
+};
+
+/* How many threads can publish their timing */
+const int MAX_TIMED_THREADS = 8;
+
 struct ThreadBlackboard {
    explicit ThreadBlackboard();
    std::map<std::string, boost::function<void(const boost::program_options::variables_map &)> > configCallbacks;
+
+   /* Tick times and deadline misses, claimed by each ThreadManager in turn,
+    * and shown in offnao */
+   Seqlock<ThreadTiming> timings[MAX_TIMED_THREADS];
+   int numTimings;
 };
 
 class Blackboard {
@@ -358,6 +439,7 @@ class Blackboard {
    friend class PerceptionThread;
    friend class KinematicsCalibrationSkill;
    friend class ThreadManager;
+   template <class T> friend struct WakeEvent;
 
    // Off-nao friends
    friend class DumpReader;
@@ -394,6 +476,19 @@ class Blackboard {
       /* Write a component to the Blackboard */
       template<class T> void write(T *component, const T& value);
 
+      /* Lock-free components, see readFrom and writeTo */
+      template<class T> const T& read(const Seqlock<T> *component);
+      template<class T> void write(Seqlock<T> *component, const T& value);
+      template<class T> const T& read(const SnapshotBuffer<T> *component);
+      template<class T> void write(SnapshotBuffer<T> *component,
+                                   const T& value);
+
+      /* Changes to a component, see versionOf and waitForChange */
+      template<class T> const Version& changes(const T *component);
+      template<class T> const Version& changes(const Seqlock<T> *component);
+      template<class T> const Version& changes(
+         const SnapshotBuffer<T> *component);
+
       /**
        * helper for serialization
        */
@@ -463,6 +558,9 @@ class Blackboard {
 
       /* Locks used for inter-thread synchronisation */
       SynchronisationBlackboard locks;
+
+      /* Changes to the components that are not lock-free */
+      ComponentVersions versions;
 };
 
 #include "Blackboard.tcc"
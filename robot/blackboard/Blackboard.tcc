@@ -1,6 +1,9 @@
 #include <boost/serialization/binary_object.hpp>
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/nvp.hpp>
+#include <boost/serialization/split_free.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <boost/serialization/level.hpp>
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
 
@@ -12,8 +15,119 @@ const T& Blackboard::read(const T *component) {
 template<class T>
 void Blackboard::write(T *component, const T& value) {
    *component = value;
+   versions.find(this, component).bump();
 }
 
+template<class T>
+const T& Blackboard::read(const Seqlock<T> *component) {
+   return component->read();
+}
+
+template<class T>
+void Blackboard::write(Seqlock<T> *component, const T& value) {
+   component->write(value);
+}
+
+template<class T>
+const T& Blackboard::read(const SnapshotBuffer<T> *component) {
+   return component->acquire();
+}
+
+template<class T>
+void Blackboard::write(SnapshotBuffer<T> *component, const T& value) {
+   component->publish(value);
+}
+
+template<class T>
+const Version& Blackboard::changes(const T *component) {
+   return versions.find(this, component);
+}
+
+template<class T>
+const Version& Blackboard::changes(const Seqlock<T> *component) {
+   return component->version();
+}
+
+template<class T>
+const Version& Blackboard::changes(const SnapshotBuffer<T> *component) {
+   return component->version();
+}
+
+/*
+ * Lock-free components serialise as the value they hold, with no class
+ * information of their own, so dumps are unchanged by them.
+ */
+namespace boost {
+namespace serialization {
+
+template<class Archive, class T>
+void save(Archive &ar, const Seqlock<T> &component, const unsigned int) {
+   ar & component.read();
+}
+
+template<class Archive, class T>
+void load(Archive &ar, Seqlock<T> &component, const unsigned int) {
+   T value;
+   ar & value;
+   component.write(value);
+}
+
+template<class Archive, class T>
+void serialize(Archive &ar, Seqlock<T> &component,
+               const unsigned int version) {
+   split_free(ar, component, version);
+}
+
+template<class Archive, class T>
+void save(Archive &ar, const SnapshotBuffer<T> &component,
+          const unsigned int) {
+   ar & component.acquire();
+}
+
+template<class Archive, class T>
+void load(Archive &ar, SnapshotBuffer<T> &component, const unsigned int) {
+   T value;
+   ar & value;
+   component.publish(value);
+}
+
+template<class Archive, class T>
+void serialize(Archive &ar, SnapshotBuffer<T> &component,
+               const unsigned int version) {
+   split_free(ar, component, version);
+}
+
+template<class T>
+struct implementation_level<Seqlock<T> > {
+   typedef mpl::integral_c_tag tag;
+   typedef mpl::int_<object_serializable> type;
+   BOOST_STATIC_CONSTANT(int, value = object_serializable);
+};
+
+template<class T>
+struct tracking_level<Seqlock<T> > {
+   typedef mpl::integral_c_tag tag;
+   typedef mpl::int_<track_never> type;
+   BOOST_STATIC_CONSTANT(int, value = track_never);
+};
+
+template<class T>
+struct implementation_level<SnapshotBuffer<T> > {
+   typedef mpl::integral_c_tag tag;
+   typedef mpl::int_<object_serializable> type;
+   BOOST_STATIC_CONSTANT(int, value = object_serializable);
+};
+
+template<class T>
+struct tracking_level<SnapshotBuffer<T> > {
+   typedef mpl::integral_c_tag tag;
+   typedef mpl::int_<track_never> type;
+   BOOST_STATIC_CONSTANT(int, value = track_never);
+};
+
+}  // namespace serialization
+}  // namespace boost
+
 BOOST_CLASS_VERSION(Blackboard, 16);
 
 template<class Archive>
@@ -47,12 +47,14 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "thread/ThreadManager.hpp"
 #include "motion/MotionAdapter.hpp"
+#include "motion/SonarRecorder.hpp"
 #include "transmitter/OffNao.hpp"
 #include "transmitter/Team.hpp"
 #include "receiver/Team.hpp"
 #include "receiver/RemoteControl.hpp"
 #include "gamecontroller/GameController.hpp"
 #include "perception/PerceptionThread.hpp"
+#include "perception/kinematics/PoseService.hpp"
 #include "perception/vision/Vision.hpp"
 #include "perception/vision/NaoCamera.hpp"
 #include "perception/vision/NaoCameraV4.hpp"
@@ -145,6 +147,12 @@ int main(int argc, char **argv) {
 
 
    Blackboard *blackboard = new Blackboard(vm);
+   // Outlives every thread, adapters are rebuilt without being destroyed
+   // after a crash
+   PoseService poseService;
+   blackboard->kinematics.poseService = &poseService;
+   SonarWindow sonarWindow;
+   blackboard->motion.sonarWindow = &sonarWindow;
 
    if (vm["debug.vision"].as<bool>()) {
       if (naoVersion >= nao_v4) {
@@ -169,7 +177,7 @@ int main(int argc, char **argv) {
    registerSignalHandlers();
 
    // create thread managers
-   ThreadManager perception("Perception", 0); // as fast as possible, waits on camera read
+   ThreadManager perception("Perception", 0, 50000); // as fast as possible, waits on camera read
    ThreadManager motion("Motion", 0); // as fast as possible, waits on agent semaphore
    ThreadManager gameController("GameController", 0); // as fast as possible, waits on udp read
    ThreadManager offnaoTransmitter("OffnaoTransmitter", 50000); // 20fps limit
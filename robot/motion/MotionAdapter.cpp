@@ -31,6 +31,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "motion/MotionAdapter.hpp"
 
+#include <sys/time.h>
 #include <boost/bind.hpp>
 
 #ifdef SIMULATION
@@ -44,8 +45,8 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "motion/touch/FilteredTouch.hpp"
 #include "motion/effector/NullEffector.hpp"
 #include "motion/generator/ClippedGenerator.hpp"
-#include "motion/generator/DistributedGenerator.hpp"
 #include "blackboard/Blackboard.hpp"
+#include "perception/kinematics/PoseService.hpp"
 #include "thread/Thread.hpp"
 #include "utils/Logger.hpp"
 #include "utils/body.hpp"
@@ -55,7 +56,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "types/SensorValues.hpp"
 #include "utils/Timer.hpp"
 
-#define SENSOR_LAG 6 // buffer the sensors/pose by 8 motion ticks and it synchronises well with vision
+#define SENSOR_LAG 6 // buffer the sensors by 6 motion ticks and it synchronises well with vision
 
 using namespace std;
 
@@ -88,8 +89,6 @@ MotionAdapter::MotionAdapter(Blackboard *bb)
    : Adapter(bb), uptime(0) {
    llog(INFO) << "Constructing MotionAdapter" << endl;
 
-   sensorBuffer.clear();
-
    // We only construct the NullTouch/Generators, the rest are done on demand
    touches["Null"] = (Touch*)(new NullTouch());
    if (touches["Null"] == NULL) {
@@ -105,8 +104,7 @@ MotionAdapter::MotionAdapter(Blackboard *bb)
    nakedTouch = touches["Null"];
    touch = (Touch*) new FilteredTouch(touches["Null"]);
 
-   generator = (Generator*) new ClippedGenerator(
-      (Generator*) new DistributedGenerator(bb));
+   generator = new ClippedGenerator(bb);
    if (generator == NULL) {
       llog(FATAL) << "MotionAdapter: NULL Generator" << endl;
    }
@@ -208,21 +206,24 @@ void MotionAdapter::tick() {
        sensors = touch->getSensors(kinematics);
    }
 
+   // Perception computes the camera pose at its own rate from this history,
+   // interpolated to when each image was captured
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   PoseService *poseService = blackboard->kinematics.poseService;
+   poseService->push((int64_t)now.tv_sec * 1000000 + now.tv_usec, sensors);
+
    // For kinematics, give it the lagged sensorValues with the most recent lean angles (because they already
-   // have a lag in them) unless it's the very first one otherwise it will propagate nans everywhere
+   // have a lag in them). Until there is enough history this is the oldest sample, and never empty since
+   // we just pushed one, otherwise it would propagate nans everywhere
    SensorValues sensorsLagged;
-   if (sensorBuffer.size() > 0) {
-      sensorsLagged = sensorBuffer.back(); 
-   } else {
-      sensorsLagged = sensors; 
-   }
+   poseService->getLagged(SENSOR_LAG, &sensorsLagged);
    sensorsLagged.sensors[Sensors::InertialSensor_AngleX] = sensors.sensors[Sensors::InertialSensor_AngleX];
    sensorsLagged.sensors[Sensors::InertialSensor_AngleY] = sensors.sensors[Sensors::InertialSensor_AngleY];
    kinematics.setSensorValues(sensorsLagged);
    kinematics.parameters = readFrom(kinematics, parameters);
-   // Calculate the Denavit-Hartenberg chain
+   // Calculate the Denavit-Hartenberg chain, the body model still needs it
    kinematics.updateDHChain();
-   writeTo(motion, pose, kinematics.getPose());
 
    bool standing = touch->getStanding();
    ButtonPresses buttons = touch->getButtons();
@@ -238,21 +239,11 @@ void MotionAdapter::tick() {
    }
    writeTo(motion, uptime, uptime);
 
-   // Sensors are lagged so it correctly synchronises with vision
-   sensorBuffer.insert(sensorBuffer.begin(), sensors);
-   writeTo(motion, sensors, sensors); //Lagged);
+   writeTo(motion, sensors, sensors);
    writeTo(kinematics, sensorsLagged, sensorsLagged);
-//   std::cout << "live = " << sensors.joints.angles[Joints::HeadYaw]
-//             << " delayed = " << sensorsLagged.joints.angles[Joints::HeadYaw]
-//             << std::endl;
-
-   if (sensorBuffer.size() > SENSOR_LAG) {
-      sensorBuffer.pop_back();
-   }
 
    // sonar recorder gets and update and returns the next sonar request
-   request.sonar = sonarRecorder.update(sensors.sonar);
-   writeTo(motion, sonarWindow, sonarRecorder.sonarWindow);
+   request.sonar = sonarRecorder.update(sensors.sonar, readFrom(motion, sonarWindow));
 
    if (isIncapacitated(request.body.actionType)) {
       uptime = 0.0f;
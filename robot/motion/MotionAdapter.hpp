@@ -34,7 +34,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <map>
 #include "motion/effector/Effector.hpp"
-#include "motion/generator/Generator.hpp"
+#include "motion/generator/ClippedGenerator.hpp"
 #include "motion/touch/FilteredTouch.hpp"
 #include "blackboard/Adapter.hpp"
 #include "motion/generator/BodyModel.hpp"
@@ -67,8 +67,6 @@ class MotionAdapter : Adapter {
       void readOptions(const boost::program_options::variables_map& config);
    private:
       Odometry odometry;
-      /* Buffers so synchronises with vision thread */
-      std::vector<SensorValues> sensorBuffer;
       /* Sonar window recorder */
       SonarRecorder sonarRecorder;
       /* Duration since we last were told to stand up by libagent (seconds) */
@@ -79,7 +77,7 @@ class MotionAdapter : Adapter {
       /* Motion module instance */
       Touch* nakedTouch;  //original, unfiltered
       Touch* touch;
-      Generator* generator;
+      ClippedGenerator* generator;
       Effector* effector;
       BodyModel bodyModel;
       Kinematics kinematics;
@@ -1,8 +1,8 @@
 #pragma once
 
 #include <vector>
-#include <list>
 #include "utils/body.hpp"
+#include "utils/SampleRing.hpp"
 
 
 #define WINDOW_SIZE 4 // keep this a power of 2
@@ -11,6 +11,21 @@
 // Time lag will be 10 cycles * 10ms * 3 directions * window size = 1200ms
 // Need to allow at least 20ms between pings since sound only travels 3.3m in 10ms
 
+/* The range readings (mm) one receiver got from a ping */
+struct SonarPing {
+   int count;
+   int readings[Sonar::NUMBER_OF_READINGS / 2];
+};
+
+/**
+ * The recent pings of each direction, written by Motion and read in place
+ * by the SonarFilter. Twice the window is kept so that the filter can catch
+ * up on a ping it missed before it is overwritten.
+ */
+struct SonarWindow {
+   SampleRing<SonarPing, 2 * WINDOW_SIZE> pings[Sonar::SIZE];
+};
+
 
 /* Simple histogram based filter for noisy sonar observations */
 class SonarRecorder {
@@ -18,11 +33,8 @@ class SonarRecorder {
 
       SonarRecorder();
 
-      /* Update the rolling window of recent observations and return the next Sonar::Mode request*/
-      float update(float sonar[Sonar::NUMBER_OF_READINGS]);
-
-      // A rolling list of recent observations of range readings to potentially multiple obstacles
-      std::vector< std::vector <int> > sonarWindow;
+      /* Record the last ping into the window and return the next Sonar::Mode request*/
+      float update(float sonar[Sonar::NUMBER_OF_READINGS], SonarWindow *window);
 
 
    private:
@@ -32,10 +44,6 @@ class SonarRecorder {
       int cycle_counter;
       std::vector<float> commands;
 
-      std::list<int> leftDrop;
-      std::list<int> middleDrop;
-      std::list<int> rightDrop;
-
-      float processUpdate(float sonar[Sonar::NUMBER_OF_READINGS]);
+      float processUpdate(float sonar[Sonar::NUMBER_OF_READINGS], SonarWindow *window);
 
 };
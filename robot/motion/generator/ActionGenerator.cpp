@@ -29,9 +29,9 @@ with this source code; if not, write to the Free Software Foundation,
 Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
+#include <cstdlib>
 #include <fstream>
-#include <limits>
-#include <cctype>
+#include <sstream>
 #include "motion/generator/ActionGenerator.hpp"
 #include "utils/Logger.hpp"
 #include "utils/angles.hpp"
@@ -39,7 +39,8 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 using namespace std;
 using boost::program_options::variables_map;
 
-ActionGenerator::ActionGenerator(std::string filename) : file_name(filename) {
+ActionGenerator::ActionGenerator(std::string filename)
+   : file_name(filename), keyframes(NULL), segment(0) {
    max_iter = 0;
    current_time = NOT_RUNNING;
 };
@@ -69,160 +70,141 @@ JointValues ActionGenerator::makeJoints(ActionCommand::All* request,
    if (current_time == NOT_RUNNING) {
       // current_time = 0;
       active = request->body;
-      j = joints[joints.size() - 1];
+      j = jointsAt(numTicks() - 1);
    } else {
-      JointValues newJoints = sensors.joints;
-      for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
-         newJoints.stiffnesses[i] = 1.0f;
+      if (current_time == 0) {
+         // Move to the first keyframe from wherever we are now
+         startJoints = sensors.joints;
+         for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
+            startJoints.stiffnesses[i] = 1.0f;
+         }
+         segment = 0;
       }
-      if (current_time == 0) interpolate(newJoints);
-      j = joints[current_time++];
-      if (current_time == (signed int)joints.size())  // if we just did last action
+      j = jointsAt(current_time++);
+      if (current_time == numTicks())  // if we just did last action
          current_time = NOT_RUNNING;
    }
-   // JointValues j = joints[current_time++];
    return j;
 };
 
-void ActionGenerator::interpolate(JointValues newJoint, int duration) {
-   if (joints.empty()) {
-      max_iter = duration / 10;
-      // Reserve space for the interpolation when the generator
-      // first called
-      for (int i = 0; i < max_iter; i++) {
-         joints.push_back(newJoint);
-      }
-      joints.push_back(newJoint);
-   } else {
-      int inTime = 0;
-      float offset[Joints::NUMBER_OF_JOINTS];
+int ActionGenerator::numTicks() const {
+   return targets.empty() ? 1 : targetTicks.back() + 1;
+}
 
-      if (duration != 0) {
-         inTime = duration / 10;
-         JointValues currentJoint = joints.back();
+JointValues ActionGenerator::jointsAt(int tick) {
+   if (tick == 0 || targets.empty()) {
+      return startJoints;
+   }
+   // Ticks only go forwards while running, the end pose may be asked for
+   // at any time in between
+   if (segment >= targets.size() ||
+       (segment > 0 && tick <= targetTicks[segment - 1])) {
+      segment = 0;
+   }
+   while (tick > targetTicks[segment] && segment + 1 < targets.size()) {
+      ++segment;
+   }
 
-         // Calculate the difference between new joint and the previous joint
-         for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
-            offset[i] = (newJoint.angles[i] - currentJoint.angles[i]) / inTime;
-         }
+   const MotionPack::Keyframe &to = keyframes[targets[segment]];
+   JointValues j;
+   for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
+      j.angles[i] = to.angles[i];
+      j.stiffnesses[i] = to.stiffnesses[i];
+   }
+   if (tick >= targetTicks[segment]) {
+      return j;
+   }
 
-         for (int i = 0; i < inTime; i++) {
-            JointValues inJoint;
-            for (int j = 0; j < Joints::NUMBER_OF_JOINTS; j++) {
-               inJoint.angles[j] = joints.back().angles[j] + offset[j];
-               inJoint.stiffnesses[j] = newJoint.stiffnesses[j];
-            }
-            joints.push_back(inJoint);
-         }
-      } else {
+   const float *from = startJoints.angles;
+   int fromTick = 0;
+   if (segment > 0) {
+      from = keyframes[targets[segment - 1]].angles;
+      fromTick = targetTicks[segment - 1];
+   }
+   float fraction = (float)(tick - fromTick) / (targetTicks[segment] - fromTick);
+   for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
+      j.angles[i] = from[i] + (to.angles[i] - from[i]) * fraction;
+   }
+   return j;
+}
 
-         JointValues firstJoint = joints.at(max_iter);
-         // Calculate the difference between the joint at MAX_ITER position
-         // with the new joint
-         for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
-            offset[i] = (firstJoint.angles[i] - newJoint.angles[i]) / max_iter;
-         }
+void ActionGenerator::buildTargets(uint32_t numKeyframes) {
+   targets.clear();
+   targetTicks.clear();
+   segment = 0;
+   if (numKeyframes == 0) {
+      return;
+   }
 
-         joints[0] = newJoint;
-         for (int i = 1; i < max_iter; i++) {
-            for (int j = 0; j < Joints::NUMBER_OF_JOINTS; j++) {
-               joints[i].angles[j] = joints[i - 1].angles[j] + offset[j];
-               joints[i].stiffnesses[j] = firstJoint.stiffnesses[j];
-            }
-         }
+   max_iter = keyframes[0].duration / 10;
+   if (max_iter < 0) {
+      max_iter = 0;
+   }
+   targets.push_back(0);
+   targetTicks.push_back(max_iter);
+   for (uint32_t k = 1; k < numKeyframes; ++k) {
+      int inTime = keyframes[k].duration / 10;
+      if (inTime > 0) {
+         targets.push_back(k);
+         targetTicks.push_back(targetTicks.back() + inTime);
       }
    }
+
+   // Until the motion first runs it starts from its first keyframe
+   for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
+      startJoints.angles[i] = keyframes[0].angles[i];
+      startJoints.stiffnesses[i] = keyframes[0].stiffnesses[i];
+   }
 }
 
 void ActionGenerator::constructPose(std::string path) {
-   ifstream in(string(path + "/" + file_name + ".pos").c_str());
    llog(INFO) << "ActionGenerator(" << file_name << ") creating" << endl;
 
-   if (!in.is_open()) {
+   // The .pos is the source of truth: the pack is only used while the
+   // motion in it was compiled from the same text as the .pos on disk
+   std::string posFile = path + "/" + file_name + ".pos";
+   std::string packFile = path + "/" + MOTION_PACK_FILE;
+   ifstream in(posFile.c_str());
+   stringstream text;
+   bool havePos = in.is_open();
+   if (havePos) {
+      text << in.rdbuf();
+      in.close();
+   }
+
+   uint32_t count = 0;
+   uint32_t sourceHash = 0;
+   const MotionPack *pack = MotionPack::shared(packFile);
+   keyframes = pack ? pack->find(file_name, &count, &sourceHash) : NULL;
+   parsedKeyframes.clear();
+
+   if (keyframes && havePos &&
+       sourceHash != MotionPack::hashSource(text.str())) {
+      llog(WARNING) << "ActionGenerator(" << file_name << ") " << packFile
+                    << " is stale, rebuild it" << endl;
+      keyframes = NULL;
+   }
+
+   if (keyframes) {
+      llog(INFO) << "ActionGenerator(" << file_name << ") loaded from "
+                 << packFile << endl;
+   } else if (!havePos) {
       llog(FATAL) << "ActionGenerator can not open " << file_name << endl;
+      count = 0;
    } else {
-      int duration = 0;
-      float stiffness = 1.0;
-      float angles = 0.0;
-      while (isspace(in.peek())) {
-         in.ignore();
+      std::string error;
+      if (!MotionPack::parsePos(text, &parsedKeyframes, &error)) {
+         std::cout << "You're " << error << " in " << file_name << ".pos" << std::endl;
+         exit(1);
       }
-      while (!in.eof()) {
-         // Ignore comments, newlines and ensure not eof
-         if (in.peek() == '#' || in.peek() == '\n' || in.peek() == EOF) {
-            in.ignore(std::numeric_limits<int>::max(), '\n');
-            continue;
-         }
-         JointValues newJoint;
-         // Read the angles in the file to create a new JointValue
-         for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
-            while (isspace(in.peek())) {
-               in.ignore();
-            }
-            if (in.peek() == '#' || in.peek() == '$' || in.peek() == '\n' || in.peek() == EOF) {
-               std::cout << "You're missing a joint value in " << file_name << ".pos" << std::endl;
-               exit(1);
-            }
-            in >> angles;
-            // Convert degree to radian because the values in the file
-            // are in degree
-            newJoint.angles[i] = DEG2RAD(angles);
-            newJoint.stiffnesses[i] = 1.0;
-         }
-
-         // read in the duration
-         while (isspace(in.peek())) {
-            in.ignore();
-         }
-         if (in.peek() == '#' || in.peek() == '$' || in.peek() == '\n' || in.peek() == EOF) {
-            std::cout << "You're missing a duration in " << file_name << ".pos" << std::endl;
-            exit(1);
-         }
-         in >> duration;
-
-         // Ignore comments, newlines and ensure not eof
-         while (isspace(in.peek())) {
-            in.ignore();
-         }
-         while (in.peek() == '#') {
-            in.ignore(std::numeric_limits<int>::max(), '\n');
-         }
-         while (isspace(in.peek())) {
-            in.ignore();
-         }
-
-         // Stiffnesses are specified by a line beginning with "$"
-         if (in.peek() == '$') {
-            in.ignore(std::numeric_limits<int>::max(), '$');
-            for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
-               while (isspace(in.peek())) {
-                  in.ignore();
-               }
-               if (in.peek() == '#' || in.peek() == '\n' || in.peek() == EOF) {
-                  std::cout << "You're missing a stiffness value in " << file_name << ".pos" << std::endl;
-                  exit(1);
-               }
-               in >> stiffness;
-               newJoint.stiffnesses[i] = stiffness;
-            }
-            // Ignore comments, newlines and ensure not eof
-            while (isspace(in.peek())) {
-               in.ignore();
-            }
-            while (in.peek() == '#') {
-               in.ignore(std::numeric_limits<int>::max(), '\n');
-            }
-            while (isspace(in.peek())) {
-               in.ignore();
-            }
-         }
-         interpolate(newJoint, duration);
-         while (isspace(in.peek())) {
-            in.ignore();
-         }
+      count = parsedKeyframes.size();
+      if (count > 0) {
+         keyframes = &parsedKeyframes[0];
       }
-      in.close();
+      llog(INFO) << "ActionGenerator(" << file_name << ") loaded from "
+                 << posFile << endl;
    }
+   buildTargets(count);
    llog(INFO) << "ActionGenerator(" << file_name << ") created" << endl;
 }
 
@@ -34,6 +34,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <vector>
 #include "motion/generator/Generator.hpp"
+#include "motion/generator/MotionPack.hpp"
 
 /* Determine whether the class is just called */
 #define NOT_RUNNING -1
@@ -41,6 +42,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 /* Hack the stiffness */
 #define MAX_STIFF 1.0
 
+/* Motion pack in motion.path holding the compiled .pos files */
+#define MOTION_PACK_FILE "motions.pack"
+
 class ActionGenerator : Generator {
    public:
       explicit ActionGenerator(std::string filename);
@@ -60,9 +64,29 @@ class ActionGenerator : Generator {
    private:
       int current_time;
       std::string file_name;
-      std::vector<JointValues> joints;
       ActionCommand::Body active;
 
+      /**
+       * The keyframes, either mapped from the motion pack or parsed from
+       * the .pos file into parsedKeyframes
+       */
+      const MotionPack::Keyframe *keyframes;
+      std::vector<MotionPack::Keyframe> parsedKeyframes;
+
+      /**
+       * Keyframes that are actually moved to, in order, and the tick at
+       * which each is reached. The first one is reached after max_iter
+       * ticks of moving from where the robot was when it started.
+       */
+      std::vector<int> targets;
+      std::vector<int> targetTicks;
+
+      /* The pose the motion started from */
+      JointValues startJoints;
+
+      /* Index into targets of the keyframe being moved towards */
+      unsigned int segment;
+
       /**
        * Determine the duration before the robot
        * actually begins to execute the sequence
@@ -71,21 +95,24 @@ class ActionGenerator : Generator {
       int max_iter;
 
       /**
-       * Interpolate the time that are determined by the
-       * duration between the new joints with the previous
-       * joints that are read in the file
-       * @param newJoint the value of the joint that need to be
-       * interpolated with the previous value
-       * @param duration if duration = 0, it will do the interpolation
-       * between the newJoint value with the joint at MAX_ITER position.
-       * Otherwise, it will interpolate between the new joint and the previous
-       * joint.
+       * Works out which keyframes are moved to and when, the same way
+       * the poses used to be expanded tick by tick up front. Keyframes
+       * other than the first with less than a tick of duration are never
+       * moved to.
+       */
+      void buildTargets(uint32_t numKeyframes);
+
+      /**
+       * The joints for one tick, interpolated between keyframes
        */
-      void interpolate(JointValues newJoint, int duration = 0);
+      JointValues jointsAt(int tick);
+
+      /* Number of ticks in the whole motion */
+      int numTicks() const;
 
       /**
-       * Reading the file from the provided path and construct
-       * the pose
+       * Maps the motion from the motion pack in path if it has it,
+       * otherwise parses the .pos file
        * @param path the directory to read the pose file
        */
       void constructPose(std::string path);
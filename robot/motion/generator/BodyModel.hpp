@@ -118,7 +118,7 @@ class BodyModel {
          this->walkCycle = w;
       }
 
-      WalkCycle getWalkCycle() {
+      WalkCycle getWalkCycle() const {
          return walkCycle;
       }
 
@@ -37,28 +37,27 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 using boost::program_options::variables_map;
 
-ClippedGenerator::ClippedGenerator(Generator* g)
-   : generator(g),
+ClippedGenerator::ClippedGenerator(Blackboard *bb)
+   : generator(bb),
      old_exists(false) {
    llog(INFO) << "ClippedGenerator constructed" << std::endl;
 }
 
 ClippedGenerator::~ClippedGenerator() {
-   delete generator;
    llog(INFO) << "ClippedGenerator destroyed" << std::endl;
 }
 
 bool ClippedGenerator::isActive() {
-   return generator->isActive();
+   return generator.isActive();
 }
 
 void ClippedGenerator::reset() {
-   generator->reset();
+   generator.reset();
    old_exists = false;
 }
 
 void ClippedGenerator::readOptions(const boost::program_options::variables_map &config) {
-   generator->readOptions(config);
+   generator.readOptions(config);
 }
 
 JointValues ClippedGenerator::makeJoints(ActionCommand::All* request,
@@ -67,7 +66,7 @@ JointValues ClippedGenerator::makeJoints(ActionCommand::All* request,
                                          BodyModel &bodyModel,
                                          float ballX,
                                          float ballY) {
-   JointValues j = generator->makeJoints(request, odometry, sensors, bodyModel, ballX, ballY);
+   JointValues j = generator.makeJoints(request, odometry, sensors, bodyModel, ballX, ballY);
    for (uint8_t i = 0; i < Joints::NUMBER_OF_JOINTS; ++i) {
       // Clip stifnesses
       if (j.stiffnesses[i] >= 0.0f) {
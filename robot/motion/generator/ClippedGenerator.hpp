@@ -32,10 +32,16 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #pragma once
 
 #include "motion/generator/Generator.hpp"
+#include "motion/generator/DistributedGenerator.hpp"
 
+/**
+ * Clips the joints DistributedGenerator asks for to the joint limits and
+ * maximum joint speeds. It owns the DistributedGenerator so that the whole
+ * pipeline is called directly rather than through Generator pointers.
+ */
 class ClippedGenerator : Generator {
    public:
-      explicit ClippedGenerator(Generator* g);
+      explicit ClippedGenerator(Blackboard *bb);
       ~ClippedGenerator();
       virtual JointValues makeJoints(ActionCommand::All* request,
                                      Odometry* odometry,
@@ -48,7 +54,7 @@ class ClippedGenerator : Generator {
       void readOptions(const boost::program_options::variables_map &config);
 
    private:
-      Generator* generator;
+      DistributedGenerator generator;
       JointValues old_j;
       bool old_exists;
 };
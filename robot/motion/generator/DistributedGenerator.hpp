@@ -31,11 +31,27 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #pragma once
 
-#include <map>
-#include <string>
 #include "motion/generator/Generator.hpp"
+#include "motion/generator/ActionGenerator.hpp"
+#include "motion/generator/DeadGenerator.hpp"
+#include "motion/generator/HeadGenerator.hpp"
+#include "motion/generator/NullGenerator.hpp"
+#include "motion/generator/RefPickupGenerator.hpp"
+#include "motion/generator/StandGenerator.hpp"
+#include "motion/generator/WalkEnginePreProcessor.hpp"
 #include "blackboard/Blackboard.hpp"
 
+/**
+ * Switches between the body generators as the requested action changes, and
+ * fills in the head joints for the actions that leave the head free.
+ *
+ * The generators are members rather than a table of Generator pointers, and
+ * each action type is mapped to one of them by a constant table, so a tick
+ * is a switch on that table plus direct calls, not a chain of virtual calls.
+ * Several action types map to the same generator (e.g. the walk engine
+ * handles WALK, KICK, DRIBBLE and LINE_UP), which is what decides whether a
+ * change of action is a change of generator.
+ */
 class DistributedGenerator : Generator {
    public:
       explicit DistributedGenerator(Blackboard *bb);
@@ -49,12 +65,61 @@ class DistributedGenerator : Generator {
       virtual bool isActive();
       void reset();
       void readOptions(const boost::program_options::variables_map &config);
-      bool isStopping;
+
+      /* The generator an action type is run by */
+      enum Slot {
+         NULL_SLOT,
+         STAND_SLOT,
+         WALK_SLOT,
+         DEAD_SLOT,
+         REF_PICKUP_SLOT,
+         // ActionGenerators, one per action type using a keyframe motion
+         ACTION_SLOT
+      };
+
+      struct Route {
+         Slot slot;
+         // the motion file of an ACTION_SLOT
+         const char *motion;
+         bool usesHead;
+      };
+
+      static const Route routes[ActionCommand::Body::NUM_ACTION_TYPES];
+
+      /* Where the switching between generators is up to */
+      struct Transition {
+         ActionCommand::Body::ActionType current;
+         ActionCommand::Body::ActionType previous;
+         ActionCommand::Body::ActionType requestedDive;
+         bool isStopping;
+      };
+
+      const Transition &getTransition() const { return transition; }
 
    private:
-      Generator* bodyGenerators[ActionCommand::Body::NUM_ACTION_TYPES];
-      Generator* headGenerator;
-      ActionCommand::Body::ActionType current_generator;
-      ActionCommand::Body::ActionType prev_generator;
-      ActionCommand::Body::ActionType requestedDive;
+      NullGenerator nullGenerator;
+      StandGenerator standGenerator;
+      WalkEnginePreProcessor walkGenerator;
+      DeadGenerator deadGenerator;
+      RefPickupGenerator refPickupGenerator;
+      ActionGenerator *actionGenerators[ActionCommand::Body::NUM_ACTION_TYPES];
+      HeadGenerator headGenerator;
+
+      Transition transition;
+
+      /* Whether two action types are run by the same generator */
+      bool sameGenerator(ActionCommand::Body::ActionType a,
+                         ActionCommand::Body::ActionType b) const;
+
+      JointValues bodyJoints(ActionCommand::Body::ActionType type,
+                             ActionCommand::All* request,
+                             Odometry* odometry,
+                             const SensorValues &sensors,
+                             BodyModel &bodyModel,
+                             float ballX,
+                             float ballY);
+      bool bodyIsActive(ActionCommand::Body::ActionType type);
+
+      /* For the calls made on a change of generator rather than every tick */
+      Generator *body(ActionCommand::Body::ActionType type);
 };
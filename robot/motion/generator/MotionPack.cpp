@@ -0,0 +1,288 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "motion/generator/MotionPack.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include "utils/angles.hpp"
+
+using namespace std;
+
+MotionPack::MotionPack()
+   : data(MAP_FAILED), size(0), header(NULL), entries(NULL), keyframes(NULL) {
+}
+
+MotionPack::~MotionPack() {
+   close();
+}
+
+void MotionPack::close() {
+   if (data != MAP_FAILED) {
+      munmap(data, size);
+   }
+   data = MAP_FAILED;
+   size = 0;
+   header = NULL;
+   entries = NULL;
+   keyframes = NULL;
+}
+
+bool MotionPack::open(const std::string &file, std::string *error) {
+   close();
+
+   int fd = ::open(file.c_str(), O_RDONLY);
+   if (fd < 0) {
+      *error = "can not open " + file;
+      return false;
+   }
+   struct stat st;
+   if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(Header)) {
+      ::close(fd);
+      *error = file + " is too short";
+      return false;
+   }
+   size = st.st_size;
+   data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   ::close(fd);
+   if (data == MAP_FAILED) {
+      *error = "can not map " + file;
+      return false;
+   }
+
+   const Header *h = (const Header *)data;
+   if (h->magic != MAGIC || h->version != VERSION) {
+      close();
+      *error = file + " is not a version 2 motion pack, rebuild it";
+      return false;
+   }
+   if (h->numJoints != Joints::NUMBER_OF_JOINTS) {
+      close();
+      *error = file + " was compiled for a different number of joints";
+      return false;
+   }
+   // checked by division, as the multiplication can wrap on the robot
+   if (h->numMotions > (size - sizeof(Header)) / sizeof(Entry)) {
+      close();
+      *error = file + " is truncated";
+      return false;
+   }
+   size_t keyframesStart = sizeof(Header) + h->numMotions * sizeof(Entry);
+   size_t numKeyframes = (size - keyframesStart) / sizeof(Keyframe);
+   const Entry *e = (const Entry *)((const char *)data + sizeof(Header));
+   for (uint32_t i = 0; i < h->numMotions; ++i) {
+      if (e[i].first > numKeyframes || e[i].count > numKeyframes - e[i].first ||
+          memchr(e[i].name, '\0', sizeof(e[i].name)) == NULL) {
+         close();
+         *error = file + " has a corrupt motion table";
+         return false;
+      }
+   }
+
+   header = h;
+   entries = e;
+   keyframes = (const Keyframe *)((const char *)data + keyframesStart);
+   return true;
+}
+
+const MotionPack::Keyframe *MotionPack::find(const std::string &name,
+                                             uint32_t *count,
+                                             uint32_t *sourceHash) const {
+   if (header == NULL) {
+      return NULL;
+   }
+   for (uint32_t i = 0; i < header->numMotions; ++i) {
+      if (name == entries[i].name) {
+         *count = entries[i].count;
+         if (sourceHash) {
+            *sourceHash = entries[i].sourceHash;
+         }
+         return keyframes + entries[i].first;
+      }
+   }
+   return NULL;
+}
+
+std::vector<std::string> MotionPack::names() const {
+   vector<string> names;
+   for (uint32_t i = 0; header && i < header->numMotions; ++i) {
+      names.push_back(entries[i].name);
+   }
+   return names;
+}
+
+const MotionPack *MotionPack::shared(const std::string &file) {
+   // Every ActionGenerator asks for the same pack, only map it once
+   static map<string, MotionPack *> packs;
+   map<string, MotionPack *>::iterator it = packs.find(file);
+   if (it == packs.end()) {
+      MotionPack *pack = new MotionPack();
+      string error;
+      if (!pack->open(file, &error)) {
+         delete pack;
+         pack = NULL;
+      }
+      it = packs.insert(make_pair(file, pack)).first;
+   }
+   return it->second;
+}
+
+uint32_t MotionPack::hashSource(const std::string &text) {
+   uint32_t hash = 2166136261u;
+   for (size_t i = 0; i < text.size(); ++i) {
+      hash ^= (unsigned char)text[i];
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+static void skipSpace(std::istream &in) {
+   while (isspace(in.peek())) {
+      in.ignore();
+   }
+}
+
+static void skipComments(std::istream &in) {
+   skipSpace(in);
+   while (in.peek() == '#') {
+      in.ignore(std::numeric_limits<int>::max(), '\n');
+   }
+   skipSpace(in);
+}
+
+bool MotionPack::parsePos(std::istream &in, std::vector<Keyframe> *keyframes,
+                          std::string *error) {
+   skipSpace(in);
+   while (!in.eof()) {
+      // Ignore comments, newlines and ensure not eof
+      if (in.peek() == '#' || in.peek() == '\n' || in.peek() == EOF) {
+         in.ignore(std::numeric_limits<int>::max(), '\n');
+         continue;
+      }
+      Keyframe keyframe;
+      // Read the angles, which are in degrees in the file
+      for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
+         skipSpace(in);
+         if (in.peek() == '#' || in.peek() == '$' || in.peek() == '\n' || in.peek() == EOF) {
+            *error = "missing a joint value";
+            return false;
+         }
+         float angle = 0.0f;
+         in >> angle;
+         keyframe.angles[i] = DEG2RAD(angle);
+         keyframe.stiffnesses[i] = 1.0f;
+      }
+
+      skipSpace(in);
+      if (in.peek() == '#' || in.peek() == '$' || in.peek() == '\n' || in.peek() == EOF) {
+         *error = "missing a duration";
+         return false;
+      }
+      int duration = 0;
+      in >> duration;
+      keyframe.duration = duration;
+      skipComments(in);
+
+      // Stiffnesses are specified by a line beginning with "$"
+      if (in.peek() == '$') {
+         in.ignore(std::numeric_limits<int>::max(), '$');
+         for (int i = 0; i < Joints::NUMBER_OF_JOINTS; i++) {
+            skipSpace(in);
+            if (in.peek() == '#' || in.peek() == '\n' || in.peek() == EOF) {
+               *error = "missing a stiffness value";
+               return false;
+            }
+            in >> keyframe.stiffnesses[i];
+         }
+         skipComments(in);
+      }
+      keyframes->push_back(keyframe);
+      skipSpace(in);
+   }
+   return true;
+}
+
+bool MotionPack::write(const std::string &file,
+                       const std::vector<std::string> &names,
+                       const std::vector<std::vector<Keyframe> > &motions,
+                       const std::vector<uint32_t> &sourceHashes,
+                       std::string *error) {
+   Header h;
+   h.magic = MAGIC;
+   h.version = VERSION;
+   h.numJoints = Joints::NUMBER_OF_JOINTS;
+   h.numMotions = names.size();
+
+   vector<Entry> table(names.size());
+   uint32_t first = 0;
+   for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i].size() >= sizeof(table[i].name)) {
+         *error = "motion name " + names[i] + " is too long";
+         return false;
+      }
+      memset(table[i].name, 0, sizeof(table[i].name));
+      strncpy(table[i].name, names[i].c_str(), sizeof(table[i].name) - 1);
+      table[i].first = first;
+      table[i].count = motions[i].size();
+      table[i].sourceHash = sourceHashes[i];
+      first += motions[i].size();
+   }
+
+   ofstream out(file.c_str(), ios::out | ios::binary | ios::trunc);
+   if (!out.is_open()) {
+      *error = "can not open " + file;
+      return false;
+   }
+   out.write((const char *)&h, sizeof(h));
+   if (!table.empty()) {
+      out.write((const char *)&table[0], table.size() * sizeof(Entry));
+   }
+   for (size_t i = 0; i < motions.size(); ++i) {
+      if (!motions[i].empty()) {
+         out.write((const char *)&motions[i][0],
+                   motions[i].size() * sizeof(Keyframe));
+      }
+   }
+   if (!out.good()) {
+      *error = "failed writing " + file;
+      return false;
+   }
+   return true;
+}
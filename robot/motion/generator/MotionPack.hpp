@@ -0,0 +1,136 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <istream>
+#include <string>
+#include <vector>
+#include "utils/body.hpp"
+
+/**
+ * Keyframe motions (the .pos files) compiled into a single binary file that
+ * is mapped into memory instead of being parsed at start up.
+ *
+ * The file is a Header, then numMotions Entries, then the Keyframes of all
+ * of the motions back to back. It is written in the native byte order; the
+ * robot and the machines the tool runs on are all little endian x86.
+ *
+ * Each Entry records a hash of the .pos text it was compiled from, so a
+ * pack that is older than an edited .pos can be told apart and ignored.
+ */
+class MotionPack {
+   public:
+      struct Keyframe {
+         float angles[Joints::NUMBER_OF_JOINTS];       // radians
+         float stiffnesses[Joints::NUMBER_OF_JOINTS];
+         int32_t duration;                             // ms from the previous keyframe
+      };
+
+      static const uint32_t MAGIC = 0x504d5352;        // "RSMP"
+      static const uint32_t VERSION = 2;
+
+      struct Header {
+         uint32_t magic;
+         uint32_t version;
+         uint32_t numJoints;
+         uint32_t numMotions;
+      };
+
+      struct Entry {
+         char name[32];                                // motion name, e.g. "getupFront"
+         uint32_t first;                               // index of its first keyframe
+         uint32_t count;
+         uint32_t sourceHash;                          // hashSource of its .pos
+      };
+
+      MotionPack();
+      ~MotionPack();
+
+      /**
+       * Maps a pack into memory and checks that it is consistent
+       * @return false with the reason in error if it can not be used
+       */
+      bool open(const std::string &file, std::string *error);
+
+      /**
+       * @param sourceHash if not NULL, set to the hash of the .pos the
+       *        motion was compiled from
+       * @return the keyframes of a motion, or NULL if it is not in the pack
+       */
+      const Keyframe *find(const std::string &name, uint32_t *count,
+                           uint32_t *sourceHash = NULL) const;
+
+      /* @return the names of all of the motions in the pack */
+      std::vector<std::string> names() const;
+
+      /**
+       * Opens a pack once per process and keeps it mapped.
+       * @return NULL if the file is missing or unusable
+       */
+      static const MotionPack *shared(const std::string &file);
+
+      /**
+       * Parses the text .pos format: per keyframe the joint angles in
+       * degrees and a duration in ms, optionally followed by a line of
+       * stiffnesses starting with '$'. '#' starts a comment.
+       * @return false with the reason in error if a value is missing
+       */
+      static bool parsePos(std::istream &in, std::vector<Keyframe> *keyframes,
+                           std::string *error);
+
+      /* @return a 32 bit FNV-1a hash of the text of a .pos file */
+      static uint32_t hashSource(const std::string &text);
+
+      /**
+       * Writes a pack of the given motions, with the hashSource of the .pos
+       * text each was parsed from
+       */
+      static bool write(const std::string &file,
+                        const std::vector<std::string> &names,
+                        const std::vector<std::vector<Keyframe> > &motions,
+                        const std::vector<uint32_t> &sourceHashes,
+                        std::string *error);
+
+   private:
+      void *data;
+      size_t size;
+      const Header *header;
+      const Entry *entries;
+      const Keyframe *keyframes;
+
+      void close();
+
+      // the mapping is owned, so no copies
+      MotionPack(const MotionPack &);
+      MotionPack &operator=(const MotionPack &);
+};
@@ -5,6 +5,9 @@
 #include "types/ActionCommand.hpp"
 
 class Planner {
-   virtual Action getAction(BodyModel p, ActionCommand::All a) = 0;
-};
+   public:
+      virtual ~Planner() {}
 
+      virtual Action getAction(const BodyModel &p,
+                               const ActionCommand::All &a) = 0;
+};
@@ -0,0 +1,243 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "motion/generator/PlannerTable.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+PlannerTable::PlannerTable() {
+   header.magic = MAGIC;
+   header.version = VERSION;
+   header.numGoals = 0;
+   for (int a = 0; a < NUM_AXES; ++a) {
+      header.axes[a].min = 0;
+      header.axes[a].step = 1;
+      header.axes[a].count = 0;
+   }
+}
+
+size_t PlannerTable::size() const {
+   return (size_t)header.numGoals * header.axes[X].count *
+          header.axes[DX].count * header.axes[T].count;
+}
+
+bool PlannerTable::load(const std::string &file, std::string *error) {
+   ifstream in(file.c_str(), ios::in | ios::binary);
+   if (!in.is_open()) {
+      *error = "can not open " + file;
+      return false;
+   }
+   uint32_t magic = 0;
+   in.read((char *)&magic, sizeof(magic));
+   in.seekg(0);
+   if (magic == MAGIC) {
+      return loadBinary(in, error);
+   }
+   in.clear();
+   return loadText(in, error);
+}
+
+bool PlannerTable::loadBinary(std::istream &in, std::string *error) {
+   in.read((char *)&header, sizeof(header));
+   if (!in.good() || header.version != VERSION) {
+      *error = "not a version 1 planner table";
+      return false;
+   }
+   if (header.numGoals == 0) {
+      *error = "planner table has no goals";
+      return false;
+   }
+   for (int a = 0; a < NUM_AXES; ++a) {
+      if (header.axes[a].count == 0 || !(header.axes[a].step > 0)) {
+         *error = "planner table has an empty axis";
+         return false;
+      }
+   }
+   values.resize(size());
+   in.read((char *)&values[0], values.size() * sizeof(float));
+   if (!in.good()) {
+      *error = "planner table is truncated";
+      return false;
+   }
+   return true;
+}
+
+/* One line of a text table */
+struct PlannerRow {
+   int goal;
+   float state[PlannerTable::NUM_AXES];
+   float action;
+};
+
+/* The next line that is not a // comment, false at the end of the file */
+static bool getLineNoComments(std::istream &in, std::string *line) {
+   while (getline(in, *line)) {
+      if (line->compare(0, 2, "//") != 0 &&
+          line->find_first_not_of(" \t\r") != string::npos) {
+         return true;
+      }
+   }
+   return false;
+}
+
+bool PlannerTable::loadText(std::istream &in, std::string *error) {
+   // The first line gives the number of goals, x, dx and t values
+   string line;
+   uint32_t counts[NUM_AXES];
+   if (!getLineNoComments(in, &line) ||
+       !(istringstream(line) >> header.numGoals >> counts[X]
+                             >> counts[DX] >> counts[T])) {
+      *error = "planner table is missing its dimensions";
+      return false;
+   }
+
+   vector<PlannerRow> rows;
+   float lo[NUM_AXES], hi[NUM_AXES];
+   while (getLineNoComments(in, &line)) {
+      PlannerRow row;
+      if (!(istringstream(line) >> row.goal >> row.state[X] >> row.state[DX]
+                                >> row.state[T] >> row.action)) {
+         *error = "bad planner table line: " + line;
+         return false;
+      }
+      for (int a = 0; a < NUM_AXES; ++a) {
+         if (rows.empty() || row.state[a] < lo[a]) lo[a] = row.state[a];
+         if (rows.empty() || row.state[a] > hi[a]) hi[a] = row.state[a];
+      }
+      rows.push_back(row);
+   }
+   if (rows.empty()) {
+      *error = "planner table has no data";
+      return false;
+   }
+
+   for (int a = 0; a < NUM_AXES; ++a) {
+      header.axes[a].min = lo[a];
+      header.axes[a].count = counts[a];
+      header.axes[a].step = counts[a] > 1 ? (hi[a] - lo[a]) / (counts[a] - 1) : 1;
+      if (counts[a] == 0 || !(header.axes[a].step > 0)) {
+         *error = "planner table has an empty axis";
+         return false;
+      }
+   }
+
+   values.assign(size(), 0.0f);
+   for (size_t r = 0; r < rows.size(); ++r) {
+      size_t i = rows[r].goal;
+      if (rows[r].goal < 0 || i >= header.numGoals) {
+         *error = "planner table goal out of range";
+         return false;
+      }
+      for (int a = 0; a < NUM_AXES; ++a) {
+         const Axis &axis = header.axes[a];
+         float u = (rows[r].state[a] - axis.min) / axis.step;
+         int cell = (int)floor(u + 0.5f);
+         if (cell < 0 || (uint32_t)cell >= axis.count || fabs(u - cell) > 0.01f) {
+            *error = "planner table state is not on a uniform grid: " + line;
+            return false;
+         }
+         i = i * axis.count + cell;
+      }
+      values[i] = rows[r].action;
+   }
+   return true;
+}
+
+bool PlannerTable::save(const std::string &file, std::string *error) const {
+   ofstream out(file.c_str(), ios::out | ios::binary | ios::trunc);
+   if (!out.is_open()) {
+      *error = "can not open " + file;
+      return false;
+   }
+   out.write((const char *)&header, sizeof(header));
+   if (!values.empty()) {
+      out.write((const char *)&values[0], values.size() * sizeof(float));
+   }
+   if (!out.good()) {
+      *error = "failed writing " + file;
+      return false;
+   }
+   return true;
+}
+
+/* Where v falls along an axis: the cell below it and how far into it */
+static inline bool locate(const PlannerTable::Axis &axis, float v,
+                          uint32_t *cell, uint32_t *next, float *fraction) {
+   float u = (v - axis.min) / axis.step;
+   // The last grid point covers up to a step past it, as the nearest cell
+   // lookup this replaced did
+   if (!(u >= 0 && u < axis.count)) {
+      return false;
+   }
+   *cell = (uint32_t)u;
+   if (*cell + 1 < axis.count) {
+      *next = *cell + 1;
+      *fraction = u - *cell;
+   } else {
+      *next = *cell;
+      *fraction = 0;
+   }
+   return true;
+}
+
+bool PlannerTable::lookup(int goal, float x, float dx, float t,
+                          float *value) const {
+   uint32_t x0, x1, dx0, dx1, t0, t1;
+   float fx, fdx, ft;
+   if (goal < 0 || (uint32_t)goal >= header.numGoals ||
+       !locate(header.axes[X], x, &x0, &x1, &fx) ||
+       !locate(header.axes[DX], dx, &dx0, &dx1, &fdx) ||
+       !locate(header.axes[T], t, &t0, &t1, &ft)) {
+      return false;
+   }
+
+   const uint32_t nDX = header.axes[DX].count;
+   const uint32_t nT = header.axes[T].count;
+   const float *g = &values[(size_t)goal * header.axes[X].count * nDX * nT];
+   const float *p00 = g + ((size_t)x0 * nDX + dx0) * nT;
+   const float *p01 = g + ((size_t)x0 * nDX + dx1) * nT;
+   const float *p10 = g + ((size_t)x1 * nDX + dx0) * nT;
+   const float *p11 = g + ((size_t)x1 * nDX + dx1) * nT;
+
+   // Along t first, the neighbours are next to each other in memory
+   float v00 = p00[t0] + ft * (p00[t1] - p00[t0]);
+   float v01 = p01[t0] + ft * (p01[t1] - p01[t0]);
+   float v10 = p10[t0] + ft * (p10[t1] - p10[t0]);
+   float v11 = p11[t0] + ft * (p11[t1] - p11[t0]);
+   float v0 = v00 + fdx * (v01 - v00);
+   float v1 = v10 + fdx * (v11 - v10);
+   *value = v0 + fx * (v1 - v0);
+   return true;
+}
@@ -0,0 +1,104 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * A policy table over (goal, x, dx, t), looked up with trilinear
+ * interpolation between the grid points rather than snapping to a cell.
+ *
+ * The grid of each axis is uniform, and is worked out from the data when
+ * the table is loaded, so finer or wider tables need no code changes. t is
+ * the innermost dimension since consecutive lookups during a step mostly
+ * move along it.
+ *
+ * Tables load from the text .rl format, or from the binary format written
+ * by save(), which is a Header followed by the values as floats in
+ * [goal][x][dx][t] order, in native byte order.
+ */
+class PlannerTable {
+   public:
+      /* A uniform grid along one axis */
+      struct Axis {
+         float min;
+         float step;
+         uint32_t count;
+      };
+
+      enum AxisIndex {
+         X = 0,
+         DX,
+         T,
+         NUM_AXES
+      };
+
+      static const uint32_t MAGIC = 0x54505352;        // "RSPT"
+      static const uint32_t VERSION = 1;
+
+      struct Header {
+         uint32_t magic;
+         uint32_t version;
+         uint32_t numGoals;
+         Axis axes[NUM_AXES];
+      };
+
+      PlannerTable();
+
+      /**
+       * Loads a binary table, or a text one if the file is not binary
+       * @return false with the reason in error if it could not be loaded
+       */
+      bool load(const std::string &file, std::string *error);
+
+      /* Writes the table in the binary format */
+      bool save(const std::string &file, std::string *error) const;
+
+      /**
+       * Interpolates the policy at a state
+       * @return false if goal is unknown or the state is outside the grid
+       */
+      bool lookup(int goal, float x, float dx, float t, float *value) const;
+
+      uint32_t numGoals() const { return header.numGoals; }
+      const Axis &axis(AxisIndex a) const { return header.axes[a]; }
+
+   private:
+      Header header;
+      std::vector<float> values;
+
+      bool loadText(std::istream &in, std::string *error);
+      bool loadBinary(std::istream &in, std::string *error);
+      size_t size() const;
+};
@@ -42,6 +42,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
 #include "motion/generator/Walk2014Generator.hpp"
+#include <climits>
 #include <cmath>
 #include "utils/angles.hpp"
 #include "utils/body.hpp"
@@ -92,6 +93,9 @@ const float MAX_FORWARD = .3;                              // meters
 const float MAX_LEFT = .2;                                 // meters
 const float MAX_TURN = .80;                                // radians
 const float BASE_LEG_LIFT = 0.010;                         // meters
+const float IK_CACHE_LENGTH = 0.00002;                     // leg IK cache resolution in meters
+const float IK_CACHE_ANGLE = 0.0001;                       // leg IK cache resolution in radians
+const float IK_CACHE_MAX_EXTENSION = 0.98;                 // fraction of the leg length beyond which the IK is too sensitive to cache
 
 float KICK_LEAN = KICK_LEAN_V5;
 
@@ -105,7 +109,8 @@ void checkNaN(float n, string s){
 }
 
 Walk2014Generator::Walk2014Generator(Blackboard *bb)
-   :t(0.0f), z(0.0f), PI(3.1415927), blackboard(bb) {
+   :t(0.0f), z(0.0f), PI(3.1415927), useIKCache(false), blackboard(bb) {
+   clearIKCache();
    initialise();
    llog(INFO) << "Walk2014Generator constructed" << std::endl;
 
@@ -717,87 +722,42 @@ JointValues Walk2014Generator::makeJoints(ActionCommand::All* request,
 //    cout << t <<" "<< leftL <<" "<< leftR << endl;
 
    // 9. Work out joint angles from walk variables above
-   // 9.1 Left foot closed form inverse kinematics
+   // 9.1 Left foot closed form inverse kinematics and turn correction
    float leghL = hiph - foothL - ankle;                    // vertical height between ankle and hip in meters
-   float legX0L = leghL / cos(leftL);                      // leg extension (eliminating knee) when forwardL = 0
-   float legXL = sqrt(legX0L*legX0L
-		   +(forwardL+comOffset)*(forwardL+comOffset));    //leg extension at forwardL
-   float beta1L = acos((thigh*thigh+legXL*legXL-tibia*tibia)/(2.0f*thigh*legXL)); // acute angle at hip in thigh-tibia triangle
-   float beta2L = acos((tibia*tibia+legXL*legXL-thigh*thigh)/(2.0f*tibia*legXL)); // acute angle at ankle in thigh-tibia triangle
-   float tempL = legX0L/legXL; if(tempL>1.0f) tempL=1.0f;  // sin ratio to calculate leg extension pitch. If > 1 due to numerical error round down.
-   float deltaL = asin(tempL);                             // leg extension angle
-   float dirL = 1.0f; if ((forwardL+comOffset) > 0.0f) dirL = -1.0f; // signum of position of foot
-   float HpL = beta1L + dirL*(M_PI/2.0f-deltaL);           // Hip pitch is sum of leg-extension + hip acute angle above
-   float ApL = beta2L + dirL*(deltaL - M_PI/2.0f);         // Ankle pitch is a similar calculation for the ankle joint
-   float KpL = HpL + ApL;                                  // to keep torso upright with both feet on the ground, the knee pitch is always the sum of the hip pitch and the ankle pitch.
-
-   // 9.2 right foot closed form inverse kinematics (comments as above but for right leg)
-   float leghR = hiph - foothR - ankle;
-   float legX0R = leghR / cos(leftR);
-   float legXR = sqrt(legX0R*legX0R
-		   +(forwardR+comOffset)*(forwardR+comOffset));
-   float dirR = 1.0f; if ((forwardR+comOffset) > 0.0f) dirR = -1.0f;
-   float beta1R = acos((thigh*thigh+legXR*legXR-tibia*tibia)/(2.0f*thigh*legXR));
-   float beta2R = acos((tibia*tibia+legXR*legXR-thigh*thigh)/(2.0f*tibia*legXR));
-   float tempR = legX0R/legXR; if(tempR>1.0f) tempR=1.0f;
-   float deltaR = asin(tempR);
-   float HpR = beta1R + dirR*(M_PI/2.0f-deltaR);
-   float ApR = beta2R + dirR*(deltaR - M_PI/2.0f);
-   float KpR = HpR + ApR;
-
-   // 9.3 Sert hip and ankle values
    float HrL = -leftL;
-   float HrR = -leftR;
    float ArL = -HrL;
-   float ArR = -HrR;
    if (walk2014Option == KICK || walk2014Option == STEP) {
       HrL += rock;
-      HrR += rock;
       ArL -= rock;
+   }
+   // 9.2 Right foot, mapped to the left leg because of symmetry
+   float leghR = hiph - foothR - ankle;
+   float HrR = -leftR;
+   float ArR = -HrR;
+   if (walk2014Option == KICK || walk2014Option == STEP) {
+      HrR += rock;
       ArR -= rock;
    }
-
-   // 9.4 Adjust HpL, HrL, ApL, ArL LEFT based on Hyp turn to keep ankle in situ
-   // Turning
-   XYZ_Coord tL = mf2b(z, -HpL, HrL, KpL, -ApL, ArL, z, z, z);
-   XYZ_Coord sL;
    float Hyp = -turnRL;
-   for (int i = 0; i < 3; i++) {
-	  sL = mf2b(Hyp, -HpL, HrL, KpL, -ApL, ArL, z, z, z);
-	  XYZ_Coord e((tL.x-sL.x), (tL.y-sL.y), (tL.z-sL.z));
-	  Hpr hpr = hipAngles(Hyp, -HpL, HrL, KpL, -ApL, ArL, z, z, z, e);
-	  HpL -= hpr.Hp;
-	  HrL += hpr.Hr;
-   }
-   // ApL and ArL to make sure LEFT foot is parallel to ground
-   XYZ_Coord up = mf2b(Hyp, -HpL, HrL, KpL, -ApL, ArL, 1.0f, 0.0f, 0.0f);
-   XYZ_Coord ur = mf2b(Hyp, -HpL, HrL, KpL, -ApL, ArL, 0.0f, 1.0f, 0.0f);
-   ApL = ApL + asin(sL.z-up.z);
-   ArL = ArL + asin(sL.z-ur.z);
-
-   // 9.5 Adjust HpR, HrR, ApR, ArR (RIGHT) based on Hyp turn to keep ankle in situ
-   // Map to LEFT - we reuse the left foot IK because of symmetry right foot
-   float Hr = -HrR;
-   float Ar = -ArR;
-   // Target foot origin in body coords
-   XYZ_Coord t = mf2b(z, -HpR, Hr, KpR, -ApR, Ar, z, z, z);
-   XYZ_Coord s;
-   Hyp = -turnRL;
-   for (int i = 0; i < 3; i++) {
-	  s = mf2b(Hyp, -HpR, Hr, KpR, -ApR, Ar, z, z, z);
-	  XYZ_Coord e((t.x-s.x), (t.y-s.y), (t.z-s.z));
-	  Hpr hpr = hipAngles(Hyp, -HpR, Hr, KpR, -ApR, Ar, z, z, z, e);
-	  HpR -= hpr.Hp;
-	  Hr += hpr.Hr;
+   LegAngles legL, legR;
+   if (useIKCache && walk2014Option != KICK && walk2014Option != STEP) {
+      legL = cachedLegAngles(leghL, forwardL + comOffset, HrL, Hyp);
+      legR = cachedLegAngles(leghR, forwardR + comOffset, -HrR, Hyp);
+   } else {
+      legL = legAngles(leghL, forwardL + comOffset, leftL, HrL, ArL, Hyp);
+      legR = legAngles(leghR, forwardR + comOffset, leftR, -HrR, -ArR, Hyp);
    }
-   // 9.6 Ap and Ar to make sure foot is parallel to ground
-   XYZ_Coord u1 = mf2b(Hyp, -HpR, Hr, KpR, -ApR, Ar, 1.0f, 0.0f, 0.0f);
-   XYZ_Coord u2 = mf2b(Hyp, -HpR, Hr, KpR, -ApR, Ar, 0.0f, 1.0f, 0.0f);
-   ApR = ApR + asin(s.z-u1.z);
-   Ar = Ar + asin(s.z-u2.z);
+   float HpL = legL.Hp;
+   float KpL = legL.Kp;
+   float ApL = legL.Ap;
+   HrL = legL.Hr;
+   ArL = legL.Ar;
    // map back from left foot to right foot
-   HrR = -Hr;
-   ArR = -Ar;
+   float HpR = legR.Hp;
+   float KpR = legR.Kp;
+   float ApR = legR.Ap;
+   HrR = -legR.Hr;
+   ArR = -legR.Ar;
 
    // 10. Set joint values and stiffness
    JointValues j = sensors.joints;
@@ -1163,6 +1123,8 @@ bool Walk2014Generator::isActive() {
 
 void Walk2014Generator::readOptions(const boost::program_options::variables_map &config) {
 	v4 = config["motion.v4"].as<bool>();
+	useIKCache = config["walk.ikCache"].as<bool>();
+	clearIKCache();
 	if (v4){
 		KICK_LEAN = KICK_LEAN_V4;
 		std::cout << "Selecting v4 kick lean of " << KICK_LEAN_V4 << endl;
@@ -1183,6 +1145,94 @@ float Walk2014Generator::interpolateSmooth(float start, float end, float tCurren
    return start + (end - start) * (1 + cos(M_PI * tCurrent / tEnd - M_PI)) / 2;
 }
 
+Walk2014Generator::LegAngles Walk2014Generator::legAngles(float legh, float forwardX, float side,
+                                                          float Hr, float Ar, float Hyp) {
+   LegAngles leg;
+   // Closed form inverse kinematics
+   float legX0 = legh / cos(side);                        // leg extension (eliminating knee) when forward = 0
+   float legX = sqrt(legX0*legX0 + forwardX*forwardX);     // leg extension at forward
+   float beta1 = acos((thigh*thigh+legX*legX-tibia*tibia)/(2.0f*thigh*legX)); // acute angle at hip in thigh-tibia triangle
+   float beta2 = acos((tibia*tibia+legX*legX-thigh*thigh)/(2.0f*tibia*legX)); // acute angle at ankle in thigh-tibia triangle
+   float temp = legX0/legX; if(temp>1.0f) temp=1.0f;       // sin ratio to calculate leg extension pitch. If > 1 due to numerical error round down.
+   float delta = asin(temp);                               // leg extension angle
+   float dir = 1.0f; if (forwardX > 0.0f) dir = -1.0f;     // signum of position of foot
+   float Hp = beta1 + dir*(M_PI/2.0f-delta);               // Hip pitch is sum of leg-extension + hip acute angle above
+   float Ap = beta2 + dir*(delta - M_PI/2.0f);             // Ankle pitch is a similar calculation for the ankle joint
+   float Kp = Hp + Ap;                                     // to keep torso upright with both feet on the ground, the knee pitch is always the sum of the hip pitch and the ankle pitch.
+
+   // Adjust Hp and Hr based on Hyp turn to keep ankle in situ
+   XYZ_Coord target = mf2b(z, -Hp, Hr, Kp, -Ap, Ar, z, z, z);
+   XYZ_Coord s;
+   for (int i = 0; i < 3; i++) {
+      s = mf2b(Hyp, -Hp, Hr, Kp, -Ap, Ar, z, z, z);
+      XYZ_Coord e((target.x-s.x), (target.y-s.y), (target.z-s.z));
+      Hpr hpr = hipAngles(Hyp, -Hp, Hr, Kp, -Ap, Ar, z, z, z, e);
+      Hp -= hpr.Hp;
+      Hr += hpr.Hr;
+   }
+   // Ap and Ar to make sure the foot is parallel to ground
+   XYZ_Coord up = mf2b(Hyp, -Hp, Hr, Kp, -Ap, Ar, 1.0f, 0.0f, 0.0f);
+   XYZ_Coord ur = mf2b(Hyp, -Hp, Hr, Kp, -Ap, Ar, 0.0f, 1.0f, 0.0f);
+   leg.Hp = Hp;
+   leg.Hr = Hr;
+   leg.Kp = Kp;
+   leg.Ap = Ap + asin(s.z-up.z);
+   leg.Ar = Ar + asin(s.z-ur.z);
+   return leg;
+}
+
+Walk2014Generator::LegAngles Walk2014Generator::cachedLegAngles(float legh, float forwardX,
+                                                                float Hr, float Hyp) {
+   // Close to a straight knee the angles change too quickly for the grid
+   float legX0 = legh / cos(Hr);
+   float maxLegX = IK_CACHE_MAX_EXTENSION * (thigh + tibia);
+   if (legX0*legX0 + forwardX*forwardX > maxLegX*maxLegX) {
+      return legAngles(legh, forwardX, -Hr, Hr, -Hr, Hyp);
+   }
+
+   float q[4] = {legh / IK_CACHE_LENGTH, forwardX / IK_CACHE_LENGTH,
+                 Hr / IK_CACHE_ANGLE, Hyp / IK_CACHE_ANGLE};
+   uint64_t key = 0;
+   for (int i = 0; i < 4; ++i) {
+      q[i] = floor(q[i] + 0.5f);
+      if (fabs(q[i]) > SHRT_MAX) {
+         return legAngles(legh, forwardX, -Hr, Hr, -Hr, Hyp);
+      }
+      key = (key << 16) | (uint16_t)(int16_t)q[i];
+   }
+
+   // Fibonacci hashing spreads neighbouring cells over the table
+   IKCacheSlot &slot =
+      ikCache[(key * 0x9E3779B97F4A7C15ull) >> (64 - IK_CACHE_BITS)];
+   bool hit = slot.valid && slot.key == key;
+#ifdef WALK_IK_CACHE_STATS
+   ++ikCacheLookups;
+   ikCacheHits += hit;
+#endif
+   if (hit) {
+      return slot.leg;
+   }
+   // Solve at the centre of the cell so the result does not depend on which
+   // point in it was asked for first
+   float HrCell = q[2] * IK_CACHE_ANGLE;
+   slot.leg = legAngles(q[0] * IK_CACHE_LENGTH, q[1] * IK_CACHE_LENGTH,
+                        -HrCell, HrCell, -HrCell, q[3] * IK_CACHE_ANGLE);
+   slot.key = key;
+   slot.valid = true;
+   return slot.leg;
+}
+
+void Walk2014Generator::clearIKCache() {
+   for (uint32_t i = 0; i < IK_CACHE_SLOTS; ++i) {
+      ikCache[i].valid = false;
+   }
+}
+
+#ifdef WALK_IK_CACHE_STATS
+uint32_t Walk2014Generator::ikCacheLookups = 0;
+uint32_t Walk2014Generator::ikCacheHits = 0;
+#endif
+
 XYZ_Coord Walk2014Generator::mf2b(float Hyp, float Hp, float Hr,
                                   float Kp,  float Ap, float Ar,
                                   float xf, float yf, float zf) {
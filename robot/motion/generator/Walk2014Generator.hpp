@@ -37,6 +37,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #pragma once
 
+#include <stdint.h>
 #include <cmath>
 #include "motion/generator/Generator.hpp"
 #include "motion/generator/BodyModel.hpp"
@@ -87,6 +88,15 @@ class Walk2014Generator : Generator {
    void stop();
    friend class WalkEnginePreProcessor;
 
+#ifdef WALK_IK_CACHE_STATS
+   /**
+    * leg IK cache lookups and hits by every walk engine, only counted in
+    * benchwalk's own build of the walk engine
+    */
+   static uint32_t ikCacheLookups;
+   static uint32_t ikCacheHits;
+#endif
+
    private:
    bool exactStepsRequested;
 
@@ -104,6 +114,8 @@ class Walk2014Generator : Generator {
    const float z;                                          // zero
    const float PI;
 
+   bool useIKCache;                                        // look leg joint angles up in ikCache while walking
+
    // Nao H25 V4 dimensions - from utils/body.hpp and converted to meters
    float thigh;                                            // thigh length in meters
    float tibia;                                            // tibia length in meters
@@ -182,6 +194,43 @@ class Walk2014Generator : Generator {
       // Hpr(): Hp(0.0f), Hr(0.0f) { }
    };
 
+   // Leg joint angles, for the right leg these are mirrored to the left
+   struct LegAngles {
+      float Hp;
+      float Hr;
+      float Kp;
+      float Ap;
+      float Ar;
+   };
+
+   /**
+    * Leg inverse kinematics for a foot side and forward of the hip and legh
+    * below it, corrected for the hip yaw pitch so the foot stays in place
+    * and parallel to the ground. The right leg is solved as the left with
+    * Hr and Ar negated.
+    */
+   LegAngles legAngles(float legh, float forwardX, float side,
+                       float Hr, float Ar, float Hyp);
+
+   /**
+    * legAngles for a leg without any kick rock (Ar = -Hr), looked up on a
+    * quantised grid of (legh, forwardX, Hr, Hyp) and solved on a miss.
+    * The table is direct mapped and allocated with the generator: a miss
+    * overwrites the cell that shared its slot, so the motion tick never
+    * allocates or frees.
+    */
+   LegAngles cachedLegAngles(float legh, float forwardX, float Hr, float Hyp);
+   void clearIKCache();
+
+   static const int IK_CACHE_BITS = 12;
+   static const uint32_t IK_CACHE_SLOTS = 1 << IK_CACHE_BITS;
+   struct IKCacheSlot {
+      uint64_t key;
+      bool valid;
+      LegAngles leg;
+   };
+   IKCacheSlot ikCache[IK_CACHE_SLOTS];
+
    /**
     * Avoids the feet of nearby robots
     */
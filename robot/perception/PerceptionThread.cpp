@@ -191,7 +191,8 @@ void PerceptionThread::readOptions(const boost::program_options::variables_map&
    } else {
       if (! dumper || dumper->getPath() != dumpPath) {
          delete dumper;
-         dumper = new PerceptionDumper(dumpPath.c_str());
+         dumper = new PerceptionDumper(dumpPath.c_str(),
+                                       config["debug.dump.compression"].as<int>());
       }
    }
 
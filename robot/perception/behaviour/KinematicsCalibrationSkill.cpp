@@ -77,7 +77,7 @@ fadbad::F<float> KinematicsCalibrationSkill::objectiveFunction(
 
 
    /* Image to RR */
-   Point cc_p = readFrom(vision, balls[0].imageCoords);
+   Point cc_p = readFrom(vision, balls)[0].imageCoords;
    std::pair<uint16_t, uint16_t>  cc(cc_p.x(), cc_p.y());
 
    // calculate vector to pixel in camera space
@@ -36,6 +36,25 @@ typedef const float (AbsCoord::*abs_get_v_const_type)() const;
 
 void py_say(const std::string &text) { SAY(text); }
 
+/* Lock-free blackboard components, read through this thread's snapshot */
+const SensorValues &motionSensors(const MotionBlackboard &motion) {
+   return motion.sensors.read();
+}
+
+const std::vector<BallInfo> &visionBalls(const VisionBlackboard &vision) {
+   return vision.balls.acquire();
+}
+
+const std::vector<RobotObstacle> &localisationRobotObstacles(
+   const LocalisationBlackboard &localisation) {
+   return localisation.robotObstacles.acquire();
+}
+
+const std::vector<std::vector<int> > &kinematicsSonarFiltered(
+   const KinematicsBlackboard &kinematics) {
+   return kinematics.sonarFiltered.acquire();
+}
+
 BOOST_PYTHON_MODULE(robot)
 {
    register_python_converters();
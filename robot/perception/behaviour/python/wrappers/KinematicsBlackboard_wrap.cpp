@@ -1,3 +1,4 @@
 class_<KinematicsBlackboard>("KinematicsBlackboard")
-   .def_readonly("sonarFiltered" , &KinematicsBlackboard::sonarFiltered )
+   .add_property("sonarFiltered" , make_function(&kinematicsSonarFiltered,
+                                                 return_internal_reference<>()))
    ;
@@ -12,5 +12,6 @@ class_<LocalisationBlackboard>("LocalisationBlackboard")
    .def_readonly("ballPos", &LocalisationBlackboard::ballPos)
    .def_readonly("ballNeckRelative", &LocalisationBlackboard::ballNeckRelative)
    .def_readonly("teamBall", &LocalisationBlackboard::teamBall)
-   .def_readonly("robotObstacles", &LocalisationBlackboard::robotObstacles);
+   .add_property("robotObstacles", make_function(&localisationRobotObstacles,
+                                                 return_internal_reference<>()));
 
@@ -1,3 +1,4 @@
 class_<MotionBlackboard>("MotionBlackboard")
-   .add_property("sensors", &MotionBlackboard::sensors) 
+   .add_property("sensors", make_function(&motionSensors,
+                                          return_internal_reference<>()))
    .add_property("active", &MotionBlackboard::active);
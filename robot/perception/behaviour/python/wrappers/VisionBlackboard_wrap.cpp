@@ -1,5 +1,6 @@
 class_<VisionBlackboard>("VisionBlackboard")
-   .add_property("balls"    , &VisionBlackboard::balls    )
+   .add_property("balls"    , make_function(&visionBalls,
+                                           return_internal_reference<>()))
    .add_property("posts"    , &VisionBlackboard::posts    )
    .add_property("timestamp", &VisionBlackboard::timestamp)
    .add_property("ballHint" , &VisionBlackboard::ballHint );
@@ -0,0 +1,207 @@
+#include "DumpFile.hpp"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include "blackboard/Blackboard.hpp"
+
+namespace io = boost::iostreams;
+
+DumpFile::DumpFile()
+   : file(NULL), frames(0), cursor(0), loadedChunk(-1), legacyArchive(NULL)
+{
+}
+
+DumpFile::~DumpFile()
+{
+   delete legacyArchive;
+   if (file) {
+      fclose(file);
+   }
+}
+
+bool DumpFile::open(const std::string &path, std::string *error)
+{
+   file = fopen(path.c_str(), "rb");
+   if (file == NULL) {
+      *error = "Can not open " + path;
+      return false;
+   }
+   char magic[sizeof(DUMP_MAGIC)];
+   if (fread(magic, sizeof(magic), 1, file) == 1 &&
+       memcmp(magic, DUMP_MAGIC, sizeof(magic)) == 0) {
+      if (!readIndex()) {
+         walkChunks();
+      }
+      return true;
+   }
+
+   fclose(file);
+   file = NULL;
+   legacyStream.open(path.c_str(), std::ios::in | std::ios::binary);
+   try {
+      legacyArchive = new boost::archive::binary_iarchive(legacyStream);
+   } catch (const std::exception &e) {
+      *error = path + " is not a blackboard dump: " + e.what();
+      return false;
+   }
+   return true;
+}
+
+bool DumpFile::isIndexed() const
+{
+   return file != NULL;
+}
+
+uint32_t DumpFile::numFrames() const
+{
+   return frames;
+}
+
+bool DumpFile::readIndex()
+{
+   DumpTrailer trailer;
+   if (fseeko(file, -(off_t)sizeof(trailer), SEEK_END) != 0 ||
+       fread(&trailer, sizeof(trailer), 1, file) != 1 ||
+       memcmp(trailer.magic, DUMP_INDEX_MAGIC, sizeof(trailer.magic)) != 0) {
+      return false;
+   }
+   chunks.resize(trailer.numChunks);
+   if (fseeko(file, trailer.indexOffset, SEEK_SET) != 0 ||
+       (trailer.numChunks &&
+        fread(&chunks[0], sizeof(DumpChunkEntry), trailer.numChunks,
+              file) != trailer.numChunks)) {
+      chunks.clear();
+      return false;
+   }
+   frames = trailer.numFrames;
+   return true;
+}
+
+void DumpFile::walkChunks()
+{
+   // The dumper never closed the dump, so find the chunks that made it
+   chunks.clear();
+   frames = 0;
+   off_t offset = sizeof(DUMP_MAGIC);
+   DumpChunkHeader header;
+   while (fseeko(file, offset, SEEK_SET) == 0 &&
+          fread(&header, sizeof(header), 1, file) == 1 &&
+          memcmp(header.tag, DUMP_CHUNK_TAG, sizeof(header.tag)) == 0) {
+      off_t end = offset + sizeof(header) +
+                  header.numFrames * sizeof(DumpFrameEntry) +
+                  header.storedLength;
+      if (fseeko(file, end - 1, SEEK_SET) != 0 || fgetc(file) == EOF) {
+         break;
+      }
+      DumpChunkEntry entry;
+      memset(&entry, 0, sizeof(entry));
+      entry.offset = offset;
+      entry.firstFrame = frames;
+      entry.numFrames = header.numFrames;
+      entry.mask = header.mask;
+      chunks.push_back(entry);
+      frames += header.numFrames;
+      offset = end;
+   }
+}
+
+bool DumpFile::seek(uint32_t frame)
+{
+   if (!isIndexed() || frame > frames) {
+      return false;
+   }
+   cursor = frame;
+   return true;
+}
+
+bool DumpFile::loadChunk(int chunk)
+{
+   if (chunk == loadedChunk) {
+      return true;
+   }
+   loadedChunk = -1;
+   DumpChunkHeader header;
+   if (fseeko(file, chunks[chunk].offset, SEEK_SET) != 0 ||
+       fread(&header, sizeof(header), 1, file) != 1 ||
+       memcmp(header.tag, DUMP_CHUNK_TAG, sizeof(header.tag)) != 0 ||
+       header.numFrames == 0) {
+      return false;
+   }
+   loadedFrames.resize(header.numFrames);
+   if (fread(&loadedFrames[0], sizeof(DumpFrameEntry), header.numFrames,
+             file) != header.numFrames) {
+      return false;
+   }
+
+   stored.resize(header.storedLength);
+   if (header.storedLength &&
+       fread(&stored[0], header.storedLength, 1, file) != 1) {
+      return false;
+   }
+   if (header.compression == ZLIB_DUMP_COMPRESSION) {
+      loadedData.resize(header.rawLength);
+      uLongf length = header.rawLength;
+      if (uncompress((Bytef *)&loadedData[0], &length,
+                     (const Bytef *)stored.data(), stored.size()) != Z_OK ||
+          length != header.rawLength) {
+         return false;
+      }
+   } else {
+      loadedData.swap(stored);
+   }
+
+   loadedOffsets.resize(header.numFrames);
+   uint32_t offset = 0;
+   for (uint32_t i = 0; i < header.numFrames; ++i) {
+      loadedOffsets[i] = offset;
+      offset += loadedFrames[i].length;
+   }
+   if (offset > loadedData.size()) {
+      return false;
+   }
+   loadedChunk = chunk;
+   return true;
+}
+
+static bool chunkBefore(uint32_t frame, const DumpChunkEntry &chunk)
+{
+   return frame < chunk.firstFrame;
+}
+
+bool DumpFile::next(Blackboard *blackboard)
+{
+   if (legacyArchive) {
+      try {
+         *legacyArchive >> *blackboard;
+      } catch (const std::exception &e) {
+         return false;
+      }
+      return true;
+   }
+   if (file == NULL || cursor >= frames) {
+      return false;
+   }
+
+   // The last chunk starting at or before the frame
+   int chunk = std::upper_bound(chunks.begin(), chunks.end(), cursor,
+                                chunkBefore) - chunks.begin() - 1;
+   if (chunk < 0 || !loadChunk(chunk)) {
+      return false;
+   }
+   const uint32_t frame = cursor - chunks[chunk].firstFrame;
+   io::stream<io::array_source> in(loadedData.data() + loadedOffsets[frame],
+                                   loadedFrames[frame].length);
+   try {
+      boost::archive::binary_iarchive ar(in, boost::archive::no_header);
+      ar >> *blackboard;
+   } catch (const std::exception &e) {
+      return false;
+   }
+   ++cursor;
+   return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/archive/binary_iarchive.hpp>
+
+#include "perception/dumper/DumpFormat.hpp"
+
+class Blackboard;
+
+/**
+ * Reads blackboard dumps written by PerceptionDumper, going to any frame
+ * through the dump's index. Dumps from before chunking can still be read
+ * in order, but can not be seeked in.
+ */
+class DumpFile
+{
+   public:
+      DumpFile();
+      virtual ~DumpFile();
+
+      /* @return false, and why in error, if path can not be read */
+      bool open(const std::string &path, std::string *error);
+
+      /* @return whether frames can be seeked to and counted */
+      bool isIndexed() const;
+
+      /* @return how many frames the dump holds, or 0 if it is not indexed */
+      uint32_t numFrames() const;
+
+      /* Makes frame the one next() reads */
+      bool seek(uint32_t frame);
+
+      /**
+       * Loads the next frame into blackboard, allocating the image buffers
+       * Blackboard::load does
+       * @return false at the end of the dump, or if the frame is corrupt
+       */
+      bool next(Blackboard *blackboard);
+
+   private:
+      FILE *file;
+      std::vector<DumpChunkEntry> chunks;
+      uint32_t frames;
+      uint32_t cursor;
+
+      /* The chunk last read, decompressed */
+      int loadedChunk;
+      std::vector<DumpFrameEntry> loadedFrames;
+      std::vector<uint32_t> loadedOffsets;
+      std::string loadedData;
+      std::string stored;
+
+      /* For dumps from before chunking */
+      std::ifstream legacyStream;
+      boost::archive::binary_iarchive *legacyArchive;
+
+      bool readIndex();
+      void walkChunks();
+      bool loadChunk(int chunk);
+};
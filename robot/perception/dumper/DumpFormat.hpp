@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "transmitter/TransmitterDefs.hpp"
+
+/**
+ * Layout of a blackboard dump (.bbd) as written by PerceptionDumper.
+ *
+ * The file starts with DUMP_MAGIC. Frames are then stored in chunks, each a
+ * DumpChunkHeader, a DumpFrameEntry per frame and the frames themselves,
+ * compressed together with zlib unless compression is NO_DUMP_COMPRESSION.
+ * Each frame is a boost binary archive of the Blackboard of its own, without
+ * an archive header, so any frame can be loaded without those before it.
+ *
+ * Once the dump is closed, a DumpChunkEntry per chunk and then a
+ * DumpTrailer follow the last chunk, so a reader can find any frame from the
+ * end of the file. A dump cut short has no trailer, and is indexed by
+ * walking its chunk headers instead.
+ *
+ * Dumps from before chunking are a single binary archive holding every
+ * frame, and do not start with DUMP_MAGIC.
+ */
+static const char DUMP_MAGIC[8] = { 'R', 'S', 'W', 'B', 'B', 'D', '0', '2' };
+static const char DUMP_CHUNK_TAG[4] = { 'C', 'H', 'N', 'K' };
+static const char DUMP_INDEX_MAGIC[8] = { 'R', 'S', 'W', 'I', 'D', 'X', '0', '2' };
+
+enum DumpCompression {
+   NO_DUMP_COMPRESSION = 0,
+   ZLIB_DUMP_COMPRESSION = 1
+};
+
+struct DumpChunkHeader {
+   char tag[4];
+   uint32_t compression;
+   /* Bytes of frame data in the file, and once decompressed */
+   uint32_t storedLength;
+   uint32_t rawLength;
+   uint32_t numFrames;
+   uint32_t reserved;
+   /* Every component saved in any of the chunk's frames */
+   OffNaoMask_t mask;
+};
+
+struct DumpFrameEntry {
+   /* Bytes of the frame once decompressed */
+   uint32_t length;
+   uint32_t reserved;
+   OffNaoMask_t mask;
+};
+
+struct DumpChunkEntry {
+   /* Where the chunk's header is in the file */
+   uint64_t offset;
+   uint32_t firstFrame;
+   uint32_t numFrames;
+   OffNaoMask_t mask;
+};
+
+struct DumpTrailer {
+   uint64_t indexOffset;
+   uint32_t numChunks;
+   uint32_t numFrames;
+   char magic[8];
+};
@@ -1,14 +1,59 @@
 #include "PerceptionDumper.hpp"
 
+#include <zlib.h>
+#include <cstring>
+
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+
 #include "blackboard/Blackboard.hpp"
+#include "utils/Logger.hpp"
+
+namespace io = boost::iostreams;
 
-PerceptionDumper::PerceptionDumper(const char *path)
-   : path(path), of(path), ar(of)
+PerceptionDumper::PerceptionDumper(const char *path, int compression)
+   : path(path), compression(compression), current(new Chunk()),
+     stopping(false), droppedChunks(0), framesWritten(0)
 {
+   current->mask = 0;
+   file = fopen(path, "wb");
+   if (file == NULL) {
+      llog(ERROR) << "Can not open " << path << " to dump to" << std::endl;
+      return;
+   }
+   fwrite(DUMP_MAGIC, sizeof(DUMP_MAGIC), 1, file);
+   writer = boost::thread(boost::bind(&PerceptionDumper::write, this));
 }
 
 PerceptionDumper::~PerceptionDumper()
 {
+   if (file) {
+      if (!current->frames.empty()) {
+         handOff();
+      }
+      {
+         boost::mutex::scoped_lock l(lock);
+         stopping = true;
+      }
+      wake.notify_one();
+      writer.join();
+      writeIndex();
+      fclose(file);
+      if (droppedChunks) {
+         llog(ERROR) << "Dropped " << droppedChunks << " chunks of "
+                     << FRAMES_PER_CHUNK << " frames from " << path
+                     << std::endl;
+      }
+   }
+   delete current;
+   for (size_t i = 0; i < spare.size(); ++i) {
+      delete spare[i];
+   }
+   for (size_t i = 0; i < pending.size(); ++i) {
+      delete pending[i];
+   }
 }
 
 const std::string &PerceptionDumper::getPath() const
@@ -18,5 +63,128 @@ const std::string &PerceptionDumper::getPath() const
 
 void PerceptionDumper::dump(Blackboard *blackboard)
 {
-   ar << *blackboard;
+   if (file == NULL) {
+      return;
+   }
+   const size_t start = current->data.size();
+   {
+      io::stream<io::back_insert_device<std::string> > out(current->data);
+      boost::archive::binary_oarchive ar(out, boost::archive::no_header);
+      ar << *blackboard;
+   }
+   DumpFrameEntry frame;
+   memset(&frame, 0, sizeof(frame));
+   frame.length = current->data.size() - start;
+   frame.mask = blackboard->mask;
+   current->frames.push_back(frame);
+   current->mask |= frame.mask;
+
+   if (current->frames.size() >= FRAMES_PER_CHUNK ||
+       current->data.size() >= MAX_CHUNK_BYTES) {
+      handOff();
+   }
+}
+
+void PerceptionDumper::handOff()
+{
+   Chunk *next = NULL;
+   {
+      boost::mutex::scoped_lock l(lock);
+      if (pending.size() < MAX_PENDING_CHUNKS) {
+         pending.push_back(current);
+         if (!spare.empty()) {
+            next = spare.back();
+            spare.pop_back();
+         }
+      } else {
+         // Keep filling the same chunk, losing what was in it
+         ++droppedChunks;
+         next = current;
+      }
+   }
+   wake.notify_one();
+   if (next == NULL) {
+      next = new Chunk();
+   }
+   next->data.clear();
+   next->frames.clear();
+   next->mask = 0;
+   current = next;
+}
+
+void PerceptionDumper::write()
+{
+   for (;;) {
+      Chunk *chunk;
+      {
+         boost::mutex::scoped_lock l(lock);
+         while (pending.empty() && !stopping) {
+            wake.wait(l);
+         }
+         if (pending.empty()) {
+            return;
+         }
+         chunk = pending.front();
+         pending.pop_front();
+      }
+      writeChunk(*chunk);
+      boost::mutex::scoped_lock l(lock);
+      spare.push_back(chunk);
+   }
+}
+
+void PerceptionDumper::writeChunk(const Chunk &chunk)
+{
+   DumpChunkHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.tag, DUMP_CHUNK_TAG, sizeof(header.tag));
+   header.compression = NO_DUMP_COMPRESSION;
+   header.rawLength = chunk.data.size();
+   header.numFrames = chunk.frames.size();
+   header.mask = chunk.mask;
+
+   const char *data = chunk.data.data();
+   header.storedLength = chunk.data.size();
+   if (compression > 0) {
+      uLongf length = compressBound(chunk.data.size());
+      compressed.resize(length);
+      if (compress2((Bytef *)&compressed[0], &length,
+                    (const Bytef *)chunk.data.data(), chunk.data.size(),
+                    compression) == Z_OK) {
+         header.compression = ZLIB_DUMP_COMPRESSION;
+         header.storedLength = length;
+         data = compressed.data();
+      }
+   }
+
+   DumpChunkEntry entry;
+   memset(&entry, 0, sizeof(entry));
+   entry.offset = ftello(file);
+   entry.firstFrame = framesWritten;
+   entry.numFrames = header.numFrames;
+   entry.mask = header.mask;
+
+   if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+       fwrite(&chunk.frames[0], sizeof(DumpFrameEntry), chunk.frames.size(),
+              file) != chunk.frames.size() ||
+       fwrite(data, header.storedLength, 1, file) != 1) {
+      llog(ERROR) << "Could not write to " << path << std::endl;
+      return;
+   }
+   index.push_back(entry);
+   framesWritten += header.numFrames;
+}
+
+void PerceptionDumper::writeIndex()
+{
+   DumpTrailer trailer;
+   memset(&trailer, 0, sizeof(trailer));
+   trailer.indexOffset = ftello(file);
+   trailer.numChunks = index.size();
+   trailer.numFrames = framesWritten;
+   memcpy(trailer.magic, DUMP_INDEX_MAGIC, sizeof(trailer.magic));
+   if (!index.empty()) {
+      fwrite(&index[0], sizeof(DumpChunkEntry), index.size(), file);
+   }
+   fwrite(&trailer, sizeof(trailer), 1, file);
 }
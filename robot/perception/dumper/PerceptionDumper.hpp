@@ -1,16 +1,35 @@
 #pragma once
 
+#include <stdint.h>
+#include <cstdio>
+#include <deque>
 #include <string>
-#include <fstream>
+#include <vector>
 
-#include <boost/archive/binary_oarchive.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "perception/dumper/DumpFormat.hpp"
 
 class Blackboard;
 
+/**
+ * Writes blackboard dumps in the format described in DumpFormat.hpp.
+ *
+ * dump() serialises the blackboard into the chunk being filled, in memory.
+ * Full chunks are handed to a writer thread that compresses them and
+ * writes them out, so perception never waits on the disk. If the writer
+ * falls too far behind, whole chunks are dropped and counted instead.
+ */
 class PerceptionDumper
 {
    public:
-      PerceptionDumper(const char *path);
+      /**
+       * @param compression zlib level (1-9) to compress chunks with, or 0 to
+       *                    store them as they are
+       */
+      PerceptionDumper(const char *path, int compression = 1);
       virtual ~PerceptionDumper();
 
       void dump(Blackboard *blackboard);
@@ -18,8 +37,40 @@ class PerceptionDumper
       const std::string &getPath() const;
 
    private:
+      static const uint32_t FRAMES_PER_CHUNK = 32;
+      static const uint32_t MAX_CHUNK_BYTES = 4 * 1024 * 1024;
+      static const size_t MAX_PENDING_CHUNKS = 8;
+
+      struct Chunk {
+         std::string data;
+         std::vector<DumpFrameEntry> frames;
+         OffNaoMask_t mask;
+      };
+
       std::string path;
-      std::ofstream of;
-      boost::archive::binary_oarchive ar;
+      int compression;
+      FILE *file;
+
+      /* Being filled by dump(), only touched by the dumping thread */
+      Chunk *current;
+
+      boost::mutex lock;
+      boost::condition_variable wake;
+      /* Full chunks waiting for the writer, and chunks to reuse */
+      std::deque<Chunk *> pending;
+      std::vector<Chunk *> spare;
+      bool stopping;
+      uint32_t droppedChunks;
+      boost::thread writer;
+
+      /* Only touched by the writer */
+      std::vector<DumpChunkEntry> index;
+      uint32_t framesWritten;
+      std::string compressed;
 
+      /* Hands current over to the writer and starts a new chunk */
+      void handOff();
+      void write();
+      void writeChunk(const Chunk &chunk);
+      void writeIndex();
 };
@@ -0,0 +1,181 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#pragma once
+
+#include <cmath>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+/**
+ * A rigid homogeneous transform of fixed size, with the constant
+ * [0 0 0 1] bottom row left implicit.
+ *
+ * This is what the forward kinematics chains are evaluated with, since every
+ * link in a DH chain is rigid. All loops have compile time trip counts so the
+ * products are fully unrolled and vectorised by the compiler, rather than
+ * going through heap allocated ublas matrices. Storage is plain float rather
+ * than an aligned SSE type because Kinematics lives inside heap allocated
+ * adapters (the same reason the build uses EIGEN_DONT_ALIGN).
+ */
+struct DHTransform {
+   float m[3][4];
+
+   static DHTransform identity() {
+      DHTransform r;
+      for (int i = 0; i < 3; ++i) {
+         for (int j = 0; j < 4; ++j) {
+            r.m[i][j] = (i == j) ? 1.0f : 0.0f;
+         }
+      }
+      return r;
+   }
+
+   /* Same convention as createDHMatrix in utils/matrix_helpers.hpp */
+   static DHTransform dh(float a, float alpha, float d, float theta) {
+      const float ct = std::cos(theta), st = std::sin(theta);
+      const float ca = std::cos(alpha), sa = std::sin(alpha);
+      DHTransform r;
+      r.m[0][0] = ct;
+      r.m[0][1] = -st;
+      r.m[0][2] = 0;
+      r.m[0][3] = a;
+
+      r.m[1][0] = st * ca;
+      r.m[1][1] = ct * ca;
+      r.m[1][2] = -sa;
+      r.m[1][3] = -sa * d;
+
+      r.m[2][0] = st * sa;
+      r.m[2][1] = ct * sa;
+      r.m[2][2] = ca;
+      r.m[2][3] = ca * d;
+      return r;
+   }
+
+   /* Same as rotateZMatrix in utils/matrix_helpers.hpp */
+   static DHTransform rotateZ(float theta) {
+      return dh(0, 0, 0, theta);
+   }
+
+   /* Same as translateMatrix in utils/matrix_helpers.hpp */
+   static DHTransform translate(float x, float y, float z) {
+      DHTransform r = identity();
+      r.m[0][3] = x;
+      r.m[1][3] = y;
+      r.m[2][3] = z;
+      return r;
+   }
+
+   static DHTransform fromMatrix(const boost::numeric::ublas::matrix<float> &t) {
+      DHTransform r;
+      for (int i = 0; i < 3; ++i) {
+         for (int j = 0; j < 4; ++j) {
+            r.m[i][j] = t(i, j);
+         }
+      }
+      return r;
+   }
+
+   boost::numeric::ublas::matrix<float> toMatrix() const {
+      boost::numeric::ublas::matrix<float> t(4, 4);
+      for (int i = 0; i < 3; ++i) {
+         for (int j = 0; j < 4; ++j) {
+            t(i, j) = m[i][j];
+         }
+      }
+      t(3, 0) = 0;
+      t(3, 1) = 0;
+      t(3, 2) = 0;
+      t(3, 3) = 1;
+      return t;
+   }
+
+   DHTransform operator*(const DHTransform &o) const {
+      DHTransform r;
+      for (int i = 0; i < 3; ++i) {
+         for (int j = 0; j < 4; ++j) {
+            r.m[i][j] = m[i][0] * o.m[0][j] +
+                        m[i][1] * o.m[1][j] +
+                        m[i][2] * o.m[2][j];
+         }
+         r.m[i][3] += m[i][3];
+      }
+      return r;
+   }
+
+   DHTransform &operator*=(const DHTransform &o) {
+      *this = *this * o;
+      return *this;
+   }
+
+   /* Inverse of a rigid transform, [R^T | -R^T t] */
+   DHTransform inverse() const {
+      DHTransform r;
+      for (int i = 0; i < 3; ++i) {
+         for (int j = 0; j < 3; ++j) {
+            r.m[i][j] = m[j][i];
+         }
+         r.m[i][3] = -(m[0][i] * m[0][3] +
+                       m[1][i] * m[1][3] +
+                       m[2][i] * m[2][3]);
+      }
+      return r;
+   }
+
+   /* Transforms the point (p[0], p[1], p[2], 1) */
+   void transformPoint(const float p[3], float out[3]) const {
+      for (int i = 0; i < 3; ++i) {
+         out[i] = m[i][0] * p[0] + m[i][1] * p[1] + m[i][2] * p[2] + m[i][3];
+      }
+   }
+
+   float x() const { return m[0][3]; }
+   float y() const { return m[1][3]; }
+   float z() const { return m[2][3]; }
+};
+
+/**
+ * Product of a fixed length run of links, links[0] * ... * links[N - 1],
+ * unrolled at compile time.
+ */
+template <int N>
+struct DHChain {
+   static DHTransform evaluate(const DHTransform *links) {
+      return DHChain<N - 1>::evaluate(links) * links[N - 1];
+   }
+};
+
+template <>
+struct DHChain<1> {
+   static DHTransform evaluate(const DHTransform *links) {
+      return links[0];
+   }
+};
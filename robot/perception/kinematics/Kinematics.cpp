@@ -3,8 +3,10 @@
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/io.hpp>
 #include <boost/numeric/ublas/lu.hpp>
+#include <algorithm>
 #include <cmath>
 #include <climits>
+#include <cstring>
 #include <vector>
 
 #include <perception/vision/VisionDefs.hpp>
@@ -55,6 +57,10 @@ static const float l10Bot = d1Bot * sin(a1Bot);
 static const float d11Bot = d1Bot * cos(a1Bot);
 static const float a3Bot = camera_bottom_angle - M_PI;
 
+// The body exclusion arrays are only recomputed once the head has moved this
+// far since they were last computed, which is about 2 pixels in the top image
+static const float EXCLUSION_UPDATE_ANGLE = DEG2RAD(0.1);
+
 Kinematics::Kinematics() {
    std::vector<boost::numeric::ublas::matrix<float> > chest;
 
@@ -87,7 +93,7 @@ Kinematics::Kinematics() {
    chest.push_back(vec4<float>(65, 20, Limbs::NeckOffsetZ - 70, 1));
    chest.push_back(vec4<float>(65, 10, Limbs::NeckOffsetZ - 70, 1));
    chest.push_back(vec4<float>(65, 0, Limbs::NeckOffsetZ - 70, 1));
-   bodyParts.push_back(chest);
+   addBodyPart(chest);
    chest.clear();
 
    // reflection
@@ -120,9 +126,11 @@ Kinematics::Kinematics() {
    chest.push_back(vec4<float>(-91, -155, Limbs::NeckOffsetZ - 34, 1));
    chest.push_back(vec4<float>(-96, -155, Limbs::NeckOffsetZ - 35, 1));
    chest.push_back(vec4<float>(-96, -100, Limbs::NeckOffsetZ - 50, 1));
-   bodyParts.push_back(chest);
+   addBodyPart(chest);
    chest.clear();
 
+   exclusionValid = false;
+
    // Setting up the masses vector to store the mass of each joint in kgs.
    // These are particularly ordered in the order that they are multiplied up
    // through the kinematics chain for use in Centre of Mass calculations.
@@ -160,113 +168,111 @@ Kinematics::Kinematics() {
 
    // Same order as above, but this time for the position of the centre of mass for each joint.
    massesCom.clear();
-   massesCom.push_back(vec4(Limbs::TorsoCoM)); // Torso
-   massesCom.push_back(vec4(Limbs::NeckCoM)); // Head
-   massesCom.push_back(vec4(Limbs::HeadCoM));
-   massesCom.push_back(vec4(Limbs::RightShoulderCoM)); // R Arm
-   massesCom.push_back(vec4(Limbs::RightBicepCoM));
-   massesCom.push_back(vec4(Limbs::RightElbowCoM));
-   massesCom.push_back(vec4(Limbs::RightForearmCoM));
-   massesCom.push_back(vec4(Limbs::RightHandCoM)); 
-   massesCom.push_back(vec4(Limbs::LeftShoulderCoM)); // L Arm
-   massesCom.push_back(vec4(Limbs::LeftBicepCoM));
-   massesCom.push_back(vec4(Limbs::LeftElbowCoM));
-   massesCom.push_back(vec4(Limbs::LeftForearmCoM));
-   massesCom.push_back(vec4(Limbs::LeftHandCoM));
-   massesCom.push_back(vec4(Limbs::RightPelvisCoM)); // R Leg
-   massesCom.push_back(vec4(Limbs::RightHipCoM));
-   massesCom.push_back(vec4(Limbs::RightThighCoM));
-   massesCom.push_back(vec4(Limbs::RightTibiaCoM));
-   massesCom.push_back(vec4(Limbs::RightAnkleCoM));
-   massesCom.push_back(vec4(Limbs::RightFootCoM));
-   massesCom.push_back(vec4(Limbs::LeftPelvisCoM)); // L Leg
-   massesCom.push_back(vec4(Limbs::LeftHipCoM));
-   massesCom.push_back(vec4(Limbs::LeftThighCoM));
-   massesCom.push_back(vec4(Limbs::LeftTibiaCoM));
-   massesCom.push_back(vec4(Limbs::LeftAnkleCoM));
-   massesCom.push_back(vec4(Limbs::LeftFootCoM));
+   massesCom.push_back(Limbs::TorsoCoM); // Torso
+   massesCom.push_back(Limbs::NeckCoM); // Head
+   massesCom.push_back(Limbs::HeadCoM);
+   massesCom.push_back(Limbs::RightShoulderCoM); // R Arm
+   massesCom.push_back(Limbs::RightBicepCoM);
+   massesCom.push_back(Limbs::RightElbowCoM);
+   massesCom.push_back(Limbs::RightForearmCoM);
+   massesCom.push_back(Limbs::RightHandCoM); 
+   massesCom.push_back(Limbs::LeftShoulderCoM); // L Arm
+   massesCom.push_back(Limbs::LeftBicepCoM);
+   massesCom.push_back(Limbs::LeftElbowCoM);
+   massesCom.push_back(Limbs::LeftForearmCoM);
+   massesCom.push_back(Limbs::LeftHandCoM);
+   massesCom.push_back(Limbs::RightPelvisCoM); // R Leg
+   massesCom.push_back(Limbs::RightHipCoM);
+   massesCom.push_back(Limbs::RightThighCoM);
+   massesCom.push_back(Limbs::RightTibiaCoM);
+   massesCom.push_back(Limbs::RightAnkleCoM);
+   massesCom.push_back(Limbs::RightFootCoM);
+   massesCom.push_back(Limbs::LeftPelvisCoM); // L Leg
+   massesCom.push_back(Limbs::LeftHipCoM);
+   massesCom.push_back(Limbs::LeftThighCoM);
+   massesCom.push_back(Limbs::LeftTibiaCoM);
+   massesCom.push_back(Limbs::LeftAnkleCoM);
+   massesCom.push_back(Limbs::LeftFootCoM);
    
    // Initialise transform matrices for DH chain
-   for (int i = 0; i < CAMERA_DH_CHAIN_LEN; ++i) {
-      transformLTop[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRTop[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformLBot[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRBot[i] = boost::numeric::ublas::identity_matrix<float>(4);
+   for (int foot = 0; foot < 2; ++foot) {
+      for (int i = 0; i < BODY; ++i) {
+         legLinks[foot][i] = DHTransform::identity();
+      }
+      for (int i = 0; i < CAMERA - BODY; ++i) {
+         headLinks[foot][i] = DHTransform::identity();
+      }
    }
    for (int i = 0; i < HEAD_DH_CHAIN_LEN; ++i) {
-      transformHB[i] = boost::numeric::ublas::identity_matrix<float>(4);
+      transformHB[i] = DHTransform::identity();
    }
    for (int i = 0; i < ARM_DH_CHAIN_LEN; ++i) {
-      transformLAB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRAB[i] = boost::numeric::ublas::identity_matrix<float>(4);
+      transformLAB[i] = DHTransform::identity();
+      transformRAB[i] = DHTransform::identity();
    }
    for (int i = 0; i < LEG_DH_CHAIN_LEN; ++i) {
-      transformLFB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRFB[i] = boost::numeric::ublas::identity_matrix<float>(4);
+      transformLFB[i] = DHTransform::identity();
+      transformRFB[i] = DHTransform::identity();
    }
 
    // Set up constant DH transforms since they only need to be calculated once
-   boost::numeric::ublas::matrix<float> pi2AboutX = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   boost::numeric::ublas::matrix<float> negpi2AboutX = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
-   boost::numeric::ublas::matrix<float> pi4AboutX = createDHMatrix<float>(0, M_PI / 4, 0, 0);
-   boost::numeric::ublas::matrix<float> negpi2AboutXnegpi2AboutZ = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 2);
-   boost::numeric::ublas::matrix<float> pi2AboutXpi2AboutZ = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2);
+   DHTransform pi2AboutX = DHTransform::dh(0, M_PI / 2, 0, 0);
+   DHTransform negpi2AboutX = DHTransform::dh(0, -M_PI / 2, 0, 0);
+   DHTransform pi4AboutX = DHTransform::dh(0, M_PI / 4, 0, 0);
+   DHTransform negpi2AboutXnegpi2AboutZ = DHTransform::dh(0, -M_PI / 2, 0, -M_PI / 2);
+   DHTransform pi2AboutXpi2AboutZ = DHTransform::dh(0, M_PI / 2, 0, M_PI / 2);
 
    // Constants in camera transforms
-   transformLTop[0] = createDHMatrix<float>(0, 0, Limbs::FootHeight, M_PI / 2);
-   transformLTop[7] = createDHMatrix<float>(0, 3 * M_PI / 4, 0, 0);
-
-   transformRTop[0] = transformLTop[0];
-   transformRTop[7] = pi4AboutX;
+   legLinks[LEFT_CHAIN][0] = DHTransform::dh(0, 0, Limbs::FootHeight, M_PI / 2);
+   legLinks[LEFT_CHAIN][7] = DHTransform::dh(0, 3 * M_PI / 4, 0, 0);
 
-   transformLBot[0] = transformLTop[0];
-   transformLBot[7] = transformLTop[7];
+   legLinks[RIGHT_CHAIN][0] = legLinks[LEFT_CHAIN][0];
+   legLinks[RIGHT_CHAIN][7] = pi4AboutX;
 
-   transformRBot[0] = transformRTop[0];
-   transformRBot[7] = transformRTop[7];
+   cameraPanInverseHack = DHTransform::dh(0, 0, d2, 0.0);
 
    // Constants in mass transforms
    transformHB[2] = pi2AboutX;
 
-   transformRAB[0] = createDHMatrix<float>(0, 0, Limbs::ShoulderOffsetZ, 0);
-   transformRAB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
+   transformRAB[0] = DHTransform::dh(0, 0, Limbs::ShoulderOffsetZ, 0);
+   transformRAB[1] = DHTransform::dh(0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
    transformRAB[3] = pi2AboutX;
-   transformRAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-                                           Limbs::ElbowOffsetY, M_PI / 2);
+   transformRAB[5] = DHTransform::dh(Limbs::UpperArmLength, M_PI / 2,
+                                     Limbs::ElbowOffsetY, M_PI / 2);
    transformRAB[7] = negpi2AboutXnegpi2AboutZ;
    transformRAB[8] = negpi2AboutX;
-   transformRAB[10] = createDHMatrix<float>(Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
+   transformRAB[10] = DHTransform::dh(Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
    transformRAB[12] = negpi2AboutXnegpi2AboutZ;
    transformRAB[13] = negpi2AboutX;
 
    transformLAB[0] = transformRAB[0];
-   transformLAB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
+   transformLAB[1] = DHTransform::dh(0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
    transformLAB[3] = transformRAB[3];
-   transformLAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-                                          -Limbs::ElbowOffsetY, M_PI / 2);
+   transformLAB[5] = DHTransform::dh(Limbs::UpperArmLength, M_PI / 2,
+                                     -Limbs::ElbowOffsetY, M_PI / 2);
    transformLAB[7] = transformRAB[7];
    transformLAB[8] = transformRAB[8];
    transformLAB[10] = transformRAB[10];
    transformLAB[12] = transformRAB[12];
    transformLAB[13] = transformRAB[13];
 
-   transformRFB[0] = createDHMatrix<float>(0, 0, -Limbs::HipOffsetZ, 0);
-   transformRFB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::HipOffsetY, 0);
+   transformRFB[0] = DHTransform::dh(0, 0, -Limbs::HipOffsetZ, 0);
+   transformRFB[1] = DHTransform::dh(0, M_PI / 2, Limbs::HipOffsetY, 0);
    transformRFB[3] = pi4AboutX;
-   transformRFB[4] = createDHMatrix<float>(0, M_PI / 2, 0, -M_PI / 2);
+   transformRFB[4] = DHTransform::dh(0, M_PI / 2, 0, -M_PI / 2);
    transformRFB[6] = pi2AboutXpi2AboutZ;
    transformRFB[7] = negpi2AboutX;
    transformRFB[9] = pi2AboutX;
-   transformRFB[10] = createDHMatrix<float>(0, 0, -Limbs::ThighLength, 0);
+   transformRFB[10] = DHTransform::dh(0, 0, -Limbs::ThighLength, 0);
    transformRFB[12] = pi2AboutX;
-   transformRFB[13] = createDHMatrix<float>(0, 0, -Limbs::TibiaLength, 0);
+   transformRFB[13] = DHTransform::dh(0, 0, -Limbs::TibiaLength, 0);
    transformRFB[15] = pi2AboutX;
-   transformRFB[16] = createDHMatrix<float>(0, 0, 0, -M_PI / 2);
+   transformRFB[16] = DHTransform::dh(0, 0, 0, -M_PI / 2);
    transformRFB[18] = pi2AboutXpi2AboutZ;
 
    transformLFB[0] = transformRFB[0];
-   transformLFB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::HipOffsetY, 0);
-   transformLFB[3] = createDHMatrix<float>(0, -M_PI / 4, 0, 0);
+   transformLFB[1] = DHTransform::dh(0, M_PI / 2, -Limbs::HipOffsetY, 0);
+   transformLFB[3] = DHTransform::dh(0, -M_PI / 4, 0, 0);
    transformLFB[4] = transformRFB[4];
    transformLFB[6] = transformRFB[6];
    transformLFB[7] = transformRFB[7];
@@ -278,6 +284,11 @@ Kinematics::Kinematics() {
    transformLFB[16] = transformRFB[16];
    transformLFB[18] = transformRFB[18];
 
+   // So the chain products are valid before the first updateDHChain
+   for (int i = 0; i < 2; ++i) {
+      footToBody[i] = DHChain<BODY>::evaluate(legLinks[i]);
+      bodyToCamera[i] = DHChain<CAMERA - BODY>::evaluate(headLinks[i]);
+   }
 }
 
 Kinematics::Chain
@@ -300,11 +311,6 @@ void Kinematics::updateDHChain() {
 
    JointValues jointValues = sensorValues.joints;
 
-   // Calculate the top left camera transform
-   coffsetY = DEG2RAD(parameters.cameraPitchTop);
-   coffsetX = DEG2RAD(parameters.cameraYawTop);
-   coffsetZ = DEG2RAD(parameters.cameraRollTop);
-
    float Cp = jointValues.angles[Joints::HeadPitch];
    float Cy = jointValues.angles[Joints::HeadYaw];
    float Hyp = jointValues.angles[Joints::LHipYawPitch];
@@ -313,84 +319,68 @@ void Kinematics::updateDHChain() {
    float KpL = jointValues.angles[Joints::LKneePitch];
    float ApL = jointValues.angles[Joints::LAnklePitch];
    float ArL = jointValues.angles[Joints::LAnkleRoll];
-   
-   cameraPanInverseHack = createDHMatrix<float>(0, 0, d2, 0.0);
-   // DH parameters
-   // Some of these are commented out since they're constant and can be calculated
-   // once at the start
-   //transformLTop[0] = createDHMatrix<float>(0, 0, Limbs::FootHeight, M_PI / 2);
-   transformLTop[1] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2 - ArL);
-   transformLTop[2] = createDHMatrix<float>(0, M_PI / 2, 0, -ApL);
-   transformLTop[3] = createDHMatrix<float>(Limbs::TibiaLength, 0, 0, -KpL);
-   transformLTop[4] = createDHMatrix<float>(Limbs::ThighLength, 0, 0, -HpL);
-   transformLTop[5] = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 4 - HrL);
-   transformLTop[6] = createDHMatrix<float>(0, M_PI / 2, -d3, M_PI / 2 - Hyp);
-   // transformLTop[7] = createDHMatrix<float>(0, 3 * M_PI / 4, 0, 0);
-   transformLTop[8] = createDHMatrix<float>(0, 0, d2, Cy);
-   transformLTop[9] = createDHMatrix<float>(0, -M_PI / 2, 0, a3Top + Cp);
-   transformLTop[10] = createDHMatrix<float>(0, -M_PI/2, l10Top, M_PI / 2 + coffsetX);
-   transformLTop[11] = createDHMatrix<float>(0, -M_PI/2 + coffsetY, d11Top, coffsetZ);
-
-   // Calculate the top right camera transform
+
+   // Left foot to body
+   // Links 0 and 7 are constant and are set up in the constructor
+   DHTransform *left = legLinks[LEFT_CHAIN];
+   //left[0] = DHTransform::dh(0, 0, Limbs::FootHeight, M_PI / 2);
+   left[1] = DHTransform::dh(0, M_PI / 2, 0, M_PI / 2 - ArL);
+   left[2] = DHTransform::dh(0, M_PI / 2, 0, -ApL);
+   left[3] = DHTransform::dh(Limbs::TibiaLength, 0, 0, -KpL);
+   left[4] = DHTransform::dh(Limbs::ThighLength, 0, 0, -HpL);
+   left[5] = DHTransform::dh(0, -M_PI / 2, 0, -M_PI / 4 - HrL);
+   left[6] = DHTransform::dh(0, M_PI / 2, -d3, M_PI / 2 - Hyp);
+   //left[7] = DHTransform::dh(0, 3 * M_PI / 4, 0, 0);
+
+   // Right foot to body
    float HpR = jointValues.angles[Joints::RHipPitch];
    float HrR = jointValues.angles[Joints::RHipRoll];
    float KpR = jointValues.angles[Joints::RKneePitch];
    float ApR = jointValues.angles[Joints::RAnklePitch];
    float ArR = jointValues.angles[Joints::RAnkleRoll];
 
-   // DH parameters
-   // Some of these are commented out since they're constant and can be calculated once
-   // Just leaving them here so they can be seen in order
-   //transformRTop[0] = transformLTop[0];
-   transformRTop[1] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2 - ArR);
-   transformRTop[2] = createDHMatrix<float>(0, M_PI / 2, 0, -ApR);
-   transformRTop[3] = createDHMatrix<float>(Limbs::TibiaLength, 0, 0, -KpR);
-   transformRTop[4] = createDHMatrix<float>(Limbs::ThighLength, 0, 0, -HpR);
-   transformRTop[5] = createDHMatrix<float>(0, -M_PI / 2, 0, M_PI / 4 - HrR);
-   transformRTop[6] = createDHMatrix<float>(0, M_PI / 2, d3, M_PI / 2 - Hyp);
-   //transformRTop[7] = createDHMatrix<float>(0, M_PI / 4, 0, 0);
-   transformRTop[8] = transformLTop[8];
-   transformRTop[9] = transformLTop[9]; 
-   transformRTop[10] = transformLTop[10];
-   transformRTop[11] = transformLTop[11];
-
-   // Calculate the bottom left camera transform
+   DHTransform *right = legLinks[RIGHT_CHAIN];
+   //right[0] = left[0];
+   right[1] = DHTransform::dh(0, M_PI / 2, 0, M_PI / 2 - ArR);
+   right[2] = DHTransform::dh(0, M_PI / 2, 0, -ApR);
+   right[3] = DHTransform::dh(Limbs::TibiaLength, 0, 0, -KpR);
+   right[4] = DHTransform::dh(Limbs::ThighLength, 0, 0, -HpR);
+   right[5] = DHTransform::dh(0, -M_PI / 2, 0, M_PI / 4 - HrR);
+   right[6] = DHTransform::dh(0, M_PI / 2, d3, M_PI / 2 - Hyp);
+   //right[7] = DHTransform::dh(0, M_PI / 4, 0, 0);
+
+   // Body to top camera
+   coffsetY = DEG2RAD(parameters.cameraPitchTop);
+   coffsetX = DEG2RAD(parameters.cameraYawTop);
+   coffsetZ = DEG2RAD(parameters.cameraRollTop);
+
+   DHTransform *top = headLinks[cameraIndex(true)];
+   top[0] = DHTransform::dh(0, 0, d2, Cy);
+   top[1] = DHTransform::dh(0, -M_PI / 2, 0, a3Top + Cp);
+   top[2] = DHTransform::dh(0, -M_PI/2, l10Top, M_PI / 2 + coffsetX);
+   top[3] = DHTransform::dh(0, -M_PI/2 + coffsetY, d11Top, coffsetZ);
+
+   // Body to bottom camera
    coffsetY = DEG2RAD(parameters.cameraPitchBottom);
    coffsetX = DEG2RAD(parameters.cameraYawBottom);
    coffsetZ = DEG2RAD(parameters.cameraRollBottom);
 
-   //transformLBot[0] = transformLTop[0];
-   transformLBot[1] = transformLTop[1];
-   transformLBot[2] = transformLTop[2];
-   transformLBot[3] = transformLTop[3];
-   transformLBot[4] = transformLTop[4];
-   transformLBot[5] = transformLTop[5];
-   transformLBot[6] = transformLTop[6];
-   //transformLBot[7] = transformLTop[7];
-   transformLBot[8] = transformLTop[8];
-   transformLBot[9] = createDHMatrix<float>(0, -M_PI / 2, 0, a3Bot + Cp);
-   transformLBot[10] = createDHMatrix<float>(0, -M_PI/2, l10Bot, M_PI / 2 + coffsetX);
-   transformLBot[11] = createDHMatrix<float>(0, -M_PI/2 + coffsetY, d11Bot, coffsetZ);
-
-   // Calculate the bottom right transform
-   //transformRBot[0] = transformRTop[0];
-   transformRBot[1] = transformRTop[1];
-   transformRBot[2] = transformRTop[2];
-   transformRBot[3] = transformRTop[3];
-   transformRBot[4] = transformRTop[4];
-   transformRBot[5] = transformRTop[5];
-   transformRBot[6] = transformRTop[6];
-   //transformRBot[7] = transformRTop[7];
-   transformRBot[8] = transformRTop[8];
-   transformRBot[9] = transformLBot[9];
-   transformRBot[10] = transformLBot[10];
-   transformRBot[11] = transformLBot[11];
+   DHTransform *bot = headLinks[cameraIndex(false)];
+   bot[0] = top[0];
+   bot[1] = DHTransform::dh(0, -M_PI / 2, 0, a3Bot + Cp);
+   bot[2] = DHTransform::dh(0, -M_PI/2, l10Bot, M_PI / 2 + coffsetX);
+   bot[3] = DHTransform::dh(0, -M_PI/2 + coffsetY, d11Bot, coffsetZ);
+
+   for (int i = 0; i < 2; ++i) {
+      footToBody[i] = DHChain<BODY>::evaluate(legLinks[i]);
+      bodyToCamera[i] = DHChain<CAMERA - BODY>::evaluate(headLinks[i]);
+   }
 
    // Transform parameters for centre of mass
    // Head to Body
-   transformHB[0] = createDHMatrix<float>(0, 0, Limbs::NeckOffsetZ, Cy);
-   transformHB[1] = createDHMatrix<float>(0, -M_PI / 2, 0, Cp);
-   //transformHB[2] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
+   transformHB[0] = DHTransform::dh(0, 0, Limbs::NeckOffsetZ, Cy);
+   transformHB[1] = DHTransform::dh(0, -M_PI / 2, 0, Cp);
+   //transformHB[2] = DHTransform::dh(0, M_PI / 2, 0, 0);
 
    // Right Arm to Body 
    // Some of these are commented out since they're constant and can be calculated once
@@ -400,21 +390,21 @@ void Kinematics::updateDHChain() {
    float Ey = jointValues.angles[Joints::RElbowYaw];
    float Er = jointValues.angles[Joints::RElbowRoll];
    float Wy = jointValues.angles[Joints::RWristYaw];
-   //transformRAB[0] = createDHMatrix<float>(0, 0, Limbs::ShoulderOffsetZ, 0);
-   //transformRAB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
-   transformRAB[2] = createDHMatrix<float>(0, -M_PI, 0, Sp);
-   //transformRAB[3] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   transformRAB[4] = createDHMatrix<float>(0, 0, 0, Sr);
-   //transformRAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-   //                                        Limbs::ElbowOffsetY, M_PI / 2);
-   transformRAB[6] = createDHMatrix<float>(0, M_PI / 2, 0, Ey);
-   //transformRAB[7] = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 2);
-   //transformRAB[8] = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
-   transformRAB[9] = createDHMatrix<float>(0, 0, 0, Er);
-   //transformRAB[10] = createDHMatrix<float>(Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
-   transformRAB[11] = createDHMatrix<float>(0, M_PI / 2, 0, Wy);
-   //transformRAB[12] = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 2);
-   //transformRAB[13] = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
+   //transformRAB[0] = DHTransform::dh(0, 0, Limbs::ShoulderOffsetZ, 0);
+   //transformRAB[1] = DHTransform::dh(0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
+   transformRAB[2] = DHTransform::dh(0, -M_PI, 0, Sp);
+   //transformRAB[3] = DHTransform::dh(0, M_PI / 2, 0, 0);
+   transformRAB[4] = DHTransform::dh(0, 0, 0, Sr);
+   //transformRAB[5] = DHTransform::dh(Limbs::UpperArmLength, M_PI / 2,
+   //                                  Limbs::ElbowOffsetY, M_PI / 2);
+   transformRAB[6] = DHTransform::dh(0, M_PI / 2, 0, Ey);
+   //transformRAB[7] = DHTransform::dh(0, -M_PI / 2, 0, -M_PI / 2);
+   //transformRAB[8] = DHTransform::dh(0, -M_PI / 2, 0, 0);
+   transformRAB[9] = DHTransform::dh(0, 0, 0, Er);
+   //transformRAB[10] = DHTransform::dh(Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
+   transformRAB[11] = DHTransform::dh(0, M_PI / 2, 0, Wy);
+   //transformRAB[12] = DHTransform::dh(0, -M_PI / 2, 0, -M_PI / 2);
+   //transformRAB[13] = DHTransform::dh(0, -M_PI / 2, 0, 0);
 
    // Left Arm to Body
    Sp = jointValues.angles[Joints::LShoulderPitch];
@@ -423,129 +413,138 @@ void Kinematics::updateDHChain() {
    Er = jointValues.angles[Joints::LElbowRoll];
    Wy = jointValues.angles[Joints::LWristYaw];
    //transformLAB[0] = transformRAB[0];
-   //transformLAB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
-   transformLAB[2] = createDHMatrix<float>(0, -M_PI, 0, Sp);
+   //transformLAB[1] = DHTransform::dh(0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
+   transformLAB[2] = DHTransform::dh(0, -M_PI, 0, Sp);
    //transformLAB[3] = transformRAB[3];
-   transformLAB[4] = createDHMatrix<float>(0, 0, 0, Sr);
-   //transformRAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-   //                                       -Limbs::ElbowOffsetY, M_PI / 2);
-   transformLAB[6] = createDHMatrix<float>(0, M_PI / 2, 0, Ey);
+   transformLAB[4] = DHTransform::dh(0, 0, 0, Sr);
+   //transformLAB[5] = DHTransform::dh(Limbs::UpperArmLength, M_PI / 2,
+   //                                  -Limbs::ElbowOffsetY, M_PI / 2);
+   transformLAB[6] = DHTransform::dh(0, M_PI / 2, 0, Ey);
    //transformLAB[7] = transformRAB[7];
    //transformLAB[8] = transformRAB[8]; 
-   transformLAB[9] = createDHMatrix<float>(0, 0, 0, Er);
+   transformLAB[9] = DHTransform::dh(0, 0, 0, Er);
    //transformLAB[10] = transformRAB[10];
-   transformLAB[11] = createDHMatrix<float>(0, M_PI / 2, 0, Wy);
+   transformLAB[11] = DHTransform::dh(0, M_PI / 2, 0, Wy);
    //transformLAB[12] = transformRAB[12];
    //transformLAB[13] = transformRAB[13];
 
    // Right Foot to Body
-   HpR = jointValues.angles[Joints::RHipPitch];
-   HrR = jointValues.angles[Joints::RHipRoll];
-   //transformRFB[0] = createDHMatrix<float>(0, 0, -Limbs::HipOffsetZ, 0);
-   //transformRFB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::HipOffsetY, 0);
-   transformRFB[2] = createDHMatrix<float>(0, -3 * M_PI / 4, 0, Hyp);
-   //transformRFB[3] = createDHMatrix<float>(0, M_PI / 4, 0, 0);
-   //transformRFB[4] = createDHMatrix<float>(0, M_PI / 2, 0, -M_PI / 2);
-   transformRFB[5] = createDHMatrix<float>(0, -M_PI / 2, 0, HrR);
-   //transformRFB[6] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2);
-   //transformRFB[7] = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
-   transformRFB[8] = createDHMatrix<float>(0, -M_PI / 2, 0, HpR);
-   //transformRFB[9] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   //transformRFB[10] = createDHMatrix<float>(0, 0, -Limbs::ThighLength, 0);
-   transformRFB[11] = createDHMatrix<float>(0, -M_PI / 2, 0, KpR);
-   //transformRFB[12] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   //transformRFB[13] = createDHMatrix<float>(0, 0, -Limbs::TibiaLength, 0);
-   transformRFB[14] = createDHMatrix<float>(0, -M_PI / 2, 0, ApR);
-   //transformRFB[15] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   //transformRFB[16] = createDHMatrix<float>(0, 0, 0, -M_PI / 2);
-   transformRFB[17] = createDHMatrix<float>(0, -M_PI / 2, 0, ArR);
-   //transformRFB[18] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2);
+   //transformRFB[0] = DHTransform::dh(0, 0, -Limbs::HipOffsetZ, 0);
+   //transformRFB[1] = DHTransform::dh(0, M_PI / 2, Limbs::HipOffsetY, 0);
+   transformRFB[2] = DHTransform::dh(0, -3 * M_PI / 4, 0, Hyp);
+   //transformRFB[3] = DHTransform::dh(0, M_PI / 4, 0, 0);
+   //transformRFB[4] = DHTransform::dh(0, M_PI / 2, 0, -M_PI / 2);
+   transformRFB[5] = DHTransform::dh(0, -M_PI / 2, 0, HrR);
+   //transformRFB[6] = DHTransform::dh(0, M_PI / 2, 0, M_PI / 2);
+   //transformRFB[7] = DHTransform::dh(0, -M_PI / 2, 0, 0);
+   transformRFB[8] = DHTransform::dh(0, -M_PI / 2, 0, HpR);
+   //transformRFB[9] = DHTransform::dh(0, M_PI / 2, 0, 0);
+   //transformRFB[10] = DHTransform::dh(0, 0, -Limbs::ThighLength, 0);
+   transformRFB[11] = DHTransform::dh(0, -M_PI / 2, 0, KpR);
+   //transformRFB[12] = DHTransform::dh(0, M_PI / 2, 0, 0);
+   //transformRFB[13] = DHTransform::dh(0, 0, -Limbs::TibiaLength, 0);
+   transformRFB[14] = DHTransform::dh(0, -M_PI / 2, 0, ApR);
+   //transformRFB[15] = DHTransform::dh(0, M_PI / 2, 0, 0);
+   //transformRFB[16] = DHTransform::dh(0, 0, 0, -M_PI / 2);
+   transformRFB[17] = DHTransform::dh(0, -M_PI / 2, 0, ArR);
+   //transformRFB[18] = DHTransform::dh(0, M_PI / 2, 0, M_PI / 2);
 
    // Left Foot to Body 
-   HpL = jointValues.angles[Joints::LHipPitch];
-   HrL = jointValues.angles[Joints::LHipRoll];
    //transformLFB[0] = transformRFB[0];
-   //transformLFB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::HipOffsetY, 0);
-   transformLFB[2] = createDHMatrix<float>(0, -M_PI / 4, 0, -Hyp);
-   //transformLFB[3] = createDHMatrix<float>(0, -M_PI / 4, 0, 0);
+   //transformLFB[1] = DHTransform::dh(0, M_PI / 2, -Limbs::HipOffsetY, 0);
+   transformLFB[2] = DHTransform::dh(0, -M_PI / 4, 0, -Hyp);
+   //transformLFB[3] = DHTransform::dh(0, -M_PI / 4, 0, 0);
    //transformLFB[4] = transformRFB[4];
-   transformLFB[5] = createDHMatrix<float>(0, -M_PI / 2, 0, HrL);
+   transformLFB[5] = DHTransform::dh(0, -M_PI / 2, 0, HrL);
    //transformLFB[6] = transformRFB[6];
    //transformLFB[7] = transformRFB[7];
-   transformLFB[8] = createDHMatrix<float>(0, -M_PI / 2, 0, HpL);
+   transformLFB[8] = DHTransform::dh(0, -M_PI / 2, 0, HpL);
    //transformLFB[9] = transformRFB[9];
    //transformLFB[10] = transformRFB[10];
-   transformLFB[11] = createDHMatrix<float>(0, -M_PI / 2, 0, KpL);
+   transformLFB[11] = DHTransform::dh(0, -M_PI / 2, 0, KpL);
    //transformLFB[12] = transformRFB[12];
    //transformLFB[13] = transformRFB[13];
-   transformLFB[14] = createDHMatrix<float>(0, -M_PI / 2, 0, ApL);
+   transformLFB[14] = DHTransform::dh(0, -M_PI / 2, 0, ApL);
    //transformLFB[15] = transformRFB[15];
    //transformLFB[16] = transformRFB[16];
-   transformLFB[17] = createDHMatrix<float>(0, -M_PI / 2, 0, ArL);
+   transformLFB[17] = DHTransform::dh(0, -M_PI / 2, 0, ArL);
    //transformLFB[18] = transformRFB[18];
 }
 
 Pose Kinematics::getPose() {
    Chain foot = determineSupportChain();
 
-   boost::numeric::ublas::matrix<float> c2wTop = createCameraToWorldTransform(foot, true);
-   boost::numeric::ublas::matrix<float> c2wBot = createCameraToWorldTransform(foot, false);
-   boost::numeric::ublas::matrix<float> n2w = createNeckToWorldTransform(foot);
+   // The foot to world and lean transforms are shared by both cameras and
+   // the neck, so only evaluate them once
+   DHTransform b2w = createFootToWorld(foot) * createLeanTransform(foot);
+
+   boost::numeric::ublas::matrix<float> c2wTop =
+      (b2w * bodyToCamera[cameraIndex(true)]).toMatrix();
+   boost::numeric::ublas::matrix<float> c2wBot =
+      (b2w * bodyToCamera[cameraIndex(false)]).toMatrix();
+   boost::numeric::ublas::matrix<float> n2w =
+      (b2w * cameraPanInverseHack).toMatrix();
    std::pair<int, int> horizon = calculateHorizon(c2wTop);
    Pose pose(c2wTop, c2wBot, n2w, horizon);
 
-   boost::numeric::ublas::matrix<float> b2cTop =
-      evaluateDHChain(BODY, CAMERA, foot, true);
-   determineBodyExclusionArray(b2cTop, pose.getTopExclusionArray(), true);
+   if (exclusionNeedsUpdate()) {
+      boost::numeric::ublas::matrix<float> b2cTop =
+         bodyToCamera[cameraIndex(true)].toMatrix();
+      determineBodyExclusionArray(b2cTop, topExclusionArray, true);
 
-   boost::numeric::ublas::matrix<float> b2cBot =
-      evaluateDHChain(BODY, CAMERA, foot, false);
-   determineBodyExclusionArray(b2cBot, pose.getBotExclusionArray(), false);
+      boost::numeric::ublas::matrix<float> b2cBot =
+         bodyToCamera[cameraIndex(false)].toMatrix();
+      determineBodyExclusionArray(b2cBot, botExclusionArray, false);
+
+      exclusionValid = true;
+      exclusionHeadYaw = sensorValues.joints.angles[Joints::HeadYaw];
+      exclusionHeadPitch = sensorValues.joints.angles[Joints::HeadPitch];
+      exclusionParameters = parameters;
+   }
+   std::copy(topExclusionArray, topExclusionArray + Pose::EXCLUSION_RESOLUTION,
+             pose.getTopExclusionArray());
+   std::copy(botExclusionArray, botExclusionArray + Pose::EXCLUSION_RESOLUTION,
+             pose.getBotExclusionArray());
 
    return pose;
 }
 
 boost::numeric::ublas::matrix<float>
 Kinematics::createCameraToWorldTransform(Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> c2f = createCameraToFootTransform(foot,top);
-   boost::numeric::ublas::matrix<float> f2w = createFootToWorldTransform(foot,top);
-   return prod(f2w, c2f);
+   DHTransform c2f = createLeanTransform(foot) * bodyToCamera[cameraIndex(top)];
+   return (createFootToWorld(foot) * c2f).toMatrix();
 }
 
 boost::numeric::ublas::matrix<float>
 Kinematics::createNeckToWorldTransform(Chain foot) {
-   boost::numeric::ublas::matrix<float> n2f = createNeckToFootTransform(foot);
-   boost::numeric::ublas::matrix<float> f2w = createFootToWorldTransform(foot);
-   return prod(f2w, n2f);
+   DHTransform n2f = createLeanTransform(foot) * cameraPanInverseHack;
+   return (createFootToWorld(foot) * n2f).toMatrix();
 }
 
 boost::numeric::ublas::matrix<float>
 Kinematics::evaluateDHChain(Link from, Link to, Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> finalTransform =
-      boost::numeric::ublas::identity_matrix<float>(4);
-   if (foot == RIGHT_CHAIN) {
-      if (top) {
-         for (int i = from; i < to; i++) {
-            finalTransform = boost::numeric::ublas::prod(finalTransform,
-                                                         transformRTop[i]);
-         }
-      } else {
-         for (int i = from; i < to; i++) {
-            finalTransform = boost::numeric::ublas::prod(finalTransform,
-                                                         transformRBot[i]);
-         }
-      } 
-   } else {
-      if (top) {
-         for (int i = from; i < to; i++) {
-            finalTransform =
-               boost::numeric::ublas::prod(finalTransform, transformLTop[i]);
-         }
+   return evaluateChain(from, to, foot, top).toMatrix();
+}
+
+DHTransform
+Kinematics::evaluateChain(Link from, Link to, Chain foot, bool top) const {
+   // Common cases are the products updateDHChain already cached
+   if (from == FOOT && to == BODY) {
+      return footToBody[foot];
+   }
+   if (from == BODY && to == CAMERA) {
+      return bodyToCamera[cameraIndex(top)];
+   }
+   if (from == FOOT && to == CAMERA) {
+      return footToBody[foot] * bodyToCamera[cameraIndex(top)];
+   }
+
+   DHTransform finalTransform = DHTransform::identity();
+   for (int i = from; i < to; i++) {
+      if (i < BODY) {
+         finalTransform *= legLinks[foot][i];
       } else {
-         for (int i = from; i < to; i++) {
-            finalTransform =
-               boost::numeric::ublas::prod(finalTransform, transformLBot[i]);
-         }
+         finalTransform *= headLinks[cameraIndex(top)][i - BODY];
       }
    }
    return finalTransform;
@@ -556,176 +555,148 @@ boost::numeric::ublas::matrix<float>
 Kinematics::evaluateMassChain() {   
    int i, joint = 0;
    float totalMass = 0;
-   boost::numeric::ublas::matrix<float> finalTransform(4, 1);
-   finalTransform = boost::numeric::ublas::zero_matrix<float>(4, 1);
+   float sum[3] = {0, 0, 0};
+   float com[3];
 
    // Mass of torso
-   finalTransform += massesCom[joint] * masses[joint]; 
+   for (int j = 0; j < 3; ++j) {
+      sum[j] += massesCom[joint][j] * masses[joint];
+   }
    totalMass += masses[joint];
    ++joint;
 
    // Mass of head
-   boost::numeric::ublas::matrix<float> headTransform = boost::numeric::ublas::identity_matrix<float>(4);
+   DHTransform headTransform = DHTransform::identity();
    for (i = 0; i < HEAD_DH_CHAIN_LEN; ++i) {
-      headTransform = boost::numeric::ublas::prod(headTransform, transformHB[i]); 
+      headTransform *= transformHB[i];
       // Up to head yaw, head pitch
       if (i == 0 || i == 2) {
-         finalTransform += boost::numeric::ublas::prod(headTransform, massesCom[joint]) * masses[joint]; 
+         headTransform.transformPoint(massesCom[joint], com);
+         for (int j = 0; j < 3; ++j) {
+            sum[j] += com[j] * masses[joint];
+         }
          totalMass += masses[joint];
          ++joint;
       }
    }
 
    // Mass of right arm 
-   boost::numeric::ublas::matrix<float> rArmTransform = boost::numeric::ublas::identity_matrix<float>(4);
+   DHTransform rArmTransform = DHTransform::identity();
    for (i = 0; i < ARM_DH_CHAIN_LEN; ++i) { 
-      rArmTransform = boost::numeric::ublas::prod(rArmTransform, transformRAB[i]);
+      rArmTransform *= transformRAB[i];
       // Up to shoulder pitch, shoulder roll, elbow yaw, elbow roll, wrist yaw
       if (i == 3 || i == 4 || i == 8 || i == 9 || i == 13) {
-         finalTransform += boost::numeric::ublas::prod(rArmTransform, massesCom[joint]) * masses[joint]; 
+         rArmTransform.transformPoint(massesCom[joint], com);
+         for (int j = 0; j < 3; ++j) {
+            sum[j] += com[j] * masses[joint];
+         }
          totalMass += masses[joint];
          ++joint;
       }
    }
 
    // Mass of left arm
-   boost::numeric::ublas::matrix<float> lArmTransform = boost::numeric::ublas::identity_matrix<float>(4);
+   DHTransform lArmTransform = DHTransform::identity();
    for (i = 0; i < ARM_DH_CHAIN_LEN; ++i) {
       // Up to shoulder pitch, shoulder roll, elbow yaw, elbow roll, wrist yaw
-      lArmTransform = boost::numeric::ublas::prod(lArmTransform, transformLAB[i]);
+      lArmTransform *= transformLAB[i];
       if (i == 3 || i == 4 || i == 8 || i == 9 || i == 13) {
-         finalTransform += boost::numeric::ublas::prod(lArmTransform, massesCom[joint]) * masses[joint]; 
+         lArmTransform.transformPoint(massesCom[joint], com);
+         for (int j = 0; j < 3; ++j) {
+            sum[j] += com[j] * masses[joint];
+         }
          totalMass += masses[joint];
          ++joint;
       }
    }
 
    // Mass of right leg 
-   boost::numeric::ublas::matrix<float> rLegTransform = boost::numeric::ublas::identity_matrix<float>(4);
+   DHTransform rLegTransform = DHTransform::identity();
    for (i = 0; i < LEG_DH_CHAIN_LEN; ++i) { 
-      rLegTransform = boost::numeric::ublas::prod(rLegTransform, transformRFB[i]);
+      rLegTransform *= transformRFB[i];
       // Up to hip yaw pitch, hip roll, hip pitch, knee pitch, ankle pitch, ankle roll
       if (i == 3 || i == 7 || i == 9 || i == 12 || i == 15 || i == 18) {
-         finalTransform += boost::numeric::ublas::prod(rLegTransform, massesCom[joint]) * masses[joint]; 
+         rLegTransform.transformPoint(massesCom[joint], com);
+         for (int j = 0; j < 3; ++j) {
+            sum[j] += com[j] * masses[joint];
+         }
          totalMass += masses[joint];
          ++joint;
       }
    }
 
    // Mass of left leg 
-   boost::numeric::ublas::matrix<float> lLegTransform = boost::numeric::ublas::identity_matrix<float>(4);
+   DHTransform lLegTransform = DHTransform::identity();
    for (i = 0; i < LEG_DH_CHAIN_LEN; ++i) { 
-      lLegTransform = boost::numeric::ublas::prod(lLegTransform, transformLFB[i]);
+      lLegTransform *= transformLFB[i];
       // Up to hip yaw pitch, hip roll, hip pitch, knee pitch, ankle pitch, ankle roll
       if (i == 3 || i == 7 || i == 9 || i == 12 || i == 15 || i == 18) {
-         finalTransform += boost::numeric::ublas::prod(lLegTransform, massesCom[joint]) * masses[joint]; 
+         lLegTransform.transformPoint(massesCom[joint], com);
+         for (int j = 0; j < 3; ++j) {
+            sum[j] += com[j] * masses[joint];
+         }
          totalMass += masses[joint];
          ++joint;
       }
    }
 
-   return finalTransform / totalMass;
+   return vec4<float>(sum[0] / totalMass, sum[1] / totalMass,
+                      sum[2] / totalMass, 1);
 }
 
-boost::numeric::ublas::matrix<float>
-Kinematics::createCameraToFootTransform(Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> b2f = evaluateDHChain(FOOT, BODY, foot, top);
+DHTransform Kinematics::createLeanTransform(Chain foot) const {
    // When we get to the torso, we need to adjust the transform by the forward and side lean to account
    // for when the robot's feet are not flat on the ground. We apply the the rotation of the lean to the
    // hip vector to account for the lean already introduced by the leg joints.
    // We also adjust by the body pitch offset from kinematics calibration.
-   boost::numeric::ublas::matrix<float> z(4, 1);
-   z(0, 0) = 0;
-   z(1, 0) = 0;
-   z(2, 0) = 0;
-   z(3, 0) = 1;
-   boost::numeric::ublas::matrix<float> hipPt = prod(b2f, z);
+   const DHTransform &b2f = footToBody[foot];
    float bodyPitchOffset = DEG2RAD(parameters.bodyPitch);
    float forwardLean = sensorValues.sensors[Sensors::InertialSensor_AngleY];
    float sideLean = sensorValues.sensors[Sensors::InertialSensor_AngleX];
 
-   boost::numeric::ublas::matrix<float> transform = createDHMatrix<float>(hipPt(0, 0), 0, 0, 0);
-   transform = prod(transform, createDHMatrix<float>(0, 0, hipPt(2, 0), M_PI / 2)); // move up by hip height
-   transform = prod(transform, createDHMatrix<float>(hipPt(1, 0), 0, 0, 0)); // move sideways
-   transform = prod(transform, createDHMatrix<float>(0, forwardLean + bodyPitchOffset, 0, -M_PI / 2));
-   transform = prod(transform, createDHMatrix<float>(0, sideLean, 0, 0));
-   
-   return prod(transform, evaluateDHChain(BODY, CAMERA, foot, top));
+   DHTransform transform = DHTransform::dh(b2f.x(), 0, 0, 0);
+   transform *= DHTransform::dh(0, 0, b2f.z(), M_PI / 2); // move up by hip height
+   transform *= DHTransform::dh(b2f.y(), 0, 0, 0); // move sideways
+   transform *= DHTransform::dh(0, forwardLean + bodyPitchOffset, 0, -M_PI / 2);
+   transform *= DHTransform::dh(0, sideLean, 0, 0);
+   return transform;
 }
 
 boost::numeric::ublas::matrix<float>
-Kinematics::createNeckToFootTransform(Chain foot) {
-   boost::numeric::ublas::matrix<float> b2f = evaluateDHChain(FOOT, BODY, foot);
-   // When we get to the torso, we need to adjust the transform by the forward and side lean to account
-   // for when the robot's feet are not flat on the ground. We apply the the rotation of the lean to the
-   // hip vector to account for the lean already introduced by the leg joints.
-   // We also adjust by the body pitch offset from kinematics calibration.
-   boost::numeric::ublas::matrix<float> z(4, 1);
-   z(0, 0) = 0;
-   z(1, 0) = 0;
-   z(2, 0) = 0;
-   z(3, 0) = 1;
-   boost::numeric::ublas::matrix<float> hipPt = prod(b2f, z);
-   float bodyPitchOffset = DEG2RAD(parameters.bodyPitch);
-   float forwardLean = sensorValues.sensors[Sensors::InertialSensor_AngleY];
-   float sideLean = sensorValues.sensors[Sensors::InertialSensor_AngleX];
-
-   boost::numeric::ublas::matrix<float> transform = createDHMatrix<float>(hipPt(0, 0), 0, 0, 0);
-   transform = prod(transform, createDHMatrix<float>(0, 0, hipPt(2, 0), M_PI / 2)); // move up by hip height
-   transform = prod(transform, createDHMatrix<float>(hipPt(1, 0), 0, 0, 0)); // move sideways
-   transform = prod(transform, createDHMatrix<float>(0, forwardLean + bodyPitchOffset, 0, -M_PI / 2));
-   transform = prod(transform, createDHMatrix<float>(0, sideLean, 0, 0));
+Kinematics::createCameraToFootTransform(Chain foot, bool top) {
+   return (createLeanTransform(foot) * bodyToCamera[cameraIndex(top)]).toMatrix();
+}
 
-   return prod(transform, cameraPanInverseHack);
+boost::numeric::ublas::matrix<float>
+Kinematics::createNeckToFootTransform(Chain foot) {
+   return (createLeanTransform(foot) * cameraPanInverseHack).toMatrix();
 }
 
 // World is defined as the centre of the two feet on the ground plane,
 // with a heading equal to the average of the two feet directions
-boost::numeric::ublas::matrix<float>
-Kinematics::createFootToWorldTransform(Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> b2lf =
-      evaluateDHChain(FOOT, BODY, foot, top);
-   boost::numeric::ublas::matrix<float> b2rf =
-      evaluateDHChain(FOOT, BODY, (Chain) !foot, top);
-
-   boost::numeric::ublas::matrix<float> rf2b(4, 4);
-   invertMatrix(b2rf, rf2b);
-
-   boost::numeric::ublas::matrix<float> rf2lf(4, 4);
-   rf2lf = prod(rf2b, b2lf);
-
-   boost::numeric::ublas::matrix<float> z(4, 1);
-   z(0, 0) = 0;
-   z(1, 0) = 0;
-   z(2, 0) = 0;
-   z(3, 0) = 1;
-   boost::numeric::ublas::matrix<float> forward(4, 1);
-   forward(0, 0) = 1;
-   forward(1, 0) = 0;
-   forward(2, 0) = 0;
-   forward(3, 0) = 1;
+DHTransform Kinematics::createFootToWorld(Chain foot) const {
+   const DHTransform &b2lf = footToBody[foot];
+   const DHTransform &b2rf = footToBody[!foot];
+
+   DHTransform rf2lf = b2rf.inverse() * b2lf;
 
    // first find position of centre of two feet on the ground.
-   z = prod(rf2lf, z);
+   float z[3] = {rf2lf.x(), rf2lf.y(), rf2lf.z()};
 
    // find direction of second foot in first foot coords
-   forward = prod(rf2lf, forward) - z;
-
-   boost::numeric::ublas::matrix<float> position = -z / 2;
-   position(3, 0) = 1;
-   position(2, 0) = 0;  // on the ground
-
-   boost::numeric::ublas::matrix<float> result =
-      boost::numeric::ublas::identity_matrix<float>(4);
-   result = prod(translateMatrix<float>(position(0, 0), position(1, 0), 0),
-                 result);
-   // result = prod(rotateZMatrix<float>(-atan2(forward(1, 0), forward(0, 0))/2.0),
-   //                            result);
-   result = prod(rotateZMatrix<float>(-atan2f(forward(1, 0), forward(0, 0)) / 2.0),
-                                      result);
+   float forward[2] = {rf2lf.m[0][0], rf2lf.m[1][0]};
+
+   DHTransform result = DHTransform::translate(-z[0] / 2, -z[1] / 2, 0);
+   result = DHTransform::rotateZ(-atan2f(forward[1], forward[0]) / 2.0) * result;
    return result;
 }
 
+// The top argument is unused since both cameras share the leg chains
+boost::numeric::ublas::matrix<float>
+Kinematics::createFootToWorldTransform(Chain foot, bool top) {
+   return createFootToWorld(foot).toMatrix();
+}
+
 void Kinematics::setSensorValues(SensorValues sensorValues) {
    this->sensorValues = sensorValues;
 }
@@ -748,13 +719,40 @@ Kinematics::createWorldToFOVTransform(
    return transform;
 }
 
+void Kinematics::addBodyPart(
+   const std::vector<boost::numeric::ublas::matrix<float> > &part) {
+   for (unsigned int i = 0; i < part.size(); i++) {
+      bodyPointX.push_back(part[i](0, 0));
+      bodyPointY.push_back(part[i](1, 0));
+      bodyPointZ.push_back(part[i](2, 0));
+   }
+   bodyPartEnds.push_back(bodyPointX.size());
+   projectedX.resize(bodyPointX.size());
+   projectedY.resize(bodyPointX.size());
+   projectedW.resize(bodyPointX.size());
+}
+
+bool Kinematics::exclusionNeedsUpdate() const {
+   if (!exclusionValid ||
+       memcmp(&exclusionParameters, &parameters, sizeof(parameters)) != 0) {
+      return true;
+   }
+   const float *angles = sensorValues.joints.angles;
+   return fabsf(angles[Joints::HeadYaw] - exclusionHeadYaw) >=
+          EXCLUSION_UPDATE_ANGLE ||
+          fabsf(angles[Joints::HeadPitch] - exclusionHeadPitch) >=
+          EXCLUSION_UPDATE_ANGLE;
+}
+
 void Kinematics::determineBodyExclusionArray(
    const boost::numeric::ublas::matrix<float> &m,
    int16_t *points, bool top) {
 
    const int COLS = (top) ? TOP_IMAGE_COLS : BOT_IMAGE_COLS;
+   const int ROWS = (top) ? TOP_IMAGE_ROWS : BOT_IMAGE_ROWS;
+   const int RESOLUTION = Pose::EXCLUSION_RESOLUTION;
 
-   for (int i = 0; i < Pose::EXCLUSION_RESOLUTION; i++) {
+   for (int i = 0; i < RESOLUTION; i++) {
       points[i] = TOP_IMAGE_ROWS;
       if (!top) points[i] += BOT_IMAGE_ROWS;
    }
@@ -762,58 +760,71 @@ void Kinematics::determineBodyExclusionArray(
    boost::numeric::ublas::matrix<float> transform
       = createWorldToFOVTransform(m);
 
-   for (unsigned int part = 0; part < bodyParts.size(); part++) {
-      boost::numeric::ublas::matrix<float> last =
-         fovToImageSpaceTransform(transform,
-                                  bodyParts[part][0],
-                                  top);
-      for (unsigned int i = 0; i < bodyParts[part].size(); i++) {
-         boost::numeric::ublas::matrix<float> m
-            = fovToImageSpaceTransform(transform,
-                                       bodyParts[part][i],
-                                       top);
-         if (m(2, 0) <= 0) {
-            last = m;
+   // Project the whole point cloud in one pass. This is
+   // fovToImageSpaceTransform without a ublas matrix per point, and only
+   // the x, y and perspective rows are needed.
+   float t[3][4];
+   for (int j = 0; j < 4; ++j) {
+      t[0][j] = transform(0, j);
+      t[1][j] = transform(1, j);
+      t[2][j] = transform(3, j);
+   }
+   const float xscale = COLS / 2;
+   const float yscale = ROWS / 2;
+   const size_t numPoints = bodyPointX.size();
+   for (size_t i = 0; i < numPoints; i++) {
+      const float x = bodyPointX[i], y = bodyPointY[i], z = bodyPointZ[i];
+      const float w = t[2][0] * x + t[2][1] * y + t[2][2] * z + t[2][3];
+      const float px = t[0][0] * x + t[0][1] * y + t[0][2] * z + t[0][3];
+      const float py = t[1][0] * x + t[1][1] * y + t[1][2] * z + t[1][3];
+      projectedX[i] = (px / w) * xscale + xscale;
+      projectedY[i] = (py / w) * xscale + yscale;
+      projectedW[i] = w;
+   }
+
+   size_t begin = 0;
+   for (unsigned int part = 0; part < bodyPartEnds.size(); part++) {
+      const size_t end = bodyPartEnds[part];
+      size_t last = begin;
+      for (size_t i = begin; i < end; i++) {
+         if (projectedW[i] <= 0) {
+            last = i;
             continue;
          }
-         // llog(VERBOSE) << "Pixel " << i << ": " << m << std::endl;
-         // llog(VERBOSE) << "Coord " << i << ": " <<
-         //            prod(transform, bodyParts[part][i]) << std::endl;
-         int lIndex = (int)(last(0, 0) / COLS *
-                            Pose::EXCLUSION_RESOLUTION);
-         int cIndex = (int)(m(0, 0) / COLS *
-                            Pose::EXCLUSION_RESOLUTION);
-         int lPixel = last(1, 0);
-         int cPixel = m(1, 0);
-         // int range = ABS(cIndex - lIndex);
+         int lIndex = (int)(projectedX[last] / COLS * RESOLUTION);
+         int cIndex = (int)(projectedX[i] / COLS * RESOLUTION);
+         int lPixel = projectedY[last];
+         int cPixel = projectedY[i];
          float gradient = 0;
          if (cIndex - lIndex != 0) {
             float denom = cIndex - lIndex;
             gradient = (cPixel - lPixel) / (denom);
          }
-         cIndex = MIN(MAX(cIndex, 0), (int) Pose::EXCLUSION_RESOLUTION);
-         lIndex = MIN(MAX(lIndex, 0), (int) Pose::EXCLUSION_RESOLUTION);
-         int index = lIndex;
-         while (index != cIndex && last(2, 0) > 0) {
-            if (index >= 0 && index < Pose::EXCLUSION_RESOLUTION &&
-                index != cIndex) {
-               int nPixel = last(1, 0) + gradient * (index - lIndex);
+         cIndex = MIN(MAX(cIndex, 0), RESOLUTION);
+         lIndex = MIN(MAX(lIndex, 0), RESOLUTION);
+
+         // Interpolate the bins from last up to, but not including, the
+         // current point. Each bin is independent, so this vectorises.
+         if (projectedW[last] > 0) {
+            int from = (lIndex < cIndex) ? lIndex : cIndex + 1;
+            int to = (lIndex < cIndex) ? cIndex : lIndex + 1;
+            to = MIN(to, RESOLUTION);
+            const float lastPixel = projectedY[last];
+            for (int index = from; index < to; index++) {
+               int nPixel = lastPixel + gradient * (index - lIndex);
                if (nPixel < points[index]) points[index] = nPixel;
             }
-            index += (cIndex - lIndex) > 0 ? 1 : -1;
          }
 
-         // get Index of last.
-         // keep adding one and linearly interpolate
-         index = (int)(m(0, 0) / COLS *
-                       Pose::EXCLUSION_RESOLUTION);
-         if (index >= 0 && index < Pose::EXCLUSION_RESOLUTION) {
-            if (m(1, 0) < points[index]) {
-               points[index] = m(1, 0);
+         int index = (int)(projectedX[i] / COLS * RESOLUTION);
+         if (index >= 0 && index < RESOLUTION) {
+            if (projectedY[i] < points[index]) {
+               points[index] = projectedY[i];
             }
          }
-         last = m;
+         last = i;
       }
+      begin = end;
    }
 }
 
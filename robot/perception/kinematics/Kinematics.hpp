@@ -47,6 +47,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <types/SensorValues.hpp>
 
 #include "CKF.hpp"
+#include "DHTransform.hpp"
 
 #define CAMERA_DH_CHAIN_LEN 12
 #define HEAD_DH_CHAIN_LEN 3
@@ -58,6 +59,7 @@ class Kinematics {
       friend class KinematicsAdapter;
       friend class KinematicsCalibrationSkill;
       friend class CameraPoseTab;
+      friend class PoseService;
       Kinematics();
 
       enum Link {
@@ -80,6 +82,10 @@ class Kinematics {
       boost::numeric::ublas::matrix<float>
       evaluateDHChain(Link from, Link to, Chain foot, bool top = true);
 
+      /* Fixed size equivalent of evaluateDHChain */
+      DHTransform
+      evaluateChain(Link from, Link to, Chain foot, bool top = true) const;
+
       boost::numeric::ublas::matrix<float> evaluateMassChain();
 
       boost::numeric::ublas::matrix<float>
@@ -125,27 +131,68 @@ class Kinematics {
       SensorValues sensorValues;
       Chain supportChain;
 
-      boost::numeric::ublas::matrix<float> transformLTop[CAMERA_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformLBot[CAMERA_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRTop[CAMERA_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRBot[CAMERA_DH_CHAIN_LEN];
-      
-      boost::numeric::ublas::matrix<float> cameraPanInverseHack;
+      /**
+       * The camera chains share their links: everything up to BODY only
+       * depends on the foot, and everything after only on the camera. So
+       * rather than the four left/right/top/bottom chains we keep the two
+       * leg halves and the two head halves, and the products of each half,
+       * which updateDHChain refreshes once per tick.
+       */
+      DHTransform legLinks[2][BODY];
+      DHTransform headLinks[2][CAMERA - BODY];
+      DHTransform footToBody[2];
+      DHTransform bodyToCamera[2];
+
+      DHTransform cameraPanInverseHack;
 
       // DH matrices for mass
-      boost::numeric::ublas::matrix<float> transformHB[HEAD_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRAB[ARM_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformLAB[ARM_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRFB[LEG_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformLFB[LEG_DH_CHAIN_LEN];
+      DHTransform transformHB[HEAD_DH_CHAIN_LEN];
+      DHTransform transformRAB[ARM_DH_CHAIN_LEN];
+      DHTransform transformLAB[ARM_DH_CHAIN_LEN];
+      DHTransform transformRFB[LEG_DH_CHAIN_LEN];
+      DHTransform transformLFB[LEG_DH_CHAIN_LEN];
 
       // Contains the masses and centre position of each joint
       std::vector<float> masses;
-      std::vector<boost::numeric::ublas::matrix<float> > massesCom;
+      std::vector<const float *> massesCom;
 
       Parameters<float> parameters;
 
-      std::vector<std::vector<boost::numeric::ublas::matrix<float> > >
-      bodyParts;
+      /**
+       * Body part polylines in body coordinates, packed as one point cloud.
+       * Part i spans [bodyPartEnds[i - 1], bodyPartEnds[i]).
+       */
+      std::vector<float> bodyPointX;
+      std::vector<float> bodyPointY;
+      std::vector<float> bodyPointZ;
+      std::vector<size_t> bodyPartEnds;
+      void addBodyPart(
+         const std::vector<boost::numeric::ublas::matrix<float> > &part);
+
+      // Scratch space for the projected body points
+      std::vector<float> projectedX;
+      std::vector<float> projectedY;
+      std::vector<float> projectedW;
+
+      /**
+       * Exclusion arrays from the last time they were computed, and the
+       * head angles and calibration they were computed with. The body to
+       * camera transform only depends on these, so while the head holds
+       * still the cached arrays are reused.
+       */
+      bool exclusionValid;
+      float exclusionHeadYaw;
+      float exclusionHeadPitch;
+      Parameters<float> exclusionParameters;
+      int16_t topExclusionArray[Pose::EXCLUSION_RESOLUTION];
+      int16_t botExclusionArray[Pose::EXCLUSION_RESOLUTION];
+      bool exclusionNeedsUpdate() const;
+
+      static int cameraIndex(bool top) { return top ? 0 : 1; }
+
+      /* Body to foot, corrected for the lean of the torso */
+      DHTransform createLeanTransform(Chain foot) const;
+
+      DHTransform createFootToWorld(Chain foot) const;
 };
 
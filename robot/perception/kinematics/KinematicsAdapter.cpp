@@ -49,8 +49,9 @@ void KinematicsAdapter::tick() {
    llog(VERBOSE) << "Kinematics took: " << t.elapsed_us() << " us" << endl;
    
    t.restart();
-   sonarFilter.update(readFrom(motion, sonarWindow));
-   writeTo(kinematics, sonarFiltered, sonarFilter.sonarFiltered);
+   if (sonarFilter.update(readFrom(motion, sonarWindow))) {
+      writeTo(kinematics, sonarFiltered, sonarFilter.sonarFiltered);
+   }
    llog(VERBOSE) << "Sonar Filter took: " << t.elapsed_us() << " us" << endl;
 }
 
@@ -0,0 +1,103 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "perception/kinematics/PoseService.hpp"
+
+PoseService::PoseService() {
+}
+
+void PoseService::push(int64_t timestamp, const SensorValues &sensors) {
+   history.push(timestamp, sensors);
+}
+
+bool PoseService::getSensors(int64_t timestamp, SensorValues *sensors) const {
+   SensorValues newest;
+   if (!history.getLagged(0, &newest)) {
+      return false;
+   }
+
+   int lag = history.findLag(timestamp);
+   SensorValues before, after;
+   int64_t beforeTime, afterTime;
+   if (lag == 0) {
+      // Newer than anything we have, don't extrapolate
+      *sensors = newest;
+   } else if (lag < 0 ||
+              !history.getLagged(lag, &before, &beforeTime) ||
+              !history.getLagged(lag - 1, &after, &afterTime)) {
+      // Older than anything we have, use the oldest sample still around
+      for (lag = HISTORY_SIZE - 1; lag >= 0; --lag) {
+         if (history.getLagged(lag, sensors)) {
+            break;
+         }
+      }
+   } else {
+      float alpha = 0;
+      if (afterTime > beforeTime) {
+         alpha = (float)(timestamp - beforeTime) / (afterTime - beforeTime);
+      }
+      *sensors = (alpha < 0.5f) ? before : after;
+      for (int i = 0; i < Joints::NUMBER_OF_JOINTS; ++i) {
+         sensors->joints.angles[i] = before.joints.angles[i] +
+            alpha * (after.joints.angles[i] - before.joints.angles[i]);
+      }
+      for (int i = 0; i < Sensors::NUMBER_OF_SENSORS; ++i) {
+         sensors->sensors[i] = before.sensors[i] +
+            alpha * (after.sensors[i] - before.sensors[i]);
+      }
+   }
+
+   sensors->sensors[Sensors::InertialSensor_AngleX] =
+      newest.sensors[Sensors::InertialSensor_AngleX];
+   sensors->sensors[Sensors::InertialSensor_AngleY] =
+      newest.sensors[Sensors::InertialSensor_AngleY];
+   return true;
+}
+
+bool PoseService::getLagged(unsigned int lag, SensorValues *sensors) const {
+   if (lag >= HISTORY_SIZE) {
+      lag = HISTORY_SIZE - 1;
+   }
+   for (int i = lag; i >= 0; --i) {
+      if (history.getLagged(i, sensors)) {
+         return true;
+      }
+   }
+   return false;
+}
+
+Pose PoseService::getPose(const SensorValues &sensors,
+                          const Parameters<float> &parameters) {
+   kinematics.setSensorValues(sensors);
+   kinematics.parameters = parameters;
+   kinematics.updateDHChain();
+   return kinematics.getPose();
+}
@@ -0,0 +1,96 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "perception/kinematics/Kinematics.hpp"
+#include "perception/kinematics/Parameters.hpp"
+#include "perception/kinematics/Pose.hpp"
+#include "types/SensorValues.hpp"
+#include "utils/SampleRing.hpp"
+
+/**
+ * Computes the camera Pose for a given image on the Perception thread.
+ *
+ * The Motion thread only pushes the timestamped sensor values it reads each
+ * tick, which is a lock-free copy into a ring. Perception then asks for the
+ * pose at the time the image was captured, and the joint angles are
+ * interpolated between the motion ticks either side of it. This keeps the
+ * camera transforms and body exclusion arrays off the motion thread, and
+ * replaces the fixed sensor lag with synchronisation on the actual
+ * timestamps.
+ */
+class PoseService {
+   public:
+      PoseService();
+
+      /**
+       * Records the sensor values read at a time. Motion thread only.
+       * @param timestamp microseconds, on the same clock as vision.timestamp
+       */
+      void push(int64_t timestamp, const SensorValues &sensors);
+
+      /**
+       * Sensor values at a time, with joint angles and sensors linearly
+       * interpolated between the samples either side of it. Times outside of
+       * the history are clamped to the oldest or newest sample.
+       *
+       * The lean angles always come from the newest sample since the IMU
+       * filter already lags behind the joints by about as much as an image.
+       *
+       * @return false if nothing has been pushed yet
+       */
+      bool getSensors(int64_t timestamp, SensorValues *sensors) const;
+
+      /**
+       * Sensor values pushed lag motion ticks before the newest ones, or the
+       * oldest still stored if there are not that many yet.
+       * @return false if nothing has been pushed yet
+       */
+      bool getLagged(unsigned int lag, SensorValues *sensors) const;
+
+      /**
+       * Evaluates the kinematics chain for the given sensor values.
+       * Only one thread may call this since it reuses a single Kinematics.
+       */
+      Pose getPose(const SensorValues &sensors,
+                   const Parameters<float> &parameters);
+
+   private:
+      // 320ms of motion ticks, much more than the camera latency
+      static const unsigned int HISTORY_SIZE = 32;
+
+      SampleRing<SensorValues, HISTORY_SIZE> history;
+
+      Kinematics kinematics;
+};
@@ -1,7 +1,8 @@
 #include "SonarFilter.hpp"
 
 #include "utils/Logger.hpp"
-#include <limits>
+#include <algorithm>
+#include <cstdlib>
 
 SonarFilter::SonarFilter(){
 
@@ -13,61 +14,121 @@ SonarFilter::SonarFilter(){
    sonarFiltered.push_back(middle);
    sonarFiltered.push_back(right);
 
+   for (unsigned int d = 0; d < Sonar::SIZE; d++){
+      windowSize[d] = 0;
+      seen[d] = 0;
+   }
+
 }
 
 
 /* Update the filtered observations */
-void SonarFilter::update(  std::vector< std::vector<int> > sonarWindow){
-   llog(DEBUG1) << "Processing sonar right\n";
-   sonarFiltered[Sonar::LEFT] = cluster(sonarWindow[Sonar::LEFT], MERGE_CUTOFF, CONFIDENCE_CUTOFF);
-   llog(DEBUG1) << "Processing sonar middle\n";
-   sonarFiltered[Sonar::MIDDLE] = cluster(sonarWindow[Sonar::MIDDLE], MERGE_CUTOFF, CONFIDENCE_CUTOFF);
-   llog(DEBUG1) << "Processing sonar left\n";   
-   sonarFiltered[Sonar::RIGHT] = cluster(sonarWindow[Sonar::RIGHT], MERGE_CUTOFF, CONFIDENCE_CUTOFF); 
+bool SonarFilter::update(const SonarWindow *sonarWindow){
+   bool changed = false;
+   for (unsigned int d = 0; d < Sonar::SIZE; d++){
+      const SampleRing<SonarPing, 2 * WINDOW_SIZE> &pings = sonarWindow->pings[d];
+      uint32_t pushed = pings.size();
+      if (pushed == seen[d]) continue;
+
+      // pings that were overwritten before we got to them are skipped
+      SonarPing ping;
+      for (uint32_t n = seen[d]; n != pushed; n++){
+         if (pings.get(n, &ping)) add(d, ping);
+      }
+      seen[d] = pushed;
+
+      llog(DEBUG1) << "Processing sonar " << d << "\n";
+      sonarFiltered[d] = clusters[d].obstacles(CONFIDENCE_CUTOFF);
+      changed = true;
+   }
+   return changed;
+}
 
+
+void SonarFilter::add(int direction, const SonarPing &ping){
+   SonarPing *pings = window[direction];
+   if (windowSize[direction] == WINDOW_SIZE){
+      for (int i = 0; i < pings[0].count; i++){
+         clusters[direction].remove(pings[0].readings[i]);
+      }
+      std::copy(pings + 1, pings + WINDOW_SIZE, pings);
+      windowSize[direction]--;
+   }
+   for (int i = 0; i < ping.count; i++){
+      clusters[direction].insert(ping.readings[i]);
+   }
+   pings[windowSize[direction]++] = ping;
 }
 
 
-std::vector<int> SonarFilter::cluster(std::vector<int> &sonar, int merge_cutoff, int confidence_cutoff){
+void SonarClusters::insert(int reading){
+   std::vector<int>::iterator it = std::upper_bound(sorted.begin(), sorted.end(), reading);
+   unsigned int changed = it - sorted.begin();
+   sorted.insert(it, reading);
+   update(changed, 1);
+}
 
-   std::sort(sonar.begin(), sonar.end());
-   std::vector<int> result;
-   
-   if (sonar.size()==0) return result;
-
-   int sum = sonar[0];
-   int count = 1;
-   int mean = sonar[0];
-
-   llog(DEBUG1) << "1st Mean: " << mean << ", ";
-
-   int i=1;
-   while (i< (int) sonar.size()){
-         
-      if ( std::abs(sonar[i] - mean) < merge_cutoff){ // merge into cluster
-         llog(DEBUG1) << "merging with: " << sonar[i];         
-         count++; 
-         sum += sonar[i];
-         mean = sum/count;
-         llog(DEBUG1) << ", new mean: " << mean << "\n";
-      } else { // save and start a new cluster
-         llog(DEBUG1) << "separate from: " << sonar[i];   
-         if (count >= confidence_cutoff || mean < 0.35f){
-            result.push_back(mean);
-            llog(DEBUG1) << ", saving mean: " << mean;
+
+void SonarClusters::remove(int reading){
+   std::vector<int>::iterator it = std::lower_bound(sorted.begin(), sorted.end(), reading);
+   if (it == sorted.end() || *it != reading) return;
+   unsigned int changed = it - sorted.begin();
+   sorted.erase(it);
+   update(changed, -1);
+}
+
+
+/*
+ * Clusters are grown from the nearest reading outwards, merging each reading
+ * into the current cluster while it is within merge_cutoff of its mean. So
+ * the clusters ending before the one holding the reading before the change
+ * are unaffected, and once a new cluster starts on the same reading an old
+ * one did after the change, the rest are the old ones shifted along.
+ */
+void SonarClusters::update(unsigned int changed, int shift){
+   unsigned int k = 0;
+   while (k + 1 < clusters.size() && clusters[k + 1].start < changed) k++;
+   unsigned int from = k < clusters.size() ? clusters[k].start : 0;
+   std::vector<Cluster> old(clusters.begin() + k, clusters.end());
+   clusters.resize(k);
+   if (sorted.empty()) return;
+
+   Cluster cluster = {from, 1, sorted[from]};
+   unsigned int o = 1;
+   for (unsigned int i = from + 1; i < sorted.size(); i++){
+      if ( std::abs(sorted[i] - cluster.sum/cluster.count) < MERGE_CUTOFF){ // merge into cluster
+         cluster.count++;
+         cluster.sum += sorted[i];
+         continue;
+      }
+      clusters.push_back(cluster);
+
+      // readings from here on are the old ones at i - shift
+      if (i > changed || (shift < 0 && i == changed)){
+         unsigned int oldStart = i - shift;
+         while (o < old.size() && old[o].start < oldStart) o++;
+         if (o < old.size() && old[o].start == oldStart){
+            for (; o < old.size(); o++){
+               old[o].start += shift;
+               clusters.push_back(old[o]);
+            }
+            return;
          }
-         sum = sonar[i];
-         count = 1;
-         mean = sonar[i];
-         llog(DEBUG1) << ", new mean: " << mean << "\n";
       }
-      i++;
+      Cluster next = {i, 1, sorted[i]};
+      cluster = next;
    }
-   if (count >= confidence_cutoff || mean < 0.35f){
-      result.push_back(mean);
-      llog(DEBUG1) << "Saving mean: " << mean << "\n";   
-   }   
-   return result;
+   clusters.push_back(cluster);
 }
 
 
+std::vector<int> SonarClusters::obstacles(int confidence_cutoff) const {
+   std::vector<int> result;
+   for (unsigned int i = 0; i < clusters.size(); i++){
+      int mean = clusters[i].sum/clusters[i].count;
+      if (clusters[i].count >= confidence_cutoff || mean < 0.35f){
+         result.push_back(mean);
+      }
+   }
+   return result;
+}
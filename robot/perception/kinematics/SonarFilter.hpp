@@ -2,7 +2,6 @@
 
 #include <vector>
 #include <utility>
-#include <list>
 #include "utils/body.hpp"
 #include "motion/SonarRecorder.hpp"
 
@@ -11,14 +10,45 @@
 #define CONFIDENCE_CUTOFF 3 // number of observations that must contain the obstacle
                             // (compare to WINDOW_SIZE in SonarRecorder)
 
+/**
+ * The readings in one direction's window, kept sorted along with the
+ * clusters found in them. Adding or removing a reading only reclusters from
+ * the cluster before it until the clusters line up with the old ones again.
+ */
+class SonarClusters {
+   public:
+      void insert(int reading);
+      void remove(int reading);
+
+      /* Means of the clusters with enough readings, nearest first */
+      std::vector<int> obstacles(int confidence_cutoff) const;
+
+   private:
+      /* A run of consecutive sorted readings */
+      struct Cluster {
+         unsigned int start;
+         int count;
+         int sum;
+      };
+
+      std::vector<int> sorted;
+      std::vector<Cluster> clusters;
+
+      /* Reclusters after the reading at index changed was inserted (shift 1) or removed (shift -1) */
+      void update(unsigned int changed, int shift);
+};
+
 /* Simple non-recursive clustering based filter for noisy sonar observations */
 class SonarFilter {
    public:
 
       SonarFilter();
 
-      /* Update the filtered observations */
-      void update(   std::vector< std::vector <int> > sonarWindow );
+      /**
+       * Update the filtered observations with any new pings
+       * @return whether sonarFiltered changed
+       */
+      bool update(const SonarWindow *sonarWindow);
 
       // Observations of multiple obstacles, each pair constains distance in m, confidence (0-1)
       std::vector< std::vector <int> > sonarFiltered; 
@@ -26,8 +56,15 @@ class SonarFilter {
 
    private:
 
-      /* Cluster to a particular cutoff */
-      std::vector<int> cluster(std::vector<int> &sonar, int merge_cutoff, int confidence_cutoff);
+      // the pings currently in each direction's window, oldest first
+      SonarPing window[Sonar::SIZE][WINDOW_SIZE];
+      int windowSize[Sonar::SIZE];
+      // number of pings of each direction added so far
+      uint32_t seen[Sonar::SIZE];
+
+      SonarClusters clusters[Sonar::SIZE];
 
+      /* Add a ping to a direction's window, dropping its oldest if full */
+      void add(int direction, const SonarPing &ping);
 
 };
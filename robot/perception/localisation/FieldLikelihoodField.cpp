@@ -0,0 +1,113 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "FieldLikelihoodField.hpp"
+#include "LocalisationDefs.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+// Cell size of the grid in mm.
+const float FieldLikelihoodField::RESOLUTION = 50.0f;
+const float FieldLikelihoodField::INV_RESOLUTION = 1.0f / FieldLikelihoodField::RESOLUTION;
+
+// Standard deviation of a line point observation from the true line (mm).
+static const float LINE_POINT_SIGMA = 150.0f;
+
+// Observations further than this from any line are treated as outliers, which caps how much
+// a single bad line point can penalise a hypothesis.
+static const float MAX_LINE_DISTANCE = 500.0f;
+
+struct LineSegment {
+   float x1, y1, x2, y2;
+   LineSegment(float x1, float y1, float x2, float y2) : x1(x1), y1(y1), x2(x2), y2(y2) {}
+};
+
+static float distanceToSegment(const LineSegment &s, float px, float py) {
+   float dx = s.x2 - s.x1;
+   float dy = s.y2 - s.y1;
+   float t = ((px - s.x1) * dx + (py - s.y1) * dy) / (dx * dx + dy * dy);
+   t = std::max(0.0f, std::min(1.0f, t));
+   float cx = s.x1 + t * dx - px;
+   float cy = s.y1 + t * dy - py;
+   return sqrtf(cx * cx + cy * cy);
+}
+
+static std::vector<LineSegment> getFieldLineSegments(void) {
+   const float hl = FIELD_LENGTH / 2.0f;
+   const float hw = FIELD_WIDTH / 2.0f;
+   const float boxX = hl - GOAL_BOX_LENGTH;
+   const float boxY = GOAL_BOX_WIDTH / 2.0f;
+
+   std::vector<LineSegment> segments;
+   // Side lines, goal lines and the half way line.
+   segments.push_back(LineSegment(-hl, hw, hl, hw));
+   segments.push_back(LineSegment(-hl, -hw, hl, -hw));
+   segments.push_back(LineSegment(-hl, -hw, -hl, hw));
+   segments.push_back(LineSegment(hl, -hw, hl, hw));
+   segments.push_back(LineSegment(0.0f, -hw, 0.0f, hw));
+
+   // Goal boxes, front line and both sides at each end.
+   for (int side = -1; side <= 1; side += 2) {
+      segments.push_back(LineSegment(side * boxX, -boxY, side * boxX, boxY));
+      segments.push_back(LineSegment(side * boxX, boxY, side * hl, boxY));
+      segments.push_back(LineSegment(side * boxX, -boxY, side * hl, -boxY));
+   }
+   return segments;
+}
+
+FieldLikelihoodField::FieldLikelihoodField() {
+   originX = FULL_FIELD_LENGTH / 2.0f;
+   originY = FULL_FIELD_WIDTH / 2.0f;
+   cols = (int)ceilf(FULL_FIELD_LENGTH * INV_RESOLUTION);
+   rows = (int)ceilf(FULL_FIELD_WIDTH * INV_RESOLUTION);
+
+   const float invTwoSigmaSq = 1.0f / (2.0f * LINE_POINT_SIGMA * LINE_POINT_SIGMA);
+   minLogLikelihood = -MAX_LINE_DISTANCE * MAX_LINE_DISTANCE * invTwoSigmaSq;
+
+   const std::vector<LineSegment> segments = getFieldLineSegments();
+   const float circleRadius = CENTER_CIRCLE_DIAMETER / 2.0f;
+
+   cells.resize(rows * cols);
+   for (int row = 0; row < rows; row++) {
+      float y = (row + 0.5f) * RESOLUTION - originY;
+      for (int col = 0; col < cols; col++) {
+         float x = (col + 0.5f) * RESOLUTION - originX;
+
+         float dist = fabsf(sqrtf(x * x + y * y) - circleRadius);
+         for (unsigned i = 0; i < segments.size(); i++) {
+            dist = std::min(dist, distanceToSegment(segments[i], x, y));
+         }
+         dist = std::min(dist, MAX_LINE_DISTANCE);
+         cells[row * cols + col] = -dist * dist * invTwoSigmaSq;
+      }
+   }
+}
@@ -0,0 +1,73 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <vector>
+
+/**
+ * A grid over the whole field (including the border) where each cell holds the log-likelihood
+ * of observing a field line point at that location. This is computed once from the known field
+ * line geometry so that evaluating an observed line point against a pose hypothesis is a single
+ * table lookup rather than a nearest-line search.
+ */
+class FieldLikelihoodField {
+public:
+   FieldLikelihoodField();
+
+   /**
+    * Returns the log-likelihood of a field line point being observed at the given world
+    * coordinates (mm). Points off the grid get the minimum log-likelihood.
+    */
+   inline float lookup(float x, float y) const {
+      int col = (int)((x + originX) * INV_RESOLUTION);
+      int row = (int)((y + originY) * INV_RESOLUTION);
+      if (col < 0 || col >= cols || row < 0 || row >= rows) {
+         return minLogLikelihood;
+      }
+      return cells[row * cols + col];
+   }
+
+   float getMinLogLikelihood(void) const {
+      return minLogLikelihood;
+   }
+
+private:
+   static const float RESOLUTION;
+   static const float INV_RESOLUTION;
+
+   int cols, rows;
+   float originX, originY;
+   float minLogLikelihood;
+
+   // Row-major, rows along the field width.
+   std::vector<float> cells;
+};
@@ -1261,9 +1261,15 @@ void addToPointCloud(Point p1, Point p2, float dist, float weight, TargetType ty
    llog(DEBUG1) << "\tDistance: " << DISTANCE(p1.x(), p1.y(), p2.x(), p2.y()) << ", ";
    llog(DEBUG1) << "\tWeight: " << weight << ", ";
    llog(DEBUG1) << "\tTargetType: ";
-   if (type == POINT ) llog(DEBUG1) << "POINT\n";
-   if (type == VERT_LINE ) llog(DEBUG1) << "VERT_LINE\n";
-   if (type == HOR_LINE ) llog(DEBUG1) << "HOR_LINE\n";
+   if (type == POINT) {
+      llog(DEBUG1) << "POINT\n";
+   }
+   if (type == VERT_LINE) {
+      llog(DEBUG1) << "VERT_LINE\n";
+   }
+   if (type == HOR_LINE) {
+      llog(DEBUG1) << "HOR_LINE\n";
+   }
 
    source.push_back(p1);
    target.push_back(p2);
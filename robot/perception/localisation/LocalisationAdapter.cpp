@@ -56,7 +56,9 @@ LocalisationAdapter::LocalisationAdapter(Blackboard *bb) : Adapter(bb) {
    prevGameState = 0;
    isInPenaltyShootout = false;
 
-   L = new Localiser(playerNumber);
+   L = new Localiser(playerNumber,
+         Localiser::backendFromString(bb->config["localisation.backend"].as<string>()),
+         bb->config["localisation.particles"].as<int>());
    robotFilter = new RobotFilter();
    
    if (LOCALISATION_DEBUG) {
@@ -337,12 +339,28 @@ void LocalisationAdapter::handleMySharedDistribution(void) {
 
 void LocalisationAdapter::handleIncomingSharedUpdate(void) {
    std::vector<bool> incomingSharedUpdates = readFrom(localisation, havePendingIncomingSharedBundle);
+   const int64_t now = readFrom(vision, timestamp);
+   
+   incomingBroadcasts.clear();
+   incomingAges.clear();
    for (unsigned i = 0; i < incomingSharedUpdates.size(); i++) {
       if (incomingSharedUpdates[i]) {
-         BroadcastData incomingData = readFrom(receiver, data)[i];
-         L->applyRemoteUpdate(incomingData, incomingData.playerNum);
+         incomingBroadcasts.push_back(readFrom(receiver, data)[i]);
+         
+         // Messages received after this frame was captured, or without a receive time (such as
+         // when replaying a dump), are treated as current.
+         int64_t received = readFrom(receiver, lastReceivedTimestamp)[i];
+         double age = 0.0;
+         if (received > 0 && received < now) {
+            age = (now - received) / 1000000.0;
+         }
+         incomingAges.push_back(age);
       }
    }
+   
+   if (!incomingBroadcasts.empty()) {
+      L->applyRemoteUpdates(incomingBroadcasts, incomingAges);
+   }
 }
 
 /**
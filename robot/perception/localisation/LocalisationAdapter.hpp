@@ -33,10 +33,12 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string>
 #include <fstream>
+#include <vector>
 
 #include "blackboard/Adapter.hpp"
 #include "types/Odometry.hpp"
 #include "types/ActionCommand.hpp"
+#include "types/BroadcastData.hpp"
 #include "VisionUpdateBundle.hpp"
 #include "robotfilter/RobotFilter.hpp"
 
@@ -82,6 +84,10 @@ class LocalisationAdapter : Adapter {
       void handleMySharedDistribution(void);
       void handleIncomingSharedUpdate(void);
       
+      // Teammate broadcasts received since the last tick, and how old each one is in seconds.
+      std::vector<BroadcastData> incomingBroadcasts;
+      std::vector<double> incomingAges;
+      
       // The below methods/variables are used for calibration purposes.
       std::vector<double> distanceObservations;
       std::vector<double> headingObservations;
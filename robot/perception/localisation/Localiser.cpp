@@ -38,29 +38,63 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "utils/speech.hpp"
 
 static const int MAX_GAUSSIANS = 8;
+static const unsigned DEFAULT_PARTICLES = 200;
 
-Localiser::Localiser(int playerNumber) {
+Localiser::Localiser(int playerNumber, Backend backend, unsigned numParticles) :
+      backend(backend) {
    this->myPlayerNumber = playerNumber;
    ballLostCount = 0;
-   worldDistribution = new MultiGaussianDistribution(MAX_GAUSSIANS, playerNumber);
-   sharedDistribution = new SharedDistribution();
+   worldDistribution = NULL;
+   sharedDistribution = NULL;
+   particleFilter = NULL;
+
+   if (backend == PARTICLE_FILTER) {
+      particleFilter = new ParticleFilter(
+            numParticles > 0 ? numParticles : DEFAULT_PARTICLES, playerNumber);
+   } else {
+      worldDistribution = new MultiGaussianDistribution(MAX_GAUSSIANS, playerNumber);
+      sharedDistribution = new SharedDistribution();
+   }
 }
 
 Localiser::~Localiser() {
    delete worldDistribution;
    delete sharedDistribution;
+   delete particleFilter;
+}
+
+Localiser::Backend Localiser::backendFromString(const std::string &name) {
+   if (name == "Particle") {
+      return PARTICLE_FILTER;
+   } else if (name != "MultiGaussian") {
+      llog(ERROR) << "Unknown localisation backend " << name
+                  << ", using MultiGaussian" << std::endl;
+   }
+   return MULTI_GAUSSIAN;
 }
 
 void Localiser::setReset(void) {
+   if (backend == PARTICLE_FILTER) {
+      particleFilter->resetDistributionToPenalisedPose();
+      return;
+   }
    worldDistribution->resetDistributionToPenalisedPose();
    resetSharedUpdateData();
 }
 
 void Localiser::resetToPenaltyShootout(void) {
+   if (backend == PARTICLE_FILTER) {
+      particleFilter->resetToPenaltyShootout();
+      return;
+   }
    worldDistribution->resetToPenaltyShootout();
 }
 
 void Localiser::setLineUpMode(bool enabled) {
+   if (backend == PARTICLE_FILTER) {
+      particleFilter->setLineUpMode(enabled);
+      return;
+   }
    worldDistribution->setLineUpMode(enabled);
 }
 
@@ -68,26 +102,42 @@ void Localiser::setReadyMode(bool enabled) {
    LocalisationConstantsProvider& constantsProvider(LocalisationConstantsProvider::instance());
    constantsProvider.setReadyMode(enabled);
    
+   if (backend == PARTICLE_FILTER) {
+      return;
+   }
    worldDistribution->setReadyMode(enabled);
    sharedDistribution->setReadyMode(enabled);
 }
 
 void Localiser::startOfPlayReset(void) {
+   if (backend == PARTICLE_FILTER) {
+      particleFilter->startOfPlayReset();
+      return;
+   }
    worldDistribution->startOfPlayReset();
    resetSharedUpdateData();
 }
 
 AbsCoord Localiser::getRobotPose(void) {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getRobotPose();
+   }
    assert(worldDistribution != NULL);
    return worldDistribution->getTopGaussian()->getRobotPose();
 }
 
 AbsCoord Localiser::getBallPosition(void) {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getBallPosition();
+   }
    assert(worldDistribution != NULL);
    return worldDistribution->getTopGaussian()->getBallPosition();
 }
 
 AbsCoord Localiser::getBallVelocity(void) {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getBallVelocity();
+   }
    assert(worldDistribution != NULL);
    return worldDistribution->getTopGaussian()->getBallVelocity();
 }
@@ -97,26 +147,44 @@ unsigned Localiser::getBallLostCount(void) {
 }
 
 double Localiser::getRobotPosUncertainty(void) const {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getRobotPosUncertainty();
+   }
    return worldDistribution->getTopGaussian()->getRobotPosUncertainty();
 }
 
 double Localiser::getRobotHeadingUncertainty(void) const {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getRobotHeadingUncertainty();
+   }
    return worldDistribution->getTopGaussian()->getRobotHeadingUncertainty();
 }
 
 double Localiser::getBallPosUncertainty(void) const {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getBallPosUncertainty();
+   }
    return worldDistribution->getTopGaussian()->getBallPosUncertainty();
 }
 
 double Localiser::getBallVelocityUncertainty(void) const {
+   if (backend == PARTICLE_FILTER) {
+      return particleFilter->getBallVelocityUncertainty();
+   }
    return worldDistribution->getTopGaussian()->getBallVelocityUncertainty();
 }
 
 SharedLocalisationUpdateBundle Localiser::getSharedUpdateData(void) const {
+   if (backend == PARTICLE_FILTER) {
+      return SharedLocalisationUpdateBundle();
+   }
    return sharedDistribution->getBroadcastData();
 }
 
 void Localiser::resetSharedUpdateData(void) {
+   if (backend == PARTICLE_FILTER) {
+      return;
+   }
    const SimpleGaussian *topGaussian = worldDistribution->getTopGaussian();
    sharedDistribution->reset(topGaussian);
 }
@@ -128,6 +196,24 @@ void Localiser::localise(const LocaliserBundle &lb, const bool canDoObservations
    
    bool canSeeBall = lb.visionUpdateBundle.visibleBalls.size() > 0;
    
+   if (backend == PARTICLE_FILTER) {
+      particleFilter->processUpdate(lb.odometry, lb.dTimeSeconds, canSeeBall);
+      if (canDoObservations) {
+         particleFilter->visionUpdate(lb.visionUpdateBundle);
+      }
+   } else {
+      localiseMultiGaussian(lb, canDoObservations, canSeeBall);
+   }
+
+   if (lb.visionUpdateBundle.visibleBalls.size() > 0 && canDoObservations) {
+      ballLostCount = 0;
+   } else {
+      ballLostCount++;
+   }
+}
+
+void Localiser::localiseMultiGaussian(const LocaliserBundle &lb, const bool canDoObservations,
+      const bool canSeeBall) {
    worldDistribution->processUpdate(lb.odometry, lb.dTimeSeconds, canSeeBall);
    if (canDoObservations) {
       worldDistribution->visionUpdate(lb.visionUpdateBundle);
@@ -139,34 +225,44 @@ void Localiser::localise(const LocaliserBundle &lb, const bool canDoObservations
             worldDistribution->getTopGaussian()->getLastAppliedICPUpdate(),
             worldDistribution->getTopGaussian()->getLastAppliedVisionUpdate());
    }
-
-   if (lb.visionUpdateBundle.visibleBalls.size() > 0 && canDoObservations) {
-      ballLostCount = 0;
-   } else {
-      ballLostCount++;
-   }
 }
 
-void Localiser::applyRemoteUpdate(const BroadcastData &broadcastData, int playerNumber) {
-   if (playerNumber == myPlayerNumber || !broadcastData.sharedLocalisationBundle.isUpdateValid) {
+void Localiser::applyRemoteUpdates(const std::vector<BroadcastData> &broadcasts,
+      const std::vector<double> &ageSeconds) {
+   if (backend == PARTICLE_FILTER) {
       return;
    }
-
-   MY_ASSERT_2(playerNumber >= 1 && playerNumber <= 5);
    
-   // Convert the player number to a teammate index. There are two cases to handle, if the player number
-   // greater than our own, or if it is less than our own.
-   int teammateIndex = 0;
-   if (playerNumber < myPlayerNumber) {
-      teammateIndex = playerNumber - 1;
-   } else {
-      teammateIndex = playerNumber - 2;
+   MY_ASSERT_2(broadcasts.size() == ageSeconds.size());
+   
+   remoteUpdates.clear();
+   for (unsigned i = 0; i < broadcasts.size(); i++) {
+      const int playerNumber = broadcasts[i].playerNum;
+      if (playerNumber == myPlayerNumber || !broadcasts[i].sharedLocalisationBundle.isUpdateValid) {
+         continue;
+      }
+      
+      MY_ASSERT_2(playerNumber >= 1 && playerNumber <= 5);
+      
+      // Convert the player number to a teammate index. There are two cases to handle, if the player
+      // number greater than our own, or if it is less than our own.
+      int teammateIndex = 0;
+      if (playerNumber < myPlayerNumber) {
+         teammateIndex = playerNumber - 1;
+      } else {
+         teammateIndex = playerNumber - 2;
+      }
+      
+      MY_ASSERT(teammateIndex >= 0 && teammateIndex <= 3, "Invalid teammateIndex");
+      remoteUpdates.push_back(RemoteUpdate(&broadcasts[i], teammateIndex, ageSeconds[i]));
    }
    
-   MY_ASSERT(teammateIndex >= 0 && teammateIndex <= 3, "Invalid teammateIndex");
-   worldDistribution->applyRemoteUpdate(broadcastData, teammateIndex, playerNumber == 1);
+   worldDistribution->applyRemoteUpdates(remoteUpdates);
 }
 
 double Localiser::getLastObservationLikelyhood(void) const {
+   if (backend == PARTICLE_FILTER) {
+      return 0.0;
+   }
    return worldDistribution->getLastObservationLikelyhood();
 }
@@ -30,10 +30,12 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 #pragma once
 
+#include <string>
 #include <vector>
 #include <memory>
 
 #include "MultiGaussianDistribution.hpp"
+#include "ParticleFilter.hpp"
 #include "SharedDistribution.hpp"
 #include "SharedLocalisationUpdateBundle.hpp"
 #include "VisionUpdateBundle.hpp"
@@ -80,9 +82,22 @@ struct LocaliserBundle {
 
 class Localiser {
    public:
-      Localiser(int playerNumber);
+      /**
+       * The filter used to estimate the world state. Selected with localisation.backend.
+       */
+      enum Backend {
+         MULTI_GAUSSIAN,
+         PARTICLE_FILTER
+      };
+
+      Localiser(int playerNumber, Backend backend = MULTI_GAUSSIAN, unsigned numParticles = 0);
       ~Localiser();
 
+      /**
+       * Parses a localisation.backend option value, "MultiGaussian" or "Particle".
+       */
+      static Backend backendFromString(const std::string &name);
+
       /**
        * Resets the distribution and sets the position hypothesis of the robot to be
        * at the side-line start positions.
@@ -124,16 +139,33 @@ class Localiser {
       void resetSharedUpdateData(void);
       
       void localise(const LocaliserBundle &lb, const bool canDoObservations);
-      void applyRemoteUpdate(const BroadcastData &broadcastData, int playerNumber);
+      /**
+       * Applies all of the teammate broadcasts received since the last tick in one batch.
+       * ageSeconds gives how long ago each was received, and is used to predict teammates' ball
+       * estimates forward to now.
+       */
+      void applyRemoteUpdates(const std::vector<BroadcastData> &broadcasts,
+            const std::vector<double> &ageSeconds);
       
       double getLastObservationLikelyhood(void) const;
 
    private:
       int myPlayerNumber;
       unsigned ballLostCount;
+      const Backend backend;
       
+      // Only one of these is non-NULL depending on the backend. Team shared updates are only
+      // supported by the multi-Gaussian filter, so the particle filter runs without a
+      // sharedDistribution.
       MultiGaussianDistribution *worldDistribution;
       SharedDistribution *sharedDistribution;
+      ParticleFilter *particleFilter;
+
+      // Kept between ticks to avoid reallocating.
+      std::vector<RemoteUpdate> remoteUpdates;
+
+      void localiseMultiGaussian(const LocaliserBundle &lb, const bool canDoObservations,
+            const bool canSeeBall);
 };
 
 inline std::ostream& operator<<(std::ostream& os, const LocaliserBundle& bundle) {
@@ -313,27 +313,39 @@ void MultiGaussianDistribution::visionUpdate(const VisionUpdateBundle &visionBun
    MY_ASSERT(checkValidDistribution(modes), "invalid distribution @ visionUpdate end");
 }
 
-void MultiGaussianDistribution::applyRemoteUpdate(
-      const BroadcastData &broadcastData, int teammateIndex, bool isFromGoalie) {
+void MultiGaussianDistribution::applyRemoteUpdates(const std::vector<RemoteUpdate> &updates) {
    MY_ASSERT(checkValidDistribution(modes), "invalid distribution @ remoteUpdate start");
    
-   if (broadcastData.sharedLocalisationBundle.haveBallUpdates) {
+   if (updates.empty()) {
+      return;
+   }
+   
+   bool haveBallUpdates = false;
+   for (unsigned i = 0; i < updates.size(); i++) {
+      haveBallUpdates |= updates[i].broadcastData->sharedLocalisationBundle.haveBallUpdates;
+   }
+   if (haveBallUpdates) {
       addSymmetricMode(modes);
    }
 
-   std::vector<SimpleGaussian*> allNewModes;
+   // The team ball is the same observation for every mode, so fuse it once up front.
+   const TeamBallFusion *teamBall = teamBallFusion.fuse(updates) ? &teamBallFusion : NULL;
+   
+   // New modes are appended in place, only the modes that existed beforehand get the update.
    bool amIGoalie = (playerNumber == 1);
-   for(unsigned i = 0; i < modes.size(); i++) {
-      std::vector<SimpleGaussian*> newModes = modes[i]->applyRemoteUpdate(
-            broadcastData.sharedLocalisationBundle, teammateIndex, amIGoalie);
-      
-      allNewModes.insert(allNewModes.end(), newModes.begin(), newModes.end());
+   const unsigned numModes = modes.size();
+   for (unsigned i = 0; i < numModes; i++) {
+      SimpleGaussian *newMode = modes[i]->applyRemoteUpdates(updates, teamBall, amIGoalie);
+      if (newMode != NULL) {
+         modes.push_back(newMode);
+      }
    }
-   modes.insert(modes.end(), allNewModes.begin(), allNewModes.end());
-   
    
    if (!amIGoalie) { // We dont want teammates to try flipping the goalie.
-      teamBallTracker.addTeammateObservation(broadcastData);
+      for (unsigned i = 0; i < updates.size(); i++) {
+         teamBallTracker.addTeammateObservation(*updates[i].broadcastData);
+      }
+      
       for (unsigned i = 0; i < modes.size(); i++) {
          if (teamBallTracker.isModeFlipped(*modes[i])) {
             if (i == 0) {
@@ -33,6 +33,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "SimpleGaussian.hpp"
 #include "VisionUpdateBundle.hpp"
 #include "TeamBallTracker.hpp"
+#include "TeamBallFusion.hpp"
 #include "types/Odometry.hpp"
 #include "types/BroadcastData.hpp"
 
@@ -100,9 +101,11 @@ public:
    void visionUpdate(const VisionUpdateBundle &visionBundle);
    
    /**
-    * Update out state estimate by incorporating the state estimate from our teammate.
+    * Update out state estimate by incorporating the state estimates from our teammates. All of
+    * the updates received since the last tick should be passed in together, so the distribution
+    * is only split and fixed up once.
     */
-   void applyRemoteUpdate(const BroadcastData &broadcastData, int teammateIndex, bool isFromGoalie);
+   void applyRemoteUpdates(const std::vector<RemoteUpdate> &updates);
 
    /**
     * Returns the top mode of the distribution. This is the mode that we think most accurately
@@ -131,6 +134,7 @@ private:
    bool haveSeenLandmarks;
    unsigned numVisionUpdatesInReady;
    TeamBallTracker teamBallTracker;
+   TeamBallFusion teamBallFusion;
    
    void doTeammateRobotVisionUpdate(const VisionUpdateBundle &visionBundle);
    bool isInInitialState(void);
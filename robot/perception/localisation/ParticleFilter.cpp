@@ -0,0 +1,506 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "ParticleFilter.hpp"
+#include "LocalisationConstantsProvider.hpp"
+#include "LocalisationDefs.hpp"
+#include "LocalisationUtils.hpp"
+#include "VarianceProvider.hpp"
+#include "utils/angles.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+static const LocalisationConstantsProvider& constantsProvider(
+      LocalisationConstantsProvider::instance());
+
+// Line features are sampled into points at this spacing (mm) before being scored.
+static const float LINE_SAMPLE_SPACING = 250.0f;
+static const unsigned MAX_SAMPLES_PER_LINE = 8;
+
+// Line points from the same frame are far from independent, so the summed log-likelihood is
+// scaled as if at most this many points had been observed.
+static const float MAX_EFFECTIVE_LINE_POINTS = 8.0f;
+
+// Resample once the effective number of particles falls below this fraction of the total.
+static const float RESAMPLE_THRESHOLD = 0.5f;
+
+ParticleFilter::ParticleFilter(unsigned numParticles, int playerNumber) :
+      numParticles(numParticles), playerNumber(playerNumber),
+      x(numParticles), y(numParticles), theta(numParticles), weight(numParticles),
+      nextX(numParticles), nextY(numParticles), nextTheta(numParticles),
+      logLikelihood(numParticles) {
+   MY_ASSERT(numParticles > 0, "invalid number of particles");
+   rngState = 0x9E3779B9u ^ (uint32_t)playerNumber;
+   doingBallLineUp = false;
+   meanX = meanY = meanTheta = 0.0f;
+
+   for (int axis = 0; axis < 2; axis++) {
+      ball[axis].pos = 0.0f;
+      ball[axis].vel = 0.0f;
+      ball[axis].varPos = get95CF(10.0f * FULL_FIELD_LENGTH);
+      ball[axis].covPosVel = 0.0f;
+      ball[axis].varVel = get95CF(10000.0f);
+   }
+
+   resetDistributionToPenalisedPose();
+}
+
+void ParticleFilter::resetDistributionToPenalisedPose(void) {
+   std::vector<AbsCoord> poses;
+   poses.push_back(AbsCoord(-FIELD_LENGTH / 3.0f, FIELD_WIDTH / 2.0f, -M_PI / 2.0f));
+   poses.push_back(AbsCoord(-FIELD_LENGTH / 3.0f, -FIELD_WIDTH / 2.0f, M_PI / 2.0f));
+   poses.push_back(AbsCoord(-FIELD_LENGTH / 6.0f, FIELD_WIDTH / 2.0f, -M_PI / 2.0f));
+   poses.push_back(AbsCoord(-FIELD_LENGTH / 6.0f, -FIELD_WIDTH / 2.0f, M_PI / 2.0f));
+   resetAround(poses, FULL_FIELD_WIDTH / 16.0f, M_PI / 8.0f);
+}
+
+void ParticleFilter::resetToPenaltyShootout(void) {
+   // The ball is still at the start of a shootout, whatever it was doing before.
+   for (int axis = 0; axis < 2; axis++) {
+      ball[axis].vel = 0.0f;
+   }
+
+   std::vector<AbsCoord> poses;
+   if (playerNumber == 1) {
+      // If youre the goalie, in goalbox facing opponent
+      poses.push_back(AbsCoord(-FIELD_LENGTH / 2.0f, 0.0f, 0.0f));
+   } else {
+      // Centre of the field, facing opposition goal, with the ball in front of you.
+      poses.push_back(AbsCoord(2200.0f, 0.0f, 0.0f));
+      ball[0].pos = 3200.0f;
+      ball[1].pos = 0.0f;
+   }
+   resetAround(poses, FULL_FIELD_WIDTH / 16.0f, M_PI / 16.0f);
+}
+
+void ParticleFilter::setLineUpMode(bool enabled) {
+   doingBallLineUp = enabled;
+}
+
+void ParticleFilter::startOfPlayReset(void) {
+   float total = 0.0f;
+   for (unsigned i = 0; i < numParticles; i++) {
+      if (x[i] > 0.0f) {
+         weight[i] = 0.0f;
+      }
+      total += weight[i];
+   }
+
+   // Every particle was in the opponent half, better to keep them than to lose track entirely.
+   if (total <= 0.0f) {
+      std::fill(weight.begin(), weight.end(), 1.0f / numParticles);
+      return;
+   }
+
+   for (unsigned i = 0; i < numParticles; i++) {
+      weight[i] /= total;
+   }
+   resampleIfDegenerate();
+   updatePoseStatistics();
+}
+
+void ParticleFilter::processUpdate(const Odometry &odometry, const double dTimeSeconds,
+      const bool canSeeBall) {
+   const float dt = dTimeSeconds;
+   const float posA = constantsProvider.get(
+         LocalisationConstantsProvider::ROBOT_POS_MOTION_UPDATE_COVARIANCE_A);
+   const float posC = constantsProvider.get(
+         LocalisationConstantsProvider::ROBOT_POS_MOTION_UPDATE_COVARIANCE_C);
+   const float headingA = constantsProvider.get(
+         LocalisationConstantsProvider::ROBOT_HEADING_MOTION_UPDATE_COVARIANCE_A);
+   const float headingC = constantsProvider.get(
+         LocalisationConstantsProvider::ROBOT_HEADING_MOTION_UPDATE_COVARIANCE_C);
+
+   // Same noise model as SimpleGaussian, applied per particle in the robot frame.
+   const float forwardSigma = sqrtf(posA * odometry.forward * odometry.forward + posC * dt);
+   const float leftSigma = sqrtf(posA * odometry.left * odometry.left + posC * dt);
+   const float turnSigma = sqrtf(headingA * odometry.turn * odometry.turn + headingC * dt);
+
+   // Draw the noise first so the pose loop below is free of the generator's dependency chain.
+   for (unsigned i = 0; i < numParticles; i++) {
+      nextX[i] = odometry.forward + forwardSigma * gaussian();
+      nextY[i] = odometry.left + leftSigma * gaussian();
+      nextTheta[i] = odometry.turn + turnSigma * gaussian();
+   }
+
+   for (unsigned i = 0; i < numParticles; i++) {
+      const float c = cosf(theta[i]);
+      const float s = sinf(theta[i]);
+      x[i] += nextX[i] * c - nextY[i] * s;
+      y[i] += nextX[i] * s + nextY[i] * c;
+      theta[i] = NORMALISE(theta[i] + nextTheta[i]);
+
+      x[i] = std::max(-(float)FIELD_X_CLIP, std::min((float)FIELD_X_CLIP, x[i]));
+      y[i] = std::max(-(float)FIELD_Y_CLIP, std::min((float)FIELD_Y_CLIP, y[i]));
+   }
+
+   processBallUpdate(dTimeSeconds, canSeeBall);
+   updatePoseStatistics();
+}
+
+void ParticleFilter::visionUpdate(const VisionUpdateBundle &visionBundle) {
+   std::fill(logLikelihood.begin(), logLikelihood.end(), 0.0f);
+
+   addLineObservations(visionBundle);
+   if (!obsX.empty()) {
+      weighLineObservations();
+   }
+   weighLandmarkObservations(visionBundle);
+
+   if (!obsX.empty() || !visionBundle.posts.empty()) {
+      applyLogLikelihood();
+      resampleIfDegenerate();
+      updatePoseStatistics();
+   }
+
+   ballObservationUpdate(visionBundle);
+}
+
+AbsCoord ParticleFilter::getRobotPose(void) const {
+   return AbsCoord(meanX, meanY, meanTheta);
+}
+
+AbsCoord ParticleFilter::getBallPosition(void) const {
+   return AbsCoord(ball[0].pos, ball[1].pos, 0.0f);
+}
+
+AbsCoord ParticleFilter::getBallVelocity(void) const {
+   return AbsCoord(ball[0].vel, ball[1].vel, 0.0f);
+}
+
+double ParticleFilter::getRobotPosUncertainty(void) const {
+   // Product of the standard deviations along the principal axes, as in SimpleGaussian.
+   return sqrt(std::max(0.0f, covXX * covYY - covXY * covXY));
+}
+
+double ParticleFilter::getRobotHeadingUncertainty(void) const {
+   return sqrt(varTheta);
+}
+
+double ParticleFilter::getBallPosUncertainty(void) const {
+   return sqrt(ball[0].varPos * ball[1].varPos);
+}
+
+double ParticleFilter::getBallVelocityUncertainty(void) const {
+   return sqrt(std::max(ball[0].varVel, ball[1].varVel));
+}
+
+unsigned ParticleFilter::getNumParticles(void) const {
+   return numParticles;
+}
+
+void ParticleFilter::resetAround(const std::vector<AbsCoord> &poses, float posSigma,
+      float headingSigma) {
+   for (unsigned i = 0; i < numParticles; i++) {
+      const AbsCoord &pose = poses[i % poses.size()];
+      x[i] = pose.x() + posSigma * gaussian();
+      y[i] = pose.y() + posSigma * gaussian();
+      theta[i] = NORMALISE(pose.theta() + headingSigma * gaussian());
+      weight[i] = 1.0f / numParticles;
+   }
+   updatePoseStatistics();
+}
+
+void ParticleFilter::addLineObservations(const VisionUpdateBundle &visionBundle) {
+   obsX.clear();
+   obsY.clear();
+
+   for (unsigned i = 0; i < visionBundle.fieldFeatures.size(); i++) {
+      const FieldFeatureInfo &feature = visionBundle.fieldFeatures[i];
+
+      if (feature.type == FieldFeatureInfo::fLine) {
+         const Point &p1 = feature.line.p1;
+         const Point &p2 = feature.line.p2;
+         float length = sqrtf(DISTANCE_SQR(p1.x(), p1.y(), p2.x(), p2.y()));
+         unsigned samples = std::min(MAX_SAMPLES_PER_LINE,
+               2 + (unsigned)(length / LINE_SAMPLE_SPACING));
+         for (unsigned s = 0; s < samples; s++) {
+            float t = (float)s / (samples - 1);
+            obsX.push_back(p1.x() + t * (p2.x() - p1.x()));
+            obsY.push_back(p1.y() + t * (p2.y() - p1.y()));
+         }
+      } else if (feature.type == FieldFeatureInfo::fCorner ||
+                 feature.type == FieldFeatureInfo::fTJunction) {
+         // Corners and T junctions lie on the field lines, so score them the same way.
+         obsX.push_back(feature.rr.distance() * cosf(feature.rr.heading()));
+         obsY.push_back(feature.rr.distance() * sinf(feature.rr.heading()));
+      }
+   }
+}
+
+void ParticleFilter::weighLineObservations(void) {
+   const unsigned numObs = obsX.size();
+   float scale = std::min(1.0f, MAX_EFFECTIVE_LINE_POINTS / numObs);
+
+   const float * const ox = &obsX[0];
+   const float * const oy = &obsY[0];
+   for (unsigned i = 0; i < numParticles; i++) {
+      const float c = cosf(theta[i]);
+      const float s = sinf(theta[i]);
+      float sum = 0.0f;
+      for (unsigned j = 0; j < numObs; j++) {
+         float wx = x[i] + c * ox[j] - s * oy[j];
+         float wy = y[i] + s * ox[j] + c * oy[j];
+         sum += likelihoodField.lookup(wx, wy);
+      }
+      logLikelihood[i] += sum * scale;
+   }
+}
+
+void ParticleFilter::weighLandmarkObservations(const VisionUpdateBundle &visionBundle) {
+   const VarianceProvider &varianceProvider = VarianceProvider::instance();
+
+   // Goal posts all look the same, so each observed post is scored against the closest
+   // matching real post for every particle.
+   AbsCoord goalposts[4] = {
+      AbsCoord(FIELD_LENGTH / 2.0f, GOAL_WIDTH / 2.0f, 0.0f),
+      AbsCoord(FIELD_LENGTH / 2.0f, -GOAL_WIDTH / 2.0f, 0.0f),
+      AbsCoord(-FIELD_LENGTH / 2.0f, GOAL_WIDTH / 2.0f, 0.0f),
+      AbsCoord(-FIELD_LENGTH / 2.0f, -GOAL_WIDTH / 2.0f, 0.0f)
+   };
+   AbsCoord centre(0.0f, 0.0f, 0.0f);
+
+   std::vector<std::pair<RRCoord, VarianceProvider::ObservationType> > landmarks;
+   for (unsigned i = 0; i < visionBundle.posts.size(); i++) {
+      landmarks.push_back(std::make_pair(visionBundle.posts[i].rr, VarianceProvider::GOALPOST));
+   }
+   for (unsigned i = 0; i < visionBundle.fieldFeatures.size(); i++) {
+      if (visionBundle.fieldFeatures[i].type == FieldFeatureInfo::fCentreCircle) {
+         landmarks.push_back(std::make_pair(visionBundle.fieldFeatures[i].rr,
+               VarianceProvider::CENTRE_CIRCLE));
+      }
+   }
+
+   for (unsigned l = 0; l < landmarks.size(); l++) {
+      const RRCoord &rr = landmarks[l].first;
+      const bool isPost = landmarks[l].second == VarianceProvider::GOALPOST;
+      VarianceProvider::Observation observation(rr.distance(), rr.heading());
+      float varDistance = varianceProvider.getDistanceObservationVariance(
+            landmarks[l].second, observation);
+      float varHeading = varianceProvider.getHeadingObservationVariance(
+            landmarks[l].second, observation);
+      if (!visionBundle.isDistanceReliable) {
+         varDistance *= constantsProvider.get(
+               LocalisationConstantsProvider::UNRELIABLE_DISTANCE_VARIANCE_SCALE);
+      }
+      if (!visionBundle.isHeadingReliable) {
+         varHeading *= constantsProvider.get(
+               LocalisationConstantsProvider::UNRELIABLE_HEADING_VARIANCE_SCALE);
+      }
+      const float invTwoVarDistance = 1.0f / (2.0f * varDistance);
+      const float invTwoVarHeading = 1.0f / (2.0f * varHeading);
+
+      const AbsCoord *candidates = isPost ? goalposts : &centre;
+      const unsigned numCandidates = isPost ? 4 : 1;
+
+      for (unsigned i = 0; i < numParticles; i++) {
+         float best = -INFINITY;
+         for (unsigned k = 0; k < numCandidates; k++) {
+            float dx = candidates[k].x() - x[i];
+            float dy = candidates[k].y() - y[i];
+            float dDistance = sqrtf(dx * dx + dy * dy) - rr.distance();
+            float dHeading = NORMALISE(atan2f(dy, dx) - theta[i] - rr.heading());
+            float ll = -dDistance * dDistance * invTwoVarDistance -
+                        dHeading * dHeading * invTwoVarHeading;
+            best = std::max(best, ll);
+         }
+         logLikelihood[i] += best;
+      }
+   }
+}
+
+void ParticleFilter::applyLogLikelihood(void) {
+   float maxLogLikelihood = *std::max_element(logLikelihood.begin(), logLikelihood.end());
+
+   float total = 0.0f;
+   for (unsigned i = 0; i < numParticles; i++) {
+      weight[i] *= expf(logLikelihood[i] - maxLogLikelihood);
+      total += weight[i];
+   }
+
+   if (!(total > 0.0f)) {
+      std::fill(weight.begin(), weight.end(), 1.0f / numParticles);
+      return;
+   }
+
+   const float invTotal = 1.0f / total;
+   for (unsigned i = 0; i < numParticles; i++) {
+      weight[i] *= invTotal;
+   }
+}
+
+void ParticleFilter::resampleIfDegenerate(void) {
+   float sumSq = 0.0f;
+   for (unsigned i = 0; i < numParticles; i++) {
+      sumSq += weight[i] * weight[i];
+   }
+   if (1.0f / sumSq >= RESAMPLE_THRESHOLD * numParticles) {
+      return;
+   }
+
+   // Low variance (systematic) resampling: a single random offset, then evenly spaced picks
+   // through the cumulative weights.
+   const float step = 1.0f / numParticles;
+   float u = uniform() * step;
+   float cumulative = weight[0];
+   unsigned j = 0;
+   for (unsigned i = 0; i < numParticles; i++) {
+      while (u > cumulative && j < numParticles - 1) {
+         j++;
+         cumulative += weight[j];
+      }
+      nextX[i] = x[j];
+      nextY[i] = y[j];
+      nextTheta[i] = theta[j];
+      u += step;
+   }
+
+   x.swap(nextX);
+   y.swap(nextY);
+   theta.swap(nextTheta);
+   std::fill(weight.begin(), weight.end(), step);
+}
+
+void ParticleFilter::updatePoseStatistics(void) {
+   float sumX = 0.0f, sumY = 0.0f, sumCos = 0.0f, sumSin = 0.0f;
+   for (unsigned i = 0; i < numParticles; i++) {
+      sumX += weight[i] * x[i];
+      sumY += weight[i] * y[i];
+      sumCos += weight[i] * cosf(theta[i]);
+      sumSin += weight[i] * sinf(theta[i]);
+   }
+   meanX = sumX;
+   meanY = sumY;
+   meanTheta = atan2f(sumSin, sumCos);
+
+   covXX = covXY = covYY = varTheta = 0.0f;
+   for (unsigned i = 0; i < numParticles; i++) {
+      float dx = x[i] - meanX;
+      float dy = y[i] - meanY;
+      float dTheta = NORMALISE(theta[i] - meanTheta);
+      covXX += weight[i] * dx * dx;
+      covXY += weight[i] * dx * dy;
+      covYY += weight[i] * dy * dy;
+      varTheta += weight[i] * dTheta * dTheta;
+   }
+}
+
+void ParticleFilter::processBallUpdate(const double dTimeSeconds, const bool canSeeBall) {
+   const float dt = dTimeSeconds;
+   const float friction = pow(constantsProvider.get(
+         LocalisationConstantsProvider::BALL_FRICTION), dTimeSeconds);
+
+   LocalisationConstantsProvider::LocalisationConstant posNoiseKey =
+         LocalisationConstantsProvider::BALL_POS_MOTION_UPDATE_COVARIANCE_C;
+   if (doingBallLineUp) {
+      posNoiseKey = LocalisationConstantsProvider::BALL_POS_MOTION_UPDATE_LINE_UP_COVARIANCE_C;
+   } else if (!canSeeBall) {
+      posNoiseKey = LocalisationConstantsProvider::BALL_UNSEEN_POS_MOTION_UPDATE_COVARIANCE_C;
+   }
+   const float posNoise = constantsProvider.get(posNoiseKey) * dt;
+   const float velNoise = constantsProvider.get(
+         LocalisationConstantsProvider::BALL_VEL_MOTION_UPDATE_COVARIANCE_C) * dt;
+
+   for (int axis = 0; axis < 2; axis++) {
+      BallAxis &b = ball[axis];
+      if (!doingBallLineUp) {
+         b.pos += b.vel * dt;
+         b.varPos += 2.0f * dt * b.covPosVel + dt * dt * b.varVel;
+         b.covPosVel += dt * b.varVel;
+      }
+      b.vel *= friction;
+      b.covPosVel *= friction;
+      b.varVel *= friction * friction;
+
+      b.varPos += posNoise;
+      b.varVel += velNoise;
+   }
+}
+
+void ParticleFilter::ballObservationUpdate(const VisionUpdateBundle &visionBundle) {
+   if (visionBundle.visibleBalls.empty()) {
+      return;
+   }
+
+   const RRCoord &rr = visionBundle.visibleBalls[0].rr;
+   if (rr.distance() > constantsProvider.get(
+         LocalisationConstantsProvider::BALL_MAX_DISTANCE_OBSERVATION)) {
+      return;
+   }
+
+   const VarianceProvider &varianceProvider = VarianceProvider::instance();
+   VarianceProvider::Observation observation(rr.distance(), rr.heading());
+   const float varDistance = varianceProvider.getDistanceObservationVariance(
+         VarianceProvider::BALL, observation);
+   const float varHeading = varianceProvider.getHeadingObservationVariance(
+         VarianceProvider::BALL, observation);
+
+   // Place the ball in world coordinates using the mean pose, and project the range/bearing
+   // variance onto each world axis.
+   const float bearing = meanTheta + rr.heading();
+   const float c = cosf(bearing);
+   const float s = sinf(bearing);
+   const float lateralVariance = rr.distance() * rr.distance() * varHeading;
+   const float measurement[2] = {meanX + rr.distance() * c, meanY + rr.distance() * s};
+   const float measurementVariance[2] = {
+      varDistance * c * c + lateralVariance * s * s + covXX,
+      varDistance * s * s + lateralVariance * c * c + covYY
+   };
+
+   for (int axis = 0; axis < 2; axis++) {
+      BallAxis &b = ball[axis];
+      const float innovation = measurement[axis] - b.pos;
+      const float innovationVariance = b.varPos + measurementVariance[axis];
+      const float gainPos = b.varPos / innovationVariance;
+      const float gainVel = b.covPosVel / innovationVariance;
+
+      b.pos += gainPos * innovation;
+      b.vel += gainVel * innovation;
+      b.varVel -= gainVel * b.covPosVel;
+      b.varPos *= 1.0f - gainPos;
+      b.covPosVel *= 1.0f - gainPos;
+   }
+}
+
+float ParticleFilter::uniform(void) {
+   // xorshift32, plenty for sampling noise and far cheaper than rand() under a lock.
+   rngState ^= rngState << 13;
+   rngState ^= rngState >> 17;
+   rngState ^= rngState << 5;
+   return (rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+float ParticleFilter::gaussian(void) {
+   // Irwin-Hall approximation to a unit normal, avoids the log/sqrt/cos of Box-Muller.
+   float sum = uniform() + uniform() + uniform() + uniform();
+   return (sum - 2.0f) * 1.7320508f;
+}
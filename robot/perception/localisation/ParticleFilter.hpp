@@ -0,0 +1,135 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include "FieldLikelihoodField.hpp"
+#include "types/AbsCoord.hpp"
+#include "types/Odometry.hpp"
+#include "VisionUpdateBundle.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * A particle filter alternative to the MultiGaussianDistribution. The robot pose is represented
+ * by a set of weighted particles stored as separate x, y, theta and weight arrays so that the
+ * per-particle loops in the motion and observation updates run over contiguous memory and can be
+ * vectorised by the compiler. Observations are scored against a precomputed FieldLikelihoodField.
+ *
+ * The ball is not part of the particle state, it is tracked by a small constant velocity Kalman
+ * filter per axis in world coordinates, using the mean particle pose to place observations.
+ */
+class ParticleFilter {
+public:
+   explicit ParticleFilter(unsigned numParticles, int playerNumber);
+
+   /**
+    * Spreads the particles over the poses we expect when coming back from a penalty, on either
+    * side line in our own half looking in. See the MultiGaussianDistribution equivalent.
+    */
+   void resetDistributionToPenalisedPose(void);
+
+   void resetToPenaltyShootout(void);
+
+   /**
+    * Ignore ball velocity in the process update while lining up to kick.
+    */
+   void setLineUpMode(bool enabled);
+
+   /**
+    * Removes particles in the opponent half at the SET to PLAYING transition.
+    */
+   void startOfPlayReset(void);
+
+   /**
+    * Moves every particle by the odometry with added noise, and moves the ball by its velocity.
+    */
+   void processUpdate(const Odometry &odometry, const double dTimeSeconds, const bool canSeeBall);
+
+   /**
+    * Reweights the particles by the likelihood of the observed field features and goal posts,
+    * resamples if the weights have degenerated, and applies any ball observation.
+    */
+   void visionUpdate(const VisionUpdateBundle &visionBundle);
+
+   AbsCoord getRobotPose(void) const;
+   AbsCoord getBallPosition(void) const;
+   AbsCoord getBallVelocity(void) const;
+
+   double getRobotPosUncertainty(void) const;
+   double getRobotHeadingUncertainty(void) const;
+   double getBallPosUncertainty(void) const;
+   double getBallVelocityUncertainty(void) const;
+
+   unsigned getNumParticles(void) const;
+
+private:
+   const unsigned numParticles;
+   const int playerNumber;
+   const FieldLikelihoodField likelihoodField;
+
+   // Particle state, one entry per particle in each array.
+   std::vector<float> x, y, theta, weight;
+
+   // Scratch space used by resampling and the observation update.
+   std::vector<float> nextX, nextY, nextTheta;
+   std::vector<float> logLikelihood;
+   std::vector<float> obsX, obsY;
+
+   // Weighted pose statistics, refreshed after every update.
+   float meanX, meanY, meanTheta;
+   float covXX, covXY, covYY, varTheta;
+
+   // Per axis constant velocity ball filter: position, velocity and their covariance.
+   struct BallAxis {
+      float pos, vel;
+      float varPos, covPosVel, varVel;
+   };
+   BallAxis ball[2];
+
+   bool doingBallLineUp;
+   uint32_t rngState;
+
+   void resetAround(const std::vector<AbsCoord> &poses, float posSigma, float headingSigma);
+   void addLineObservations(const VisionUpdateBundle &visionBundle);
+   void weighLineObservations(void);
+   void weighLandmarkObservations(const VisionUpdateBundle &visionBundle);
+   void applyLogLikelihood(void);
+   void resampleIfDegenerate(void);
+   void updatePoseStatistics(void);
+
+   void processBallUpdate(const double dTimeSeconds, const bool canSeeBall);
+   void ballObservationUpdate(const VisionUpdateBundle &visionBundle);
+
+   float uniform(void);
+   float gaussian(void);
+};
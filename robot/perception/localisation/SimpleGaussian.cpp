@@ -194,6 +194,7 @@ void SimpleGaussian::resetMean(const Eigen::MatrixXd &src) {
 
 void SimpleGaussian::resetCovariance(const Eigen::MatrixXd &src) {
    MY_ASSERT(src.rows() >= DIM && src.cols() >= DIM, "resetCovariance() called with incompatible src");
+   pendingProcessUpdate.clear();
    for (unsigned i = 0; i < DIM; i++) {
       for (unsigned j = 0; j < DIM; j++) {
          covariance(i, j) = src(i, j);
@@ -541,25 +542,37 @@ SimpleGaussian* SimpleGaussian::createSymmetricGaussian(void) {
    reflectedMean(BALL_DX_DIM, 0) *= -1.0;
    reflectedMean(BALL_DY_DIM, 0) *= -1.0;
    
+   materialiseCovariance();
    return new SimpleGaussian(DIM, symmetryWeight * weight, reflectedMean, covariance, 
          doingBallLineUp, isInReadyMode, observedPostsHistory.createSymmetricHistory());
 }
 
-std::vector<SimpleGaussian*> SimpleGaussian::applyRemoteUpdate(
-      const SharedLocalisationUpdateBundle &updateBundle, int teammateIndex, bool amGoalie) {
+SimpleGaussian* SimpleGaussian::applyRemoteUpdates(const std::vector<RemoteUpdate> &updates,
+      const TeamBallFusion *teamBall, bool amGoalie) {
 
    MY_ASSERT(DIM == MAIN_DIM, "dim no equal to main dim in apply remote");
-   MY_ASSERT(teammateIndex >= 0 && teammateIndex <= 3, "apply remote invalid teammate index");
    
-   updateMeanVectorWithRemoteOdometry(updateBundle, teammateIndex);
-   updateCovarianceWithRemoteOdometry(updateBundle, teammateIndex);
+   unsigned numVisionUpdates = 0;
+   for (unsigned i = 0; i < updates.size(); i++) {
+      const SharedLocalisationUpdateBundle &updateBundle =
+            updates[i].broadcastData->sharedLocalisationBundle;
+      MY_ASSERT(updates[i].teammateIndex >= 0 && updates[i].teammateIndex <= 3,
+            "apply remote invalid teammate index");
+
+      updateMeanVectorWithRemoteOdometry(updateBundle, updates[i].teammateIndex);
+      updateCovarianceWithRemoteOdometry(updateBundle, updates[i].teammateIndex);
+      
+      if (updateBundle.haveVisionUpdates) {
+         numVisionUpdates++;
+      }
+   }
    
-   if (!updateBundle.haveVisionUpdates || doingBallLineUp || isBallTooCloseForRemoteUpdate()) {
-      return std::vector<SimpleGaussian*>();
+   if (teamBall == NULL || numVisionUpdates == 0 || doingBallLineUp || 
+       isBallTooCloseForRemoteUpdate()) {
+      return NULL;
    }
    
-   // Create a mode that doesnt have the observation applied.
-   std::vector<SimpleGaussian*> newModes;
+   // Create a mode that doesnt have the observations applied.
    SimpleGaussian *splitGaussian = createSplitGaussian();
    
    double remoteUpdateInvalidProbability = 0.0;
@@ -571,61 +584,85 @@ std::vector<SimpleGaussian*> SimpleGaussian::applyRemoteUpdate(
             LocalisationConstantsProvider::INVALID_REMOTE_OBSERVATION_PROBABILITY);
    }
    splitGaussian->weight *= remoteUpdateInvalidProbability;
-   newModes.push_back(splitGaussian);
    
-   // Do the direct update part now.
-   Eigen::MatrixXd jacobian(SHARED_DIM, DIM);
+   // Do the direct update part now, as one observation made up of the fused team ball followed by
+   // the pose of each teammate that sent a vision update.
+   const int observationDim = 4 + 3 * numVisionUpdates;
+   Eigen::MatrixXd jacobian(observationDim, DIM);
+   MatrixXd innovation(observationDim, 1);
+   MatrixXd observationVariance(observationDim, observationDim);
    jacobian.setZero();
+   observationVariance.setZero();
    
    // The ball part is a direct relationship
-   jacobian(BALL_X_DIM, BALL_X_DIM) = 1.0;
-   jacobian(BALL_Y_DIM, BALL_Y_DIM) = 1.0;
-   jacobian(BALL_DX_DIM, BALL_DX_DIM) = 1.0;
-   jacobian(BALL_DY_DIM, BALL_DY_DIM) = 1.0;
+   const MatrixXd &ballMean = teamBall->getMean();
+   const MatrixXd &ballCovariance = teamBall->getCovariance();
+   for (int i = 0; i < 4; i++) {
+      jacobian(i, BALL_X_DIM + i) = 1.0;
+      innovation(i, 0) = ballMean(i, 0) - mean(BALL_X_DIM + i, 0);
+      for (int j = 0; j < 4; j++) {
+         observationVariance(i, j) = ballCovariance(i, j);
+      }
+   }
    
    // The robot pose part is shifted according to the teammate index.
-   const unsigned poseXIndex = getTeammateIndex(teammateIndex, ROBOT_X_DIM);
-   const unsigned poseYIndex = getTeammateIndex(teammateIndex, ROBOT_Y_DIM);
-   const unsigned poseHIndex = getTeammateIndex(teammateIndex, ROBOT_H_DIM);
-   jacobian(ROBOT_X_DIM, poseXIndex) = 1.0;
-   jacobian(ROBOT_Y_DIM, poseYIndex) = 1.0;
-   jacobian(ROBOT_H_DIM, poseHIndex) = 1.0;
-   
-   MatrixXd innovation(SHARED_DIM, 1);
-   innovation(ROBOT_X_DIM, 0) = updateBundle.sharedUpdateMean(ROBOT_X_DIM, 0) - mean(poseXIndex, 0);
-   innovation(ROBOT_Y_DIM, 0) = updateBundle.sharedUpdateMean(ROBOT_Y_DIM, 0) - mean(poseYIndex, 0);
-   innovation(ROBOT_H_DIM, 0) = normaliseTheta(updateBundle.sharedUpdateMean(ROBOT_H_DIM, 0) - mean(poseHIndex, 0));
-   innovation(BALL_X_DIM, 0) = updateBundle.sharedUpdateMean(BALL_X_DIM, 0) - mean(BALL_X_DIM, 0);
-   innovation(BALL_Y_DIM, 0) = updateBundle.sharedUpdateMean(BALL_Y_DIM, 0) - mean(BALL_Y_DIM, 0);
-   innovation(BALL_DX_DIM, 0) = updateBundle.sharedUpdateMean(BALL_DX_DIM, 0) - mean(BALL_DX_DIM, 0);
-   innovation(BALL_DY_DIM, 0) = updateBundle.sharedUpdateMean(BALL_DY_DIM, 0) - mean(BALL_DY_DIM, 0);
-   
    double uncertaintyFactor = constantsProvider.get(
          LocalisationConstantsProvider::REMOTE_OBSERVATION_UNCERTAINTY_FACTOR);
-   MatrixXd observationVariance(SHARED_DIM, SHARED_DIM);
-   for (unsigned i = 0; i < SHARED_DIM; i++) {
-      for(unsigned j = 0; j < SHARED_DIM; j++) {
-         observationVariance(i, j) = updateBundle.sharedUpdateCovariance(i, j) * uncertaintyFactor;
+   int row = 4;
+   for (unsigned i = 0; i < updates.size(); i++) {
+      const SharedLocalisationUpdateBundle &updateBundle =
+            updates[i].broadcastData->sharedLocalisationBundle;
+      if (!updateBundle.haveVisionUpdates) {
+         continue;
       }
+      
+      const unsigned poseXIndex = getTeammateIndex(updates[i].teammateIndex, ROBOT_X_DIM);
+      const unsigned poseYIndex = getTeammateIndex(updates[i].teammateIndex, ROBOT_Y_DIM);
+      const unsigned poseHIndex = getTeammateIndex(updates[i].teammateIndex, ROBOT_H_DIM);
+      jacobian(row + ROBOT_X_DIM, poseXIndex) = 1.0;
+      jacobian(row + ROBOT_Y_DIM, poseYIndex) = 1.0;
+      jacobian(row + ROBOT_H_DIM, poseHIndex) = 1.0;
+      
+      innovation(row + ROBOT_X_DIM, 0) = updateBundle.sharedUpdateMean(ROBOT_X_DIM, 0) - mean(poseXIndex, 0);
+      innovation(row + ROBOT_Y_DIM, 0) = updateBundle.sharedUpdateMean(ROBOT_Y_DIM, 0) - mean(poseYIndex, 0);
+      innovation(row + ROBOT_H_DIM, 0) = 
+            normaliseTheta(updateBundle.sharedUpdateMean(ROBOT_H_DIM, 0) - mean(poseHIndex, 0));
+      
+      for (int j = 0; j < 3; j++) {
+         for (int k = 0; k < 3; k++) {
+            observationVariance(row + j, row + k) = 
+                  updateBundle.sharedUpdateCovariance(j, k) * uncertaintyFactor;
+         }
+      }
+      row += 3;
    }
 
    double lastWeightAdjustment =
          performTrimmedKalmanUpdate(innovation, jacobian, observationVariance, true, true);
    
-   // If the remote update did not go through (its weight is too small) then scale up that teammates
-   // pose covariance, since we are less sure of our own idea of it.
+   // If the remote update did not go through (its weight is too small) then scale up those 
+   // teammates pose covariance, since we are less sure of our own idea of it.
    // TODO: investigate whether 2.0 is a good scale.
    if (lastWeightAdjustment < remoteUpdateInvalidProbability) {
-      covariance(poseXIndex, poseXIndex) *= 2.0;
-      covariance(poseYIndex, poseYIndex) *= 2.0;
-      covariance(poseHIndex, poseHIndex) *= 2.0;
+      for (unsigned i = 0; i < updates.size(); i++) {
+         if (!updates[i].broadcastData->sharedLocalisationBundle.haveVisionUpdates) {
+            continue;
+         }
+         const unsigned poseXIndex = getTeammateIndex(updates[i].teammateIndex, ROBOT_X_DIM);
+         const unsigned poseYIndex = getTeammateIndex(updates[i].teammateIndex, ROBOT_Y_DIM);
+         const unsigned poseHIndex = getTeammateIndex(updates[i].teammateIndex, ROBOT_H_DIM);
+         covariance(poseXIndex, poseXIndex) *= 2.0;
+         covariance(poseYIndex, poseYIndex) *= 2.0;
+         covariance(poseHIndex, poseHIndex) *= 2.0;
+      }
    }
    
    sanityCheck();
-   return newModes;
+   return splitGaussian;
 }
 
 AbsCoord SimpleGaussian::getRobotPose(void) const {
+   materialiseCovariance();
    AbsCoord result = AbsCoord(mean(ROBOT_X_DIM, 0), mean(ROBOT_Y_DIM, 0), mean(ROBOT_H_DIM, 0));
    for (int i = 0; i < 3; i++) {
       for (int j = 0; j < 3; j++) {
@@ -636,6 +673,7 @@ AbsCoord SimpleGaussian::getRobotPose(void) const {
 }
    
 AbsCoord SimpleGaussian::getBallPosition(void) const {
+   materialiseCovariance();
    AbsCoord result = AbsCoord(mean(BALL_X_DIM, 0), mean(BALL_Y_DIM, 0), 0);
    for (int i = 0; i < 2; i++) {
       for (int j = 0; j < 2; j++) {
@@ -646,6 +684,7 @@ AbsCoord SimpleGaussian::getBallPosition(void) const {
 }
    
 AbsCoord SimpleGaussian::getBallVelocity(void) const {
+   materialiseCovariance();
    AbsCoord result = AbsCoord(mean(BALL_DX_DIM, 0), mean(BALL_DY_DIM, 0), 0);
    for (int i = 0; i < 2; i++) {
       for (int j = 0; j < 2; j++) {
@@ -656,6 +695,7 @@ AbsCoord SimpleGaussian::getBallVelocity(void) const {
 }
 
 double SimpleGaussian::getRobotPosUncertainty(void) const {
+   materialiseCovariance();
    Eigen::MatrixXd positionCovariance = covariance.block(ROBOT_X_DIM, ROBOT_X_DIM, 2, 2);
    EigenSolver<MatrixXd> es(positionCovariance);
    
@@ -665,10 +705,12 @@ double SimpleGaussian::getRobotPosUncertainty(void) const {
 }
 
 double SimpleGaussian::getRobotHeadingUncertainty(void) const {
+   materialiseCovariance();
    return sqrt(covariance(ROBOT_H_DIM, ROBOT_H_DIM));
 }
 
 double SimpleGaussian::getBallPosUncertainty(void) const {
+   materialiseCovariance();
    Eigen::MatrixXd positionCovariance = covariance.block(BALL_X_DIM, BALL_X_DIM, 2, 2);
    EigenSolver<MatrixXd> es(positionCovariance);
    
@@ -678,6 +720,7 @@ double SimpleGaussian::getBallPosUncertainty(void) const {
 }
 
 double SimpleGaussian::getBallVelocityUncertainty(void) const {
+   materialiseCovariance();
    Eigen::MatrixXd velocityCovariance = covariance.block(BALL_DX_DIM, BALL_DX_DIM, 2, 2);
    EigenSolver<MatrixXd> es(velocityCovariance);
    
@@ -735,6 +778,8 @@ bool SimpleGaussian::isSimilarTo(const SimpleGaussian &other) const {
    if (headingDiff < headingThreshold && posDiff < posThreshold) {
       // Calculate the Euclidean distance between the covariance matrix elements corresponding to
       // the robot position and heading.
+      materialiseCovariance();
+      other.materialiseCovariance();
       double covDist = 0.0;
       for (int row = 0; row < 3; row++) {
          for (int col = 0; col < 3; col++) {
@@ -776,6 +821,8 @@ void SimpleGaussian::mergeWith(SimpleGaussian &other) {
    }
 
    // Merge the covariance matrices;
+   materialiseCovariance();
+   other.materialiseCovariance();
    covariance *= thisRatio;
    other.covariance *= otherRatio;
    covariance += other.covariance;
@@ -822,6 +869,7 @@ Eigen::MatrixXd SimpleGaussian::getMean(void) const {
 }
 
 Eigen::MatrixXd SimpleGaussian::getCovariance(void) const {
+   materialiseCovariance();
    return covariance;
 }
 
@@ -891,6 +939,7 @@ double SimpleGaussian::distanceTo(const AbsCoord &coord) {
 }
 
 SimpleGaussian* SimpleGaussian::createSplitGaussian(void) {
+   materialiseCovariance();
    return new SimpleGaussian(DIM, weight, mean, covariance, 
          doingBallLineUp, isInReadyMode, observedPostsHistory);
 }
@@ -1063,6 +1112,7 @@ double SimpleGaussian::performTrimmedKalmanUpdate(
       const Eigen::MatrixXd &observationVariance,
       const bool isSharedUpdate,
       const bool updateWeight) {
+   materialiseCovariance();
    
    const Eigen::MatrixXd jacobianT = jacobian.transpose();
    MY_ASSERT(jacobianT.rows() == (int) DIM, "jacobianT rows unexpected");
@@ -1500,30 +1550,85 @@ void SimpleGaussian::updateCovarianceWithRemoteOdometry(
    const double uncertaintyScale = constantsProvider.get(
          LocalisationConstantsProvider::TEAMMATE_ODOMETRY_UNCERTAINTY_SCALE);
    
-   covariance(poseXIndex, poseXIndex) += updateBundle.sharedCovarianceDx * uncertaintyScale;
-   covariance(poseYIndex, poseYIndex) += updateBundle.sharedCovarianceDy * uncertaintyScale;
-   covariance(poseHIndex, poseHIndex) += updateBundle.sharedCovarianceDh * uncertaintyScale;
+   pendingProcessUpdate.diagonal[poseXIndex] += updateBundle.sharedCovarianceDx * uncertaintyScale;
+   pendingProcessUpdate.diagonal[poseYIndex] += updateBundle.sharedCovarianceDy * uncertaintyScale;
+   pendingProcessUpdate.diagonal[poseHIndex] += updateBundle.sharedCovarianceDh * uncertaintyScale;
+   pendingProcessUpdate.isEmpty = false;
 }
 
-// This is basically the A*C*Atranspose part of the motion update
-void SimpleGaussian::processUpdateCovarianceMatrix(const Odometry &odometry, const double dTimeSeconds) {
-   const double frictionModulation = pow(constantsProvider.get(
-         LocalisationConstantsProvider::BALL_FRICTION), dTimeSeconds);
+void PendingProcessUpdate::clear(void) {
+   isEmpty = true;
+   posFromVel = 0.0;
+   velDecay = 1.0;
+   for (unsigned i = 0; i < MAIN_DIM; i++) {
+      diagonal[i] = 0.0;
+   }
+   for (unsigned axis = 0; axis < 2; axis++) {
+      ballPosPos[axis] = 0.0;
+      ballPosVel[axis] = 0.0;
+      ballVelVel[axis] = 0.0;
+   }
+}
 
-   double useBallVelocity = doingBallLineUp ? 0.0 : 1.0;
+void SimpleGaussian::materialiseCovariance(void) const {
+   if (pendingProcessUpdate.isEmpty) {
+      return;
+   }
+   
+   const double posFromVel = pendingProcessUpdate.posFromVel;
+   const double velDecay = pendingProcessUpdate.velDecay;
    for (unsigned col = 0; col < DIM; col++) {
-      covariance(col, BALL_X_DIM) += covariance(col, BALL_DX_DIM) * dTimeSeconds * useBallVelocity;
-      covariance(col, BALL_Y_DIM) += covariance(col, BALL_DY_DIM) * dTimeSeconds * useBallVelocity;
-      covariance(col, BALL_DX_DIM) *= frictionModulation;
-      covariance(col, BALL_DY_DIM) *= frictionModulation;
+      covariance(col, BALL_X_DIM) += covariance(col, BALL_DX_DIM) * posFromVel;
+      covariance(col, BALL_Y_DIM) += covariance(col, BALL_DY_DIM) * posFromVel;
+      covariance(col, BALL_DX_DIM) *= velDecay;
+      covariance(col, BALL_DY_DIM) *= velDecay;
    }
 
    for (unsigned row = 0; row < DIM; row++) {
-      covariance(BALL_X_DIM, row) += covariance(BALL_DX_DIM, row) * dTimeSeconds * useBallVelocity;
-      covariance(BALL_Y_DIM, row) += covariance(BALL_DY_DIM, row) * dTimeSeconds * useBallVelocity;
-      covariance(BALL_DX_DIM, row) *= frictionModulation;
-      covariance(BALL_DY_DIM, row) *= frictionModulation;
+      covariance(BALL_X_DIM, row) += covariance(BALL_DX_DIM, row) * posFromVel;
+      covariance(BALL_Y_DIM, row) += covariance(BALL_DY_DIM, row) * posFromVel;
+      covariance(BALL_DX_DIM, row) *= velDecay;
+      covariance(BALL_DY_DIM, row) *= velDecay;
+   }
+   
+   for (unsigned i = 0; i < DIM; i++) {
+      covariance(i, i) += pendingProcessUpdate.diagonal[i];
+   }
+   
+   for (unsigned axis = 0; axis < 2; axis++) {
+      const unsigned pos = BALL_X_DIM + axis;
+      const unsigned vel = BALL_DX_DIM + axis;
+      covariance(pos, pos) += pendingProcessUpdate.ballPosPos[axis];
+      covariance(pos, vel) += pendingProcessUpdate.ballPosVel[axis];
+      covariance(vel, pos) += pendingProcessUpdate.ballPosVel[axis];
+      covariance(vel, vel) += pendingProcessUpdate.ballVelVel[axis];
+   }
+   
+   pendingProcessUpdate.clear();
+}
+
+// This is basically the A*C*Atranspose part of the motion update. Rather than transforming the
+// covariance matrix every frame, the transition is composed with any earlier pending ones, and the
+// noise already accumulated since the last materialisation is propagated through it.
+void SimpleGaussian::processUpdateCovarianceMatrix(const Odometry &odometry, const double dTimeSeconds) {
+   const double frictionModulation = pow(constantsProvider.get(
+         LocalisationConstantsProvider::BALL_FRICTION), dTimeSeconds);
+
+   double useBallVelocity = doingBallLineUp ? 0.0 : 1.0;
+   const double posFromVel = dTimeSeconds * useBallVelocity;
+   
+   PendingProcessUpdate &pending = pendingProcessUpdate;
+   pending.posFromVel += posFromVel * pending.velDecay;
+   pending.velDecay *= frictionModulation;
+   
+   for (unsigned axis = 0; axis < 2; axis++) {
+      pending.ballPosPos[axis] += 2.0 * posFromVel * pending.ballPosVel[axis] +
+            posFromVel * posFromVel * pending.ballVelVel[axis];
+      pending.ballPosVel[axis] = frictionModulation *
+            (pending.ballPosVel[axis] + posFromVel * pending.ballVelVel[axis]);
+      pending.ballVelVel[axis] *= frictionModulation * frictionModulation;
    }
+   pending.isEmpty = false;
 }
 
 void SimpleGaussian::additiveProcessNoiseUpdateCovarianceMatrix(
@@ -1540,8 +1645,8 @@ void SimpleGaussian::additiveProcessNoiseUpdateCovarianceMatrix(
          LocalisationConstantsProvider::ROBOT_POS_MOTION_UPDATE_COVARIANCE_C);
    outOdometryUpdateResult.covDx = rPosA*dx*dx;
    outOdometryUpdateResult.covDy = rPosA*dy*dy;
-   covariance(ROBOT_X_DIM, ROBOT_X_DIM) += outOdometryUpdateResult.covDx + rPosC*dTimeSeconds;
-   covariance(ROBOT_Y_DIM, ROBOT_Y_DIM) += outOdometryUpdateResult.covDy + rPosC*dTimeSeconds;
+   pendingProcessUpdate.diagonal[ROBOT_X_DIM] += outOdometryUpdateResult.covDx + rPosC*dTimeSeconds;
+   pendingProcessUpdate.diagonal[ROBOT_Y_DIM] += outOdometryUpdateResult.covDy + rPosC*dTimeSeconds;
    
    // Increase the robot heading pose covariance.
    double rHeadingA = constantsProvider.get(
@@ -1549,7 +1654,7 @@ void SimpleGaussian::additiveProcessNoiseUpdateCovarianceMatrix(
    double rHeadingC = constantsProvider.get(
          LocalisationConstantsProvider::ROBOT_HEADING_MOTION_UPDATE_COVARIANCE_C);
    outOdometryUpdateResult.covDh = rHeadingA*dh*dh;
-   covariance(ROBOT_H_DIM, ROBOT_H_DIM) += outOdometryUpdateResult.covDh + rHeadingC*dTimeSeconds;
+   pendingProcessUpdate.diagonal[ROBOT_H_DIM] += outOdometryUpdateResult.covDh + rHeadingC*dTimeSeconds;
    
    
    if (DIM == MAIN_DIM) {
@@ -1561,9 +1666,9 @@ void SimpleGaussian::additiveProcessNoiseUpdateCovarianceMatrix(
          const unsigned poseYIndex = getTeammateIndex(teammateIndex, ROBOT_Y_DIM);
          const unsigned poseHIndex = getTeammateIndex(teammateIndex, ROBOT_H_DIM);
          
-         covariance(poseXIndex, poseXIndex) += uncertaintyScale*rPosC*dTimeSeconds;
-         covariance(poseYIndex, poseYIndex) += uncertaintyScale*rPosC*dTimeSeconds;
-         covariance(poseHIndex, poseHIndex) += uncertaintyScale*rHeadingC*dTimeSeconds;
+         pendingProcessUpdate.diagonal[poseXIndex] += uncertaintyScale*rPosC*dTimeSeconds;
+         pendingProcessUpdate.diagonal[poseYIndex] += uncertaintyScale*rPosC*dTimeSeconds;
+         pendingProcessUpdate.diagonal[poseHIndex] += uncertaintyScale*rHeadingC*dTimeSeconds;
       }
    }
    
@@ -1589,12 +1694,13 @@ void SimpleGaussian::additiveProcessNoiseUpdateCovarianceMatrix(
             LocalisationConstantsProvider::BALL_POS_MOTION_UPDATE_LINE_UP_COVARIANCE_C);
    }
    
-   covariance(BALL_X_DIM, BALL_X_DIM) += bPosC * dTimeSeconds;
-   covariance(BALL_Y_DIM, BALL_Y_DIM) += bPosC * dTimeSeconds;
+   pendingProcessUpdate.ballPosPos[0] += bPosC * dTimeSeconds;
+   pendingProcessUpdate.ballPosPos[1] += bPosC * dTimeSeconds;
    
    // Increase the ball velocity covariance.
-   covariance(BALL_DX_DIM, BALL_DX_DIM) += bVelC * dTimeSeconds;
-   covariance(BALL_DY_DIM, BALL_DY_DIM) += bVelC * dTimeSeconds;
+   pendingProcessUpdate.ballVelVel[0] += bVelC * dTimeSeconds;
+   pendingProcessUpdate.ballVelVel[1] += bVelC * dTimeSeconds;
+   pendingProcessUpdate.isEmpty = false;
 }
 
 bool SimpleGaussian::goalieUpdateDisagrees(const SharedLocalisationUpdateBundle &updateBundle) const {
@@ -1649,6 +1755,7 @@ void SimpleGaussian::clipBallOutOfRobot(Eigen::MatrixXd &pose) {
 }
 
 bool SimpleGaussian::isStateValid(void) const {
+   materialiseCovariance();
    if (weight < 0.0 || weight > 1.0 || weight != weight || !std::isfinite(weight)) {
       std::cout << "weight failed: " << weight << std::endl;
       return false;
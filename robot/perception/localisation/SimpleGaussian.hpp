@@ -35,6 +35,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "PostType.hpp"
 #include "ObservedPostsHistory.hpp"
 #include "SharedLocalisationUpdateBundle.hpp"
+#include "TeamBallFusion.hpp"
 #include "VisionUpdateBundle.hpp"
 #include "VarianceProvider.hpp"
 #include "ICP.hpp"
@@ -102,6 +103,34 @@ struct OdometryUpdateResult {
    double covDx, covDy, covDh;
 };
 
+/**
+ * Odometry updates that have been applied to the mean of a SimpleGaussian but not yet to its
+ * covariance matrix. A process update only rescales the ball position/velocity rows and columns
+ * and adds noise to the main diagonal, so any number of them compose into a single ball
+ * transition [1 posFromVel; 0 velDecay] (the same for the x and y axes) and an accumulated noise
+ * term. These are folded into the covariance matrix when it is next read or updated.
+ */
+struct PendingProcessUpdate {
+   PendingProcessUpdate() {
+      clear();
+   }
+
+   void clear(void);
+
+   bool isEmpty;
+
+   double posFromVel;
+   double velDecay;
+
+   // Noise for the main diagonal, excluding the ball dimensions.
+   double diagonal[MAIN_DIM];
+
+   // Noise for the ball x and y axes, as the upper triangle of each 2x2 position/velocity block.
+   double ballPosPos[2];
+   double ballPosVel[2];
+   double ballVelVel[2];
+};
+
 /**
  * A SimpleGaussian represents a single mode of a multi-model distribution. Each Gaussian mode
  * has an associated mean state, covariance matrix, and a weight. The weight represents the
@@ -160,8 +189,14 @@ public:
    int uniModalVisionUpdate(const UniModalVisionUpdate &vu);
    void uniModalTeammateRobotVisionUpdate(const UniModalTeammateUpdate &vu);
    
-   std::vector<SimpleGaussian*> applyRemoteUpdate(const SharedLocalisationUpdateBundle &updateBundle,
-         int teammateIndex, bool amGoalie);
+   /**
+    * Applies all of the teammate updates received this tick: their odometry, and then a single
+    * observation of the fused team ball and each teammate's pose. Returns the mode without the
+    * observation applied, which should be inserted back into the distribution, or NULL if there
+    * was nothing to observe. teamBall is NULL if no update had a ball estimate to fuse.
+    */
+   SimpleGaussian* applyRemoteUpdates(const std::vector<RemoteUpdate> &updates,
+         const TeamBallFusion *teamBall, bool amGoalie);
    
    double applyObservation(int obsDimension, const Eigen::MatrixXd &innovation, 
          const Eigen::MatrixXd &jacobian, const Eigen::MatrixXd &observationVariance,
@@ -245,7 +280,11 @@ private:
 
    double weight;
    Eigen::MatrixXd mean; // DIM x 1
-   Eigen::MatrixXd covariance; // DIM x DIM
+
+   // Only valid after materialiseCovariance(), which every method that touches it must call first.
+   // Both are mutable so the const getters can fold in the pending process updates.
+   mutable Eigen::MatrixXd covariance; // DIM x DIM
+   mutable PendingProcessUpdate pendingProcessUpdate;
 
    bool doingBallLineUp;
    bool isInReadyMode;
@@ -389,6 +428,11 @@ private:
    void updateMeanVectorWithRemoteOdometry(const SharedLocalisationUpdateBundle &updateBundle, int teammateIndex);
    void updateCovarianceWithRemoteOdometry(const SharedLocalisationUpdateBundle &updateBundle, int teammateIndex);
    
+   /**
+    * Applies any pending process updates to the covariance matrix.
+    */
+   void materialiseCovariance(void) const;
+
    void processUpdateCovarianceMatrix(const Odometry &odometry, const double dTimeSeconds);
    void additiveProcessNoiseUpdateCovarianceMatrix(const Odometry &odometry, const double dTimeSeconds,
          const bool canSeeBall, OdometryUpdateResult &outOdometryUpdateResult);
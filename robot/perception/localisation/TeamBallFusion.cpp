@@ -0,0 +1,149 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "TeamBallFusion.hpp"
+#include "LocalisationConstantsProvider.hpp"
+
+#include <cmath>
+
+using namespace Eigen;
+
+// The ball x, y, dx, dy block ends the shared state vector, after the robot pose.
+static const int BALL_DIM = 4;
+static const int SHARED_BALL_OFFSET = SHARED_DIM - BALL_DIM;
+
+static const LocalisationConstantsProvider& constantsProvider(
+      LocalisationConstantsProvider::instance());
+
+TeamBallFusion::TeamBallFusion() :
+      mean(BALL_DIM, 1),
+      covariance(BALL_DIM, BALL_DIM),
+      predictedMean(BALL_DIM, 1),
+      predictedCovariance(BALL_DIM, BALL_DIM),
+      information(BALL_DIM, BALL_DIM),
+      informationMean(BALL_DIM, 1) {
+   mean.setZero();
+   covariance.setZero();
+}
+
+bool TeamBallFusion::fuse(const std::vector<RemoteUpdate> &updates) {
+   const double friction = constantsProvider.get(LocalisationConstantsProvider::BALL_FRICTION);
+   const double posNoise = constantsProvider.get(
+         LocalisationConstantsProvider::BALL_POS_MOTION_UPDATE_COVARIANCE_C);
+   const double velNoise = constantsProvider.get(
+         LocalisationConstantsProvider::BALL_VEL_MOTION_UPDATE_COVARIANCE_C);
+
+   information.setZero();
+   informationMean.setZero();
+   double sumWeights = 0.0;
+
+   for (unsigned i = 0; i < updates.size(); i++) {
+      const SharedLocalisationUpdateBundle &bundle = updates[i].broadcastData->sharedLocalisationBundle;
+      if (!bundle.haveVisionUpdates) {
+         continue;
+      }
+
+      // Only the ball block is taken, so the teammate's pose/ball cross-covariance is dropped
+      // and their ball is treated as independent of where they think they are.
+      for (int row = 0; row < BALL_DIM; row++) {
+         predictedMean(row, 0) = bundle.sharedUpdateMean(SHARED_BALL_OFFSET + row, 0);
+         for (int col = 0; col < BALL_DIM; col++) {
+            predictedCovariance(row, col) =
+                  bundle.sharedUpdateCovariance(SHARED_BALL_OFFSET + row, SHARED_BALL_OFFSET + col);
+         }
+      }
+
+      // Predict the teammate's estimate forward to now, same as SimpleGaussian's process update.
+      const double dt = updates[i].ageSeconds;
+      if (dt > 0.0) {
+         const double frictionModulation = pow(friction, dt);
+         for (int axis = 0; axis < 2; axis++) {
+            predictedMean(axis, 0) += predictedMean(2 + axis, 0) * dt;
+            predictedMean(2 + axis, 0) *= frictionModulation;
+         }
+
+         for (int row = 0; row < BALL_DIM; row++) {
+            for (int axis = 0; axis < 2; axis++) {
+               predictedCovariance(row, axis) += predictedCovariance(row, 2 + axis) * dt;
+               predictedCovariance(row, 2 + axis) *= frictionModulation;
+            }
+         }
+         for (int col = 0; col < BALL_DIM; col++) {
+            for (int axis = 0; axis < 2; axis++) {
+               predictedCovariance(axis, col) += predictedCovariance(2 + axis, col) * dt;
+               predictedCovariance(2 + axis, col) *= frictionModulation;
+            }
+         }
+
+         for (int axis = 0; axis < 2; axis++) {
+            predictedCovariance(axis, axis) += posNoise * dt;
+            predictedCovariance(2 + axis, 2 + axis) += velNoise * dt;
+         }
+      }
+
+      // Weight each estimate by the inverse of its trace, which is the usual closed form
+      // approximation to the optimal covariance intersection weights.
+      double trace = 0.0;
+      for (int row = 0; row < BALL_DIM; row++) {
+         trace += predictedCovariance(row, row);
+      }
+      if (!(trace > 0.0)) {
+         continue;
+      }
+      const double weight = 1.0 / trace;
+
+      const MatrixXd inverse = predictedCovariance.inverse();
+      information += weight * inverse;
+      informationMean += weight * (inverse * predictedMean);
+      sumWeights += weight;
+   }
+
+   if (sumWeights <= 0.0) {
+      return false;
+   }
+
+   information /= sumWeights;
+   informationMean /= sumWeights;
+
+   covariance = information.inverse();
+   mean = covariance * informationMean;
+   covariance *= constantsProvider.get(
+         LocalisationConstantsProvider::REMOTE_OBSERVATION_UNCERTAINTY_FACTOR);
+   return true;
+}
+
+const Eigen::MatrixXd &TeamBallFusion::getMean(void) const {
+   return mean;
+}
+
+const Eigen::MatrixXd &TeamBallFusion::getCovariance(void) const {
+   return covariance;
+}
@@ -0,0 +1,85 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include "SharedLocalisationUpdateBundle.hpp"
+#include "types/BroadcastData.hpp"
+
+#include <vector>
+#include <Eigen/Eigen>
+
+/**
+ * A teammate's broadcast, together with how long ago it was received. The broadcast is not
+ * copied, so it must outlive the RemoteUpdate.
+ */
+struct RemoteUpdate {
+   RemoteUpdate(const BroadcastData *broadcastData, int teammateIndex, double ageSeconds) :
+      broadcastData(broadcastData), teammateIndex(teammateIndex), ageSeconds(ageSeconds) {}
+
+   const BroadcastData *broadcastData;
+   int teammateIndex;
+   double ageSeconds;
+};
+
+/**
+ * Combines the ball estimates from all of the teammate updates received since the last tick into
+ * a single ball position/velocity observation. Each estimate is first predicted forward by its
+ * age using the same ball motion model as the process update. They are then fused with covariance
+ * intersection, since teammates' ball estimates are built partly from each other's broadcasts and
+ * their correlation is unknown. Only updates carrying a vision update take part.
+ */
+class TeamBallFusion {
+public:
+   TeamBallFusion();
+
+   /**
+    * Returns false if none of the updates had a ball estimate to fuse.
+    */
+   bool fuse(const std::vector<RemoteUpdate> &updates);
+
+   /**
+    * Ball x, y, dx, dy (4 x 1) and its covariance (4 x 4). Only valid after fuse() returns true.
+    * The covariance has REMOTE_OBSERVATION_UNCERTAINTY_FACTOR applied.
+    */
+   const Eigen::MatrixXd &getMean(void) const;
+   const Eigen::MatrixXd &getCovariance(void) const;
+
+private:
+   Eigen::MatrixXd mean;
+   Eigen::MatrixXd covariance;
+
+   // Scratch space, kept to avoid reallocating every tick.
+   Eigen::MatrixXd predictedMean;
+   Eigen::MatrixXd predictedCovariance;
+   Eigen::MatrixXd information;
+   Eigen::MatrixXd informationMean;
+};
@@ -31,96 +31,131 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "RobotFilter.hpp"
 
-#include <string>
-#include <sstream>
+#include <math.h>
 
-const int NO_CLOSE_OBSERVATION = -1;
+#include <algorithm>
 
 //Make my life easier for iterating over vectors
 #define FOR_EACH(index, vector) for (unsigned int index = 0; index < vector.size(); ++index)
 
-std::vector<RobotObstacle> RobotFilter::update(const RobotFilterUpdate &update) {
+const std::vector<RobotObstacle> &RobotFilter::update(const RobotFilterUpdate &update) {
 
     //Only update visual robots if not incapacitated
     if (!update.isIncapacitated) {
+        tickGroups(update);
+        associateObservations(update.visualRobots);
+    }
 
-        std::vector<GroupedRobots>::iterator it = groupedRobots.begin();
+    updateRobotObstacles();
 
-        while (it != groupedRobots.end()) {
-            GroupedRobots &group = (*it);
-            group.tick(update.odometryDiff, update.headYaw, update.robotPos);
-            if (group.isEmpty()) {
-                it = groupedRobots.erase(it);
-            } else {
-                ++it;
+    return filteredRobots;
+}
+
+void RobotFilter::tickGroups(const RobotFilterUpdate &update) {
+    //Tick every group, compacting out the ones that have gone empty while
+    //keeping the rest in order.
+    unsigned int numGroups = 0;
+    FOR_EACH(groupIndex, groupedRobots) {
+        GroupedRobots &group = groupedRobots[groupIndex];
+        group.tick(update.odometryDiff, update.headYaw, update.robotPos);
+        if (!group.isEmpty()) {
+            if (numGroups != groupIndex) {
+                groupedRobots[numGroups] = group;
             }
+            ++numGroups;
         }
+    }
+    groupedRobots.erase(groupedRobots.begin() + numGroups, groupedRobots.end());
+
+    groupDistance.resize(numGroups);
+    groupCos.resize(numGroups);
+    groupSin.resize(numGroups);
+    groupMergeRadius.resize(numGroups);
+    FOR_EACH(groupIndex, groupedRobots) {
+        const GroupedRobots &group = groupedRobots[groupIndex];
+        const RRCoord rr = group.getRRCoordinates();
+        groupDistance[groupIndex] = rr.distance();
+        groupCos[groupIndex] = cos(rr.heading());
+        groupSin[groupIndex] = sin(rr.heading());
+        groupMergeRadius[groupIndex] = group.getMergeRadius();
+    }
+}
 
+void RobotFilter::associateObservations(const std::vector<RobotInfo> &visualRobots) {
+    const unsigned int numGroups = groupedRobots.size();
+    const unsigned int numObservations = visualRobots.size();
 
-        //Greedy algorithm to determine what observation goes into what group.
-        //Current assumptions: multiple observations cannot go into the same group,
-        //even if they are close together. The closest observation gets merge
-        //into the group so there is many cases where this is suboptimal but as
-        //this is a NP Complete problem it is good enough.
-        std::vector<bool> observationMerged(update.visualRobots.size(), false);
-        FOR_EACH(groupIndex, groupedRobots) {
-            GroupedRobots &group = groupedRobots[groupIndex];
-
-            int smallestIndex = NO_CLOSE_OBSERVATION;
-            double smallestDistance = 0;
-            FOR_EACH(visualIndex, update.visualRobots) {
-
-                if (!observationMerged[visualIndex]) {
-
-                    const RobotInfo &visualRobot = update.visualRobots[visualIndex];
-                    if (group.canMergeRobot(visualRobot)) {
-
-                        double distance = group.distanceToRobot(visualRobot);
-                        if (smallestIndex == -1 || smallestDistance > distance) {
-                            smallestIndex = visualIndex;
-                            smallestDistance = distance;
-                        }
-                    }
-                }
-            }
+    observationX.resize(numObservations);
+    observationY.resize(numObservations);
+    FOR_EACH(visualIndex, visualRobots) {
+        const RRCoord &rr = visualRobots[visualIndex].rr;
+        observationX[visualIndex] = rr.distance() * cos(rr.heading());
+        observationY[visualIndex] = rr.distance() * sin(rr.heading());
+    }
 
-            if (smallestIndex != -1) {
-                const RobotInfo &observation = update.visualRobots[smallestIndex];
-                group.mergeRobot(observation);
-                observationMerged[smallestIndex] = true;
+    //Build the gated cost matrix. Each observation is rotated into the
+    //group's frame (the group on the x axis), which is what
+    //GroupedRobots::canMergeRobot and distanceToRobot do per pair.
+    candidates.clear();
+    for (unsigned int groupIndex = 0; groupIndex < numGroups; ++groupIndex) {
+        const double c = groupCos[groupIndex];
+        const double s = groupSin[groupIndex];
+        const double radius = groupMergeRadius[groupIndex];
+
+        for (unsigned int visualIndex = 0; visualIndex < numObservations; ++visualIndex) {
+            const double x = observationX[visualIndex];
+            const double y = observationY[visualIndex];
+            const double dx = x * c + y * s - groupDistance[groupIndex];
+            const double dy = y * c - x * s;
+
+            const double scaledDy = dy * GroupedRobots::ELLIPSE_VER_HOR_RATIO;
+            if (dx * dx + scaledDy * scaledDy < radius * radius) {
+                Candidate candidate;
+                candidate.cost = dx * dx + dy * dy;
+                candidate.group = groupIndex;
+                candidate.observation = visualIndex;
+                candidates.push_back(candidate);
             }
         }
+    }
 
-        FOR_EACH(visualIndex, update.visualRobots) {
-            if (!observationMerged[visualIndex]) {
-                GroupedRobots group(update.visualRobots[visualIndex]);
-                groupedRobots.push_back(group);
-            }
+    //Greedy assignment, cheapest pair first. Multiple observations cannot go
+    //into the same group, even if they are close together. This is not
+    //optimal in every case but unlike matching group by group it does not let
+    //one group take an observation that was much closer to another.
+    std::stable_sort(candidates.begin(), candidates.end());
+
+    groupMerged.assign(numGroups, false);
+    observationMerged.assign(numObservations, false);
+    FOR_EACH(candidateIndex, candidates) {
+        const Candidate &candidate = candidates[candidateIndex];
+        if (!groupMerged[candidate.group] && !observationMerged[candidate.observation]) {
+            groupedRobots[candidate.group].mergeRobot(visualRobots[candidate.observation]);
+            groupMerged[candidate.group] = true;
+            observationMerged[candidate.observation] = true;
         }
     }
 
-    filteredRobots = generateRobotObstacles();
-
-    return filteredRobots;
+    FOR_EACH(visualIndex, visualRobots) {
+        if (!observationMerged[visualIndex]) {
+            groupedRobots.push_back(GroupedRobots(visualRobots[visualIndex]));
+        }
+    }
 }
 
-std::vector<RobotObstacle> RobotFilter::generateRobotObstacles() const {
-    std::vector<RobotObstacle> obstacles;
-
+void RobotFilter::updateRobotObstacles() {
+    //Overwrite the previous tick's obstacles rather than rebuilding the vector.
+    unsigned int numObstacles = 0;
     FOR_EACH(groupedIndex, groupedRobots) {
         const GroupedRobots &group = groupedRobots[groupedIndex];
         if (group.isOnField() && group.isImportantObstacle()) {
-            std::string type;
-            if (group.getType() == RobotInfo::rUnknown) {
-                type = "unknown";
-            } else if (group.getType() == RobotInfo::rBlue) {
-                type = "blue";
+            if (numObstacles < filteredRobots.size()) {
+                filteredRobots[numObstacles] = group.generateRobotObstacle();
             } else {
-                type = "red";
+                filteredRobots.push_back(group.generateRobotObstacle());
             }
-            obstacles.push_back(group.generateRobotObstacle());
+            ++numObstacles;
         }
     }
-
-    return obstacles;
+    filteredRobots.erase(filteredRobots.begin() + numObstacles, filteredRobots.end());
 }
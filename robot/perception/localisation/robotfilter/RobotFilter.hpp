@@ -44,15 +44,47 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 /**
  * Robot filter deals with deciding what observations should be placed into
  * what groups depending on whether it is possible to merge it into that group.
+ *
+ * The state each group needs for association (its position and merge radius)
+ * is refreshed into flat arrays once per tick, so the gated cost of every
+ * group/observation pair is computed in a single pass without walking each
+ * group's observation history. The pairs are then assigned greedily, cheapest
+ * first.
  */
 class RobotFilter {
    public:
-      std::vector<RobotObstacle> update(const RobotFilterUpdate &update);
+      const std::vector<RobotObstacle> &update(const RobotFilterUpdate &update);
 
    private:
 
+      struct Candidate {
+         double cost;
+         unsigned int group;
+         unsigned int observation;
+
+         bool operator<(const Candidate &other) const {
+            return cost < other.cost;
+         }
+      };
+
       std::vector<RobotObstacle> filteredRobots;
-      std::vector<RobotObstacle> generateRobotObstacles() const;
+      void updateRobotObstacles();
       std::vector<GroupedRobots> groupedRobots;
-};
 
+      // Per group, indexed as groupedRobots.
+      std::vector<double> groupDistance;
+      std::vector<double> groupCos;
+      std::vector<double> groupSin;
+      std::vector<double> groupMergeRadius;
+
+      // Per observation, robot relative cartesian coordinates.
+      std::vector<double> observationX;
+      std::vector<double> observationY;
+      std::vector<bool> observationMerged;
+
+      std::vector<bool> groupMerged;
+      std::vector<Candidate> candidates;
+
+      void tickGroups(const RobotFilterUpdate &update);
+      void associateObservations(const std::vector<RobotInfo> &visualRobots);
+};
@@ -119,6 +119,10 @@ double GroupedRobots::distanceToRobot(const RobotInfo &robot) const {
 }
 
 
+double GroupedRobots::getMergeRadius() const {
+    return (double)ELLIPSE_VERTICAL * getScaleFactor(getLargestWeight());
+}
+
 bool GroupedRobots::canMergeRobot(const RobotInfo &robot) const {
     double scaleFactor = getScaleFactor(getLargestWeight());
     Point robotRelativeCoordinates = getScaledRobotRelativeCartesianToGroup(robot.rr, scaleFactor);
@@ -55,6 +55,13 @@ public:
      */
     bool canMergeRobot(const RobotInfo &robot) const;
 
+    /**
+     * The range-axis radius of the merge ellipse, which grows as the group's
+     * observations get older. The heading axis is ELLIPSE_VER_HOR_RATIO times
+     * narrower.
+     */
+    double getMergeRadius() const;
+
     /**
      * Merge the visual robot into this group.
      */
@@ -29,7 +29,9 @@ with this source code; if not, write to the Free Software Foundation,
 Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
+#include <sys/time.h>
 #include "perception/vision/Camera.hpp"
+#include "perception/vision/CameraRecorder.hpp"
 #include "utils/Timer.hpp"
 #include "utils/Logger.hpp"
 
@@ -137,42 +139,42 @@ __s32 controlValues_lights[NUM_CAMERAS][NUM_CONTROLS] =
 */
 __s32 (*controlValues)[NUM_CONTROLS] = controlValues_lights;
 
-Camera::Camera() : dumpFile(0) {
+Camera::Camera() : recorder(NULL) {
   // imageSize = IMAGE_WIDTH * IMAGE_HEIGHT * 2;
 }
 
+int64_t Camera::getTimestamp() {
+   // Without driver timestamps, the best we know is that it was just now
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 bool Camera::startRecording(const char *filename, uint32_t frequency_ms) {
    this->frequency_ms = frequency_ms;
-   if (dumpFile != NULL) {
-      fclose(dumpFile);
-   }
-   dumpFile = fopen(filename, "w");
+   delete recorder;
+   recorder = new CameraRecorder(filename);
    llog(INFO) << "Starting camera dump to file: " << filename << endl;
-   return dumpFile != NULL;
+   if (!recorder->isOpen()) {
+      delete recorder;
+      recorder = NULL;
+   }
+   return recorder != NULL;
 }
 
 void Camera::stopRecording() {
-   if (dumpFile != NULL) {
-      fclose(dumpFile);
-      dumpFile = NULL;
-   }
+   delete recorder;
+   recorder = NULL;
    llog(INFO) << "Finishing camera dump to file" << endl;
 }
 
-void Camera::writeFrame(const uint8_t*& imageTop,const uint8_t*& imageBot) {
-   static Timer t;
-   int topSize = 1280*960;
-   int botSize = 640*480;
-   if (dumpFile != NULL && imageTop != NULL && imageBot != NULL) {
-      if (t.elapsed_ms() >= frequency_ms) {
-         t.restart();
+void Camera::writeFrame(const uint8_t *imageTop, const uint8_t *imageBot,
+                        int64_t timestamp, const float *jointAngles) {
+   if (recorder != NULL && imageTop != NULL && imageBot != NULL) {
+      if (recordTimer.elapsed_ms() >= frequency_ms) {
+         recordTimer.restart();
          llog(DEBUG3) << "Writing frame to dumpFile" << endl;
-         int written = fwrite(imageTop, topSize*2, 1, dumpFile);
-         llog(DEBUG3) << "wrote " << written << " top frames" << endl;
-         fflush(dumpFile);
-         written = fwrite(imageBot, botSize*2, 1, dumpFile);
-         llog(DEBUG3) << "wrote " << written << " bot frames" << endl;
-         fflush(dumpFile);
+         recorder->record(imageTop, imageBot, timestamp, jointAngles);
       }
    }
 }
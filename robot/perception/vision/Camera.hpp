@@ -41,6 +41,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <alvision/alvisiondefinitions.h>
 #include <linux/videodev2.h>
 #include "WhichCamera.hpp"
+#include "utils/Timer.hpp"
+
+class CameraRecorder;
 
 #define IMAGE_WIDTH 640
 #define IMAGE_HEIGHT 480
@@ -97,6 +100,13 @@ class Camera {
        */
       virtual WhichCamera getCamera() = 0;
 
+      /**
+       * Gets the time the image last returned by get() was captured
+       *
+       * @return microseconds, on the same clock as gettimeofday
+       */
+      virtual int64_t getTimestamp();
+
       /**
        * Starts recording to a file.  If there is a recording in progress, will
        * stop recording, first.
@@ -112,6 +122,15 @@ class Camera {
        */
       void stopRecording();
 
+      /**
+       * Records a frame if we are currently recording
+       *
+       * @param timestamp when imageTop was captured
+       * @param jointAngles the joint angles at that time, or NULL
+       */
+      void writeFrame(const uint8_t *imageTop, const uint8_t *imageBot,
+                      int64_t timestamp, const float *jointAngles);
+
       /**
        * Sets a camera control (eg. hue)
        *
@@ -122,14 +141,14 @@ class Camera {
       virtual bool setControl(const uint32_t id, const int32_t value) = 0;
 
    protected:
-      /* File handle pointing to where we are recording */
-      FILE *dumpFile;
+      /* Where we are recording to, or NULL */
+      CameraRecorder *recorder;
 
       unsigned int imageSize;
 
       /* How frequently to record frames */
       uint32_t frequency_ms;
 
-      /* Writes a frame to disk if we are currently recording */
-      void writeFrame(const uint8_t*& imageTop,const uint8_t*& imageBot);
+      /* When we last recorded a frame */
+      Timer recordTimer;
 };
@@ -0,0 +1,177 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "perception/vision/CameraRecorder.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "utils/Logger.hpp"
+
+using namespace std;
+
+static const size_t PAGE_SIZE_ALIGNMENT = 4096;
+
+CameraRecorder::CameraRecorder(const char *path)
+   : fd(-1), ring(NULL), head(0), tail(0), stopping(false), frames(0),
+     dropped(0) {
+   void *memory;
+   if (posix_memalign(&memory, PAGE_SIZE_ALIGNMENT,
+                      SLOTS * CAMERA_RECORD_SIZE) != 0) {
+      llog(ERROR) << "Could not allocate the camera recording buffers"
+                  << endl;
+      return;
+   }
+   ring = (uint8_t *)memory;
+   // The padding after each header is written too, so keep it clean
+   memset(ring, 0, SLOTS * CAMERA_RECORD_SIZE);
+
+   // Skip the page cache where the file system lets us
+   fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+   if (fd < 0 && errno == EINVAL) {
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   }
+   if (fd < 0) {
+      llog(ERROR) << "Could not open " << path << ": " << strerror(errno)
+                  << endl;
+      return;
+   }
+   if (pthread_create(&writer, NULL, &CameraRecorder::writeRecords,
+                      this) != 0) {
+      llog(ERROR) << "Could not start the camera recording thread" << endl;
+      close(fd);
+      fd = -1;
+   }
+}
+
+CameraRecorder::~CameraRecorder() {
+   if (fd >= 0) {
+      stopping = true;
+      pthread_join(writer, NULL);
+      close(fd);
+      llog(INFO) << "Recorded " << frames - dropped << " of " << frames
+                 << " camera frames" << endl;
+   }
+   free(ring);
+}
+
+bool CameraRecorder::isOpen() const {
+   return fd >= 0;
+}
+
+void CameraRecorder::record(const uint8_t *top, const uint8_t *bot,
+                            int64_t timestamp, const float *jointAngles) {
+   if (fd < 0) {
+      return;
+   }
+   ++frames;
+   if (head - tail >= SLOTS) {
+      ++dropped;
+      return;
+   }
+
+   uint8_t *slot = ring + (head % SLOTS) * CAMERA_RECORD_SIZE;
+   CameraRecordHeader *header = (CameraRecordHeader *)slot;
+   memcpy(header->magic, CAMERA_RECORD_MAGIC, sizeof(header->magic));
+   header->headerSize = CAMERA_RECORD_HEADER_SIZE;
+   header->topSize = CAMERA_RECORD_TOP_SIZE;
+   header->botSize = CAMERA_RECORD_BOT_SIZE;
+   header->frame = frames - 1;
+   header->dropped = dropped;
+   header->numJoints = Joints::NUMBER_OF_JOINTS;
+   header->timestamp = timestamp;
+   if (jointAngles) {
+      memcpy(header->jointAngles, jointAngles, sizeof(header->jointAngles));
+   } else {
+      memset(header->jointAngles, 0, sizeof(header->jointAngles));
+   }
+   slot += CAMERA_RECORD_HEADER_SIZE;
+   memcpy(slot, top, CAMERA_RECORD_TOP_SIZE);
+   memcpy(slot + CAMERA_RECORD_TOP_SIZE, bot, CAMERA_RECORD_BOT_SIZE);
+
+   __sync_synchronize();
+   ++head;
+}
+
+void *CameraRecorder::writeRecords(void *recorder) {
+   ((CameraRecorder *)recorder)->writeRecords();
+   return NULL;
+}
+
+void CameraRecorder::writeRecords() {
+   for (;;) {
+      const uint32_t filled = head;
+      if (filled == tail) {
+         if (stopping) {
+            return;
+         }
+         usleep(IDLE_US);
+         continue;
+      }
+      __sync_synchronize();
+
+      // Everything filled up to the end of the ring in one go
+      const uint32_t first = tail % SLOTS;
+      const uint32_t count = std::min(filled - tail, SLOTS - first);
+      if (!writeAll(ring + first * CAMERA_RECORD_SIZE,
+                    count * CAMERA_RECORD_SIZE)) {
+         llog(ERROR) << "Could not write camera recording: "
+                     << strerror(errno) << endl;
+      }
+      __sync_synchronize();
+      tail += count;
+   }
+}
+
+bool CameraRecorder::writeAll(const uint8_t *data, size_t length) {
+   while (length > 0) {
+      ssize_t written = write(fd, data, length);
+      if (written < 0 && errno == EINVAL &&
+          (fcntl(fd, F_GETFL) & O_DIRECT)) {
+         // The file system took O_DIRECT at open but will not write with it
+         fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+         continue;
+      }
+      if (written < 0 && errno == EINTR) {
+         continue;
+      }
+      if (written <= 0) {
+         return false;
+      }
+      data += written;
+      length -= written;
+   }
+   return true;
+}
@@ -0,0 +1,117 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "perception/vision/VisionDefs.hpp"
+#include "utils/body.hpp"
+
+/**
+ * Raw camera recordings are a run of fixed size records, one per frame: a
+ * CameraRecordHeader padded out to CAMERA_RECORD_HEADER_SIZE, then the top
+ * and bottom images as they came from the cameras. Everything is a whole
+ * number of pages, so records can be written straight from memory with
+ * O_DIRECT, and frame n is at n * CAMERA_RECORD_SIZE.
+ */
+static const char CAMERA_RECORD_MAGIC[8] =
+   { 'R', 'S', 'W', 'C', 'A', 'M', '0', '1' };
+static const uint32_t CAMERA_RECORD_HEADER_SIZE = 4096;
+static const uint32_t CAMERA_RECORD_TOP_SIZE =
+   TOP_IMAGE_ROWS * TOP_IMAGE_COLS * 2;
+static const uint32_t CAMERA_RECORD_BOT_SIZE =
+   BOT_IMAGE_ROWS * BOT_IMAGE_COLS * 2;
+static const uint32_t CAMERA_RECORD_SIZE = CAMERA_RECORD_HEADER_SIZE +
+   CAMERA_RECORD_TOP_SIZE + CAMERA_RECORD_BOT_SIZE;
+
+struct CameraRecordHeader {
+   char magic[8];
+   uint32_t headerSize;
+   uint32_t topSize;
+   uint32_t botSize;
+   /* Frames offered to the recorder before this one, and how many of them
+    * were dropped */
+   uint32_t frame;
+   uint32_t dropped;
+   uint32_t numJoints;
+   /* When the top image was captured, on the gettimeofday clock */
+   int64_t timestamp;
+   /* Joint angles at that time, for the camera pose */
+   float jointAngles[Joints::NUMBER_OF_JOINTS];
+};
+
+/**
+ * Records both cameras' images to disk without holding up vision.
+ *
+ * record() copies the images into the next free record of a ring of
+ * page-aligned records, and an I/O thread writes out runs of them with
+ * one write() each. When the disk falls behind and the ring fills, frames
+ * are dropped and counted rather than waited for.
+ */
+class CameraRecorder {
+   public:
+      explicit CameraRecorder(const char *path);
+
+      /* Writes out what is left in the ring before closing */
+      ~CameraRecorder();
+
+      bool isOpen() const;
+
+      /**
+       * Only call from one thread
+       * @param jointAngles Joints::NUMBER_OF_JOINTS angles, or NULL
+       */
+      void record(const uint8_t *top, const uint8_t *bot, int64_t timestamp,
+                  const float *jointAngles);
+
+   private:
+      static const uint32_t SLOTS = 8;
+      /* How long the I/O thread sleeps when there is nothing to write */
+      static const int IDLE_US = 10000;
+
+      int fd;
+      uint8_t *ring;
+      pthread_t writer;
+
+      /* Records filled and written, each only changed by one side */
+      volatile uint32_t head;
+      volatile uint32_t tail;
+      volatile bool stopping;
+
+      uint32_t frames;
+      uint32_t dropped;
+
+      static void *writeRecords(void *recorder);
+      void writeRecords();
+      bool writeAll(const uint8_t *data, size_t length);
+};
@@ -178,7 +178,7 @@ NaoCamera::NaoCamera(Blackboard *blackboard, const char *filename, const IOMetho
    }
    start_capturing();
    setCamera(initialCamera);
-   dumpFile = NULL;
+   recorder = NULL;
 }
 
 
@@ -1057,3 +1057,24 @@ WhichCamera NaoCamera::getCamera() {
    }
    return currentCamera;
 }
+
+int64_t NaoCamera::getTimestamp() {
+   if (io == IO_METHOD_READ || lastDequeued.index == UINT_MAX ||
+       (lastDequeued.timestamp.tv_sec == 0 &&
+        lastDequeued.timestamp.tv_usec == 0)) {
+      return Camera::getTimestamp();
+   }
+   int64_t timestamp = (int64_t)lastDequeued.timestamp.tv_sec * 1000000 +
+                       lastDequeued.timestamp.tv_usec;
+#ifdef V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC
+   // Newer drivers stamp buffers with the monotonic clock, so move it onto
+   // the gettimeofday clock everything else uses
+   if (lastDequeued.flags & V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      int64_t monotonic = (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+      timestamp += Camera::getTimestamp() - monotonic;
+   }
+#endif
+   return timestamp;
+}
@@ -101,6 +101,7 @@ class NaoCamera : public Camera {
       const uint8_t *get(const int colourSpace);
       bool setCamera(WhichCamera whichCamera);
       WhichCamera getCamera();
+      int64_t getTimestamp();
       bool setControl(const uint32_t id, const int32_t value);
 
    protected:
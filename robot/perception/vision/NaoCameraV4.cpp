@@ -123,7 +123,7 @@ NaoCameraV4::NaoCameraV4(Blackboard *blackboard, const char *filename, const IOM
 */
    //start_capturing();
    
-   dumpFile = NULL;
+   recorder = NULL;
 }
 
 NaoCameraV4::~NaoCameraV4()
@@ -114,7 +114,6 @@ void Vision::getFrame() {
       //(camera == top_camera ? bot_camera : top_camera)->get();
    botFrame = bot_camera->get();
    topFrame = top_camera->get();
-   camera->writeFrame(topFrame,botFrame);
   // }
    //currentFrame = camera->get();
 }
@@ -36,6 +36,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <pthread.h>
 #include <vector>
 #include "blackboard/Blackboard.hpp"
+#include "perception/kinematics/PoseService.hpp"
 #include "utils/Logger.hpp"
 #include "perception/kinematics/Pose.hpp"
 
@@ -83,7 +84,8 @@ VisionAdapter::VisionAdapter(Blackboard *bb)
        (blackboard->config)["vision.vocab"].as<string>(),
        (blackboard->config)["debug.vision"].as<bool>(),
        (blackboard->config)["vision.seeBluePosts"].as<bool>(),
-       (blackboard->config)["vision.seeLandmarks"].as<bool>())
+       (blackboard->config)["vision.seeLandmarks"].as<bool>()),
+     sonarVersion(0)
 {
    writeTo(vision, topSaliency, (Colour*)V.topSaliency._colour);
    writeTo(vision, botSaliency, (Colour*)V.botSaliency._colour);
@@ -98,13 +100,26 @@ void VisionAdapter::tick() {
    llog(VERBOSE) << "Vision.. ticking away" << endl;
    Timer t;
 
-   // Read current Pose from blakboard
-   V.convRR.pose = readFrom(motion, pose);
-
    // Read whichCamera from blackboard
    //int behaviourReadBuf = readFrom(behaviour, readBuf);
    //V.whichCamera = readFrom(behaviour, request[behaviourReadBuf].whichCamera);
    V.getFrame();
+
+   // Pose at the moment the image was captured, from the joint history
+   // Motion keeps for us. Falls back to the live sensors until Motion
+   // has pushed anything. The dumps record the same values.
+   SensorValues valuesAtCapture;
+   if (!blackboard->kinematics.poseService->getSensors(
+          Vision::top_camera->getTimestamp(), &valuesAtCapture)) {
+      valuesAtCapture = readFrom(motion, sensors);
+   }
+   writeTo(kinematics, sensorsAtCapture, valuesAtCapture);
+   Vision::camera->writeFrame(V.topFrame, V.botFrame,
+                              Vision::top_camera->getTimestamp(),
+                              valuesAtCapture.joints.angles);
+   V.convRR.pose = blackboard->kinematics.poseService->getPose(
+      valuesAtCapture, readFrom(kinematics, parameters));
+   writeTo(motion, pose, V.convRR.pose);
    //writeTo(vision, currentFrame, V.currentFrame);
    writeTo(vision, topFrame, V.topFrame);
    writeTo(vision, botFrame, V.botFrame);
@@ -117,19 +132,22 @@ void VisionAdapter::tick() {
    t.restart();
 
    SensorValues values = readFrom(motion, sensors);
-   SensorValues valuesLagged = readFrom(kinematics, sensorsLagged);
-   V.convRR.updateAngles(valuesLagged);
-
-   // robot detection needs sonar
-   V.robotDetection._sonar = readFrom(kinematics, sonarFiltered);
-   V.oldRobotDetection.sonar = readFrom(kinematics, sonarFiltered);
+   V.convRR.updateAngles(valuesAtCapture);
+
+   // robot detection needs sonar, which only changes with new pings
+   const uint32_t sonarNow = versionOf(kinematics, sonarFiltered);
+   if (sonarNow != sonarVersion) {
+      V.robotDetection._sonar = readFrom(kinematics, sonarFiltered);
+      V.oldRobotDetection.sonar = V.robotDetection._sonar;
+      sonarVersion = sonarNow;
+   }
 
    // goal matcher needs to know which end is which and other details to store landmarks
    RoboCupGameControlData gameData = readFrom(gameController, data);
    V.goalMatcher.state = gameData.state;
    V.goalMatcher.secondaryState = gameData.secondaryState;
    V.goalMatcher.robotPos = readFrom(localisation, robotPos);
-   V.goalMatcher.headYaw = valuesLagged.joints.angles[Joints::HeadYaw];
+   V.goalMatcher.headYaw = valuesAtCapture.joints.angles[Joints::HeadYaw];
 
    // field line detection uses current robotPos to search for features
    V.fieldLineDetection.robotPos = readFrom(localisation, robotPos);
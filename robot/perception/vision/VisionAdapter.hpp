@@ -57,6 +57,8 @@ class VisionAdapter : Adapter {
    Vision V;
    /* A wall clock */
    Timer timer;
+   /* versionOf(kinematics, sonarFiltered) last given to robot detection */
+   uint32_t sonarVersion;
 
    friend class VisionTest::DumpResult;
    friend class VisionTest::FrameResult;
@@ -30,6 +30,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
 #include <ctime>
+#include <sys/time.h>
 #include <iostream>
 #include "Team.hpp"
 #include "types/SPLStandardMessage.hpp"
@@ -68,6 +69,11 @@ void TeamReceiver::naoHandler(const boost::system::error_code &error,
          writeTo(receiver, data[bd.playerNum - 1], bd);
          writeTo(receiver, lastReceived[bd.playerNum - 1], time(NULL));
 
+         struct timeval tv;
+         gettimeofday(&tv, NULL);
+         int64_t receivedTimestamp = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+         writeTo(receiver, lastReceivedTimestamp[bd.playerNum - 1], receivedTimestamp);
+
          // calculate incapacitated
          bool incapacitated = false;
          if (readFrom(gameController, our_team).players[bd.playerNum - 1].penalty
@@ -18,6 +18,7 @@ SET(SOCCER_SRCS
    perception/vision/rle.cpp
    perception/vision/VisionDefs.cpp
    perception/vision/Camera.cpp
+   perception/vision/CameraRecorder.cpp
    perception/vision/BallDetection.cpp
    perception/vision/GoalDetection.cpp
    perception/vision/OldRobotDetection.cpp
@@ -53,6 +54,7 @@ SET(SOCCER_SRCS
    perception/vision/VarianceCalculator.cpp
 
    perception/dumper/PerceptionDumper.cpp
+   perception/dumper/DumpFile.cpp
 
    # Localisation
    perception/localisation/LocalisationAdapter.cpp
@@ -69,16 +71,20 @@ SET(SOCCER_SRCS
    perception/localisation/SharedDistribution.cpp
    perception/localisation/SimpleGaussian.cpp
    perception/localisation/MultiGaussianDistribution.cpp
+   perception/localisation/ParticleFilter.cpp
+   perception/localisation/FieldLikelihoodField.cpp
    perception/localisation/LocalisationConstantsProvider.cpp
    perception/localisation/VarianceProvider.cpp
    perception/localisation/ObservedPostsHistory.cpp
    perception/localisation/TeamBallTracker.cpp
+   perception/localisation/TeamBallFusion.cpp
 
    # Kinematics
    perception/kinematics/KinematicsAdapter.cpp
    perception/kinematics/Kinematics.cpp
    perception/kinematics/SonarFilter.cpp
    perception/kinematics/Pose.cpp
+   perception/kinematics/PoseService.cpp
    perception/kinematics/Parameters.cpp
    perception/kinematics/CKF.cpp
 
@@ -104,10 +110,13 @@ SET(SOCCER_SRCS
    #utils/bzip_compress.cpp
    utils/options.cpp
    utils/Logger.cpp
+   utils/Version.cpp
    utils/NaoVersion.cpp
    gamecontroller/GameController.cpp
    gamecontroller/RoboCupGameControlData.cpp
    transmitter/OffNao.cpp
+   transmitter/WireFormat.cpp
+   transmitter/ShmRing.cpp
    transmitter/Nao.cpp
    transmitter/Team.cpp
    transmitter/NaturalLandmarks.cpp
@@ -120,8 +129,10 @@ SET(SOCCER_SRCS
 
    # Motion
    motion/generator/ActionGenerator.cpp
+   motion/generator/MotionPack.cpp
    motion/generator/ClippedGenerator.cpp
    motion/generator/BodyModel.cpp
+   motion/generator/PlannerTable.cpp
    motion/generator/RLPlanner.cpp
    motion/generator/DistributedGenerator.cpp
    motion/generator/HeadGenerator.cpp
@@ -171,6 +182,8 @@ SET_TARGET_PROPERTIES(soccer PROPERTIES CLEAN_DIRECT_OUTPUT 1)
 SET_TARGET_PROPERTIES(soccer-static PROPERTIES CLEAN_DIRECT_OUTPUT 1)
 
 TARGET_LINK_LIBRARIES(soccer soccer-static)
+# ThreadManager's timers and clock_nanosleep
+TARGET_LINK_LIBRARIES(soccer-static rt)
 
 ADD_CUSTOM_COMMAND ( OUTPUT version.cpp
    COMMAND ${CMAKE_CURRENT_SOURCE_DIR}/../bin/genversion.pl > version.cpp
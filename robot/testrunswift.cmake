@@ -11,8 +11,22 @@ SET(TEST_RUNSWIFT_SRCS
         tests/TestBresenhamPtr.cpp
         tests/TestRansac.cpp
         tests/TestFovea.cpp
-
+        tests/TestProjections.cpp
+        tests/utils/TestLogRing.cpp
+        tests/utils/TestSampleRing.cpp
+        tests/utils/TestSeqlock.cpp
+        tests/utils/TestSnapshotBuffer.cpp
+        tests/utils/TestVersion.cpp
+        tests/perception/kinematics/TestSonarFilter.cpp
+
+        perception/kinematics/Kinematics.cpp
+        perception/kinematics/Parameters.cpp
+        perception/kinematics/Pose.cpp
+        perception/kinematics/SonarFilter.cpp
         perception/vision/Ransac.cpp
+        thread/Thread.cpp
+        utils/Logger.cpp
+        utils/Version.cpp
 
 
         #ROBOT FILTER TESTS AND DEPENDENCIES
@@ -1,7 +1,15 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <boost/test/unit_test.hpp>
 
+#include "perception/kinematics/DHTransform.hpp"
+#include "perception/kinematics/Kinematics.hpp"
 #include "perception/kinematics/Pose.hpp"
+#include "perception/vision/VisionDefs.hpp"
+#include "utils/angles.hpp"
+#include "utils/matrix_helpers.hpp"
 
 using namespace boost::numeric::ublas;
 
@@ -10,17 +18,30 @@ BOOST_AUTO_TEST_SUITE(kinematics_pose)
 
 BOOST_AUTO_TEST_CASE(forward_backwards)
 {
-   matrix<float> t(4, 4);
-   t(0,0) = -0.190343; t(1,0) = -0.980772; t(2,0) =  0.043068; t(3,0) = 0.0,
-   t(0,1) = -0.291743; t(1,1) =  0.014622; t(2,1) = -0.956385; t(3,1) = 0.0,
-   t(0,2) =  0.937366; t(1,2) = -0.194606; t(2,2) = -0.288916; t(3,2) = 0.0,
-   t(0,3) = 49.128441; t(1,3) = -5.226813; t(2,3) =  493.6120; t(3,3) = 1.0;
+   // Standing with the head tilted down so both cameras see the ground
+   SensorValues sensorValues;
+   for (int j = 0; j < Joints::NUMBER_OF_JOINTS; ++j) {
+      sensorValues.joints.angles[j] = 0;
+   }
+   for (int j = 0; j < Sensors::NUMBER_OF_SENSORS; ++j) {
+      sensorValues.sensors[j] = 0;
+   }
+   sensorValues.joints.angles[Joints::HeadPitch] = 0.4;
 
-   Pose pose(t, std::pair<int, int>(0, 0));
+   Kinematics kinematics;
+   memset(&kinematics.parameters, 0, sizeof(kinematics.parameters));
+   kinematics.setSensorValues(sensorValues);
+   kinematics.updateDHChain();
+   Pose pose = kinematics.getPose();
 
-   int i;
+   int i, compared = 0;
    for (i = 0; i < 1000; ++ i) {
-      Point test  = Point(rand() % IMAGE_COLS, rand() % IMAGE_ROWS);
+      // Either camera, in the stacked coordinates imageToRobotXY takes
+      bool top = rand() % 2;
+      Point test = top ?
+         Point(rand() % TOP_IMAGE_COLS, rand() % TOP_IMAGE_ROWS) :
+         Point(rand() % BOT_IMAGE_COLS,
+               TOP_IMAGE_ROWS + rand() % BOT_IMAGE_ROWS);
 
       int h = rand() % 100;
       Point robot = pose.imageToRobotXY(test , h);
@@ -29,18 +50,235 @@ BOOST_AUTO_TEST_CASE(forward_backwards)
       if (robot.x() < 0) {
          continue;
       }
-      /*
-      printf ("%d %d -> %d %d -> %d %d\n",
-              test.x(), test.y(), 
-              robot.x(), robot.y(),
-              image.x(), image.y());
-      */
-
-      BOOST_CHECK_LT(abs(test.x() - image.x()), 3);
-      BOOST_CHECK_LT(abs(test.y() - image.y()), 3);
 
+      // The bottom of the top image is also seen by the bottom camera,
+      // which robotToImageXY prefers, and where a pixel is less than the mm
+      // the robot point is rounded to the rounding alone moves the pixel,
+      // so only compare pixels away from both. Either way the point has to
+      // land on the same spot on the ground
+      Point nudged = pose.robotToImageXY(robot + Point(1, 1), h);
+      bool sameCamera = (image.y() < TOP_IMAGE_ROWS) == top;
+      if (sameCamera && abs(nudged.x() - image.x()) <= 1 &&
+          abs(nudged.y() - image.y()) <= 1) {
+         ++compared;
+         BOOST_CHECK_LT(abs(test.x() - image.x()), 3);
+         BOOST_CHECK_LT(abs(test.y() - image.y()), 3);
+      }
+      Point back = pose.imageToRobotXY(image, h);
+      float distance = hypotf(robot.x(), robot.y());
+      BOOST_CHECK_LT(hypotf(back.x() - robot.x(), back.y() - robot.y()),
+                     0.01 * distance + 5);
    }
+   // most of the points should have had their pixels compared
+   BOOST_CHECK_GT(compared, 500);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
 
+
+BOOST_AUTO_TEST_SUITE(kinematics_chain)
+
+static const float TOLERANCE = 1e-3;
+
+static float randomFloat(float range) {
+   return (rand() / (float)RAND_MAX - 0.5f) * 2 * range;
+}
+
+static void checkClose(const matrix<float> &a, const matrix<float> &b) {
+   BOOST_REQUIRE_EQUAL(a.size1(), b.size1());
+   BOOST_REQUIRE_EQUAL(a.size2(), b.size2());
+   for (unsigned i = 0; i < a.size1(); ++i) {
+      for (unsigned j = 0; j < a.size2(); ++j) {
+         BOOST_CHECK_SMALL(a(i, j) - b(i, j), TOLERANCE);
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(dh_transform_matches_ublas)
+{
+   for (int i = 0; i < 100; ++i) {
+      matrix<float> chain = identity_matrix<float>(4);
+      DHTransform links[CAMERA_DH_CHAIN_LEN];
+      for (int j = 0; j < CAMERA_DH_CHAIN_LEN; ++j) {
+         float a = randomFloat(100), alpha = randomFloat(M_PI);
+         float d = randomFloat(100), theta = randomFloat(M_PI);
+         links[j] = DHTransform::dh(a, alpha, d, theta);
+         checkClose(links[j].toMatrix(),
+                    createDHMatrix<float>(a, alpha, d, theta));
+         chain = prod(chain, createDHMatrix<float>(a, alpha, d, theta));
+      }
+      DHTransform fixed = DHChain<CAMERA_DH_CHAIN_LEN>::evaluate(links);
+      checkClose(fixed.toMatrix(), chain);
+
+      matrix<float> inverse(4, 4);
+      invertMatrix(chain, inverse);
+      checkClose(fixed.inverse().toMatrix(), inverse);
+   }
+}
+
+BOOST_AUTO_TEST_CASE(chains_match_ublas)
+{
+   for (int i = 0; i < 100; ++i) {
+      SensorValues sensorValues;
+      for (int j = 0; j < Joints::NUMBER_OF_JOINTS; ++j) {
+         sensorValues.joints.angles[j] = randomFloat(0.5);
+      }
+      for (int j = 0; j < Sensors::NUMBER_OF_SENSORS; ++j) {
+         sensorValues.sensors[j] = randomFloat(0.1);
+      }
+      const JointValues &joints = sensorValues.joints;
+
+      Kinematics kinematics;
+      kinematics.parameters.cameraPitchTop = randomFloat(5);
+      kinematics.parameters.cameraYawTop = randomFloat(5);
+      kinematics.parameters.cameraRollTop = randomFloat(5);
+      kinematics.parameters.cameraYawBottom = randomFloat(5);
+      kinematics.parameters.cameraPitchBottom = randomFloat(5);
+      kinematics.parameters.cameraRollBottom = randomFloat(5);
+      kinematics.parameters.bodyPitch = randomFloat(5);
+      kinematics.setSensorValues(sensorValues);
+      kinematics.updateDHChain();
+
+      // The left leg and top camera chain written out with ublas, as it was
+      // evaluated before the fixed size transforms
+      const float d2 = Limbs::HipOffsetZ + Limbs::NeckOffsetZ - Limbs::HipOffsetY;
+      const float d3 = Limbs::HipOffsetY * sqrt(2);
+      const float Hyp = joints.angles[Joints::LHipYawPitch];
+      matrix<float> links[Kinematics::NECK] = {
+         createDHMatrix<float>(0, 0, Limbs::FootHeight, M_PI / 2),
+         createDHMatrix<float>(0, M_PI / 2, 0,
+                               M_PI / 2 - joints.angles[Joints::LAnkleRoll]),
+         createDHMatrix<float>(0, M_PI / 2, 0,
+                               -joints.angles[Joints::LAnklePitch]),
+         createDHMatrix<float>(Limbs::TibiaLength, 0, 0,
+                               -joints.angles[Joints::LKneePitch]),
+         createDHMatrix<float>(Limbs::ThighLength, 0, 0,
+                               -joints.angles[Joints::LHipPitch]),
+         createDHMatrix<float>(0, -M_PI / 2, 0,
+                               -M_PI / 4 - joints.angles[Joints::LHipRoll]),
+         createDHMatrix<float>(0, M_PI / 2, -d3, M_PI / 2 - Hyp),
+         createDHMatrix<float>(0, 3 * M_PI / 4, 0, 0),
+         createDHMatrix<float>(0, 0, d2, joints.angles[Joints::HeadYaw]),
+      };
+      matrix<float> b2f = identity_matrix<float>(4);
+      for (int j = Kinematics::FOOT; j < Kinematics::BODY; ++j) {
+         b2f = prod(b2f, links[j]);
+      }
+      checkClose(kinematics.evaluateDHChain(Kinematics::FOOT, Kinematics::BODY,
+                                            Kinematics::LEFT_CHAIN), b2f);
+      checkClose(kinematics.evaluateDHChain(Kinematics::FOOT, Kinematics::NECK,
+                                            Kinematics::LEFT_CHAIN),
+                 prod(b2f, links[Kinematics::BODY]));
+
+      for (int foot = 0; foot < 2; ++foot) {
+         Kinematics::Chain chain = (Kinematics::Chain) foot;
+
+         // The cached chain products must agree with walking the links
+         checkClose(kinematics.evaluateDHChain(Kinematics::FOOT,
+                                               Kinematics::CAMERA, chain),
+                    prod(kinematics.evaluateDHChain(Kinematics::FOOT,
+                                                    Kinematics::NECK, chain),
+                         kinematics.evaluateDHChain(Kinematics::NECK,
+                                                    Kinematics::CAMERA, chain)));
+
+         // Lean correction and foot to world, written out with ublas
+         matrix<float> hip = kinematics.evaluateDHChain(Kinematics::FOOT,
+                                                        Kinematics::BODY, chain);
+         float forwardLean = sensorValues.sensors[Sensors::InertialSensor_AngleY] +
+                             DEG2RAD(kinematics.parameters.bodyPitch);
+         float sideLean = sensorValues.sensors[Sensors::InertialSensor_AngleX];
+         matrix<float> lean = createDHMatrix<float>(hip(0, 3), 0, 0, 0);
+         lean = prod(lean, createDHMatrix<float>(0, 0, hip(2, 3), M_PI / 2));
+         lean = prod(lean, createDHMatrix<float>(hip(1, 3), 0, 0, 0));
+         lean = prod(lean, createDHMatrix<float>(0, forwardLean, 0, -M_PI / 2));
+         lean = prod(lean, createDHMatrix<float>(0, sideLean, 0, 0));
+         for (int top = 0; top < 2; ++top) {
+            checkClose(kinematics.createCameraToFootTransform(chain, top),
+                       prod(lean, kinematics.evaluateDHChain(Kinematics::BODY,
+                                                             Kinematics::CAMERA,
+                                                             chain, top)));
+         }
+
+         matrix<float> other = kinematics.evaluateDHChain(
+            Kinematics::FOOT, Kinematics::BODY, (Kinematics::Chain) !foot);
+         matrix<float> otherInverse(4, 4);
+         invertMatrix(other, otherInverse);
+         matrix<float> between = prod(otherInverse, hip);
+         matrix<float> f2w = prod(
+            rotateZMatrix<float>(-atan2f(between(1, 0), between(0, 0)) / 2.0),
+            translateMatrix<float>(-between(0, 3) / 2, -between(1, 3) / 2, 0));
+         checkClose(kinematics.createFootToWorldTransform(chain), f2w);
+         checkClose(kinematics.createCameraToWorldTransform(chain, true),
+                    prod(f2w, kinematics.createCameraToFootTransform(chain, true)));
+         checkClose(kinematics.createNeckToWorldTransform(chain),
+                    prod(f2w, kinematics.createNeckToFootTransform(chain)));
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(exclusion_reused_until_head_moves)
+{
+   SensorValues sensorValues;
+   for (int j = 0; j < Joints::NUMBER_OF_JOINTS; ++j) {
+      sensorValues.joints.angles[j] = 0;
+   }
+   for (int j = 0; j < Sensors::NUMBER_OF_SENSORS; ++j) {
+      sensorValues.sensors[j] = 0;
+   }
+   sensorValues.joints.angles[Joints::HeadPitch] = 0.4;
+
+   Kinematics kinematics;
+   memset(&kinematics.parameters, 0, sizeof(kinematics.parameters));
+   kinematics.setSensorValues(sensorValues);
+   kinematics.updateDHChain();
+   Pose first = kinematics.getPose();
+
+   // A jitter below the threshold keeps the previous arrays
+   sensorValues.joints.angles[Joints::HeadYaw] = DEG2RAD(0.05);
+   kinematics.setSensorValues(sensorValues);
+   kinematics.updateDHChain();
+   Pose jittered = kinematics.getPose();
+   BOOST_CHECK(std::equal(first.getBotExclusionArray(),
+                          first.getBotExclusionArray() +
+                          Pose::EXCLUSION_RESOLUTION,
+                          jittered.getBotExclusionArray()));
+
+   // A real head turn must give the same arrays as starting from scratch
+   sensorValues.joints.angles[Joints::HeadYaw] = 0.5;
+   kinematics.setSensorValues(sensorValues);
+   kinematics.updateDHChain();
+   Pose turned = kinematics.getPose();
+
+   Kinematics fresh;
+   fresh.parameters = kinematics.parameters;
+   fresh.setSensorValues(sensorValues);
+   fresh.updateDHChain();
+   Pose expected = fresh.getPose();
+   BOOST_CHECK(std::equal(expected.getBotExclusionArray(),
+                          expected.getBotExclusionArray() +
+                          Pose::EXCLUSION_RESOLUTION,
+                          turned.getBotExclusionArray()));
+   BOOST_CHECK(!std::equal(first.getBotExclusionArray(),
+                           first.getBotExclusionArray() +
+                           Pose::EXCLUSION_RESOLUTION,
+                           turned.getBotExclusionArray()));
+
+   // So must a calibration change with the head still
+   kinematics.parameters.cameraPitchBottom = 3;
+   kinematics.updateDHChain();
+   Pose recalibrated = kinematics.getPose();
+
+   fresh.parameters = kinematics.parameters;
+   fresh.updateDHChain();
+   expected = fresh.getPose();
+   BOOST_CHECK(std::equal(expected.getBotExclusionArray(),
+                          expected.getBotExclusionArray() +
+                          Pose::EXCLUSION_RESOLUTION,
+                          recalibrated.getBotExclusionArray()));
+   BOOST_CHECK(!std::equal(turned.getBotExclusionArray(),
+                           turned.getBotExclusionArray() +
+                           Pose::EXCLUSION_RESOLUTION,
+                           recalibrated.getBotExclusionArray()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
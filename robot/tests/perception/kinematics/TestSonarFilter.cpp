@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "motion/SonarRecorder.hpp"
+#include "perception/kinematics/SonarFilter.hpp"
+
+BOOST_AUTO_TEST_SUITE(sonar_filter)
+
+/* Sorts and clusters a whole window at once, as SonarFilter used to */
+static std::vector<int> batchCluster(std::vector<int> sonar) {
+   std::sort(sonar.begin(), sonar.end());
+   std::vector<int> result;
+   if (sonar.empty()) return result;
+
+   int sum = sonar[0];
+   int count = 1;
+   int mean = sonar[0];
+   for (unsigned int i = 1; i < sonar.size(); i++) {
+      if (std::abs(sonar[i] - mean) < MERGE_CUTOFF) {
+         count++;
+         sum += sonar[i];
+         mean = sum / count;
+      } else {
+         if (count >= CONFIDENCE_CUTOFF || mean < 0.35f) {
+            result.push_back(mean);
+         }
+         sum = sonar[i];
+         count = 1;
+         mean = sonar[i];
+      }
+   }
+   if (count >= CONFIDENCE_CUTOFF || mean < 0.35f) {
+      result.push_back(mean);
+   }
+   return result;
+}
+
+/* A ping off a few obstacles that drift, with noise and the odd stray */
+static SonarPing syntheticPing(const int obstacles[3]) {
+   SonarPing ping;
+   ping.count = rand() % (Sonar::NUMBER_OF_READINGS / 2 + 1);
+   for (int i = 0; i < ping.count; i++) {
+      if (rand() % 8 == 0) {
+         ping.readings[i] = 250 + rand() % 2300;
+      } else {
+         ping.readings[i] = obstacles[rand() % 3] + rand() % 121 - 60;
+      }
+   }
+   return ping;
+}
+
+BOOST_AUTO_TEST_CASE(incremental_clusters_match_batch_clustering)
+{
+   srand(42);
+   SonarWindow window;
+   SonarFilter filter;
+   std::deque<SonarPing> recent[Sonar::SIZE];
+   int obstacles[3] = {400, 900, 1500};
+
+   for (int tick = 0; tick < 5000; tick++) {
+      for (int o = 0; o < 3; o++) {
+         obstacles[o] += rand() % 21 - 10;
+      }
+
+      // at most as many new pings as the ring holds between updates
+      int pushes = rand() % 3;
+      for (int p = 0; p < pushes; p++) {
+         int d = rand() % Sonar::SIZE;
+         SonarPing ping = syntheticPing(obstacles);
+         window.pings[d].push(0, ping);
+         recent[d].push_back(ping);
+         if (recent[d].size() > WINDOW_SIZE) recent[d].pop_front();
+      }
+      filter.update(&window);
+
+      for (int d = 0; d < Sonar::SIZE; d++) {
+         std::vector<int> readings;
+         for (unsigned int p = 0; p < recent[d].size(); p++) {
+            readings.insert(readings.end(), recent[d][p].readings,
+                            recent[d][p].readings + recent[d][p].count);
+         }
+         std::vector<int> expected = batchCluster(readings);
+         BOOST_REQUIRE_EQUAL_COLLECTIONS(
+            filter.sonarFiltered[d].begin(), filter.sonarFiltered[d].end(),
+            expected.begin(), expected.end());
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
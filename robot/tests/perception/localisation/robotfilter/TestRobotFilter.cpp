@@ -70,4 +70,31 @@ BOOST_AUTO_TEST_CASE(cartesian_single_robot_group) {
     BOOST_CHECK_EQUAL(obstacles.size(), (unsigned int)3);
 }
 
+//An observation closer to the second group should go to it, leaving the first
+//group free to take an observation only it can reach, rather than the first
+//group taking its closest observation and the other one starting a new group.
+BOOST_AUTO_TEST_CASE(closest_pair_assigned_first) {
+    RobotFilter robotFilter;
+
+    RobotInfo robotA, robotB;
+    robotA.rr = RRCoord(CMs(100), 0);
+    robotB.rr = RRCoord(CMs(100), DEG2RAD(20));
+
+    std::vector<RobotInfo> visualRobots;
+    visualRobots.push_back(robotA);
+    visualRobots.push_back(robotB);
+    robotFilter.update(createUpdate(visualRobots, CENTER_FIELD, 0, EMPTY_ODOMETRY, false));
+    BOOST_CHECK_EQUAL(robotFilter.groupedRobots.size(), (unsigned int)2);
+
+    RobotInfo robotP, robotQ;
+    robotP.rr = RRCoord(CMs(100), DEG2RAD(12));  //Can merge into A and B, closer to B
+    robotQ.rr = RRCoord(CMs(100), DEG2RAD(-14)); //Can only merge into A
+
+    visualRobots.clear();
+    visualRobots.push_back(robotP);
+    visualRobots.push_back(robotQ);
+    robotFilter.update(createUpdate(visualRobots, CENTER_FIELD, 0, EMPTY_ODOMETRY, false));
+    BOOST_CHECK_EQUAL(robotFilter.groupedRobots.size(), (unsigned int)2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
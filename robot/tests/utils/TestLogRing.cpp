@@ -0,0 +1,77 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "utils/LogRing.hpp"
+
+BOOST_AUTO_TEST_SUITE(log_ring)
+
+BOOST_AUTO_TEST_CASE(drops_rather_than_overwrites)
+{
+   LogRing *ring = new LogRing();
+   BOOST_CHECK(ring->peek() == NULL);
+
+   for (uint32_t i = 0; i < LogRing::SLOTS; ++i) {
+      LogRing::Record *record = ring->claim();
+      BOOST_REQUIRE(record != NULL);
+      record->header.length = i;
+      ring->commit();
+   }
+   BOOST_CHECK(ring->claim() == NULL);
+
+   BOOST_REQUIRE(ring->peek() != NULL);
+   BOOST_CHECK_EQUAL(ring->peek()->header.length, 0u);
+   ring->release();
+   BOOST_REQUIRE(ring->claim() != NULL);
+   ring->claim()->header.length = LogRing::SLOTS;
+   ring->commit();
+
+   for (uint32_t i = 1; i <= LogRing::SLOTS; ++i) {
+      BOOST_REQUIRE(ring->peek() != NULL);
+      BOOST_CHECK_EQUAL(ring->peek()->header.length, i);
+      ring->release();
+   }
+   BOOST_CHECK(ring->peek() == NULL);
+   delete ring;
+}
+
+static void logLines(LogRing *ring, int count) {
+   for (int i = 0; i < count; ++i) {
+      LogRing::Record *record;
+      while ((record = ring->claim()) == NULL) {
+         boost::this_thread::yield();
+      }
+      record->header.timestamp = i;
+      record->header.length =
+         snprintf(record->text, LogRing::TEXT_LENGTH, "%d\n", i);
+      ring->commit();
+   }
+}
+
+BOOST_AUTO_TEST_CASE(records_arrive_whole_and_in_order)
+{
+   const int COUNT = 200000;
+   LogRing *ring = new LogRing();
+   boost::thread writer(logLines, ring, COUNT);
+
+   int next = 0;
+   bool whole = true;
+   while (next < COUNT) {
+      const LogRing::Record *record = ring->peek();
+      if (record == NULL) {
+         continue;
+      }
+      whole &= record->header.timestamp == next &&
+               atoi(record->text) == next;
+      ring->release();
+      ++next;
+   }
+   writer.join();
+   BOOST_CHECK(whole);
+   BOOST_CHECK(ring->peek() == NULL);
+   delete ring;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
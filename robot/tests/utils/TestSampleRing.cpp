@@ -0,0 +1,76 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "utils/SampleRing.hpp"
+
+BOOST_AUTO_TEST_SUITE(sample_ring)
+
+BOOST_AUTO_TEST_CASE(lagged_and_timed_reads)
+{
+   SampleRing<int, 4> ring;
+   int sample;
+   int64_t timestamp;
+   BOOST_CHECK(!ring.getLagged(0, &sample));
+   BOOST_CHECK_EQUAL(ring.findLag(100), -1);
+
+   for (int i = 0; i < 6; ++i) {
+      ring.push(i * 10, i);
+   }
+   BOOST_CHECK_EQUAL(ring.size(), 6u);
+
+   BOOST_REQUIRE(ring.getLagged(0, &sample, &timestamp));
+   BOOST_CHECK_EQUAL(sample, 5);
+   BOOST_CHECK_EQUAL(timestamp, 50);
+   BOOST_REQUIRE(ring.getLagged(3, &sample));
+   BOOST_CHECK_EQUAL(sample, 2);
+
+   // Only the last 4 are kept
+   BOOST_CHECK(!ring.getLagged(4, &sample));
+
+   BOOST_REQUIRE(ring.get(2, &sample, &timestamp));
+   BOOST_CHECK_EQUAL(sample, 2);
+   BOOST_CHECK_EQUAL(timestamp, 20);
+   BOOST_CHECK(!ring.get(1, &sample));
+   BOOST_CHECK(!ring.get(6, &sample));
+
+   BOOST_CHECK_EQUAL(ring.findLag(100), 0);
+   BOOST_CHECK_EQUAL(ring.findLag(35), 2);
+   BOOST_CHECK_EQUAL(ring.findLag(30), 2);
+   BOOST_CHECK_EQUAL(ring.findLag(19), -1);
+}
+
+struct Block {
+   int values[64];
+};
+
+static void writeBlocks(SampleRing<Block, 8> *ring, int count) {
+   Block block;
+   for (int i = 0; i < count; ++i) {
+      for (int j = 0; j < 64; ++j) {
+         block.values[j] = i;
+      }
+      ring->push(i, block);
+   }
+}
+
+BOOST_AUTO_TEST_CASE(reads_are_never_torn)
+{
+   const int COUNT = 200000;
+   SampleRing<Block, 8> ring;
+   boost::thread writer(writeBlocks, &ring, COUNT);
+
+   Block block;
+   int64_t timestamp;
+   bool torn = false;
+   while (ring.size() < (uint32_t)COUNT && !torn) {
+      if (ring.getLagged(7, &block, &timestamp)) {
+         for (int j = 0; j < 64; ++j) {
+            torn |= block.values[j] != timestamp;
+         }
+      }
+   }
+   writer.join();
+   BOOST_CHECK(!torn);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,76 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "utils/Seqlock.hpp"
+
+BOOST_AUTO_TEST_SUITE(seqlock)
+
+BOOST_AUTO_TEST_CASE(reads_the_last_write)
+{
+   Seqlock<int> value(3);
+   BOOST_CHECK_EQUAL(value.read(), 3);
+   BOOST_CHECK_EQUAL(value.version().number(), 0u);
+
+   value.write(5);
+   value.write(7);
+   BOOST_CHECK_EQUAL(value.read(), 7);
+   BOOST_CHECK_EQUAL(value.version().number(), 2u);
+
+   Seqlock<int> copy(value);
+   BOOST_CHECK_EQUAL(copy.read(), 7);
+}
+
+struct Block {
+   int values[64];
+};
+
+static void writeBlocks(Seqlock<Block> *value, int count) {
+   Block block;
+   for (int i = 1; i <= count; ++i) {
+      for (int j = 0; j < 64; ++j) {
+         block.values[j] = i;
+      }
+      value->write(block);
+   }
+}
+
+BOOST_AUTO_TEST_CASE(reads_are_never_torn)
+{
+   const int COUNT = 200000;
+   Block zero = {{0}};
+   Seqlock<Block> value(zero);
+   boost::thread writer(writeBlocks, &value, COUNT);
+
+   bool torn = false;
+   int last = 0;
+   while (last < COUNT && !torn) {
+      const Block &block = value.read();
+      for (int j = 0; j < 64; ++j) {
+         torn |= block.values[j] != block.values[0];
+      }
+      torn |= block.values[0] < last;
+      last = block.values[0];
+   }
+   writer.join();
+   BOOST_CHECK(!torn);
+}
+
+static void readOnce(Seqlock<int> *value, int *index) {
+   value->read();
+   *index = threadIndex();
+}
+
+BOOST_AUTO_TEST_CASE(thread_indices_are_reused)
+{
+   // Far more threads than there are indices, one after another
+   Seqlock<int> value(1);
+   for (int i = 0; i < 4 * MAX_THREAD_INDICES; ++i) {
+      int index = -1;
+      boost::thread reader(readOnce, &value, &index);
+      reader.join();
+      BOOST_REQUIRE_GE(index, 0);
+      BOOST_REQUIRE_LT(index, MAX_THREAD_INDICES);
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,79 @@
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "utils/SnapshotBuffer.hpp"
+
+BOOST_AUTO_TEST_SUITE(snapshot_buffer)
+
+BOOST_AUTO_TEST_CASE(acquires_the_last_publish)
+{
+   SnapshotBuffer<std::vector<int> > buffer;
+   BOOST_CHECK(buffer.acquire().empty());
+
+   buffer.publish(std::vector<int>(3, 1));
+   const std::vector<int> &held = buffer.acquire();
+   BOOST_CHECK_EQUAL(held.size(), 3u);
+   BOOST_CHECK_EQUAL(buffer.version().number(), 1u);
+
+   // What a thread holds does not change under it
+   for (int i = 0; i < 10; ++i) {
+      buffer.publish(std::vector<int>(i, 2));
+   }
+   BOOST_CHECK_EQUAL(held.size(), 3u);
+   BOOST_CHECK_EQUAL(held[0], 1);
+   BOOST_CHECK_EQUAL(buffer.acquire().size(), 9u);
+   BOOST_CHECK_EQUAL(buffer.version().number(), 11u);
+}
+
+static void publishVectors(SnapshotBuffer<std::vector<int> > *buffer,
+                           int count) {
+   std::vector<int> v;
+   for (int i = 1; i <= count; ++i) {
+      v.assign(1 + i % 32, i);
+      buffer->publish(v);
+   }
+}
+
+static void acquireVectors(SnapshotBuffer<std::vector<int> > *buffer,
+                           int count, bool *torn) {
+   int last = 0;
+   while (last < count && !*torn) {
+      const std::vector<int> &v = buffer->acquire();
+      if (v.empty()) {
+         continue;
+      }
+      bool bad = v.size() != (size_t)(1 + v[0] % 32) || v[0] < last;
+      for (size_t j = 0; j < v.size(); ++j) {
+         bad |= v[j] != v[0];
+      }
+      // Reading it twice catches it being overwritten while held
+      for (size_t j = 0; j < v.size(); ++j) {
+         bad |= v[j] != v[0];
+      }
+      *torn |= bad;
+      last = v[0];
+   }
+}
+
+BOOST_AUTO_TEST_CASE(many_readers_never_see_torn_values)
+{
+   const int COUNT = 200000;
+   const int READERS = 3;
+   SnapshotBuffer<std::vector<int> > buffer;
+   bool torn[READERS] = {false};
+
+   boost::thread_group readers;
+   for (int r = 0; r < READERS; ++r) {
+      readers.create_thread(boost::bind(acquireVectors, &buffer, COUNT,
+                                        &torn[r]));
+   }
+   publishVectors(&buffer, COUNT);
+   readers.join_all();
+   for (int r = 0; r < READERS; ++r) {
+      BOOST_CHECK(!torn[r]);
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "utils/Timer.hpp"
+#include "utils/Version.hpp"
+
+BOOST_AUTO_TEST_SUITE(version)
+
+BOOST_AUTO_TEST_CASE(counts_and_stamps_changes)
+{
+   Version version;
+   BOOST_CHECK_EQUAL(version.number(), 0u);
+   BOOST_CHECK_EQUAL(version.timestamp(), 0);
+
+   version.bump();
+   version.bump();
+   BOOST_CHECK_EQUAL(version.number(), 2u);
+   BOOST_CHECK(version.timestamp() > 0);
+   BOOST_CHECK(version.changedSince(1));
+   BOOST_CHECK(!version.changedSince(2));
+   BOOST_CHECK(version.wait(1, 0));
+
+   Version copy(version);
+   BOOST_CHECK_EQUAL(copy.number(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(wait_times_out)
+{
+   Version version;
+   Timer timer;
+   BOOST_CHECK(!version.wait(0, 20));
+   BOOST_CHECK(timer.elapsed_ms() >= 20);
+}
+
+static void bumpLater(Version *version) {
+   boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+   version->bump();
+}
+
+BOOST_AUTO_TEST_CASE(wait_wakes_on_change)
+{
+   Version version;
+   boost::thread writer(bumpLater, &version);
+   BOOST_CHECK(version.wait(0, 5000));
+   BOOST_CHECK_EQUAL(version.number(), 1u);
+   writer.join();
+}
+
+static void bumpMany(Version *version, int count) {
+   for (int i = 0; i < count; ++i) {
+      version->bump();
+   }
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_bumps_are_all_counted)
+{
+   const int COUNT = 100000;
+   Version version;
+   boost::thread first(bumpMany, &version, COUNT);
+   boost::thread second(bumpMany, &version, COUNT);
+   first.join();
+   second.join();
+   BOOST_CHECK_EQUAL(version.number(), 2u * COUNT);
+   // returns, rather than spinning on a timestamp left half written
+   BOOST_CHECK(version.timestamp() > 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
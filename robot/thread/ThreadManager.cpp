@@ -1,18 +1,166 @@
 #include "ThreadManager.hpp"
 
+#include <boost/algorithm/string/case_conv.hpp>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 class Blackboard;
 class ThreadManager;
 
 ConcurrentMap<pthread_t, jmp_buf*> jumpPoints;
 
 using namespace std;
+using boost::algorithm::to_lower_copy;
+namespace po = boost::program_options;
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
 
-ThreadManager::ThreadManager(std::string name, int cycleTime) {
+static int64_t toUs(const struct timespec &t) {
+   return (int64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+ThreadManager::ThreadManager(std::string name, int cycleTime, int budget) {
    this->name = name;
    this->cycleTime = cycleTime;
+   this->budget = budget ? budget : cycleTime;
    running = false;
-   // register thread name
+   priority = 0;
+   cpu = -1;
+   watchdogSeconds = 0;
+   hasWatchdog = false;
+   wakes = 0;
+   latenessSquares = 0.0;
+   published = NULL;
+   strncpy(timing.name, name.c_str(), sizeof(timing.name) - 1);
+}
 
+void ThreadManager::configure(Blackboard *bb, pthread_attr_t *attr) {
+   const po::variables_map &config = bb->config;
+   const string prefix = "thread." + to_lower_copy(name);
+   if (config.count(prefix + ".priority")) {
+      priority = config[prefix + ".priority"].as<int>();
+      cpu = config[prefix + ".cpu"].as<int>();
+      watchdogSeconds = config[prefix + ".watchdog"].as<int>();
+   }
+
+   if (priority > 0) {
+      struct sched_param param;
+      param.sched_priority = priority;
+      pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+      pthread_attr_setschedpolicy(attr, SCHED_FIFO);
+      pthread_attr_setschedparam(attr, &param);
+   }
+   if (cpu >= 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(cpu, &cpus);
+      pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus);
+   }
+
+   if (bb->thread.numTimings < MAX_TIMED_THREADS) {
+      published = &bb->thread.timings[bb->thread.numTimings];
+      published->write(timing);
+      ++bb->thread.numTimings;
+   }
+}
+
+void ThreadManager::startWatchdog() {
+   if (watchdogSeconds <= 0) {
+      return;
+   }
+   // Delivered to this thread only, so every thread can have its own
+   struct sigevent event;
+   memset(&event, 0, sizeof(event));
+   event.sigev_notify = SIGEV_THREAD_ID;
+   event.sigev_signo = SIGALRM;
+   event.sigev_notify_thread_id = syscall(SYS_gettid);
+   signal(SIGALRM, overtimeAlert);
+   hasWatchdog = timer_create(CLOCK_MONOTONIC, &event, &watchdog) == 0;
+   if (!hasWatchdog) {
+      llog(ERROR) << "Could not create a watchdog for " << name << endl;
+   }
+}
+
+void ThreadManager::armWatchdog(bool arm) {
+   if (!hasWatchdog) {
+      return;
+   }
+   // Keeps alerting every watchdogSeconds for as long as the tick is stuck
+   struct itimerspec value;
+   value.it_value.tv_sec = arm ? watchdogSeconds : 0;
+   value.it_value.tv_nsec = 0;
+   value.it_interval = value.it_value;
+   timer_settime(watchdog, 0, &value, NULL);
+}
+
+void ThreadManager::stopWatchdog() {
+   if (hasWatchdog) {
+      timer_delete(watchdog);
+      hasWatchdog = false;
+   }
+}
+
+void ThreadManager::finishTick(int32_t elapsed) {
+   llog(INFO) << "Thread '" << name << "' took "
+              << elapsed << " us." << std::endl;
+   ++timing.ticks;
+   timing.lastTick = elapsed;
+   timing.maxTick = std::max(timing.maxTick, elapsed);
+   if (budget > 0 && elapsed > budget) {
+      ++timing.overruns;
+      llog(ERROR) << "WARNING: Thread " + name +
+      " ran overtime" << ": " << elapsed / 1000  << "ms!" <<
+      std::endl;
+      if (elapsed >= 1000000)
+         SAY(name + " overtime");
+   }
+   if (published) {
+      published->write(timing);
+   }
+}
+
+void ThreadManager::waitForNextTick(const Version *event, uint32_t *seen) {
+   struct timespec now;
+   if (cycleTime > 0) {
+      deadline.tv_nsec += (cycleTime % 1000000) * 1000L;
+      deadline.tv_sec += cycleTime / 1000000 + deadline.tv_nsec / 1000000000L;
+      deadline.tv_nsec %= 1000000000L;
+
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      if (toUs(now) >= toUs(deadline)) {
+         // Missed it, start a new schedule from now rather than bursting
+         deadline = now;
+      } else {
+         while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+                                NULL) == EINTR && !attemptingShutdown) {
+         }
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         const int32_t lateness = toUs(now) - toUs(deadline);
+         ++wakes;
+         timing.lastLateness = lateness;
+         timing.maxLateness = std::max(timing.maxLateness, lateness);
+         // Welford's running mean and variance
+         const double difference = lateness - timing.meanLateness;
+         timing.meanLateness += difference / wakes;
+         latenessSquares += difference * (lateness - timing.meanLateness);
+         timing.latenessDeviation = sqrt(latenessSquares / wakes);
+      }
+   }
+
+   if (event) {
+      // Without a cycle time still wake up now and then to check for shutdown
+      event->wait(*seen, cycleTime > 0 ? cycleTime / 1000 : 1000);
+      *seen = event->number();
+      if (cycleTime > 0) {
+         // The schedule follows the event
+         clock_gettime(CLOCK_MONOTONIC, &deadline);
+      }
+   }
 }
 
 void ThreadManager::join() {
@@ -26,16 +174,8 @@ ThreadManager::~ThreadManager() {
    join();
 }
 
-
 void overtimeAlert(int) {
    SAY(std::string(Thread::name) + " thread has frozen");
-   signal(SIGALRM, overtimeAlert);
-   struct itimerval itval5;
-   itval5.it_value.tv_sec = 5;
-   itval5.it_value.tv_usec = 0;
-   itval5.it_interval.tv_sec = 0;
-   itval5.it_interval.tv_usec = 0;
-   setitimer(ITIMER_REAL, &itval5, NULL);
 }
 
 /**
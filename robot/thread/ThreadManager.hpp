@@ -4,12 +4,15 @@
 #include <signal.h>
 #include <setjmp.h>
 #include <sys/time.h>
+#include <time.h>
 #include <string>
 #include <thread/Thread.hpp>
 #include <utils/speech.hpp>
 #include <utils/ConcurrentMap.hpp>
 #include <utils/Timer.hpp>
+#include <blackboard/Adapter.hpp>
 #include <blackboard/Blackboard.hpp>
+#include <types/ThreadTiming.hpp>
 
 #define ALL_SIGNALS -1  // for indicating that we should register
                         // all signal handlers
@@ -31,6 +34,19 @@ void overtimeAlert(int);
 void handleSignals(int sigNumber, siginfo_t* info, void*);
 void registerSignalHandlers(int signal = ALL_SIGNALS);
 
+/**
+ * Runs a module's tick() in its own thread, restarting it if it crashes.
+ *
+ * Threads with a cycle time tick on absolute deadlines, so the time a tick
+ * takes does not push the next one back. A tick that runs past its deadline
+ * starts a new schedule rather than bursting to catch up. Threads without a
+ * cycle time tick back to back, and are expected to block on I/O. Modules
+ * that specialise WakeEvent also tick as soon as that event happens.
+ *
+ * The thread's SCHED_FIFO priority, CPU and watchdog come from the
+ * thread.<name>.* options, and how well it keeps to its schedule is
+ * published on the blackboard in thread.timings.
+ */
 class ThreadManager {
    public:
       std::string name;
@@ -38,7 +54,13 @@ class ThreadManager {
       pthread_t pthread;
       bool running;
 
-      ThreadManager(std::string name, int cycleTime);
+      /**
+       * @param cycleTime period (us) to tick at, 0 to tick back to back, or
+       *                  -1 for modules that do not tick
+       * @param budget how long (us) a tick may take before it counts as an
+       *               overrun, 0 for the cycle time
+       */
+      ThreadManager(std::string name, int cycleTime, int budget = 0);
 
       template <class T> void run(Blackboard *bb);
 
@@ -51,6 +73,44 @@ class ThreadManager {
       template <class T>
       void safelyRun(Blackboard *bb);
       SafelyRunArgs args;
+
+      int budget;
+      int priority;
+      int cpu;
+      int watchdogSeconds;
+
+      /* Per-thread timer that alerts us about stuck threads */
+      timer_t watchdog;
+      bool hasWatchdog;
+
+      /* When the next periodic tick is due, on CLOCK_MONOTONIC */
+      struct timespec deadline;
+
+      ThreadTiming timing;
+      uint32_t wakes;
+      /* Sum of squared differences of lateness from its mean so far */
+      double latenessSquares;
+      Seqlock<ThreadTiming> *published;
+
+      /**
+       * Reads this thread's options and sets up how it is created
+       */
+      void configure(Blackboard *bb, pthread_attr_t *attr);
+
+      void startWatchdog();
+      void armWatchdog(bool arm);
+      void stopWatchdog();
+
+      /**
+       * Accounts for a tick that took elapsed us
+       */
+      void finishTick(int32_t elapsed);
+
+      /**
+       * Sleeps until the next deadline, then until event changes since seen
+       * if the module has one, waiting at most another cycle for it
+       */
+      void waitForNextTick(const Version *event, uint32_t *seen);
 };
 
 #include "ThreadManager.tcc"
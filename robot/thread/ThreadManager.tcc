@@ -11,22 +11,27 @@ template <class T> void ThreadManager::run(Blackboard *bb) {
    args.blackboard = bb;
    args.threadManager = this;
    llog(INFO) << "Running ThreadManager for " << name << std::endl;
-   if (name == "Motion") {
-      // set up real-time priorities
+
+   pthread_attr_t attr;
+   pthread_attr_init(&attr);
+   configure(bb, &attr);
+   if (pthread_create(&pthread, &attr,
+                      &thunk<ThreadManager, &ThreadManager::safelyRun<T> >,
+                      &args)) {
+      llog(ERROR) << "Could not start " << name << " with priority "
+                  << priority << " on cpu " << cpu
+                  << ", starting it normally" << std::endl;
+      pthread_create(&pthread, NULL,
+                     &thunk<ThreadManager, &ThreadManager::safelyRun<T> >,
+                     &args);
+   }
+   pthread_attr_destroy(&attr);
+   if (priority > 0) {
       struct sched_param param;
       int policy;
-      pthread_attr_t attr;
-      pthread_attr_init(&attr);
-      pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-      pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
-      param.sched_priority = 65;
-      pthread_attr_setschedparam(&attr, &param);
-      pthread_create(&pthread, &attr, &thunk<ThreadManager, &ThreadManager::safelyRun<T> >, &args);
-      pthread_attr_destroy(&attr);
       pthread_getschedparam(pthread, &policy, &param);
-      llog(INFO) << "Motion granted priority: " << param.sched_priority << std::endl;
-   } else {
-      pthread_create(&pthread, NULL, &thunk<ThreadManager, &ThreadManager::safelyRun<T> >, &args);
+      llog(INFO) << name << " granted priority: " << param.sched_priority
+                 << std::endl;
    }
    running = true;
 
@@ -39,9 +44,7 @@ void ThreadManager::safelyRun(Blackboard *bb) {
    llog(INFO) << "Registering thread name '" << name
               << "' with ID " << threadID << std::endl;
 
-   if (name == "Perception") {
-      signal(SIGALRM, overtimeAlert);
-   }
+   startWatchdog();
    while (!attemptingShutdown) {
       try {
          // we don't care if this leaks
@@ -56,47 +59,20 @@ void ThreadManager::safelyRun(Blackboard *bb) {
          // register jump point for where to resume if we crash
          if (!setjmp(*jumpPoints[threadID])) {
             T t(bb);
-            Timer timer;
-            int32_t elapsed = 0.0;
+            const Version *event = WakeEvent<T>::of(bb);
+            uint32_t seen = event ? event->number() : 0;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
             while (!attemptingShutdown) {
-               timer.restart();
-
                if (cycleTime != -1) {
-                  // set watchdog timer to alert us about stuck threads
-                  if (name == "Perception") {
-                     struct itimerval itval5;
-                     itval5.it_value.tv_sec = 5;
-                     itval5.it_value.tv_usec = 0;
-                     itval5.it_interval.tv_sec = 0;
-                     itval5.it_interval.tv_usec = 0;
-                     setitimer(ITIMER_REAL, &itval5, NULL);
-                  }
+                  Timer timer;
+                  armWatchdog(true);
 
                   // Execute one cycle of the module
                   t.tick();
 
-                  // unset watchdog timer to alert us about stuck threads
-                  if (name == "Perception") {
-                     struct itimerval itval0;
-                     itval0.it_value.tv_sec = 0;
-                     itval0.it_value.tv_usec = 0;
-                     itval0.it_interval.tv_sec = 0;
-                     itval0.it_interval.tv_usec = 0;
-                     setitimer(ITIMER_REAL, &itval0, NULL);
-                  }
-
-                  elapsed = timer.elapsed_us();
-                  llog(INFO) << "Thread '" << name << "' took "
-                             << elapsed << " us." << std::endl;
-                  if (elapsed < cycleTime) {
-                     usleep(cycleTime - elapsed);
-                  } else if (((name != "Motion") && (name != "Perception")) || ((name == "Perception") && (elapsed >= 50000))){
-                     llog(ERROR) << "WARNING: Thread " + name +
-                     " ran overtime" << ": " << elapsed / 1000  << "ms!" <<
-                     std::endl;
-                     if (elapsed >= 1000000 && name == "perception")
-                        SAY("perception overtime");
-                  }
+                  armWatchdog(false);
+                  finishTick(timer.elapsed_us());
+                  waitForNextTick(event, &seen);
                } else {
                   sleep(10);  // thread does not need a 'tick'
                }
@@ -106,6 +82,7 @@ void ThreadManager::safelyRun(Blackboard *bb) {
                     << "' disabled." << std::endl;
       } catch(const std::exception & e) {
          SAY("exception caught");
+         armWatchdog(false);
          free(jumpPoints[threadID]);
          usleep(500000);
          llog(ERROR) << "exception derivative was caught with error msg: "
@@ -114,6 +91,7 @@ void ThreadManager::safelyRun(Blackboard *bb) {
                      << " with id " << threadID << std::endl;
       } catch(...) {
          SAY("exception caught");
+         armWatchdog(false);
          free(jumpPoints[threadID]);
          usleep(500000);
          llog(ERROR) << "Something was thrown from "
@@ -121,4 +99,5 @@ void ThreadManager::safelyRun(Blackboard *bb) {
                      << " with id " << threadID << std::endl;
       }
    }
+   stopWatchdog();
 }
@@ -30,11 +30,13 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
 #include "OffNao.hpp"
+#include <string.h>
 #include <zlib.h>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -48,7 +50,19 @@ using namespace boost;
 using namespace boost::algorithm;
 namespace po = boost::program_options;
 
-OffNaoTransmitter::OffNaoTransmitter(Blackboard *bb) : Adapter(bb) {
+/**
+ * Writes are asynchronous, so the socket is given room for a few frames at a
+ * time.  Whatever does not fit waits for the next poll of the io_service.
+ */
+static const int SEND_BUFFER_SIZE = 256 * 1024;
+
+OffNaoTransmitter::OffNaoTransmitter(Blackboard *bb)
+   : Adapter(bb),
+     room_(std::max(1, (bb->config)["transmitter.offnao.keyframe"].as<int>())),
+     maxQueued(std::max(1, (bb->config)["transmitter.offnao.queue"].as<int>())) {
+   if ((bb->config)["transmitter.shm"].as<bool>())
+      shm_.open(std::max(2, (bb->config)["transmitter.shm.slots"].as<int>()),
+                (bb->config)["transmitter.shm.mask"].as<int>());
    start_accept();
 }
 
@@ -56,7 +70,8 @@ void OffNaoTransmitter::start_accept(){
    try {
       tcp::endpoint endpoint(tcp::v4(), 10125);
       acceptor_ = new tcp::acceptor(io_service_, endpoint);
-      offnao_session_ptr new_session(new offnao_session(&io_service_, &room_));
+      offnao_session_ptr new_session(new offnao_session(&io_service_, &room_,
+                                                        maxQueued));
 
       acceptor_->async_accept(new_session->socket(),
                               boost::bind(&OffNaoTransmitter::handle_accept,
@@ -72,6 +87,7 @@ void OffNaoTransmitter::tick() {
    llog(VERBOSE) << "ticking away" << endl;
    io_service_.poll();
    room_.deliver(blackboard);
+   shm_.publish(blackboard);
    io_service_.poll();
 }
 
@@ -82,16 +98,15 @@ OffNaoTransmitter::~OffNaoTransmitter() {
 void OffNaoTransmitter::handle_accept(offnao_session_ptr session,
                                       const boost::system::error_code& error) {
    if (!error) {
-      offnao_session_ptr new_session(new offnao_session(&io_service_, &room_));
+      offnao_session_ptr new_session(new offnao_session(&io_service_, &room_,
+                                                        maxQueued));
          acceptor_->async_accept(new_session->socket(),
                               boost::bind(&OffNaoTransmitter::handle_accept,
                                           this, new_session,
                                           boost::asio::placeholders::error));
       session->start(blackboard);
-      boost::asio::socket_base::send_buffer_size option(2048);
+      boost::asio::socket_base::send_buffer_size option(SEND_BUFFER_SIZE);
       session->socket().set_option(option);
-      boost::asio::socket_base::non_blocking_io command(false);
-      session->socket().io_control(command);
       llog(DEBUG1) << "Created wireless link." << endl;
    } else {
       llog(ERROR) << error.message() << endl;
@@ -100,8 +115,10 @@ void OffNaoTransmitter::handle_accept(offnao_session_ptr session,
 }
 
 OffNaoTransmitter::offnao_session::
-offnao_session(boost::asio::io_service* io_service, offnao_room *room)
-   : connection_(io_service), room_(*room), sendingMask(INITIAL_MASK) {}
+offnao_session(boost::asio::io_service* io_service, offnao_room *room,
+               size_t maxQueued)
+   : connection_(io_service), room_(*room), sendingMask(INITIAL_MASK),
+     maxQueued_(maxQueued), synced_(false), syncedMask_(0) {}
 
 tcp::socket& OffNaoTransmitter::offnao_session::socket() {
    return connection_.socket();
@@ -118,21 +135,47 @@ void OffNaoTransmitter::offnao_session::start(Blackboard *blackboard) {
                                        boost::asio::placeholders::error, blackboard));
 }
 
-void OffNaoTransmitter::offnao_session::deliver(Blackboard *blackboard) {
-   // mask set before delivery to attempt to allow multiple clients to stream different things
-   // writeTo(, mask, sendingMask);
-   blackboard->write(&(blackboard->mask), sendingMask);
-   /*
-   connection_.async_write(*blackboard,
-                           boost::bind(&offnao_session::handle_write,
-                                       shared_from_this(),
-                                       boost::asio::placeholders::error));
-   */
-   boost::system::error_code e = connection_.sync_write(*blackboard);
-   if (e)
-      llog(ERROR) << "Failed to write: " << e << endl;
+OffNaoMask_t OffNaoTransmitter::offnao_session::mask() const {
+   return sendingMask;
+}
+
+bool OffNaoTransmitter::offnao_session::synced(OffNaoMask_t mask) const {
+   return synced_ && syncedMask_ == mask;
+}
+
+void OffNaoTransmitter::offnao_session::deliver(const offnao_frame_ptr &frame) {
+   if (frame->keyframe) {
+      // nothing waiting is needed once a whole frame follows it
+      queue_.clear();
+      synced_ = true;
+      syncedMask_ = frame->mask;
+   } else if (queue_.size() >= maxQueued_) {
+      // offnao is not keeping up.  the deltas after those dropped no longer
+      // decode, so send nothing more until the room sends a keyframe
+      llog(DEBUG1) << "Dropped " << queue_.size() + 1 << " frames" << endl;
+      queue_.clear();
+      synced_ = false;
+      return;
+   }
+   queue_.push_back(frame);
+   if (!writing_)
+      write_next();
 }
 
+void OffNaoTransmitter::offnao_session::write_next() {
+   // the frame is held until the write completes, as no copy is made
+   writing_ = queue_.front();
+   queue_.pop_front();
+   boost::asio::async_write(connection_.socket(),
+                            boost::asio::buffer(writing_->data),
+                            boost::bind(&offnao_session::handle_write,
+                                        shared_from_this(),
+                                        boost::asio::placeholders::error));
+}
+
+OffNaoTransmitter::offnao_room::offnao_room(int keyframeInterval)
+   : keyframeInterval_(keyframeInterval) {}
+
 void OffNaoTransmitter::offnao_room::join(offnao_participant_ptr participant) {
    participants_.insert(participant);
 }
@@ -143,14 +186,97 @@ leave(offnao_participant_ptr participant) {
 }
 
 void OffNaoTransmitter::offnao_room::deliver(Blackboard *blackboard) {
-   for_each(participants_.begin(), participants_.end(),
-            boost::bind(&offnao_participant::deliver, _1, boost::ref(blackboard)));
+   typedef map<OffNaoMask_t, vector<offnao_participant_ptr> > Groups;
+   Groups groups;
+   for (set<offnao_participant_ptr>::const_iterator it = participants_.begin();
+        it != participants_.end(); ++it)
+      groups[(*it)->mask()].push_back(*it);
+
+   map<OffNaoMask_t, offnao_stream_ptr>::iterator stream = streams_.begin();
+   while (stream != streams_.end()) {
+      if (groups.count(stream->first))
+         ++stream;
+      else
+         streams_.erase(stream++);
+   }
+
+   for (Groups::const_iterator group = groups.begin(); group != groups.end();
+        ++group) {
+      const OffNaoMask_t mask = group->first;
+      offnao_stream_ptr &stream = streams_[mask];
+      if (!stream)
+         stream.reset(new offnao_stream());
+
+      bool behind = false;
+      for (size_t i = 0; i < group->second.size(); ++i)
+         behind |= !group->second[i]->synced(mask);
+
+      // participants that have had every frame since their keyframe get
+      // only what changed.  any that dropped a frame, joined or changed mask
+      // get a keyframe, as does everyone when one is due.  the stream's
+      // baseline moves on with every frame, so the deltas count since the
+      // last keyframe sent to everyone
+      const bool due = !stream->baseline.covers(mask) ||
+         (int)stream->baseline.deltas + 1 >= keyframeInterval_;
+      offnao_frame_ptr delta, keyframe;
+      if (!due) {
+         delta = stream->encode(blackboard, mask, &stream->baseline);
+         stream->frame.acknowledge(&stream->baseline);
+      }
+      if (!delta || behind) {
+         keyframe = stream->encode(blackboard, mask, NULL);
+         if (!delta)
+            stream->frame.acknowledge(&stream->baseline);
+      }
+
+      for (size_t i = 0; i < group->second.size(); ++i) {
+         const offnao_participant_ptr &participant = group->second[i];
+         participant->deliver(delta && participant->synced(mask) ?
+                              delta : keyframe);
+      }
+   }
+}
+
+OffNaoTransmitter::offnao_frame_ptr
+OffNaoTransmitter::offnao_room::offnao_stream::
+encode(Blackboard *blackboard, OffNaoMask_t mask,
+       const WireBaseline *baseline) {
+   encodeWireFrame(blackboard, mask, true, baseline, &frame);
+
+   boost::shared_ptr<offnao_frame> shared;
+   for (size_t i = 0; i < pool.size() && !shared; ++i)
+      if (pool[i].unique())
+         shared = pool[i];
+   if (!shared) {
+      shared.reset(new offnao_frame());
+      pool.push_back(shared);
+   }
+
+   // images are copied out too, since vision may overwrite them before the
+   // slowest session has been sent them
+   shared->data.resize(frame.size());
+   char *data = shared->data.empty() ? NULL : &shared->data[0];
+   const vector<boost::asio::const_buffer> &buffers = frame.buffers();
+   for (size_t i = 0; i < buffers.size(); ++i) {
+      size_t length = boost::asio::buffer_size(buffers[i]);
+      memcpy(data, boost::asio::buffer_cast<const char *>(buffers[i]), length);
+      data += length;
+   }
+   shared->mask = mask;
+   shared->keyframe = !(frame.header().flags & WIRE_DELTA);
+   return shared;
 }
 
 void OffNaoTransmitter::offnao_session::
 handle_write(boost::system::error_code const& error) {
-   if (error)
+   writing_.reset();
+   if (error) {
+      llog(ERROR) << "Failed to write: " << error.message() << endl;
+      queue_.clear();
       room_.leave(shared_from_this());
+   } else if (!queue_.empty()) {
+      write_next();
+   }
 }
 
 void OffNaoTransmitter::offnao_session::
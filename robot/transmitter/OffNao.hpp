@@ -34,18 +34,25 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <boost/asio.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
+#include <deque>
+#include <map>
 #include <set>
 #include <string>
+#include <vector>
 #include "utils/Connection.hpp"
 #include "blackboard/Blackboard.hpp"
 #include "blackboard/Adapter.hpp"
+#include "transmitter/ShmRing.hpp"
 #include "transmitter/TransmitterDefs.hpp"
+#include "transmitter/WireFormat.hpp"
 
 /**
  * Adapter that allows Vision to communicate with the Blackboard
  * heavily mimics the boost chat server example at
  * http://www.boost.org/doc/libs/1_40_0/doc/html/boost_asio/examples.html
- * except without a message queue
+ * except that each tick is encoded once per mask rather than per session,
+ * and each session's message queue is bounded, dropping frames offnao is
+ * too slow to take rather than holding up the other sessions
  */
 class OffNaoTransmitter : Adapter {
    public:
@@ -68,6 +75,18 @@ class OffNaoTransmitter : Adapter {
        */
       boost::asio::io_service io_service_;
 
+      /**
+       * a frame encoded once for every participant wanting its mask, and
+       * not changed once delivered, so their writes can all share it
+       */
+      struct offnao_frame {
+         std::vector<char> data;
+         OffNaoMask_t mask;
+         bool keyframe;
+      };
+
+      typedef boost::shared_ptr<const offnao_frame> offnao_frame_ptr;
+
       /**
        * just an abstract class requiring a delivery mechanism for a participant.
        */
@@ -75,7 +94,17 @@ class OffNaoTransmitter : Adapter {
          public:
             // TODO(jayen): move the function "bodies" into a cpp file
             virtual ~offnao_participant() {}
-            virtual void deliver(Blackboard *blackboard) = 0;
+            /**
+             * @return the mask to send this participant
+             */
+            virtual OffNaoMask_t mask() const = 0;
+            /**
+             * @return whether this participant has been delivered every
+             *         frame of mask since its last keyframe, so the next
+             *         delta can be decoded
+             */
+            virtual bool synced(OffNaoMask_t mask) const = 0;
+            virtual void deliver(const offnao_frame_ptr &frame) = 0;
       };
 
       typedef boost::shared_ptr<offnao_participant> offnao_participant_ptr;
@@ -85,6 +114,11 @@ class OffNaoTransmitter : Adapter {
        */
       class offnao_room {
          public:
+            /**
+             * @param keyframeInterval frames from one keyframe to the next
+             */
+            explicit offnao_room(int keyframeInterval);
+
             /**
              * adds a "participant" to this "room"
              *
@@ -100,14 +134,41 @@ class OffNaoTransmitter : Adapter {
             void leave(offnao_participant_ptr participant);
 
             /**
-             * delivers a message to all the participants
+             * delivers a message to all the participants, encoding it once
+             * for each mask they want
              *
              * @param blackboard the message to send
              */
             void deliver(Blackboard *blackboard);
 
          private:
+            /**
+             * what the participants wanting one mask have been sent
+             */
+            struct offnao_stream {
+               /**
+                * encodes the blackboard into a frame that can be shared
+                *
+                * @param baseline what to encode a delta against, or NULL for
+                *        a keyframe
+                */
+               offnao_frame_ptr encode(Blackboard *blackboard,
+                                       OffNaoMask_t mask,
+                                       const WireBaseline *baseline);
+
+               WireFrame frame;
+               WireBaseline baseline;
+               /**
+                * frames encoded before, reused once no session holds them
+                */
+               std::vector<boost::shared_ptr<offnao_frame> > pool;
+            };
+
+            typedef boost::shared_ptr<offnao_stream> offnao_stream_ptr;
+
             std::set<offnao_participant_ptr> participants_;
+            std::map<OffNaoMask_t, offnao_stream_ptr> streams_;
+            int keyframeInterval_;
       };
 
       /**
@@ -122,9 +183,11 @@ class OffNaoTransmitter : Adapter {
              *
              * @param io_service the io_service associated with this session
              * @param room the "room" associated with this session
+             * @param maxQueued frames that may wait for the one being
+             *        written before they are dropped
              */
             offnao_session(boost::asio::io_service* io_service,
-                           offnao_room* room);
+                           offnao_room* room, std::size_t maxQueued);
 
             /**
              * @return the socket associated with this session
@@ -136,12 +199,18 @@ class OffNaoTransmitter : Adapter {
              */
             void start(Blackboard *blackboard);
 
+            OffNaoMask_t mask() const;
+            bool synced(OffNaoMask_t mask) const;
+
             /**
-             * delivers messages to this session by binding an asynchronous write
+             * delivers messages to this session by queueing them to be
+             * written to the socket once those before them are.  if too
+             * many are waiting, offnao is not keeping up and they are
+             * dropped until the next keyframe
              *
-             * @param blackboard the message to be delivered
+             * @param frame the message to be delivered
              */
-            void deliver(Blackboard *blackboard);
+            void deliver(const offnao_frame_ptr &frame);
 
             /**
              * handles reads.  sets some internal variables to control what to send.
@@ -152,14 +221,18 @@ class OffNaoTransmitter : Adapter {
             void handle_read(const boost::system::error_code& error, Blackboard *blackboard);
 
             /**
-             * handles writes.  should send packets every tick by scheduling an async
-             * write
+             * handles writes.  starts writing the next frame queued, if any
              *
-             * @param error i don't know... :(
+             * @param error an error, if there was one during writing
              */
             void handle_write(const boost::system::error_code& error);
 
          private:
+            /**
+             * starts an async write of the frame at the front of the queue
+             */
+            void write_next();
+
             Connection connection_;
             offnao_room& room_;
             /**
@@ -170,6 +243,18 @@ class OffNaoTransmitter : Adapter {
              * the mask to send to offnao.  should only be a data mask
              */
             OffNaoMask_t sendingMask;
+            /**
+             * frames waiting for the one being written, oldest first
+             */
+            std::deque<offnao_frame_ptr> queue_;
+            offnao_frame_ptr writing_;
+            std::size_t maxQueued_;
+            /**
+             * whether every frame since the last keyframe has been queued,
+             * and the mask of that keyframe
+             */
+            bool synced_;
+            OffNaoMask_t syncedMask_;
       };
 
       typedef boost::shared_ptr<offnao_session> offnao_session_ptr;
@@ -184,8 +269,30 @@ class OffNaoTransmitter : Adapter {
 
       offnao_room room_;
 
+      /**
+       * frames each session may fall behind before they are dropped
+       */
+      std::size_t maxQueued;
+
+      /**
+       * where blackboards are published for readers on this machine, if
+       * transmitter.shm is set
+       */
+      ShmRingWriter shm_;
+
       /**
        * the acceptor
        */
       boost::asio::ip::tcp::acceptor* acceptor_;
 };
+
+/**
+ * Send each perception frame as soon as it is done, rather than whatever is
+ * on the blackboard when the cycle comes round
+ */
+template <>
+struct WakeEvent<OffNaoTransmitter> {
+   static const Version *of(Blackboard *blackboard) {
+      return &blackboard->changes(&blackboard->perception.total);
+   }
+};
@@ -0,0 +1,320 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "transmitter/ShmRing.hpp"
+
+#include <errno.h>
+#include <fcntl.h>           /* For O_* constants */
+#include <sys/mman.h>        /* For shared memory */
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+#include "blackboard/Blackboard.hpp"
+#include "transmitter/WireFormat.hpp"
+#include "utils/Logger.hpp"
+
+static const std::size_t PAGE_SIZE_ALIGNMENT = 4096;
+
+/* Room for both raw images and saliency, and the structured components */
+static const uint32_t SHM_SLOT_SIZE =
+   2 * sizeof(uint8_t[IMAGE_ROWS * IMAGE_COLS * 2]) +
+   sizeof(Colour[IMAGE_COLS / TOP_SALIENCY_DENSITY]
+                [IMAGE_ROWS / TOP_SALIENCY_DENSITY]) +
+   sizeof(Colour[IMAGE_COLS / BOT_SALIENCY_DENSITY]
+                [IMAGE_ROWS / BOT_SALIENCY_DENSITY]) +
+   (1 << 20);
+
+/* Bytes from one slot to the next, each starting on a page */
+static std::size_t slotStride(uint32_t slotSize) {
+   const std::size_t size = sizeof(ShmSlotHeader) + slotSize;
+   return (size + PAGE_SIZE_ALIGNMENT - 1) / PAGE_SIZE_ALIGNMENT *
+          PAGE_SIZE_ALIGNMENT;
+}
+
+static std::size_t ringLength(uint32_t numSlots, uint32_t slotSize) {
+   return SHM_RING_HEADER_SIZE + numSlots * slotStride(slotSize);
+}
+
+/* The slot frame n of the ring at memory goes in */
+static const ShmSlotHeader *slotOf(const char *memory, uint64_t n) {
+   const ShmRingHeader *header = (const ShmRingHeader *)memory;
+   return (const ShmSlotHeader *)(memory + SHM_RING_HEADER_SIZE +
+                                  (n % header->numSlots) *
+                                  slotStride(header->slotSize));
+}
+
+ShmRingWriter::ShmRingWriter()
+   : fd(-1), memory((char *)MAP_FAILED), length(0), semaphore(SEM_FAILED),
+     header(NULL), frame(new WireFrame()) {}
+
+ShmRingWriter::~ShmRingWriter() {
+   close();
+   delete frame;
+}
+
+bool ShmRingWriter::open(uint32_t numSlots, OffNaoMask_t mask) {
+   close();
+   // the writer may be part way through one slot, so two leave a frame
+   // readers can always decode
+   numSlots = std::max(numSlots, 2u);
+
+   // a ring left by an earlier runswift is unlinked rather than reused, so
+   // readers still mapping it are not cut short if its size changes
+   shm_unlink(SHM_RING_MEMORY);
+   sem_unlink(SHM_RING_SEMAPHORE);
+
+   fd = shm_open(SHM_RING_MEMORY, O_RDWR | O_CREAT, 0600);
+   if (fd < 0) {
+      llog(ERROR) << "ShmRingWriter: shm_open() failed: " << strerror(errno)
+                  << std::endl;
+      return false;
+   }
+   length = ringLength(numSlots, SHM_SLOT_SIZE);
+   if (ftruncate(fd, length) == -1) {
+      llog(ERROR) << "ShmRingWriter: ftruncate() failed: " << strerror(errno)
+                  << std::endl;
+      close();
+      return false;
+   }
+   memory = (char *)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, 0);
+   if (memory == MAP_FAILED) {
+      llog(ERROR) << "ShmRingWriter: mmap() failed: " << strerror(errno)
+                  << std::endl;
+      close();
+      return false;
+   }
+
+   // a new shared memory object is zeroed, so every slot starts empty
+   header = (ShmRingHeader *)memory;
+   header->numSlots = numSlots;
+   header->slotSize = SHM_SLOT_SIZE;
+   header->published = 0;
+   header->mask = mask;
+   // readers check the magic before anything else, so it goes in last
+   __sync_synchronize();
+   memcpy(header->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC));
+
+   semaphore = sem_open(SHM_RING_SEMAPHORE, O_RDWR | O_CREAT, 0600, 0);
+   if (semaphore == SEM_FAILED) {
+      llog(ERROR) << "ShmRingWriter: sem_open() failed: " << strerror(errno)
+                  << std::endl;
+      close();
+      return false;
+   }
+
+   llog(INFO) << "Publishing blackboards to " << SHM_RING_MEMORY << " in "
+              << numSlots << " slots of " << SHM_SLOT_SIZE << " bytes"
+              << std::endl;
+   return true;
+}
+
+void ShmRingWriter::close() {
+   if (memory != MAP_FAILED) munmap(memory, length);
+   if (fd >= 0) ::close(fd);
+   if (semaphore != SEM_FAILED) sem_close(semaphore);
+   fd = -1;
+   memory = (char *)MAP_FAILED;
+   semaphore = SEM_FAILED;
+   header = NULL;
+}
+
+bool ShmRingWriter::publish(Blackboard *blackboard) {
+   if (header == NULL) {
+      return false;
+   }
+
+   // readers are on the same machine, so nothing is compressed
+   encodeWireFrame(blackboard, header->mask, false, NULL, frame);
+   if (frame->size() > header->slotSize) {
+      llog(WARNING) << "ShmRingWriter: a " << frame->size()
+                    << " byte frame does not fit in a slot" << std::endl;
+      return false;
+   }
+
+   const uint64_t n = header->published;
+   ShmSlotHeader *slot = (ShmSlotHeader *)slotOf(memory, n);
+   slot->sequence = 2 * n + 1;
+   __sync_synchronize();
+   char *data = (char *)(slot + 1);
+   const std::vector<boost::asio::const_buffer> &buffers = frame->buffers();
+   for (std::size_t i = 0; i < buffers.size(); ++i) {
+      const std::size_t size = boost::asio::buffer_size(buffers[i]);
+      memcpy(data, boost::asio::buffer_cast<const char *>(buffers[i]), size);
+      data += size;
+   }
+   slot->length = frame->size();
+   __sync_synchronize();
+   slot->sequence = 2 * (n + 1);
+   header->published = n + 1;
+
+   // only V() the semaphore if it is 0, so a reader that was away does not
+   // wake once for each frame it missed
+   int value;
+   sem_getvalue(semaphore, &value);
+   if (value <= 0) {
+      sem_post(semaphore);
+   }
+   return true;
+}
+
+ShmRingReader::ShmRingReader()
+   : fd(-1), memory((const char *)MAP_FAILED), length(0),
+     semaphore(SEM_FAILED), header(NULL), read_(0), dropped_(0) {}
+
+ShmRingReader::~ShmRingReader() {
+   close();
+}
+
+bool ShmRingReader::open(std::string *error) {
+   close();
+
+   fd = shm_open(SHM_RING_MEMORY, O_RDONLY, 0);
+   if (fd < 0) {
+      *error = "No runswift on this machine is publishing blackboards, "
+               "run it with --transmitter.shm true";
+      return false;
+   }
+   struct stat st;
+   if (fstat(fd, &st) == -1 || (std::size_t)st.st_size < SHM_RING_HEADER_SIZE) {
+      *error = "The blackboard ring is still being created";
+      close();
+      return false;
+   }
+   length = st.st_size;
+   memory = (const char *)mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+   if (memory == MAP_FAILED) {
+      *error = std::string("mmap() failed: ") + strerror(errno);
+      close();
+      return false;
+   }
+   header = (const ShmRingHeader *)memory;
+   if (memcmp(header->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC)) != 0 ||
+       header->numSlots < 2 ||
+       ringLength(header->numSlots, header->slotSize) > length) {
+      *error = "The blackboard ring is from a different runswift";
+      close();
+      return false;
+   }
+   __sync_synchronize();
+
+   semaphore = sem_open(SHM_RING_SEMAPHORE, O_RDWR);
+   if (semaphore == SEM_FAILED) {
+      *error = std::string("sem_open() failed: ") + strerror(errno);
+      close();
+      return false;
+   }
+
+   const uint64_t published = header->published;
+   read_ = published ? published - 1 : 0;
+   dropped_ = 0;
+   return true;
+}
+
+void ShmRingReader::close() {
+   if (memory != MAP_FAILED) munmap((void *)memory, length);
+   if (fd >= 0) ::close(fd);
+   if (semaphore != SEM_FAILED) sem_close(semaphore);
+   fd = -1;
+   memory = (const char *)MAP_FAILED;
+   semaphore = SEM_FAILED;
+   header = NULL;
+}
+
+bool ShmRingReader::isOpen() const {
+   return header != NULL;
+}
+
+bool ShmRingReader::wait(int timeoutMs) {
+   if (header == NULL) {
+      return false;
+   }
+   if (header->published > read_) {
+      return true;
+   }
+   struct timespec deadline;
+   clock_gettime(CLOCK_REALTIME, &deadline);
+   deadline.tv_sec += timeoutMs / 1000;
+   deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+   if (deadline.tv_nsec >= 1000000000L) {
+      ++deadline.tv_sec;
+      deadline.tv_nsec -= 1000000000L;
+   }
+   while (sem_timedwait(semaphore, &deadline) == -1 && errno == EINTR) {
+   }
+   return header->published > read_;
+}
+
+bool ShmRingReader::next(Blackboard *blackboard, std::string *error) {
+   error->clear();
+   if (header == NULL) {
+      return false;
+   }
+   for (;;) {
+      const uint64_t published = header->published;
+      if (read_ >= published) {
+         return false;
+      }
+      // the slot after the newest frame may be being written
+      const uint64_t oldest = published - std::min<uint64_t>(
+         published, header->numSlots - 1);
+      if (read_ < oldest) {
+         dropped_ += oldest - read_;
+         read_ = oldest;
+      }
+
+      const ShmSlotHeader *slot = slotOf(memory, read_);
+      const uint64_t sequence = 2 * (read_ + 1);
+      ++read_;
+      if (slot->sequence != sequence) {
+         ++dropped_;
+         continue;
+      }
+      __sync_synchronize();
+      const uint32_t frameLength = std::min(slot->length, header->slotSize);
+      const char *data = (const char *)(slot + 1);
+      frame.assign(data, data + frameLength);
+      __sync_synchronize();
+      if (slot->sequence != sequence) {
+         ++dropped_;
+         continue;
+      }
+      return decodeWireFrame(frame.empty() ? NULL : &frame[0], frameLength,
+                             blackboard, NULL, error);
+   }
+}
+
+uint64_t ShmRingReader::dropped() const {
+   return dropped_;
+}
@@ -0,0 +1,170 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <semaphore.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "transmitter/TransmitterDefs.hpp"
+
+class Blackboard;
+class WireFrame;
+
+#define SHM_RING_MEMORY "/runswift-blackboard"
+#define SHM_RING_SEMAPHORE "/runswift-blackboard-semaphore"
+
+/**
+ * Layout of the shared memory runswift publishes blackboards in for tools on
+ * the same machine, in place of the offnao TCP stream.
+ *
+ * A ShmRingHeader, padded out to a page, is followed by numSlots slots. Each
+ * slot is a ShmSlotHeader and then slotSize bytes holding one uncompressed
+ * WireFrame keyframe. Frame n goes in slot n % numSlots.
+ *
+ * Each slot is a seqlock. Its sequence is odd while frame n is being
+ * written, and 2 * (n + 1) once it is done. A reader copies the frame out
+ * of the slot and checks the sequence has not moved before decoding the
+ * copy, so a frame overwritten part way through is thrown away rather than
+ * waited for, and never decoded. The writer never waits for a reader.
+ *
+ * The semaphore is posted after each frame unless an earlier post has not
+ * been taken yet, as libagent does for runswift. Only one reader is woken for each
+ * post. Others find the frame when their wait times out.
+ */
+static const char SHM_RING_MAGIC[8] = { 'R', 'S', 'W', 'S', 'H', 'M', '0', '1' };
+static const uint32_t SHM_RING_HEADER_SIZE = 4096;
+
+struct ShmRingHeader {
+   char magic[8];
+   uint32_t numSlots;
+   uint32_t slotSize;
+   /* Frames published since the ring was created */
+   volatile uint64_t published;
+   /* What each frame holds */
+   OffNaoMask_t mask;
+};
+
+struct ShmSlotHeader {
+   volatile uint64_t sequence;
+   uint32_t length;
+   uint32_t reserved;
+};
+
+/**
+ * Creates the ring and publishes frames into it, from the OffNaoTransmitter.
+ */
+class ShmRingWriter {
+   public:
+      ShmRingWriter();
+      ~ShmRingWriter();
+
+      /**
+       * Creates the shared memory and semaphore, replacing those of any
+       * runswift before
+       *
+       * @param numSlots frames a reader may fall behind before it drops some
+       * @return whether the ring could be created, the reason is logged
+       */
+      bool open(uint32_t numSlots, OffNaoMask_t mask);
+
+      /**
+       * Encodes the blackboard into the next slot, and wakes a reader
+       *
+       * @return false if the frame did not fit in a slot
+       */
+      bool publish(Blackboard *blackboard);
+
+   private:
+      void close();
+
+      int fd;
+      char *memory;
+      std::size_t length;
+      sem_t *semaphore;
+      ShmRingHeader *header;
+      WireFrame *frame;
+};
+
+/**
+ * Attaches to the ring of a runswift on the same machine, and decodes its
+ * frames.
+ */
+class ShmRingReader {
+   public:
+      ShmRingReader();
+      ~ShmRingReader();
+
+      /**
+       * Maps the ring read only. Only the newest frame is read at first.
+       *
+       * @return whether runswift has created a ring to attach to
+       */
+      bool open(std::string *error);
+      void close();
+      bool isOpen() const;
+
+      /**
+       * Waits until a frame not yet read is published
+       *
+       * @return whether one was within timeoutMs
+       */
+      bool wait(int timeoutMs);
+
+      /**
+       * Decodes the oldest frame not yet read that is still in the ring.
+       * Frames overwritten while they were copied are skipped.
+       *
+       * @return false once every frame published has been read, or if the
+       *         frame could not be decoded, in which case error is set and
+       *         the blackboard is incomplete
+       */
+      bool next(Blackboard *blackboard, std::string *error);
+
+      /**
+       * @return frames overwritten before they could be read
+       */
+      uint64_t dropped() const;
+
+   private:
+      int fd;
+      const char *memory;
+      std::size_t length;
+      sem_t *semaphore;
+      const ShmRingHeader *header;
+      uint64_t read_;
+      uint64_t dropped_;
+      /* the frame being decoded, copied out of its slot */
+      std::vector<char> frame;
+};
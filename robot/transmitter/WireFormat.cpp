@@ -0,0 +1,1301 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "transmitter/WireFormat.hpp"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "blackboard/Blackboard.hpp"
+#include "utils/Logger.hpp"
+
+namespace io = boost::iostreams;
+
+#define WIRE_COMPONENT(id, version) { id, version, #id }
+
+const WireComponentSchema WIRE_SCHEMA[NUM_WIRE_COMPONENTS] = {
+   { 0, 0, "WIRE_NONE" },
+   WIRE_COMPONENT(WIRE_GAMECONTROLLER, 1),
+   WIRE_COMPONENT(WIRE_MOTION_SENSORS, 1),
+   WIRE_COMPONENT(WIRE_MOTION_POSE, 1),
+   WIRE_COMPONENT(WIRE_MOTION_COM, 1),
+   WIRE_COMPONENT(WIRE_MOTION_ODOMETRY, 1),
+   WIRE_COMPONENT(WIRE_MOTION_ACTIVE, 1),
+   WIRE_COMPONENT(WIRE_MOTION_PENDULUM, 1),
+   WIRE_COMPONENT(WIRE_PERCEPTION, 1),
+   WIRE_COMPONENT(WIRE_BEHAVIOUR_REQUEST, 1),
+   WIRE_COMPONENT(WIRE_KINEMATICS_SONAR, 1),
+   WIRE_COMPONENT(WIRE_KINEMATICS_PARAMETERS, 1),
+   WIRE_COMPONENT(WIRE_KINEMATICS_SENSORS_LAGGED, 1),
+   WIRE_COMPONENT(WIRE_VISION, 1),
+   WIRE_COMPONENT(WIRE_VISION_LANDMARKS, 1),
+   WIRE_COMPONENT(WIRE_VISION_FEET, 1),
+   WIRE_COMPONENT(WIRE_VISION_BALLS, 1),
+   WIRE_COMPONENT(WIRE_VISION_POSTS, 1),
+   WIRE_COMPONENT(WIRE_VISION_ROBOTS, 1),
+   WIRE_COMPONENT(WIRE_VISION_FIELD_EDGES, 1),
+   WIRE_COMPONENT(WIRE_VISION_FIELD_FEATURES, 1),
+   WIRE_COMPONENT(WIRE_RECEIVER, 1),
+   WIRE_COMPONENT(WIRE_LOCALISATION, 1),
+   WIRE_COMPONENT(WIRE_LOCALISATION_ROBOT_OBSTACLES, 1),
+   WIRE_COMPONENT(WIRE_ROBOT_POS, 1),
+   WIRE_COMPONENT(WIRE_TOP_SALIENCY, 1),
+   WIRE_COMPONENT(WIRE_BOT_SALIENCY, 1),
+   WIRE_COMPONENT(WIRE_TOP_FRAME, 1),
+   WIRE_COMPONENT(WIRE_BOT_FRAME, 1),
+   WIRE_COMPONENT(WIRE_THREAD_TIMINGS, 1)
+};
+
+static const std::size_t TOP_SALIENCY_BYTES =
+   sizeof(Colour[IMAGE_COLS / TOP_SALIENCY_DENSITY]
+                [IMAGE_ROWS / TOP_SALIENCY_DENSITY]);
+static const std::size_t BOT_SALIENCY_BYTES =
+   sizeof(Colour[IMAGE_COLS / BOT_SALIENCY_DENSITY]
+                [IMAGE_ROWS / BOT_SALIENCY_DENSITY]);
+static const std::size_t FRAME_BYTES = sizeof(uint8_t[IMAGE_ROWS * IMAGE_COLS * 2]);
+
+bool isWireFrameHeader(const WireFrameHeader &header) {
+   return memcmp(header.magic, WIRE_MAGIC, sizeof(WIRE_MAGIC)) == 0 &&
+          header.version == WIRE_VERSION;
+}
+
+static bool isPayload(const WireComponentHeader &component) {
+   return component.payloadLength || component.rawPayloadLength;
+}
+
+WireBaseline::WireBaseline() {
+   reset();
+}
+
+void WireBaseline::reset() {
+   valid = false;
+   mask = 0;
+   deltas = 0;
+   for (int i = 0; i < NUM_WIRE_COMPONENTS; ++i) {
+      components[i].clear();
+   }
+}
+
+bool WireBaseline::covers(OffNaoMask_t mask) const {
+   return valid && this->mask == mask;
+}
+
+void WireBaseline::store(const char *component, std::size_t length) {
+   const WireComponentHeader *header = (const WireComponentHeader *)component;
+   components[header->id].assign(component, component + length);
+}
+
+WireFrame::WireFrame()
+   : deflater(NULL), numOwnedPayloads(0), componentStart(0) {
+   memset(&header_, 0, sizeof(header_));
+   structured.reserve(64 * 1024);
+}
+
+WireFrame::~WireFrame() {
+   if (deflater) {
+      deflateEnd(deflater);
+      delete deflater;
+   }
+}
+
+bool WireFrame::compressInto(const void *data, std::size_t length,
+                             std::vector<char> *out,
+                             std::size_t *compressedLength) {
+   if (!deflater) {
+      deflater = new z_stream;
+      memset(deflater, 0, sizeof(*deflater));
+      if (deflateInit(deflater, Z_BEST_SPEED) != Z_OK) {
+         llog(ERROR) << "Failed to set up zlib: " << deflater->msg
+                     << std::endl;
+         delete deflater;
+         deflater = NULL;
+         return false;
+      }
+   } else {
+      deflateReset(deflater);
+   }
+
+   std::size_t bound = deflateBound(deflater, length);
+   if (out->size() < bound) {
+      out->resize(bound);
+   }
+   deflater->next_in = (Bytef *)data;
+   deflater->avail_in = length;
+   deflater->next_out = (Bytef *)&(*out)[0];
+   deflater->avail_out = out->size();
+   if (deflate(deflater, Z_FINISH) != Z_STREAM_END) {
+      return false;
+   }
+   *compressedLength = deflater->total_out;
+   return *compressedLength < length;
+}
+
+void WireFrame::begin(OffNaoMask_t mask) {
+   memcpy(header_.magic, WIRE_MAGIC, sizeof(WIRE_MAGIC));
+   header_.version = WIRE_VERSION;
+   header_.flags = 0;
+   header_.mask = mask;
+   header_.numComponents = 0;
+   header_.structuredLength = 0;
+   header_.rawStructuredLength = 0;
+   header_.payloadLength = 0;
+   structured.clear();
+   componentOffsets.clear();
+   numOwnedPayloads = 0;
+   payloads.clear();
+   gather.clear();
+}
+
+void WireFrame::beginComponent(WireComponentId id) {
+   WireComponentHeader component;
+   component.id = id;
+   component.version = WIRE_SCHEMA[id].version;
+   component.length = 0;
+   component.payloadLength = 0;
+   component.rawPayloadLength = 0;
+   componentStart = structured.size();
+   componentOffsets.push_back(componentStart);
+   put(component);
+}
+
+void WireFrame::endComponent() {
+   WireComponentHeader *component =
+      (WireComponentHeader *)&structured[componentStart];
+   component->length =
+      structured.size() - componentStart - sizeof(WireComponentHeader);
+   ++header_.numComponents;
+}
+
+void WireFrame::putBytes(const void *data, std::size_t length) {
+   const char *bytes = (const char *)data;
+   structured.insert(structured.end(), bytes, bytes + length);
+}
+
+template <class T>
+void WireFrame::putArchive(const T &value) {
+   std::size_t lengthAt = structured.size();
+   put<uint32_t>(0);
+   {
+      io::stream<io::back_insert_device<std::vector<char> > > out(structured);
+      boost::archive::binary_oarchive ar(out, boost::archive::no_header);
+      ar << value;
+   }
+   uint32_t length = structured.size() - lengthAt - sizeof(uint32_t);
+   memcpy(&structured[lengthAt], &length, sizeof(length));
+}
+
+void WireFrame::putPayload(WireComponentId id, const void *data,
+                           uint32_t length, bool compress, bool copy) {
+   uint32_t sent = length;
+   if (compress || copy) {
+      if (numOwnedPayloads == ownedPayloads.size()) {
+         ownedPayloads.push_back(std::vector<char>());
+      }
+      std::vector<char> &out = ownedPayloads[numOwnedPayloads];
+      std::size_t outLength;
+      if (compress && compressInto(data, length, &out, &outLength)) {
+         ++numOwnedPayloads;
+         data = &out[0];
+         sent = outLength;
+      } else if (copy) {
+         const char *bytes = (const char *)data;
+         out.assign(bytes, bytes + length);
+         ++numOwnedPayloads;
+         data = &out[0];
+      }
+   }
+
+   beginComponent(id);
+   WireComponentHeader *component =
+      (WireComponentHeader *)&structured[componentStart];
+   component->payloadLength = sent;
+   component->rawPayloadLength = length;
+   endComponent();
+   payloads.push_back(boost::asio::buffer(data, sent));
+   header_.payloadLength += sent;
+}
+
+void WireFrame::finish(bool compress, const WireBaseline *baseline) {
+   const std::vector<char> *section = &structured;
+   if (baseline && baseline->covers(header_.mask)) {
+      // keep the payloads and whatever differs from what the peer has
+      delta.clear();
+      uint32_t numComponents = 0;
+      for (std::size_t i = 0; i < componentOffsets.size(); ++i) {
+         const char *start = &structured[componentOffsets[i]];
+         const WireComponentHeader *component =
+            (const WireComponentHeader *)start;
+         const std::size_t length = sizeof(*component) + component->length;
+         const std::vector<char> &last = baseline->components[component->id];
+         if (!isPayload(*component) && last.size() == length &&
+             memcmp(&last[0], start, length) == 0) {
+            continue;
+         }
+         delta.insert(delta.end(), start, start + length);
+         ++numComponents;
+      }
+      header_.flags |= WIRE_DELTA;
+      header_.numComponents = numComponents;
+      section = &delta;
+   }
+
+   header_.rawStructuredLength = section->size();
+   header_.structuredLength = section->size();
+   const char *sent = section->empty() ? NULL : &(*section)[0];
+   std::size_t length;
+   if (compress && sent &&
+       compressInto(sent, section->size(), &compressed, &length)) {
+      header_.flags |= WIRE_COMPRESSED;
+      header_.structuredLength = length;
+      sent = &compressed[0];
+   }
+
+   gather.push_back(boost::asio::buffer(&header_, sizeof(header_)));
+   if (sent) {
+      gather.push_back(boost::asio::buffer(sent, header_.structuredLength));
+   }
+   gather.insert(gather.end(), payloads.begin(), payloads.end());
+}
+
+void WireFrame::acknowledge(WireBaseline *baseline) const {
+   if (header_.flags & WIRE_DELTA) {
+      ++baseline->deltas;
+   } else {
+      baseline->reset();
+      baseline->valid = true;
+      baseline->mask = header_.mask;
+   }
+   // the full encoding is still in structured, whatever was sent
+   for (std::size_t i = 0; i < componentOffsets.size(); ++i) {
+      const char *start = &structured[componentOffsets[i]];
+      const WireComponentHeader *component =
+         (const WireComponentHeader *)start;
+      if (!isPayload(*component)) {
+         baseline->store(start, sizeof(*component) + component->length);
+      }
+   }
+}
+
+const std::vector<boost::asio::const_buffer> &WireFrame::buffers() const {
+   return gather;
+}
+
+std::size_t WireFrame::size() const {
+   return sizeof(header_) + wireFrameBodyLength(header_);
+}
+
+const WireFrameHeader &WireFrame::header() const {
+   return header_;
+}
+
+namespace {
+
+/**
+ * Reads the encoding of a component, failing rather than reading past its
+ * end
+ */
+class WireCursor {
+   public:
+      WireCursor(const char *data, std::size_t length)
+         : ok(true), pos(data), end(data + length) {}
+
+      template <class T>
+      bool get(T *value) {
+         return getBytes(value, sizeof(T));
+      }
+
+      bool getBytes(void *data, std::size_t length) {
+         if (!ok || (std::size_t)(end - pos) < length) {
+            ok = false;
+            return false;
+         }
+         memcpy(data, pos, length);
+         pos += length;
+         return true;
+      }
+
+      template <class T>
+      bool getArchive(T *value) {
+         uint32_t length;
+         if (!get(&length) || (std::size_t)(end - pos) < length) {
+            ok = false;
+            return false;
+         }
+         try {
+            io::stream<io::array_source> in(pos, length);
+            boost::archive::binary_iarchive ar(in, boost::archive::no_header);
+            ar >> *value;
+         } catch (const std::exception &e) {
+            ok = false;
+            return false;
+         }
+         pos += length;
+         return true;
+      }
+
+      std::size_t remaining() const {
+         return end - pos;
+      }
+
+      bool ok;
+
+   private:
+      const char *pos;
+      const char *end;
+};
+
+/* Encoders and decoders for the types the components are made of */
+
+void encodeFloats(WireFrame *frame, const float *values, uint32_t count) {
+   frame->put(count);
+   frame->putBytes(values, count * sizeof(float));
+}
+
+bool decodeFloats(WireCursor *cursor, float *values, uint32_t count) {
+   uint32_t encoded;
+   if (!cursor->get(&encoded) || encoded != count) {
+      cursor->ok = false;
+      return false;
+   }
+   return cursor->getBytes(values, count * sizeof(float));
+}
+
+template <class E>
+void encodeEnum(WireFrame *frame, E value) {
+   frame->put<int32_t>(value);
+}
+
+template <class E>
+bool decodeEnum(WireCursor *cursor, E *value) {
+   int32_t encoded;
+   if (!cursor->get(&encoded)) {
+      return false;
+   }
+   *value = (E)encoded;
+   return true;
+}
+
+void encode(WireFrame *frame, bool value) {
+   frame->put<uint8_t>(value);
+}
+
+bool decode(WireCursor *cursor, bool *value) {
+   uint8_t encoded;
+   if (!cursor->get(&encoded)) {
+      return false;
+   }
+   *value = encoded;
+   return true;
+}
+
+void encode(WireFrame *frame, const Point &point) {
+   frame->put<int32_t>(point.x());
+   frame->put<int32_t>(point.y());
+}
+
+bool decode(WireCursor *cursor, Point *point) {
+   int32_t x, y;
+   if (!cursor->get(&x) || !cursor->get(&y)) {
+      return false;
+   }
+   *point = Point(x, y);
+   return true;
+}
+
+void encode(WireFrame *frame, const BBox &box) {
+   encode(frame, box.a);
+   encode(frame, box.b);
+}
+
+bool decode(WireCursor *cursor, BBox *box) {
+   return decode(cursor, &box->a) && decode(cursor, &box->b);
+}
+
+void encode(WireFrame *frame, const RRCoord &coord) {
+   frame->putBytes(coord.vec.data(), 3 * sizeof(float));
+   frame->putBytes(coord.var.data(), 9 * sizeof(float));
+}
+
+bool decode(WireCursor *cursor, RRCoord *coord) {
+   return cursor->getBytes(coord->vec.data(), 3 * sizeof(float)) &&
+          cursor->getBytes(coord->var.data(), 9 * sizeof(float));
+}
+
+void encode(WireFrame *frame, const AbsCoord &coord) {
+   frame->putBytes(coord.vec.data(), 3 * sizeof(float));
+   frame->putBytes(coord.var.data(), 9 * sizeof(float));
+}
+
+bool decode(WireCursor *cursor, AbsCoord *coord) {
+   return cursor->getBytes(coord->vec.data(), 3 * sizeof(float)) &&
+          cursor->getBytes(coord->var.data(), 9 * sizeof(float));
+}
+
+void encode(WireFrame *frame, const XYZ_Coord &coord) {
+   frame->put(coord.x);
+   frame->put(coord.y);
+   frame->put(coord.z);
+}
+
+bool decode(WireCursor *cursor, XYZ_Coord *coord) {
+   return cursor->get(&coord->x) && cursor->get(&coord->y) &&
+          cursor->get(&coord->z);
+}
+
+void encode(WireFrame *frame, const RANSACLine &line) {
+   encode(frame, line.p1);
+   encode(frame, line.p2);
+   frame->put<int32_t>(line.t1);
+   frame->put<int32_t>(line.t2);
+   frame->put<int32_t>(line.t3);
+   frame->put(line.var);
+}
+
+bool decode(WireCursor *cursor, RANSACLine *line) {
+   int32_t t1, t2, t3;
+   if (!decode(cursor, &line->p1) || !decode(cursor, &line->p2) ||
+       !cursor->get(&t1) || !cursor->get(&t2) || !cursor->get(&t3)) {
+      return false;
+   }
+   line->t1 = t1;
+   line->t2 = t2;
+   line->t3 = t3;
+   return cursor->get(&line->var);
+}
+
+void encode(WireFrame *frame, const SensorValues &sensors) {
+   encodeFloats(frame, sensors.joints.angles, Joints::NUMBER_OF_JOINTS);
+   encodeFloats(frame, sensors.joints.stiffnesses, Joints::NUMBER_OF_JOINTS);
+   encodeFloats(frame, sensors.joints.temperatures, Joints::NUMBER_OF_JOINTS);
+   encodeFloats(frame, sensors.joints.currents, Joints::NUMBER_OF_JOINTS);
+   encodeFloats(frame, sensors.sensors, Sensors::NUMBER_OF_SENSORS);
+   encodeFloats(frame, sensors.sonar, Sonar::NUMBER_OF_READINGS);
+}
+
+bool decode(WireCursor *cursor, SensorValues *sensors) {
+   return
+      decodeFloats(cursor, sensors->joints.angles, Joints::NUMBER_OF_JOINTS) &&
+      decodeFloats(cursor, sensors->joints.stiffnesses,
+                   Joints::NUMBER_OF_JOINTS) &&
+      decodeFloats(cursor, sensors->joints.temperatures,
+                   Joints::NUMBER_OF_JOINTS) &&
+      decodeFloats(cursor, sensors->joints.currents,
+                   Joints::NUMBER_OF_JOINTS) &&
+      decodeFloats(cursor, sensors->sensors, Sensors::NUMBER_OF_SENSORS) &&
+      decodeFloats(cursor, sensors->sonar, Sonar::NUMBER_OF_READINGS);
+}
+
+void encode(WireFrame *frame, const Odometry &odometry) {
+   frame->put(odometry.forward);
+   frame->put(odometry.left);
+   frame->put(odometry.turn);
+}
+
+bool decode(WireCursor *cursor, Odometry *odometry) {
+   return cursor->get(&odometry->forward) && cursor->get(&odometry->left) &&
+          cursor->get(&odometry->turn);
+}
+
+void encode(WireFrame *frame, const ThreadTiming &timing) {
+   frame->putBytes(timing.name, sizeof(timing.name));
+   frame->put(timing.ticks);
+   frame->put(timing.overruns);
+   frame->put(timing.lastTick);
+   frame->put(timing.maxTick);
+   frame->put(timing.lastLateness);
+   frame->put(timing.maxLateness);
+   frame->put(timing.meanLateness);
+   frame->put(timing.latenessDeviation);
+}
+
+bool decode(WireCursor *cursor, ThreadTiming *timing) {
+   if (!cursor->getBytes(timing->name, sizeof(timing->name))) {
+      return false;
+   }
+   timing->name[sizeof(timing->name) - 1] = '\0';
+   return cursor->get(&timing->ticks) && cursor->get(&timing->overruns) &&
+          cursor->get(&timing->lastTick) && cursor->get(&timing->maxTick) &&
+          cursor->get(&timing->lastLateness) &&
+          cursor->get(&timing->maxLateness) &&
+          cursor->get(&timing->meanLateness) &&
+          cursor->get(&timing->latenessDeviation);
+}
+
+void encode(WireFrame *frame, const Ipoint &point) {
+   frame->put(point.x);
+   frame->put(point.y);
+   frame->put(point.scale);
+   frame->put<int32_t>(point.laplacian);
+   frame->put<int32_t>(point.isRobot);
+   encodeFloats(frame, point.descriptor, SURF_DESCRIPTOR_LENGTH);
+}
+
+bool decode(WireCursor *cursor, Ipoint *point) {
+   int32_t laplacian, isRobot;
+   if (!cursor->get(&point->x) || !cursor->get(&point->y) ||
+       !cursor->get(&point->scale) || !cursor->get(&laplacian) ||
+       !cursor->get(&isRobot)) {
+      return false;
+   }
+   point->laplacian = laplacian;
+   point->isRobot = isRobot;
+   return decodeFloats(cursor, point->descriptor, SURF_DESCRIPTOR_LENGTH);
+}
+
+void encode(WireFrame *frame, const FootInfo &foot) {
+   encode(frame, foot.robotBounds);
+   encode(frame, foot.imageBounds);
+   frame->put<int32_t>(foot.age);
+}
+
+bool decode(WireCursor *cursor, FootInfo *foot) {
+   int32_t age;
+   if (!decode(cursor, &foot->robotBounds) ||
+       !decode(cursor, &foot->imageBounds) || !cursor->get(&age)) {
+      return false;
+   }
+   foot->age = age;
+   return true;
+}
+
+void encode(WireFrame *frame, const BallInfo &ball) {
+   encode(frame, ball.rr);
+   frame->put<int32_t>(ball.radius);
+   encode(frame, ball.imageCoords);
+   encode(frame, ball.neckRelative);
+   encode(frame, ball.topCamera);
+   frame->put(ball.visionVar);
+}
+
+bool decode(WireCursor *cursor, BallInfo *ball) {
+   int32_t radius;
+   if (!decode(cursor, &ball->rr) || !cursor->get(&radius)) {
+      return false;
+   }
+   ball->radius = radius;
+   return decode(cursor, &ball->imageCoords) &&
+          decode(cursor, &ball->neckRelative) &&
+          decode(cursor, &ball->topCamera) && cursor->get(&ball->visionVar);
+}
+
+void encode(WireFrame *frame, const PostInfo &post) {
+   encode(frame, post.rr);
+   encodeEnum(frame, post.type);
+   encode(frame, post.imageCoords);
+   frame->put(post.wDistance);
+   frame->put(post.kDistance);
+   encode(frame, post.trustDistance);
+   encodeEnum(frame, post.dir);
+}
+
+bool decode(WireCursor *cursor, PostInfo *post) {
+   return decode(cursor, &post->rr) && decodeEnum(cursor, &post->type) &&
+          decode(cursor, &post->imageCoords) &&
+          cursor->get(&post->wDistance) && cursor->get(&post->kDistance) &&
+          decode(cursor, &post->trustDistance) &&
+          decodeEnum(cursor, &post->dir);
+}
+
+void encode(WireFrame *frame, const RobotInfo &robot) {
+   encode(frame, robot.rr);
+   encodeEnum(frame, robot.type);
+   encodeEnum(frame, robot.cameras);
+   encode(frame, robot.imageCoords);
+   encode(frame, robot.topImageCoords);
+   encode(frame, robot.botImageCoords);
+}
+
+bool decode(WireCursor *cursor, RobotInfo *robot) {
+   return decode(cursor, &robot->rr) && decodeEnum(cursor, &robot->type) &&
+          decodeEnum(cursor, &robot->cameras) &&
+          decode(cursor, &robot->imageCoords) &&
+          decode(cursor, &robot->topImageCoords) &&
+          decode(cursor, &robot->botImageCoords);
+}
+
+void encode(WireFrame *frame, const FieldEdgeInfo &edge) {
+   encode(frame, edge.rrEdge);
+   encode(frame, edge.imageEdge);
+}
+
+bool decode(WireCursor *cursor, FieldEdgeInfo *edge) {
+   return decode(cursor, &edge->rrEdge) && decode(cursor, &edge->imageEdge);
+}
+
+void encode(WireFrame *frame, const TeamBallInfo &teamBall) {
+   encode(frame, teamBall.pos);
+   encodeEnum(frame, teamBall.status);
+   frame->put<uint32_t>(teamBall.contributors);
+}
+
+bool decode(WireCursor *cursor, TeamBallInfo *teamBall) {
+   uint32_t contributors;
+   if (!decode(cursor, &teamBall->pos) ||
+       !decodeEnum(cursor, &teamBall->status) ||
+       !cursor->get(&contributors)) {
+      return false;
+   }
+   teamBall->contributors = contributors;
+   return true;
+}
+
+template <class T>
+void encode(WireFrame *frame, const std::vector<T> &values) {
+   frame->put<uint32_t>(values.size());
+   for (std::size_t i = 0; i < values.size(); ++i) {
+      encode(frame, values[i]);
+   }
+}
+
+template <class T>
+bool decode(WireCursor *cursor, std::vector<T> *values) {
+   uint32_t count;
+   // every element takes at least a byte, so a corrupt count fails here
+   // rather than in resize
+   if (!cursor->get(&count) || count > cursor->remaining()) {
+      cursor->ok = false;
+      return false;
+   }
+   values->resize(count);
+   for (uint32_t i = 0; i < count; ++i) {
+      if (!decode(cursor, &(*values)[i])) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/* Encoders and decoders for each component */
+
+void encodeComponents(Blackboard *blackboard, OffNaoMask_t mask,
+                      WireFrame *frame) {
+   frame->beginComponent(WIRE_GAMECONTROLLER);
+   encode(frame, blackboard->gameController.team_red);
+   frame->put<int32_t>(blackboard->gameController.player_number);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_MOTION_SENSORS);
+   encode(frame, readFrom(motion, sensors));
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_MOTION_POSE);
+   frame->putArchive(blackboard->motion.pose);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_MOTION_COM);
+   encode(frame, blackboard->motion.com);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_MOTION_ODOMETRY);
+   encode(frame, readFrom(motion, odometry));
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_MOTION_ACTIVE);
+   frame->putArchive(blackboard->motion.active);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_MOTION_PENDULUM);
+   frame->putArchive(blackboard->motion.pendulumModel);
+   frame->endComponent();
+
+   const PerceptionBlackboard &perception = blackboard->perception;
+   frame->beginComponent(WIRE_PERCEPTION);
+   frame->put<uint32_t>(perception.behaviour);
+   frame->put<uint32_t>(perception.kinematics);
+   frame->put<uint32_t>(perception.localisation);
+   frame->put<uint32_t>(perception.total);
+   frame->put<uint32_t>(perception.vision);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_BEHAVIOUR_REQUEST);
+   frame->putArchive(blackboard->behaviour.request);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_KINEMATICS_SONAR);
+   frame->putArchive(readFrom(kinematics, sonarFiltered));
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_KINEMATICS_PARAMETERS);
+   frame->putArchive(blackboard->kinematics.parameters);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_KINEMATICS_SENSORS_LAGGED);
+   encode(frame, blackboard->kinematics.sensorsLagged);
+   frame->endComponent();
+
+   const VisionBlackboard &vision = blackboard->vision;
+   frame->beginComponent(WIRE_VISION);
+   frame->put<int64_t>(vision.timestamp);
+   encodeEnum(frame, vision.goalArea);
+   frame->put(vision.awayGoalProb);
+   frame->put<int32_t>(vision.homeMapSize);
+   frame->put<int32_t>(vision.awayMapSize);
+   encodeEnum(frame, vision.ballHint.type);
+   frame->put<uint32_t>(vision.missedFrames);
+   frame->put<int32_t>(vision.dxdy.first);
+   frame->put<int32_t>(vision.dxdy.second);
+   frame->endComponent();
+
+   if (mask & LANDMARKS_MASK) {
+      frame->beginComponent(WIRE_VISION_LANDMARKS);
+      encode(frame, vision.landmarks);
+      frame->endComponent();
+   }
+
+   frame->beginComponent(WIRE_VISION_FEET);
+   encode(frame, vision.feetBoxes);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_VISION_BALLS);
+   encode(frame, readFrom(vision, balls));
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_VISION_POSTS);
+   encode(frame, vision.posts);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_VISION_ROBOTS);
+   encode(frame, readFrom(vision, robots));
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_VISION_FIELD_EDGES);
+   encode(frame, vision.fieldEdges);
+   frame->endComponent();
+
+   frame->beginComponent(WIRE_VISION_FIELD_FEATURES);
+   frame->putArchive(readFrom(vision, fieldFeatures));
+   frame->endComponent();
+
+   const ReceiverBlackboard &receiver = blackboard->receiver;
+   frame->beginComponent(WIRE_RECEIVER);
+   frame->put<uint32_t>(ROBOTS_PER_TEAM);
+   frame->put<uint32_t>(sizeof(SPLStandardMessage));
+   frame->putBytes(receiver.message, sizeof(receiver.message));
+   frame->putArchive(receiver.data);
+   for (int i = 0; i < ROBOTS_PER_TEAM; ++i) {
+      encode(frame, receiver.incapacitated[i]);
+   }
+   frame->endComponent();
+
+   const LocalisationBlackboard &localisation = blackboard->localisation;
+   frame->beginComponent(WIRE_LOCALISATION);
+   frame->put<uint32_t>(localisation.ballLostCount);
+   encode(frame, localisation.ballPosRR);
+   encode(frame, localisation.ballPosRRC);
+   encode(frame, localisation.ballVelRRC);
+   encode(frame, localisation.ballVel);
+   frame->put(localisation.ballPosUncertainty);
+   frame->put(localisation.ballVelEigenvalue);
+   frame->put(localisation.robotPosUncertainty);
+   frame->put(localisation.robotHeadingUncertainty);
+   encode(frame, localisation.ballNeckRelative);
+   encode(frame, localisation.ballPos);
+   encode(frame, localisation.teamBall);
+   frame->putArchive(localisation.sharedLocalisationBundle);
+   encode(frame, localisation.havePendingOutgoingSharedBundle);
+   const std::vector<bool> &incoming =
+      localisation.havePendingIncomingSharedBundle;
+   frame->put<uint32_t>(incoming.size());
+   for (std::size_t i = 0; i < incoming.size(); ++i) {
+      encode(frame, (bool)incoming[i]);
+   }
+   frame->endComponent();
+
+   if (mask & ROBOT_FILTER_MASK) {
+      frame->beginComponent(WIRE_LOCALISATION_ROBOT_OBSTACLES);
+      frame->putArchive(readFrom(localisation, robotObstacles));
+      frame->endComponent();
+   }
+
+   const ThreadBlackboard &thread = blackboard->thread;
+   frame->beginComponent(WIRE_THREAD_TIMINGS);
+   frame->put<uint32_t>(thread.numTimings);
+   for (int i = 0; i < thread.numTimings; ++i) {
+      encode(frame, readFrom(thread, timings[i]));
+   }
+   frame->endComponent();
+}
+
+bool decodeFields(uint16_t id, WireCursor *cursor, Blackboard *blackboard) {
+   switch (id) {
+   case WIRE_GAMECONTROLLER: {
+      int32_t playerNumber;
+      if (decode(cursor, &blackboard->gameController.team_red) &&
+          cursor->get(&playerNumber)) {
+         blackboard->gameController.player_number = playerNumber;
+      }
+      break;
+   }
+   case WIRE_MOTION_SENSORS: {
+      SensorValues sensors;
+      if (decode(cursor, &sensors)) {
+         blackboard->motion.sensors.write(sensors);
+      }
+      break;
+   }
+   case WIRE_MOTION_POSE:
+      cursor->getArchive(&blackboard->motion.pose);
+      break;
+   case WIRE_MOTION_COM:
+      decode(cursor, &blackboard->motion.com);
+      break;
+   case WIRE_MOTION_ODOMETRY: {
+      Odometry odometry;
+      if (decode(cursor, &odometry)) {
+         blackboard->motion.odometry.write(odometry);
+      }
+      break;
+   }
+   case WIRE_MOTION_ACTIVE:
+      cursor->getArchive(&blackboard->motion.active);
+      break;
+   case WIRE_MOTION_PENDULUM:
+      cursor->getArchive(&blackboard->motion.pendulumModel);
+      break;
+   case WIRE_PERCEPTION: {
+      PerceptionBlackboard &perception = blackboard->perception;
+      cursor->get(&perception.behaviour);
+      cursor->get(&perception.kinematics);
+      cursor->get(&perception.localisation);
+      cursor->get(&perception.total);
+      cursor->get(&perception.vision);
+      break;
+   }
+   case WIRE_BEHAVIOUR_REQUEST:
+      cursor->getArchive(&blackboard->behaviour.request);
+      break;
+   case WIRE_KINEMATICS_SONAR: {
+      std::vector<std::vector<int> > sonar;
+      if (cursor->getArchive(&sonar)) {
+         blackboard->kinematics.sonarFiltered.publish(sonar);
+      }
+      break;
+   }
+   case WIRE_KINEMATICS_PARAMETERS:
+      cursor->getArchive(&blackboard->kinematics.parameters);
+      break;
+   case WIRE_KINEMATICS_SENSORS_LAGGED:
+      decode(cursor, &blackboard->kinematics.sensorsLagged);
+      break;
+   case WIRE_VISION: {
+      VisionBlackboard &vision = blackboard->vision;
+      int32_t homeMapSize, awayMapSize, dx, dy;
+      uint32_t missedFrames;
+      if (cursor->get(&vision.timestamp) &&
+          decodeEnum(cursor, &vision.goalArea) &&
+          cursor->get(&vision.awayGoalProb) && cursor->get(&homeMapSize) &&
+          cursor->get(&awayMapSize) &&
+          decodeEnum(cursor, &vision.ballHint.type) &&
+          cursor->get(&missedFrames) && cursor->get(&dx) &&
+          cursor->get(&dy)) {
+         vision.homeMapSize = homeMapSize;
+         vision.awayMapSize = awayMapSize;
+         vision.missedFrames = missedFrames;
+         vision.dxdy = std::make_pair(dx, dy);
+      }
+      break;
+   }
+   case WIRE_VISION_LANDMARKS:
+      decode(cursor, &blackboard->vision.landmarks);
+      break;
+   case WIRE_VISION_FEET:
+      decode(cursor, &blackboard->vision.feetBoxes);
+      break;
+   case WIRE_VISION_BALLS: {
+      std::vector<BallInfo> balls;
+      if (decode(cursor, &balls)) {
+         blackboard->vision.balls.publish(balls);
+      }
+      break;
+   }
+   case WIRE_VISION_POSTS:
+      decode(cursor, &blackboard->vision.posts);
+      break;
+   case WIRE_VISION_ROBOTS: {
+      std::vector<RobotInfo> robots;
+      if (decode(cursor, &robots)) {
+         blackboard->vision.robots.publish(robots);
+      }
+      break;
+   }
+   case WIRE_VISION_FIELD_EDGES:
+      decode(cursor, &blackboard->vision.fieldEdges);
+      break;
+   case WIRE_VISION_FIELD_FEATURES: {
+      std::vector<FieldFeatureInfo> features;
+      if (cursor->getArchive(&features)) {
+         blackboard->vision.fieldFeatures.publish(features);
+      }
+      break;
+   }
+   case WIRE_RECEIVER: {
+      ReceiverBlackboard &receiver = blackboard->receiver;
+      uint32_t robots, messageSize;
+      if (!cursor->get(&robots) || !cursor->get(&messageSize) ||
+          robots != ROBOTS_PER_TEAM ||
+          messageSize != sizeof(SPLStandardMessage)) {
+         cursor->ok = false;
+         break;
+      }
+      if (cursor->getBytes(receiver.message, sizeof(receiver.message)) &&
+          cursor->getArchive(&receiver.data)) {
+         for (int i = 0; i < ROBOTS_PER_TEAM; ++i) {
+            decode(cursor, &receiver.incapacitated[i]);
+         }
+      }
+      break;
+   }
+   case WIRE_LOCALISATION: {
+      LocalisationBlackboard &localisation = blackboard->localisation;
+      uint32_t incoming;
+      if (!cursor->get(&localisation.ballLostCount) ||
+          !decode(cursor, &localisation.ballPosRR) ||
+          !decode(cursor, &localisation.ballPosRRC) ||
+          !decode(cursor, &localisation.ballVelRRC) ||
+          !decode(cursor, &localisation.ballVel) ||
+          !cursor->get(&localisation.ballPosUncertainty) ||
+          !cursor->get(&localisation.ballVelEigenvalue) ||
+          !cursor->get(&localisation.robotPosUncertainty) ||
+          !cursor->get(&localisation.robotHeadingUncertainty) ||
+          !decode(cursor, &localisation.ballNeckRelative) ||
+          !decode(cursor, &localisation.ballPos) ||
+          !decode(cursor, &localisation.teamBall) ||
+          !cursor->getArchive(&localisation.sharedLocalisationBundle) ||
+          !decode(cursor, &localisation.havePendingOutgoingSharedBundle) ||
+          !cursor->get(&incoming) || incoming > cursor->remaining()) {
+         cursor->ok = false;
+         break;
+      }
+      localisation.havePendingIncomingSharedBundle.resize(incoming);
+      for (uint32_t i = 0; i < incoming; ++i) {
+         bool pending = false;
+         decode(cursor, &pending);
+         localisation.havePendingIncomingSharedBundle[i] = pending;
+      }
+      break;
+   }
+   case WIRE_LOCALISATION_ROBOT_OBSTACLES: {
+      std::vector<RobotObstacle> obstacles;
+      if (cursor->getArchive(&obstacles)) {
+         blackboard->localisation.robotObstacles.publish(obstacles);
+      }
+      break;
+   }
+   case WIRE_ROBOT_POS:
+      decode(cursor, &blackboard->localisation.robotPos);
+      break;
+   case WIRE_THREAD_TIMINGS: {
+      ThreadBlackboard &thread = blackboard->thread;
+      uint32_t numTimings;
+      if (!cursor->get(&numTimings) || numTimings > MAX_TIMED_THREADS) {
+         cursor->ok = false;
+         break;
+      }
+      for (uint32_t i = 0; i < numTimings; ++i) {
+         ThreadTiming timing;
+         if (!decode(cursor, &timing)) {
+            break;
+         }
+         thread.timings[i].write(timing);
+      }
+      if (cursor->ok) {
+         thread.numTimings = numTimings;
+      }
+      break;
+   }
+   }
+   return cursor->ok;
+}
+
+/**
+ * @return whether this build knows how to decode component
+ */
+bool understands(const WireComponentHeader &component) {
+   if (component.id >= NUM_WIRE_COMPONENTS ||
+       component.id != WIRE_SCHEMA[component.id].id ||
+       component.version != WIRE_SCHEMA[component.id].version) {
+      // once per component, rather than every frame
+      static bool warned[NUM_WIRE_COMPONENTS + 1];
+      bool &once = warned[std::min<uint16_t>(component.id,
+                                             NUM_WIRE_COMPONENTS)];
+      if (!once) {
+         llog(WARNING) << "Skipping component " << component.id
+                       << " version " << component.version << std::endl;
+         once = true;
+      }
+      return false;
+   }
+   return true;
+}
+
+void decodeComponent(const WireComponentHeader &component,
+                     const char *encoding, Blackboard *blackboard) {
+   if (understands(component)) {
+      WireCursor cursor(encoding, component.length);
+      if (!decodeFields(component.id, &cursor, blackboard)) {
+         llog(WARNING) << "Failed to decode "
+                       << WIRE_SCHEMA[component.id].name << std::endl;
+      }
+   }
+}
+
+/**
+ * Copies or decompresses a payload into a buffer of its own if it is the
+ * size expected
+ */
+template <class T>
+T *decodePayload(const char *payload, const WireComponentHeader &component,
+                 std::size_t expected) {
+   if (component.rawPayloadLength != expected) {
+      llog(WARNING) << "Ignoring a " << component.rawPayloadLength
+                    << " byte payload where " << expected
+                    << " bytes were expected" << std::endl;
+      return NULL;
+   }
+   T *buffer = new T[expected / sizeof(T)];
+   if (component.payloadLength == component.rawPayloadLength) {
+      memcpy(buffer, payload, expected);
+   } else {
+      uLongf length = expected;
+      int status = uncompress((Bytef *)buffer, &length,
+                              (const Bytef *)payload, component.payloadLength);
+      if (status != Z_OK || length != expected) {
+         llog(WARNING) << "Failed to decompress payload: " << zError(status)
+                       << std::endl;
+         delete[] buffer;
+         return NULL;
+      }
+   }
+   return buffer;
+}
+
+void decodePayload(const WireComponentHeader &component, const char *payload,
+                   Blackboard *blackboard) {
+   // a payload sent twice in one frame replaces the first
+   VisionBlackboard &vision = blackboard->vision;
+   switch (component.id) {
+   case WIRE_TOP_SALIENCY:
+      delete[] vision.topSaliency;
+      vision.topSaliency =
+         decodePayload<Colour>(payload, component, TOP_SALIENCY_BYTES);
+      break;
+   case WIRE_BOT_SALIENCY:
+      delete[] vision.botSaliency;
+      vision.botSaliency =
+         decodePayload<Colour>(payload, component, BOT_SALIENCY_BYTES);
+      break;
+   case WIRE_TOP_FRAME:
+      delete[] vision.topFrame;
+      vision.topFrame = decodePayload<uint8_t>(payload, component, FRAME_BYTES);
+      break;
+   case WIRE_BOT_FRAME:
+      delete[] vision.botFrame;
+      vision.botFrame = decodePayload<uint8_t>(payload, component, FRAME_BYTES);
+      break;
+   }
+}
+
+}  // namespace
+
+void encodeWireFrame(Blackboard *blackboard, OffNaoMask_t mask,
+                     bool compress, const WireBaseline *baseline,
+                     WireFrame *frame) {
+   VisionBlackboard &vision = blackboard->vision;
+   if ((mask & SALIENCY_MASK) && (!vision.topSaliency || !vision.botSaliency))
+      mask &= (~SALIENCY_MASK);
+   if ((mask & RAW_IMAGE_MASK) && (!vision.topFrame || !vision.botFrame))
+      mask &= (~RAW_IMAGE_MASK);
+   frame->begin(mask);
+
+   // as in Blackboard::save, keep the saliency scans from changing while
+   // the rest of the blackboard is encoded. The frame is written after the
+   // lock is released, so the scans are copied into it.
+   const bool lock = (mask & BLACKBOARD_MASK) && (mask & SALIENCY_MASK);
+   if (lock) {
+      blackboard->locks.serialization->lock();
+   }
+   if (mask & BLACKBOARD_MASK) {
+      encodeComponents(blackboard, mask, frame);
+   }
+   if (mask & SALIENCY_MASK) {
+      frame->putPayload(WIRE_TOP_SALIENCY, vision.topSaliency,
+                        TOP_SALIENCY_BYTES, compress, true);
+      frame->putPayload(WIRE_BOT_SALIENCY, vision.botSaliency,
+                        BOT_SALIENCY_BYTES, compress, true);
+   }
+   if (lock) {
+      blackboard->locks.serialization->unlock();
+   }
+   if (mask & RAW_IMAGE_MASK) {
+      frame->putPayload(WIRE_TOP_FRAME, vision.topFrame, FRAME_BYTES, false);
+      frame->putPayload(WIRE_BOT_FRAME, vision.botFrame, FRAME_BYTES, false);
+   }
+
+   frame->beginComponent(WIRE_ROBOT_POS);
+   encode(frame, blackboard->localisation.robotPos);
+   frame->endComponent();
+
+   frame->finish(compress, baseline);
+}
+
+bool decodeWireFrame(const char *data, std::size_t length,
+                     Blackboard *blackboard, WireBaseline *baseline,
+                     std::string *error) {
+   WireFrameHeader header;
+   if (length < sizeof(header)) {
+      *error = "Frame is shorter than its header";
+      return false;
+   }
+   memcpy(&header, data, sizeof(header));
+   if (!isWireFrameHeader(header)) {
+      *error = "Not a frame this version of offnao can read";
+      return false;
+   }
+   if (length != sizeof(header) + wireFrameBodyLength(header)) {
+      *error = "Frame is not the length its header says";
+      return false;
+   }
+   const bool delta = header.flags & WIRE_DELTA;
+   if (delta && (!baseline || !baseline->covers(header.mask))) {
+      *error = "Waiting for a keyframe";
+      return false;
+   }
+
+   const char *structured = data + sizeof(header);
+   const char *payload = structured + header.structuredLength;
+   const char *payloadEnd = payload + header.payloadLength;
+   std::vector<char> inflated;
+   if (header.flags & WIRE_COMPRESSED) {
+      inflated.resize(header.rawStructuredLength);
+      uLongf inflatedLength = inflated.size();
+      int status = uncompress((Bytef *)&inflated[0], &inflatedLength,
+                              (const Bytef *)structured,
+                              header.structuredLength);
+      if (status != Z_OK || inflatedLength != inflated.size()) {
+         *error = std::string("Failed to decompress frame: ") + zError(status);
+         return false;
+      }
+      structured = &inflated[0];
+   }
+   const char *structuredEnd = structured + header.rawStructuredLength;
+
+   VisionBlackboard &vision = blackboard->vision;
+   vision.topSaliency = vision.botSaliency = NULL;
+   vision.topFrame = vision.botFrame = NULL;
+
+   // check that every component arrived whole before decoding any, so a
+   // frame that does not parse leaves the baseline as it was and has
+   // nothing allocated for it
+   const char *next = structured;
+   const char *nextPayload = payload;
+   for (uint32_t i = 0; i < header.numComponents; ++i) {
+      WireComponentHeader component;
+      if ((std::size_t)(structuredEnd - next) < sizeof(component)) {
+         *error = "Frame ends in the middle of a component";
+         return false;
+      }
+      memcpy(&component, next, sizeof(component));
+      if ((std::size_t)(structuredEnd - next) <
+             sizeof(component) + component.length ||
+          (std::size_t)(payloadEnd - nextPayload) < component.payloadLength) {
+         *error = "Frame ends in the middle of a component";
+         return false;
+      }
+      next += sizeof(component) + component.length;
+      nextPayload += component.payloadLength;
+   }
+
+   blackboard->mask = header.mask;
+   if (baseline && !delta) {
+      baseline->reset();
+      baseline->valid = true;
+      baseline->mask = header.mask;
+   } else if (baseline) {
+      ++baseline->deltas;
+   }
+
+   for (uint32_t i = 0; i < header.numComponents; ++i) {
+      WireComponentHeader component;
+      memcpy(&component, structured, sizeof(component));
+
+      if (isPayload(component)) {
+         if (understands(component)) {
+            decodePayload(component, payload, blackboard);
+         }
+      } else if (baseline) {
+         if (understands(component)) {
+            baseline->store(structured, sizeof(component) + component.length);
+         }
+      } else {
+         decodeComponent(component, structured + sizeof(component),
+                         blackboard);
+      }
+      structured += sizeof(component) + component.length;
+      payload += component.payloadLength;
+   }
+
+   // a delta frame only holds what changed, so decode the whole stream
+   // from the baseline
+   if (baseline) {
+      for (int id = 0; id < NUM_WIRE_COMPONENTS; ++id) {
+         const std::vector<char> &stored = baseline->components[id];
+         if (!stored.empty()) {
+            WireComponentHeader component;
+            memcpy(&component, &stored[0], sizeof(component));
+            decodeComponent(component, &stored[sizeof(component)],
+                            blackboard);
+         }
+      }
+   }
+
+   // as Blackboard::load would have, only claim images that arrived whole
+   if (!vision.topSaliency || !vision.botSaliency) {
+      delete[] vision.topSaliency;
+      delete[] vision.botSaliency;
+      vision.topSaliency = vision.botSaliency = NULL;
+      blackboard->mask &= ~SALIENCY_MASK;
+   }
+   if (!vision.topFrame || !vision.botFrame) {
+      delete[] vision.topFrame;
+      delete[] vision.botFrame;
+      vision.topFrame = vision.botFrame = NULL;
+      blackboard->mask &= ~RAW_IMAGE_MASK;
+   }
+   return true;
+}
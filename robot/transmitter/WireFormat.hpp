@@ -0,0 +1,320 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+#include "transmitter/TransmitterDefs.hpp"
+
+class Blackboard;
+struct z_stream_s;
+
+/**
+ * Layout of a blackboard frame as streamed to offnao.
+ *
+ * A frame is a WireFrameHeader, then the structured section and then the
+ * payloads. The structured section is a sequence of components, each a
+ * WireComponentHeader followed by its encoding, and is compressed with zlib
+ * when the header has WIRE_COMPRESSED set. Payloads are the saliency scans
+ * and raw images, sent in the order of their components. The raw images
+ * are sent straight from where they are on the robot without being copied.
+ * They barely compress and take far longer to compress than to send, so
+ * never are. The saliency scans are copied into the frame under the
+ * serialization lock, and compressed when the rest of the frame is.
+ *
+ * Components are encoded field by field in host byte order, which is x86 on
+ * the robot and on the laptops. A component is only understood by a decoder
+ * with the same version of it in WIRE_SCHEMA, and is skipped otherwise, so
+ * a component can change without breaking the rest of the stream. Changing
+ * the frame layout itself needs a new WIRE_VERSION.
+ *
+ * The few components whose types have no encoder here (Pose, field features,
+ * behaviour requests...) are a boost binary archive of the component alone.
+ *
+ * A frame with WIRE_DELTA set leaves out the components that are the same
+ * as in the previous frame on the same stream. Decoding one needs the
+ * WireBaseline of every frame since the last keyframe, a frame without
+ * WIRE_DELTA, and only works for the mask of that keyframe. Payloads change
+ * every frame so are never left out.
+ */
+static const char WIRE_MAGIC[4] = { 'R', 'S', 'W', 'W' };
+static const uint16_t WIRE_VERSION = 1;
+
+enum WireFlags {
+   WIRE_COMPRESSED = 0x0001,
+   WIRE_DELTA      = 0x0002
+};
+
+enum WireComponentId {
+   WIRE_GAMECONTROLLER = 1,
+   WIRE_MOTION_SENSORS,
+   WIRE_MOTION_POSE,
+   WIRE_MOTION_COM,
+   WIRE_MOTION_ODOMETRY,
+   WIRE_MOTION_ACTIVE,
+   WIRE_MOTION_PENDULUM,
+   WIRE_PERCEPTION,
+   WIRE_BEHAVIOUR_REQUEST,
+   WIRE_KINEMATICS_SONAR,
+   WIRE_KINEMATICS_PARAMETERS,
+   WIRE_KINEMATICS_SENSORS_LAGGED,
+   WIRE_VISION,
+   WIRE_VISION_LANDMARKS,
+   WIRE_VISION_FEET,
+   WIRE_VISION_BALLS,
+   WIRE_VISION_POSTS,
+   WIRE_VISION_ROBOTS,
+   WIRE_VISION_FIELD_EDGES,
+   WIRE_VISION_FIELD_FEATURES,
+   WIRE_RECEIVER,
+   WIRE_LOCALISATION,
+   WIRE_LOCALISATION_ROBOT_OBSTACLES,
+   WIRE_ROBOT_POS,
+   WIRE_TOP_SALIENCY,
+   WIRE_BOT_SALIENCY,
+   WIRE_TOP_FRAME,
+   WIRE_BOT_FRAME,
+   WIRE_THREAD_TIMINGS,
+   NUM_WIRE_COMPONENTS
+};
+
+struct WireComponentSchema {
+   uint16_t id;
+   /* Bumped whenever the component's encoding changes */
+   uint16_t version;
+   const char *name;
+};
+
+/* Every component a frame may hold, indexed by WireComponentId */
+extern const WireComponentSchema WIRE_SCHEMA[NUM_WIRE_COMPONENTS];
+
+struct WireFrameHeader {
+   char magic[4];
+   uint16_t version;
+   uint16_t flags;
+   /* The components in the frame, with the masks of missing images cleared */
+   OffNaoMask_t mask;
+   uint32_t numComponents;
+   /* Bytes of the structured section on the wire, and once decompressed */
+   uint32_t structuredLength;
+   uint32_t rawStructuredLength;
+   /* Bytes of all the payloads together */
+   uint32_t payloadLength;
+};
+
+struct WireComponentHeader {
+   uint16_t id;
+   uint16_t version;
+   /* Bytes of the encoding following this header */
+   uint32_t length;
+   /* Bytes of the component's payload after the structured section, and
+    * once decompressed if they differ */
+   uint32_t payloadLength;
+   uint32_t rawPayloadLength;
+};
+
+/**
+ * @return whether header starts a frame this build can decode
+ */
+bool isWireFrameHeader(const WireFrameHeader &header);
+
+/**
+ * @return the bytes following the header in its frame
+ */
+static inline std::size_t wireFrameBodyLength(const WireFrameHeader &header) {
+   return (std::size_t)header.structuredLength + header.payloadLength;
+}
+
+/**
+ * The components last sent to, or received from, one peer, against which
+ * delta frames are encoded and decoded
+ */
+class WireBaseline {
+   public:
+      WireBaseline();
+
+      /**
+       * Forgets every component, so that only a keyframe can follow
+       */
+      void reset();
+
+      /**
+       * @return whether a frame of mask can be a delta against this
+       */
+      bool covers(OffNaoMask_t mask) const;
+
+      /**
+       * Replaces a component with one from a frame, its header included
+       */
+      void store(const char *component, std::size_t length);
+
+      /* Whether a keyframe has been stored since the last reset */
+      bool valid;
+      OffNaoMask_t mask;
+      /* Delta frames since the last keyframe */
+      unsigned deltas;
+      /* Each component's header and encoding, empty if it was not sent */
+      std::vector<char> components[NUM_WIRE_COMPONENTS];
+};
+
+/**
+ * A frame being encoded, kept between frames so that its buffers are only
+ * allocated once.
+ *
+ * Payloads are referenced rather than copied unless asked to, so the memory
+ * they point to must stay put until the frame has been written.
+ */
+class WireFrame {
+   public:
+      WireFrame();
+      ~WireFrame();
+
+      /**
+       * Starts a new frame, dropping anything encoded before
+       */
+      void begin(OffNaoMask_t mask);
+
+      /**
+       * Starts and ends a component, encoded with the put functions between
+       */
+      void beginComponent(WireComponentId id);
+      void endComponent();
+
+      template <class T>
+      void put(const T &value) {
+         putBytes(&value, sizeof(T));
+      }
+      void putBytes(const void *data, std::size_t length);
+
+      /**
+       * Encodes value as a boost binary archive of its own
+       */
+      template <class T>
+      void putArchive(const T &value);
+
+      /**
+       * Adds a component for a payload sent after the structured section,
+       * compressed if asked to and if it helps
+       *
+       * @param copy whether to keep a copy of data in the frame, for data
+       *        that may change before the frame is written
+       */
+      void putPayload(WireComponentId id, const void *data, uint32_t length,
+                      bool compress, bool copy = false);
+
+      /**
+       * Fills in the header, compressing the structured section if asked to
+       * and if it helps
+       *
+       * @param baseline if not NULL and it covers the frame's mask, leave out
+       *        the components it already has and make this a delta frame
+       */
+      void finish(bool compress, const WireBaseline *baseline);
+
+      /**
+       * Records every component of the frame in baseline, once the frame
+       * has reached the peer baseline is kept for
+       */
+      void acknowledge(WireBaseline *baseline) const;
+
+      /**
+       * The frame as buffers for a gather write, valid until the next begin
+       */
+      const std::vector<boost::asio::const_buffer> &buffers() const;
+
+      /**
+       * @return the bytes in the finished frame
+       */
+      std::size_t size() const;
+
+      const WireFrameHeader &header() const;
+
+   private:
+      /**
+       * Compresses length bytes of data into out, reusing one zlib stream
+       * rather than setting one up each time as compress2 would
+       *
+       * @param compressedLength set to the bytes in out
+       * @return whether it compressed to fewer bytes than length
+       */
+      bool compressInto(const void *data, std::size_t length,
+                        std::vector<char> *out, std::size_t *compressedLength);
+
+      WireFrameHeader header_;
+      z_stream_s *deflater;
+      std::vector<char> structured;
+      /* Where each component's header is in structured */
+      std::vector<std::size_t> componentOffsets;
+      /* The components of a delta frame that differ from its baseline */
+      std::vector<char> delta;
+      std::vector<char> compressed;
+      /**
+       * Payloads compressed or copied into the frame, a deque so they stay
+       * put as more are added
+       */
+      std::deque<std::vector<char> > ownedPayloads;
+      std::size_t numOwnedPayloads;
+      std::vector<boost::asio::const_buffer> payloads;
+      std::vector<boost::asio::const_buffer> gather;
+      /* Where the open component's header is in structured */
+      std::size_t componentStart;
+};
+
+/**
+ * Encodes the components of blackboard selected by mask into frame, as
+ * Blackboard::save would for the same mask
+ *
+ * @param baseline what the peer already has, see WireFrame::finish
+ */
+void encodeWireFrame(Blackboard *blackboard, OffNaoMask_t mask,
+                     bool compress, const WireBaseline *baseline,
+                     WireFrame *frame);
+
+/**
+ * Decodes a whole frame, header included, into blackboard. Saliency and raw
+ * images are copied into buffers allocated with new[], as Blackboard::load
+ * does.
+ *
+ * @param baseline the components of the stream so far, updated with those
+ *        in the frame. Only keyframes can be decoded without one.
+ * @param error why the frame could not be decoded
+ * @return whether the frame could be decoded
+ */
+bool decodeWireFrame(const char *data, std::size_t length,
+                     Blackboard *blackboard, WireBaseline *baseline,
+                     std::string *error);
@@ -0,0 +1,90 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <istream>
+#include <string>
+
+#include "utils/Logger.hpp"
+
+/**
+ * What llog writes to disk. Each log file starts with LOG_MAGIC and is then
+ * a run of records, each a LogRecordHeader followed by length bytes of text.
+ * A record holds at most one line; a line longer than a record is carried on
+ * in the records after it, and the line is done once the text ends in '\n'.
+ * Files are written in the robot's byte order.
+ */
+static const char LOG_MAGIC[8] = { 'R', 'S', 'W', 'L', 'O', 'G', '0', '1' };
+
+struct LogRecordHeader {
+   /* Microseconds since the epoch when the record was written */
+   int64_t timestamp;
+   int32_t level;
+   uint32_t length;
+};
+
+/* @return the name of a LogLevel, or NULL if it is not one */
+inline const char *logLevelName(int level) {
+   switch (level) {
+   case NONE: return "NONE";
+   case SILENT: return "SILENT";
+   case QUIET: return "QUIET";
+   case FATAL: return "FATAL";
+   case ERROR: return "ERROR";
+   case WARNING: return "WARNING";
+   case INFO: return "INFO";
+   case VERBOSE: return "VERBOSE";
+   case DEBUG1: return "DEBUG1";
+   case DEBUG2: return "DEBUG2";
+   case DEBUG3: return "DEBUG3";
+   default:   return NULL;
+   }
+}
+
+/* @return false if in is not a log file */
+inline bool readLogMagic(std::istream &in) {
+   char magic[sizeof(LOG_MAGIC)];
+   return in.read(magic, sizeof(magic)) &&
+          memcmp(magic, LOG_MAGIC, sizeof(magic)) == 0;
+}
+
+/* @return false at the end of the file, or if the last record is cut short */
+inline bool readLogRecord(std::istream &in, LogRecordHeader *header,
+                          std::string *text) {
+   if (!in.read(reinterpret_cast<char *>(header), sizeof(*header))) {
+      return false;
+   }
+   text->resize(header->length);
+   return header->length == 0 || in.read(&(*text)[0], header->length);
+}
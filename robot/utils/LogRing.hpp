@@ -0,0 +1,99 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "utils/LogRecord.hpp"
+
+/**
+ * Log records one thread writes and the log writer thread takes out, without
+ * locks. The writer fills records in place, so logging copies nothing.
+ *
+ * Unlike a SampleRing nothing is overwritten before it is read: when the
+ * ring is full, claim() fails and the caller drops the record, so a slow
+ * disk loses log lines rather than holding the logging thread up.
+ */
+class LogRing {
+   public:
+      static const uint32_t SLOTS = 1024;
+      static const uint32_t TEXT_LENGTH = 240;
+
+      struct Record {
+         LogRecordHeader header;
+         char text[TEXT_LENGTH];
+      };
+
+      LogRing() : head(0), tail(0) {}
+
+      /**
+       * Only call from the thread that logs
+       * @return the next record to fill in, or NULL if the ring is full
+       */
+      Record *claim() {
+         if (head - tail >= SLOTS) {
+            return NULL;
+         }
+         return &records[head % SLOTS];
+      }
+
+      /* Hands the claimed record over to the reader */
+      void commit() {
+         __sync_synchronize();
+         ++head;
+      }
+
+      /**
+       * Only call from the reading thread
+       * @return the oldest committed record, or NULL if there are none
+       */
+      const Record *peek() const {
+         if (tail == head) {
+            return NULL;
+         }
+         __sync_synchronize();
+         return &records[tail % SLOTS];
+      }
+
+      /* Gives the peeked record back to the logging thread */
+      void release() {
+         __sync_synchronize();
+         ++tail;
+      }
+
+   private:
+      Record records[SLOTS];
+
+      /* Records committed and released, only ever written by one side each */
+      volatile uint32_t head;
+      volatile uint32_t tail;
+};
@@ -1,5 +1,8 @@
 #include "Logger.hpp"
 
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
 #include <stdexcept>
 #include <string>
 #include <cstdlib>
@@ -7,11 +10,121 @@
 #include <iostream>
 #include <fstream>
 #include <ostream>
+#include <streambuf>
 #include <map>
 #include "thread/Thread.hpp"
 #include "utils/basic_onullstream.hpp"
+#include "utils/LogRecord.hpp"
+#include "utils/LogRing.hpp"
 
-Logger::Logger(const char *name) {
+/* Most threads that can have a log file at once */
+static const int MAX_LOGGERS = 32;
+/* How often the log writer writes out what has been logged */
+static const int WRITE_INTERVAL_US = 20000;
+static const size_t FILE_BUFFER_SIZE = 64 * 1024;
+
+static Logger *loggers[MAX_LOGGERS];
+static int numLoggers = 0;
+/* Taken by the log writer and when threads start or stop logging, and while
+ * logging only to write out a FATAL or ERROR record */
+static pthread_mutex_t loggersLock = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t now() {
+   struct timespec t;
+   clock_gettime(CLOCK_REALTIME, &t);
+   return (int64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+/**
+ * Formats a thread's log lines straight into records in its LogRing, and
+ * hands each one over when the line is flushed, e.g. by std::endl.
+ */
+class LogBuffer : public std::streambuf {
+   public:
+      LogBuffer(Logger *logger, LogRing *ring)
+         : logger(logger), ring(ring), record(NULL), level(INFO), dropped(0) {
+         setp(NULL, NULL);
+      }
+
+      /**
+       * Sets the level the next record is logged at. Text not yet ended by
+       * a flush was logged at the old level, so it is committed at that.
+       */
+      void setLevel(int level) {
+         if (level != this->level) {
+            sync();
+         }
+         this->level = level;
+      }
+
+   protected:
+      virtual int_type overflow(int_type c) {
+         if (pbase() != NULL) {
+            commit();
+         }
+         claim();
+         if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+         }
+         return traits_type::not_eof(c);
+      }
+
+      virtual int sync() {
+         if (pptr() != pbase()) {
+            commit();
+            setp(NULL, NULL);
+         }
+         return 0;
+      }
+
+   private:
+      Logger *logger;
+      LogRing *ring;
+      LogRing::Record *record;
+      int level;
+
+      /* Records lost to a full ring since the last one that made it */
+      uint32_t dropped;
+      char scratch[LogRing::TEXT_LENGTH];
+
+      void claim() {
+         record = ring->claim();
+         if (record && dropped) {
+            int length = snprintf(record->text, LogRing::TEXT_LENGTH,
+                                  "(%u log records dropped)\n", dropped);
+            record->header.timestamp = now();
+            record->header.level = WARNING;
+            record->header.length = length;
+            ring->commit();
+            dropped = 0;
+            record = ring->claim();
+         }
+         if (record) {
+            setp(record->text, record->text + LogRing::TEXT_LENGTH);
+         } else {
+            setp(scratch, scratch + LogRing::TEXT_LENGTH);
+         }
+      }
+
+      void commit() {
+         if (record) {
+            record->header.timestamp = now();
+            record->header.level = level;
+            record->header.length = pptr() - pbase();
+            ring->commit();
+            record = NULL;
+            // the log writer may not get to these before a crash
+            if (level <= ERROR) {
+               logger->drainNow();
+            }
+         } else {
+            ++dropped;
+         }
+      }
+};
+
+Logger::Logger(const char *name) : ring(NULL), buffer(NULL), file(NULL) {
    if (!initialised) {
       throw std::runtime_error("Logging framework not initialized.");
    } else {
@@ -23,15 +136,48 @@ Logger::Logger(const char *name) {
       } else if (!motion && (strcmp(name, "Motion") == 0)) {
          logStream = new onullstream;
       } else {
-         logStream = new std::ofstream((logPath + std::string("/") + std::string(name)).c_str(), std::ios_base::out);
+         file = fopen((logPath + std::string("/") + std::string(name)).c_str(),
+                      "w");
+         if (file == NULL) {
+            logStream = new onullstream;
+            return;
+         }
+         setvbuf(file, NULL, _IOFBF, FILE_BUFFER_SIZE);
+         fwrite(LOG_MAGIC, sizeof(LOG_MAGIC), 1, file);
+         ring = new LogRing();
+         buffer = new LogBuffer(this, ring);
+         logStream = new std::ostream(buffer);
+
+         pthread_mutex_lock(&loggersLock);
+         if (numLoggers < MAX_LOGGERS) {
+            loggers[numLoggers++] = this;
+         } else {
+            std::cerr << "Too many threads to log " << name << std::endl;
+         }
+         pthread_mutex_unlock(&loggersLock);
       }
    }
 }
 
 Logger::~Logger() {
-   if (logStream != std::cerr) {
+   if (ring) {
+      logStream->flush();
+      pthread_mutex_lock(&loggersLock);
+      for (int i = 0; i < numLoggers; ++i) {
+         if (loggers[i] == this) {
+            loggers[i] = loggers[--numLoggers];
+            break;
+         }
+      }
+      drain();
+      pthread_mutex_unlock(&loggersLock);
+      fclose(file);
+   }
+   if (logStream != &std::cerr) {
       delete logStream;
    }
+   delete buffer;
+   delete ring;
    logStream = NULL;
 }
 
@@ -57,6 +203,15 @@ void Logger::init(std::string logPath_, std::string logLevel_, bool motion_) {
    init(logLevel_, motion_);
    logPath = logPath_;
    system((std::string("/bin/mkdir -p ") + logPath).c_str());
+   if (!initialised) {
+      pthread_t writer;
+      if (pthread_create(&writer, NULL, &Logger::writeLogs, NULL) == 0) {
+         pthread_detach(writer);
+      } else {
+         std::cerr << "Could not start the log writer" << std::endl;
+      }
+      atexit(&Logger::flush);
+   }
    initialised = true;
 }
 
@@ -73,12 +228,46 @@ Logger *Logger::instance() {
 }
 
 std::ostream &Logger::realLlog(int logLevel_) {
-   if (logLevel >= logLevel_) {
-      return *logStream;
-   } else {
-      static onullstream nullStream;
-      return nullStream;
+   if (buffer) {
+      buffer->setLevel(logLevel_);
+   }
+   return *logStream;
+}
+
+void Logger::drain() {
+   const LogRing::Record *record = ring->peek();
+   if (record == NULL) {
+      return;
+   }
+   for (; record != NULL; record = ring->peek()) {
+      fwrite(&record->header, sizeof(record->header), 1, file);
+      fwrite(record->text, record->header.length, 1, file);
+      ring->release();
+   }
+   fflush(file);
+}
+
+void Logger::drainNow() {
+   pthread_mutex_lock(&loggersLock);
+   drain();
+   pthread_mutex_unlock(&loggersLock);
+}
+
+void Logger::flush() {
+   pthread_mutex_lock(&loggersLock);
+   for (int i = 0; i < numLoggers; ++i) {
+      loggers[i]->drain();
+   }
+   pthread_mutex_unlock(&loggersLock);
+}
+
+void *Logger::writeLogs(void *) {
+   // Batches each thread's records into one write per interval
+   for (;;) {
+      flush();
+      usleep(WRITE_INTERVAL_US);
    }
+   return NULL;
 }
 
 __thread Logger *Logger::logger = NULL;
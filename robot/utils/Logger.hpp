@@ -1,10 +1,23 @@
 #pragma once
 
+#include <cstdio>
 #include <string>
 #include <ostream>
 #include <boost/program_options/variables_map.hpp>
 
-#define llog(X) ((Logger::instance())->realLlog(X))
+/**
+ * Disabled levels cost a comparison: nothing after the << is evaluated.
+ * Enabled levels are written into the thread's LogRing and go to disk from
+ * the log writer thread, so logging never blocks on I/O. FATAL and ERROR
+ * records are the exception, and are written out before llog returns.
+ *
+ * The guard is a for rather than an if, so an llog in an unbraced if has no
+ * else of its own to dangle.
+ */
+#define llog(X) \
+   for (bool llogEnabled_ = Logger::enabled(X); llogEnabled_; \
+        llogEnabled_ = false) \
+      ((Logger::instance())->realLlog(X))
 
 /**
  * Possible log levels
@@ -35,14 +48,26 @@ enum LogLevel {
    DEBUG3  = 100
 };
 
+class LogRing;
+class LogBuffer;
+
 class Logger {
    public:
       Logger(const char *name);
       virtual ~Logger();
       static void init(std::string logPath, std::string logLevel, bool motion);
       static Logger *instance();
+      static bool enabled(int logLevel_) {
+         return logLevel >= logLevel_;
+      }
       std::ostream &realLlog(int logLevel);
 
+      /**
+       * Writes out everything logged so far. Called at exit, so a record
+       * is only lost if the process dies without exiting.
+       */
+      static void flush();
+
    private:
       static void readOptions(const boost::program_options::variables_map &config);
       static void init(std::string logLevel, bool motion);
@@ -52,4 +77,19 @@ class Logger {
       static std::string logPath;
       static bool initialised;
       std::ostream *logStream;
+
+      /* Only for threads that log to a file */
+      LogRing *ring;
+      LogBuffer *buffer;
+      FILE *file;
+
+      /* Writes the records waiting in ring to file */
+      void drain();
+
+      /* Writes out this thread's records now, for FATAL and ERROR */
+      void drainNow();
+
+      friend class LogBuffer;
+
+      static void *writeLogs(void *);
 };
@@ -0,0 +1,101 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * A fixed capacity history of timestamped samples that one thread writes
+ * and any number of threads read, without locks.
+ *
+ * The writer never waits on readers. Each slot carries a sequence number that
+ * is odd while the slot is being written and encodes which push it holds
+ * once written, so a reader can tell if the slot was overwritten (or is
+ * being overwritten) while it copied it. Readers therefore only ever see
+ * whole samples, at the cost of losing the oldest one to a fast writer.
+ */
+template <class T, unsigned int N>
+class SampleRing {
+   public:
+      SampleRing();
+
+      /**
+       * Appends a sample, overwriting the oldest once full.
+       * Only ever call this from one thread.
+       */
+      void push(int64_t timestamp, const T &sample);
+
+      /* @return the number of samples pushed so far */
+      uint32_t size() const;
+
+      /**
+       * Copies the sample pushed lag pushes before the newest one
+       * @param lag 0 for the newest sample
+       * @param sample where to copy the sample to
+       * @param timestamp if not NULL, set to the sample's timestamp
+       * @return false if the sample has not been pushed yet or was overwritten
+       */
+      bool getLagged(unsigned int lag, T *sample,
+                     int64_t *timestamp = NULL) const;
+
+      /**
+       * Copies a sample by when it was pushed, which unlike a lag does not
+       * change if the writer pushes again meanwhile
+       * @param n 0 for the first sample ever pushed
+       * @return false if the sample has not been pushed yet or was overwritten
+       */
+      bool get(uint32_t n, T *sample, int64_t *timestamp = NULL) const;
+
+      /**
+       * Finds the newest sample at or before a given time
+       * @return its lag, or -1 if no such sample is still stored
+       */
+      int findLag(int64_t timestamp) const;
+
+   private:
+      struct Slot {
+         volatile uint32_t sequence;
+         int64_t timestamp;
+         T sample;
+      };
+
+      Slot slots[N];
+
+      /* Number of pushes so far, only ever written by the writer */
+      volatile uint32_t count;
+
+      /* Sequence number of a slot once push n has been written into it */
+      static uint32_t written(uint32_t n) { return 2 * n + 2; }
+};
+
+#include "utils/SampleRing.tcc"
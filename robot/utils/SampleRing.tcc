@@ -0,0 +1,79 @@
+template <class T, unsigned int N>
+SampleRing<T, N>::SampleRing() : count(0) {
+   for (unsigned int i = 0; i < N; ++i) {
+      slots[i].sequence = 0;
+   }
+}
+
+template <class T, unsigned int N>
+void SampleRing<T, N>::push(int64_t timestamp, const T &sample) {
+   const uint32_t n = count;
+   Slot &slot = slots[n % N];
+
+   slot.sequence = written(n) - 1;
+   __sync_synchronize();
+   slot.timestamp = timestamp;
+   slot.sample = sample;
+   __sync_synchronize();
+   slot.sequence = written(n);
+   __sync_synchronize();
+   count = n + 1;
+}
+
+template <class T, unsigned int N>
+uint32_t SampleRing<T, N>::size() const {
+   return count;
+}
+
+template <class T, unsigned int N>
+bool SampleRing<T, N>::getLagged(unsigned int lag, T *sample,
+                                 int64_t *timestamp) const {
+   const uint32_t c = count;
+   if (lag >= c || lag >= N) {
+      return false;
+   }
+   return get(c - 1 - lag, sample, timestamp);
+}
+
+template <class T, unsigned int N>
+bool SampleRing<T, N>::get(uint32_t n, T *sample, int64_t *timestamp) const {
+   const Slot &slot = slots[n % N];
+
+   if (slot.sequence != written(n)) {
+      return false;
+   }
+   __sync_synchronize();
+   int64_t t = slot.timestamp;
+   *sample = slot.sample;
+   __sync_synchronize();
+   if (slot.sequence != written(n)) {
+      return false;
+   }
+   if (timestamp) {
+      *timestamp = t;
+   }
+   return true;
+}
+
+template <class T, unsigned int N>
+int SampleRing<T, N>::findLag(int64_t timestamp) const {
+   const uint32_t c = count;
+   for (uint32_t lag = 0; lag < c && lag < N; ++lag) {
+      const uint32_t n = c - 1 - lag;
+      const Slot &slot = slots[n % N];
+
+      if (slot.sequence != written(n)) {
+         return -1;
+      }
+      __sync_synchronize();
+      int64_t t = slot.timestamp;
+      __sync_synchronize();
+      if (slot.sequence != written(n)) {
+         return -1;
+      }
+      if (t <= timestamp) {
+         return lag;
+      }
+   }
+   return -1;
+}
@@ -0,0 +1,85 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "utils/ThreadIndex.hpp"
+#include "utils/Version.hpp"
+
+/**
+ * A value that one thread writes and any number of threads read, without
+ * locks, for plain data that is cheap to copy.
+ *
+ * The writer never waits. It makes the sequence number odd while it copies
+ * the value in, so a reader that copied the value out while the sequence was
+ * odd, or while it changed, knows its copy may be torn and copies again.
+ * Each reading thread gets its own copy, kept here so that read() can hand out
+ * a reference like any other blackboard component.
+ */
+template <class T>
+class Seqlock {
+   public:
+      Seqlock();
+      explicit Seqlock(const T &value);
+      Seqlock(const Seqlock &other);
+      Seqlock &operator=(const Seqlock &other);
+      ~Seqlock();
+
+      /**
+       * Replaces the value. Only ever call this from one thread at a time.
+       */
+      void write(const T &value);
+
+      /**
+       * Copies the newest whole value out for the calling thread
+       * @return the thread's copy, which stays valid until the same thread
+       *         reads this Seqlock again, and must not be used by any other
+       *         thread or after this one exits
+       */
+      const T &read() const;
+
+      /* @return the writes so far */
+      const Version &version() const;
+
+   private:
+      volatile uint32_t sequence;
+      T current;
+      Version writes;
+
+      /* Per-thread copies handed out by read(), allocated on first use */
+      mutable T *copies[MAX_THREAD_INDICES];
+
+      void init();
+};
+
+#include "utils/Seqlock.tcc"
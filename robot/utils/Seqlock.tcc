@@ -0,0 +1,73 @@
+template <class T>
+Seqlock<T>::Seqlock() : current() {
+   init();
+}
+
+template <class T>
+Seqlock<T>::Seqlock(const T &value) : current(value) {
+   init();
+}
+
+template <class T>
+Seqlock<T>::Seqlock(const Seqlock &other) : current(other.read()) {
+   init();
+}
+
+template <class T>
+Seqlock<T> &Seqlock<T>::operator=(const Seqlock &other) {
+   if (this != &other) {
+      write(other.read());
+   }
+   return *this;
+}
+
+template <class T>
+Seqlock<T>::~Seqlock() {
+   for (int i = 0; i < MAX_THREAD_INDICES; ++i) {
+      delete copies[i];
+   }
+}
+
+template <class T>
+void Seqlock<T>::init() {
+   sequence = 0;
+   for (int i = 0; i < MAX_THREAD_INDICES; ++i) {
+      copies[i] = NULL;
+   }
+}
+
+template <class T>
+void Seqlock<T>::write(const T &value) {
+   const uint32_t s = sequence;
+   sequence = s + 1;
+   __sync_synchronize();
+   current = value;
+   __sync_synchronize();
+   sequence = s + 2;
+   writes.bump();
+}
+
+template <class T>
+const T &Seqlock<T>::read() const {
+   T *&copy = copies[threadIndex()];
+   if (copy == NULL) {
+      copy = new T();
+   }
+   for (;;) {
+      const uint32_t s = sequence;
+      if (s & 1) {
+         continue;
+      }
+      __sync_synchronize();
+      *copy = current;
+      __sync_synchronize();
+      if (sequence == s) {
+         return *copy;
+      }
+   }
+}
+
+template <class T>
+const Version &Seqlock<T>::version() const {
+   return writes;
+}
@@ -0,0 +1,95 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "utils/ThreadIndex.hpp"
+#include "utils/Version.hpp"
+
+/**
+ * A value that one thread publishes and any number of threads acquire,
+ * without locks and without copying on the reader side, for data such as
+ * vectors that is too big or too irregular to copy on every read.
+ *
+ * This is a triple buffer generalised to many readers. Each thread holds at
+ * most one buffer, the one it last acquired, and the writer always has one
+ * spare that is neither held nor the newest to publish into, so neither side
+ * ever waits. Buffers are allocated the first time the writer needs another
+ * one, which stops happening once every reading thread has read.
+ */
+template <class T>
+class SnapshotBuffer {
+   public:
+      SnapshotBuffer();
+      explicit SnapshotBuffer(const T &value);
+      SnapshotBuffer(const SnapshotBuffer &other);
+      SnapshotBuffer &operator=(const SnapshotBuffer &other);
+      ~SnapshotBuffer();
+
+      /**
+       * Makes a copy of value the newest. Only ever call this from one thread
+       * at a time.
+       */
+      void publish(const T &value);
+
+      /**
+       * Holds the newest value for the calling thread
+       * @return the value, which stays valid and unchanged until the same
+       *         thread acquires from this SnapshotBuffer again, and must not
+       *         be used after the thread exits
+       */
+      const T &acquire() const;
+
+      /* @return the publishes so far */
+      const Version &version() const;
+
+   private:
+      static const int NUM_BUFFERS = MAX_THREAD_INDICES + 2;
+
+      T *buffers[NUM_BUFFERS];
+
+      /* Index of the newest buffer */
+      volatile int newest;
+
+      /* Index of the buffer each thread holds, or -1 */
+      mutable volatile int held[MAX_THREAD_INDICES];
+
+      Version publishes;
+
+      void init(const T &value);
+
+      /* @return a buffer that no thread holds and is not the newest */
+      int spare();
+};
+
+#include "utils/SnapshotBuffer.tcc"
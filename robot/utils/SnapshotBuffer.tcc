@@ -0,0 +1,100 @@
+template <class T>
+SnapshotBuffer<T>::SnapshotBuffer() {
+   init(T());
+}
+
+template <class T>
+SnapshotBuffer<T>::SnapshotBuffer(const T &value) {
+   init(value);
+}
+
+template <class T>
+SnapshotBuffer<T>::SnapshotBuffer(const SnapshotBuffer &other) {
+   init(other.acquire());
+}
+
+template <class T>
+SnapshotBuffer<T> &SnapshotBuffer<T>::operator=(const SnapshotBuffer &other) {
+   if (this != &other) {
+      publish(other.acquire());
+   }
+   return *this;
+}
+
+template <class T>
+SnapshotBuffer<T>::~SnapshotBuffer() {
+   for (int i = 0; i < NUM_BUFFERS; ++i) {
+      delete buffers[i];
+   }
+}
+
+template <class T>
+void SnapshotBuffer<T>::init(const T &value) {
+   buffers[0] = new T(value);
+   for (int i = 1; i < NUM_BUFFERS; ++i) {
+      buffers[i] = NULL;
+   }
+   for (int i = 0; i < MAX_THREAD_INDICES; ++i) {
+      held[i] = -1;
+   }
+   newest = 0;
+}
+
+template <class T>
+int SnapshotBuffer<T>::spare() {
+   int unallocated = -1;
+   for (int b = 0; b < NUM_BUFFERS; ++b) {
+      if (b == newest) {
+         continue;
+      }
+      if (buffers[b] == NULL) {
+         if (unallocated < 0) {
+            unallocated = b;
+         }
+         continue;
+      }
+      bool isHeld = false;
+      for (int t = 0; t < MAX_THREAD_INDICES && !isHeld; ++t) {
+         isHeld = held[t] == b;
+      }
+      if (!isHeld) {
+         return b;
+      }
+   }
+   // At most MAX_THREAD_INDICES are held and one is the newest, so there
+   // is always one left to allocate
+   buffers[unallocated] = new T();
+   return unallocated;
+}
+
+template <class T>
+void SnapshotBuffer<T>::publish(const T &value) {
+   const int b = spare();
+   *buffers[b] = value;
+   __sync_synchronize();
+   newest = b;
+   // Readers that saw the old newest must have their hold seen by the next
+   // spare(), or that buffer could be overwritten under them
+   __sync_synchronize();
+   publishes.bump();
+}
+
+template <class T>
+const T &SnapshotBuffer<T>::acquire() const {
+   volatile int &hold = held[threadIndex()];
+   for (;;) {
+      const int b = newest;
+      hold = b;
+      __sync_synchronize();
+      // If b is still the newest, the writer was not publishing into it when
+      // the hold was made, and will see the hold before it next picks a spare
+      if (newest == b) {
+         return *buffers[b];
+      }
+   }
+}
+
+template <class T>
+const Version &SnapshotBuffer<T>::version() const {
+   return publishes;
+}
@@ -0,0 +1,94 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdexcept>
+
+/* Most threads that can hold per-thread state in a lock-free structure at
+ * once, one per bit of the in-use mask below */
+const int MAX_THREAD_INDICES = 32;
+
+/* Bit i is set while a live thread has index i */
+inline volatile uint32_t &threadIndicesInUse() {
+   static volatile uint32_t inUse = 0;
+   return inUse;
+}
+
+/* Destructor of the key below, hands the exiting thread's index back */
+inline void releaseThreadIndex(void *index) {
+   __sync_fetch_and_and(&threadIndicesInUse(),
+                        ~(1u << ((intptr_t)index - 1)));
+}
+
+inline pthread_key_t &threadIndexKey() {
+   static pthread_key_t key;
+   return key;
+}
+
+inline void createThreadIndexKey() {
+   pthread_key_create(&threadIndexKey(), &releaseThreadIndex);
+}
+
+/**
+ * A small, dense index for the calling thread, handed out the first time the
+ * thread asks for one, so that lock-free structures can keep per-thread state
+ * in plain arrays. The index is freed when the thread exits and handed to the
+ * next thread that asks, along with whatever state was kept for it, so
+ * nothing a thread read through one may be used after it exits.
+ * @throws std::runtime_error if MAX_THREAD_INDICES threads already hold one
+ */
+inline int threadIndex() {
+   static __thread int index = -1;
+   if (index < 0) {
+      static pthread_once_t once = PTHREAD_ONCE_INIT;
+      pthread_once(&once, &createThreadIndexKey);
+      for (;;) {
+         const uint32_t inUse = threadIndicesInUse();
+         if (inUse == 0xffffffffu) {
+            throw std::runtime_error(
+               "threadIndex(): more than 32 threads are reading lock-free "
+               "blackboard components at once");
+         }
+         const int unused = __builtin_ctz(~inUse);
+         if (__sync_bool_compare_and_swap(&threadIndicesInUse(), inUse,
+                                          inUse | (1u << unused))) {
+            index = unused;
+            break;
+         }
+      }
+      // stored off by one, the destructor only runs for non-NULL values
+      pthread_setspecific(threadIndexKey(), (void *)(intptr_t)(index + 1));
+   }
+   return index;
+}
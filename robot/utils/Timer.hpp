@@ -82,16 +82,22 @@ class Timer {
                 sec(timeStamp);
       }
 
+      /* Differences are taken in 64 bit integers: a float of the whole time
+       * since the epoch can not hold microseconds, and a 32 bit long of the
+       * microseconds since restart() overflows after 35 minutes */
       uint32_t elapsed_ms() {
          timeval tmp;
          gettimeofday(&tmp, NULL);
-         return msec(tmp) - msec(timeStamp);
+         return (int64_t)(tmp.tv_sec - timeStamp.tv_sec) * 1000 +
+                (tmp.tv_usec - timeStamp.tv_usec) / 1000;
       }
 
+      /* wraps after 71 minutes, use elapsed_ms() for anything longer */
       uint32_t elapsed_us() {
          timeval tmp;
          gettimeofday(&tmp, NULL);
-         return usec(tmp) - usec(timeStamp);
+         return (int64_t)(tmp.tv_sec - timeStamp.tv_sec) * 1000000 +
+                (tmp.tv_usec - timeStamp.tv_usec);
       }
 
       /* return estimated maximum value for elapsed() */
@@ -0,0 +1,142 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "utils/Version.hpp"
+
+#include <climits>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+Version::Version() : count(0), stamping(0), time(0), waiters(0) {}
+
+Version::Version(const Version &)
+   : count(0), stamping(0), time(0), waiters(0) {}
+
+Version &Version::operator=(const Version &) {
+   return *this;
+}
+
+void Version::bump() {
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   const int64_t stamp = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+   for (;;) {
+      const uint32_t s = stamping;
+      if (!(s & 1) && __sync_bool_compare_and_swap(&stamping, s, s + 1)) {
+         break;
+      }
+   }
+   // A writer that got here later may have read the clock earlier
+   if (stamp > time) {
+      time = stamp;
+   }
+   __sync_fetch_and_add(&stamping, 1);
+   // Either a waiter sees the new count before it sleeps, or it has
+   // registered by now and gets woken, as the add is a full barrier
+   __sync_fetch_and_add(&count, 1);
+   if (waiters) {
+#ifdef __linux__
+      syscall(SYS_futex, &count, FUTEX_WAKE_PRIVATE, INT_MAX,
+              NULL, NULL, 0);
+#endif
+   }
+}
+
+uint32_t Version::number() const {
+   return count;
+}
+
+int64_t Version::timestamp() const {
+   for (;;) {
+      const uint32_t s = stamping;
+      if (s & 1) {
+         continue;
+      }
+      __sync_synchronize();
+      const int64_t t = time;
+      __sync_synchronize();
+      if (stamping == s) {
+         return t;
+      }
+   }
+}
+
+bool Version::changedSince(uint32_t since) const {
+   return count != since;
+}
+
+bool Version::wait(uint32_t since, int timeoutMs) const {
+   if (changedSince(since)) {
+      return true;
+   }
+
+   struct timespec deadline;
+   clock_gettime(CLOCK_MONOTONIC, &deadline);
+   deadline.tv_sec += timeoutMs / 1000;
+   deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+   if (deadline.tv_nsec >= 1000000000L) {
+      ++deadline.tv_sec;
+      deadline.tv_nsec -= 1000000000L;
+   }
+
+   __sync_fetch_and_add(&waiters, 1);
+   while (!changedSince(since)) {
+      struct timespec remaining, now;
+      struct timespec *timeout = NULL;
+      if (timeoutMs >= 0) {
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+         remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+         if (remaining.tv_nsec < 0) {
+            --remaining.tv_sec;
+            remaining.tv_nsec += 1000000000L;
+         }
+         if (remaining.tv_sec < 0) {
+            break;
+         }
+         timeout = &remaining;
+      }
+#ifdef __linux__
+      // Only sleeps if count is still since, so a bump in between is not lost
+      syscall(SYS_futex, &count, FUTEX_WAIT_PRIVATE, since, timeout, NULL, 0);
+#else
+      usleep(1000);
+#endif
+   }
+   __sync_fetch_and_sub(&waiters, 1);
+   return changedSince(since);
+}
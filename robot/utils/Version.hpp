@@ -0,0 +1,84 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Counts the changes to something that one thread writes, and when the
+ * newest one was made, so that other threads can skip work on data that has
+ * not changed, or sleep until it does.
+ *
+ * Recording a change never blocks. Copies start again from no changes, as
+ * they count changes to a different object.
+ */
+class Version {
+   public:
+      Version();
+      Version(const Version &other);
+      Version &operator=(const Version &other);
+
+      /**
+       * Records a change made now. Call this after the change is visible to
+       * other threads. Any number of threads may bump the same Version.
+       */
+      void bump();
+
+      /* @return the number of changes so far */
+      uint32_t number() const;
+
+      /* @return when the newest change was made (us), or 0 if there was none */
+      int64_t timestamp() const;
+
+      /* @return whether there were changes after the given number() */
+      bool changedSince(uint32_t since) const;
+
+      /**
+       * Waits for a change after the given number()
+       * @param timeoutMs how long to wait at most, or -1 for ever
+       * @return whether there was a change
+       */
+      bool wait(uint32_t since, int timeoutMs = -1) const;
+
+   private:
+      volatile uint32_t count;
+
+      /**
+       * Odd while a writer holds time, which may take two stores to write.
+       * Writers take turns holding it, so none leaves it odd.
+       */
+      volatile uint32_t stamping;
+      volatile int64_t time;
+
+      /* Threads in wait(), so bump() only makes a syscall if needed */
+      mutable volatile uint32_t waiters;
+};
@@ -43,6 +43,13 @@ namespace po = boost::program_options;
 using namespace std;
 using namespace __gnu_cxx;
 
+/* Called by po::notify, a filter can not run without particles */
+static void checkParticles(int particles) {
+   if (particles < 1) {
+      throw po::error("localisation.particles must be at least 1");
+   }
+}
+
 void populate_options(po::options_description &config_file_options) {
    po::options_description game_config("Game options");
    game_config.add_options()
@@ -89,6 +96,8 @@ void populate_options(po::options_description &config_file_options) {
        "Go to PLAYING state when in SET state and whistle heard")
       ("debug.dump,D", po::value<string>()->default_value(""),
       "Dump blackboard in .bbd format. Empty string disables.")
+      ("debug.dump.compression", po::value<int>()->default_value(1),
+      "zlib level (1-9) to compress dumps with, 0 to store them uncompressed")
       ("debug.mask", po::value<int>()->default_value(INITIAL_MASK),
       "Blackboard mask determining what is serialised");
 
@@ -160,7 +169,18 @@ void populate_options(po::options_description &config_file_options) {
       ("walk.moveFrac", po::value<float>()->default_value(0.4f),
       "fraction of cycle in which leg move is performed.")
       ("walk.m", po::value<float>()->default_value(0.0),
-      "leg lift frequency multiplier (must be multiple of two)");
+      "leg lift frequency multiplier (must be multiple of two)")
+      ("walk.ikCache", po::value<bool>()->default_value(false),
+      "look walking leg joint angles up on a quantised grid instead of "
+      "solving the inverse kinematics every tick");
+
+   po::options_description localisation_config("Localisation options");
+   localisation_config.add_options()
+      ("localisation.backend", po::value<string>()->default_value("MultiGaussian"),
+      "filter used for localisation (MultiGaussian, Particle)")
+      ("localisation.particles",
+      po::value<int>()->default_value(200)->notifier(&checkParticles),
+      "number of particles used by the Particle backend");
 
    po::options_description vision_config("Vision options");
    vision_config.add_options()
@@ -301,7 +321,21 @@ void populate_options(po::options_description &config_file_options) {
       ("transmitter.address", po::value<string>()->default_value
          ("192.168.0.255"), "address to broadcast to")
       ("transmitter.base_port", po::value<int>()->default_value(10000),
-      "port to which we add team number, and then broadcast on");
+      "port to which we add team number, and then broadcast on")
+      ("transmitter.offnao.keyframe", po::value<int>()->default_value(30),
+      "frames between whole blackboards sent to offnao, those between only "
+      "hold what changed. 1 sends every frame whole")
+      ("transmitter.offnao.queue", po::value<int>()->default_value(2),
+      "frames an offnao may fall behind before those it has not been sent "
+      "are dropped")
+      ("transmitter.shm", po::value<bool>()->default_value(false),
+      "also publish blackboards in shared memory, for offnao and tools "
+      "on the same machine")
+      ("transmitter.shm.slots", po::value<int>()->default_value(4),
+      "blackboards kept in shared memory for readers that fall behind")
+      ("transmitter.shm.mask", po::value<int>()->default_value
+         (BLACKBOARD_MASK | SALIENCY_MASK | RAW_IMAGE_MASK),
+      "OffNaoMask_t of what to publish in shared memory");
 
    po::options_description network_config("Networking options");
    network_config.add_options()
@@ -323,10 +357,35 @@ void populate_options(po::options_description &config_file_options) {
       ("remotecontrol.port", po::value<int>()->default_value(4000),
        "port to receive on");
 
+   /* Motion must never wait on the others, and perception used to have an
+    * alarm set for it, so they keep those by default */
+   struct { const char *name; int priority; int watchdog; } threads[] = {
+      { "motion", 65, 0 },
+      { "perception", 0, 5 },
+      { "gamecontroller", 0, 0 },
+      { "offnaotransmitter", 0, 0 },
+      { "teamtransmitter", 0, 0 },
+      { "teamreceiver", 0, 0 },
+   };
+   po::options_description thread_config("Thread options");
+   for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+      const string prefix = string("thread.") + threads[i].name;
+      thread_config.add_options()
+         ((prefix + ".priority").c_str(),
+          po::value<int>()->default_value(threads[i].priority),
+          "SCHED_FIFO priority (1-99), 0 for the normal scheduler")
+         ((prefix + ".cpu").c_str(), po::value<int>()->default_value(-1),
+          "CPU to pin the thread to, -1 to let it run on any")
+         ((prefix + ".watchdog").c_str(),
+          po::value<int>()->default_value(threads[i].watchdog),
+          "seconds a tick may take before we say it has frozen, 0 for never");
+   }
+
    config_file_options.add(game_config).add(player_config)
    .add(gamecontroller_config).add(debug_config).add(behaviour_config)
-   .add(motion_config).add(vision_config).add(camera_config).add(kinematics_config)
-   .add(transmitter_config).add(network_config).add(touch_config);
+   .add(motion_config).add(localisation_config).add(vision_config).add(camera_config).add(kinematics_config)
+   .add(transmitter_config).add(network_config).add(touch_config)
+   .add(thread_config);
 }
 
 po::options_description store_and_notify(int argc, char **argv,
@@ -0,0 +1,268 @@
+/**
+ * Renders the binary log files llog writes as text.
+ *
+ * Usage: logdecode [-r] Perception [Motion ...]
+ *        logdecode [-r] -f Perception [Motion ...]
+ *
+ * Each line is printed with the wall clock time it was logged at and its
+ * level. Given several threads' logs, the lines are merged in time order and
+ * tagged with the file they came from. -r prints times as raw microseconds.
+ *
+ * -f follows logs as they are written, like tail -f, merging several by time.
+ * Pass - to follow a log piped in, e.g.
+ *    ssh nao@robot "tail -c +1 -f /var/volatile/runswift/x/Perception"
+ * or name fifos to follow several logs piped in at once.
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/LogRecord.hpp"
+
+using namespace std;
+
+struct Line {
+   int64_t timestamp;
+   int level;
+   size_t file;
+   string text;
+
+   bool operator<(const Line &other) const {
+      return timestamp < other.timestamp;
+   }
+};
+
+/* Reads a log file, joining lines that were split across records */
+static bool readLines(const char *path, size_t file, vector<Line> *lines) {
+   ifstream in(path, ios::in | ios::binary);
+   if (!in.is_open() || !readLogMagic(in)) {
+      cerr << path << " is not a log file" << endl;
+      return false;
+   }
+   LogRecordHeader header;
+   string text;
+   bool lineDone = true;
+   while (readLogRecord(in, &header, &text)) {
+      if (lineDone) {
+         Line line;
+         line.timestamp = header.timestamp;
+         line.level = header.level;
+         line.file = file;
+         lines->push_back(line);
+      }
+      lines->back().text += text;
+      lineDone = !text.empty() && text[text.size() - 1] == '\n';
+   }
+   return true;
+}
+
+static string formatTime(int64_t timestamp, bool raw) {
+   char buffer[32];
+   if (raw) {
+      snprintf(buffer, sizeof(buffer), "%lld", (long long)timestamp);
+   } else {
+      time_t seconds = timestamp / 1000000;
+      struct tm tm;
+      localtime_r(&seconds, &tm);
+      size_t length = strftime(buffer, sizeof(buffer), "%H:%M:%S", &tm);
+      snprintf(buffer + length, sizeof(buffer) - length, ".%06d",
+               (int)(timestamp % 1000000));
+   }
+   return buffer;
+}
+
+static void printLine(const Line &line, const char *name, bool raw) {
+   const char *level = logLevelName(line.level);
+   cout << formatTime(line.timestamp, raw) << " ";
+   if (name) {
+      cout << name << " ";
+   }
+   if (level) {
+      cout << level;
+   } else {
+      cout << line.level;
+   }
+   cout << ": " << line.text;
+   if (line.text.empty() || line.text[line.text.size() - 1] != '\n') {
+      cout << endl;
+   }
+}
+
+/* A log being followed, and whatever of it has not made a whole line yet */
+struct Followed {
+   const char *path;
+   string name;
+   int fd;
+   bool pipe;
+   bool started;
+   bool done;
+   string pending;
+   Line line;
+};
+
+/* Moves every whole line read from a followed log into lines */
+static bool takeLines(Followed *log, size_t file, vector<Line> *lines) {
+   size_t offset = 0;
+   if (!log->started) {
+      if (log->pending.size() < sizeof(LOG_MAGIC)) {
+         return true;
+      }
+      if (memcmp(log->pending.data(), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+         cerr << log->path << " is not a log file" << endl;
+         return false;
+      }
+      log->started = true;
+      offset = sizeof(LOG_MAGIC);
+   }
+   LogRecordHeader header;
+   while (log->pending.size() - offset >= sizeof(header)) {
+      memcpy(&header, log->pending.data() + offset, sizeof(header));
+      if (log->pending.size() - offset - sizeof(header) < header.length) {
+         break;
+      }
+      if (log->line.text.empty()) {
+         log->line.timestamp = header.timestamp;
+         log->line.level = header.level;
+         log->line.file = file;
+      }
+      log->line.text.append(log->pending, offset + sizeof(header),
+                            header.length);
+      offset += sizeof(header) + header.length;
+      const string &text = log->line.text;
+      if (!text.empty() && text[text.size() - 1] == '\n') {
+         lines->push_back(log->line);
+         log->line.text.clear();
+      }
+   }
+   log->pending.erase(0, offset);
+   return true;
+}
+
+/**
+ * Prints lines as they are logged, until every log piped in ends. Several
+ * logs are merged by time: a line is held back until it is HOLD_BACK older
+ * than the newest line read, or until the logs have been quiet that long, so
+ * a line that arrives a little late from one log still lands in order.
+ */
+static int follow(char **paths, size_t count, bool raw) {
+   static const int64_t HOLD_BACK = 500000;
+   static const int64_t POLL = 100000;
+   vector<Followed> logs(count);
+   for (size_t i = 0; i < count; ++i) {
+      logs[i].path = paths[i];
+      string name = paths[i];
+      logs[i].name = name.substr(name.find_last_of('/') + 1);
+      logs[i].fd = strcmp(paths[i], "-") == 0 ? STDIN_FILENO :
+                   open(paths[i], O_RDONLY);
+      struct stat st;
+      if (logs[i].fd < 0 || fstat(logs[i].fd, &st) != 0 ||
+          fcntl(logs[i].fd, F_SETFL, O_NONBLOCK) != 0) {
+         cerr << paths[i] << " could not be opened" << endl;
+         return 1;
+      }
+      logs[i].pipe = !S_ISREG(st.st_mode);
+      logs[i].started = false;
+      logs[i].done = false;
+   }
+
+   vector<Line> lines;
+   size_t running = count;
+   int64_t newest = 0;
+   int64_t quiet = 0;
+   while (running > 0 || !lines.empty()) {
+      bool got = false;
+      for (size_t i = 0; i < count; ++i) {
+         Followed &log = logs[i];
+         char buffer[65536];
+         ssize_t length = log.done ? 0 :
+                          read(log.fd, buffer, sizeof(buffer));
+         if (length > 0) {
+            log.pending.append(buffer, length);
+            got = true;
+            if (!takeLines(&log, i, &lines)) {
+               return 1;
+            }
+         } else if (length == 0 && log.pipe && !log.done) {
+            log.done = true;
+            --running;
+         }
+      }
+
+      quiet = got ? 0 : quiet + POLL;
+      stable_sort(lines.begin(), lines.end());
+      if (!lines.empty()) {
+         newest = max(newest, lines.back().timestamp);
+      }
+      size_t ready = lines.size();
+      if (count > 1 && quiet < HOLD_BACK && running > 0) {
+         Line cutoff;
+         cutoff.timestamp = newest - HOLD_BACK;
+         ready = upper_bound(lines.begin(), lines.end(), cutoff) -
+                 lines.begin();
+      }
+      for (size_t i = 0; i < ready; ++i) {
+         printLine(lines[i],
+                   count > 1 ? logs[lines[i].file].name.c_str() : NULL, raw);
+      }
+      if (ready) {
+         cout.flush();
+         lines.erase(lines.begin(), lines.begin() + ready);
+      }
+      if (!got && running > 0) {
+         usleep(POLL);
+      }
+   }
+   return 0;
+}
+
+int main(int argc, char **argv) {
+   bool raw = false;
+   bool following = false;
+   int first = 1;
+   for (; first < argc && argv[first][0] == '-' && argv[first][1]; ++first) {
+      if (strcmp(argv[first], "-r") == 0) {
+         raw = true;
+      } else if (strcmp(argv[first], "-f") == 0) {
+         following = true;
+      } else {
+         break;
+      }
+   }
+   if (first >= argc) {
+      cerr << "Usage: " << argv[0] << " [-r] logfile..." << endl
+           << "       " << argv[0] << " [-r] -f logfile|-..." << endl;
+      return 1;
+   }
+   if (following) {
+      return follow(argv + first, argc - first, raw);
+   }
+
+   vector<string> names;
+   vector<Line> lines;
+   for (int i = first; i < argc; ++i) {
+      if (!readLines(argv[i], names.size(), &lines)) {
+         return 1;
+      }
+      string name = argv[i];
+      names.push_back(name.substr(name.find_last_of('/') + 1));
+   }
+   if (names.size() > 1) {
+      stable_sort(lines.begin(), lines.end());
+   }
+
+   for (size_t i = 0; i < lines.size(); ++i) {
+      printLine(lines[i], names.size() > 1 ? names[lines[i].file].c_str() : NULL,
+                raw);
+   }
+   return 0;
+}
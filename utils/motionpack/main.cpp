@@ -0,0 +1,93 @@
+/**
+ * Compiles .pos keyframe files into the binary motion pack ActionGenerator
+ * maps at start up, or lists what is in a pack.
+ *
+ * Usage: motionpack -o motions.pack getupFront.pos getupBack.pos ...
+ *        motionpack -l motions.pack
+ *
+ * Each motion is named after its file without the .pos extension, which is
+ * the name ActionGenerator asks for. Run it over the whole pos directory and
+ * sync motions.pack along with it; ActionGenerator falls back to the .pos
+ * file for any motion missing from the pack.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "motion/generator/MotionPack.hpp"
+
+using namespace std;
+
+static string motionName(const string &file) {
+   string name = file.substr(file.find_last_of('/') + 1);
+   if (name.size() > 4 && name.compare(name.size() - 4, 4, ".pos") == 0) {
+      name.erase(name.size() - 4);
+   }
+   return name;
+}
+
+static int list(const string &file) {
+   MotionPack pack;
+   string error;
+   if (!pack.open(file, &error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   vector<string> names = pack.names();
+   for (size_t i = 0; i < names.size(); ++i) {
+      uint32_t count = 0;
+      const MotionPack::Keyframe *keyframes = pack.find(names[i], &count);
+      int duration = 0;
+      for (uint32_t k = 0; k < count; ++k) {
+         duration += keyframes[k].duration;
+      }
+      cout << names[i] << ": " << count << " keyframes, "
+           << duration << "ms" << endl;
+   }
+   return 0;
+}
+
+int main(int argc, char **argv) {
+   if (argc == 3 && strcmp(argv[1], "-l") == 0) {
+      return list(argv[2]);
+   }
+   if (argc < 4 || strcmp(argv[1], "-o") != 0) {
+      cerr << "Usage: " << argv[0] << " -o motions.pack file.pos..." << endl
+           << "       " << argv[0] << " -l motions.pack" << endl;
+      return 1;
+   }
+
+   vector<string> names;
+   vector<vector<MotionPack::Keyframe> > motions;
+   vector<uint32_t> sourceHashes;
+   for (int i = 3; i < argc; ++i) {
+      ifstream in(argv[i]);
+      if (!in.is_open()) {
+         cerr << "Can not open " << argv[i] << endl;
+         return 1;
+      }
+      stringstream text;
+      text << in.rdbuf();
+      vector<MotionPack::Keyframe> keyframes;
+      string error;
+      if (!MotionPack::parsePos(text, &keyframes, &error)) {
+         cerr << argv[i] << ": " << error << endl;
+         return 1;
+      }
+      names.push_back(motionName(argv[i]));
+      motions.push_back(keyframes);
+      sourceHashes.push_back(MotionPack::hashSource(text.str()));
+   }
+
+   string error;
+   if (!MotionPack::write(argv[2], names, motions, sourceHashes, &error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   cout << "Wrote " << names.size() << " motions to " << argv[2] << endl;
+   return 0;
+}
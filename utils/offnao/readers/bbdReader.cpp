@@ -5,46 +5,36 @@
 
 using namespace std;
 
-BBDReader::BBDReader(const QString &fileName) : ifs(), in(){
-   // catch if file not found
-   ifs.exceptions(ifstream::eofbit | ifstream::failbit | ifstream::badbit);
-   ifs.open(qPrintable(fileName), ios::in | ios::binary);
-   in.push(ifs);
-   ia = new boost::archive::binary_iarchive(in);
+BBDReader::BBDReader(const QString &fileName) {
+   dump.open(qPrintable(fileName), &error);
 }
 
 BBDReader::BBDReader(const QString &fileName, const NaoData &naoData) : 
-Reader(naoData), ifs(), in(){
-   // catch if file not found
-   ifs.exceptions(ifstream::eofbit | ifstream::failbit | ifstream::badbit);
-   ifs.open(qPrintable(fileName), ios::in | ios::binary);
-   in.push(ifs);
-   ia = new boost::archive::binary_iarchive(in);
+Reader(naoData) {
+   dump.open(qPrintable(fileName), &error);
 }
 
 BBDReader::~BBDReader() {
-   delete ia;
 }
 
 void BBDReader::run() {
    /* Load as many frames as possible until we hit an exception */
 
    for(;;) {
-      try {
-         Frame frame;
-         frame.blackboard = new Blackboard(config);
-         *ia & *frame.blackboard;
-         naoData.appendFrame(frame);
-      } catch(const std::exception& e) {
+      Frame frame;
+      frame.blackboard = new Blackboard(config);
+      if (!dump.next(frame.blackboard)) {
+         delete frame.blackboard;
          /* Only error if we read no frames */
          if (naoData.getFramesTotal() == 0) {
             QString s("Can not load record: ");
             emit disconnectFromNao();
-            emit showMessage(s + e.what());
+            emit showMessage(s + (error.empty() ? "no frames" : error.c_str()));
             return;
          }
          break;
       }
+      naoData.appendFrame(frame);
    }
 
    stringstream s;
@@ -2,10 +2,10 @@
 
 #include "reader.hpp"
 
-#include <boost/archive/binary_iarchive.hpp>
-#include <boost/iostreams/filtering_streambuf.hpp>
-#include <fstream>
 #include <QString>
+#include <string>
+
+#include "perception/dumper/DumpFile.hpp"
 
 /*
  *  Simple reader that reads in recorded dumps from file.
@@ -43,17 +43,12 @@ class BBDReader : public Reader {
       virtual ~BBDReader();
    private:
       /**
-       * the file stream to read from
-       */
-      std::ifstream ifs;
-
-      /**
-       * the input stream buffer.  may contain compression components
+       * the dump to read from
        */
-      boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+      DumpFile dump;
 
       /**
-       * the input archive attached to the stream buffer
+       * why the dump could not be opened, if it could not
        */
-      boost::archive::binary_iarchive *ia;
+      std::string error;
 };
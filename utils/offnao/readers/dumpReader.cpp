@@ -35,9 +35,11 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <sstream>
 #include <cmath>
+#include <cstring>
 #include "utils/basic_maths.hpp"
 #include "readers/dumpReader.hpp"
 #include "blackboard/Blackboard.hpp"
+#include "perception/vision/CameraRecorder.hpp"
 #include "progopts.hpp"
 #include <iostream>
  using namespace std;
@@ -62,12 +64,29 @@ void DumpReader::run() {
    //yuy2 encoding uses 16 bits per pixel, thus 2x8bits per pixel
    // load whole file into memory  dodgey for now.
    int frameLoaded = 1;
+
+   // CameraRecorder puts a header before each frame, older dumps are just
+   // the images
+   CameraRecordHeader header;
+   bool hasHeaders = dumpFile != NULL &&
+      fread(&header, sizeof(header), 1, dumpFile) == 1 &&
+      memcmp(header.magic, CAMERA_RECORD_MAGIC, sizeof(header.magic)) == 0;
+   if (dumpFile != NULL) {
+      rewind(dumpFile);
+   }
    do {
+      if (hasHeaders) {
+         if (fread(&header, sizeof(header), 1, dumpFile) != 1 ||
+             fseek(dumpFile, header.headerSize - sizeof(header),
+                   SEEK_CUR) != 0) {
+            break;
+         }
+      }
       uint8_t* top =
             (uint8_t *) malloc(sizeof(uint8_t)*TOP_SIZE);
       uint8_t* bot =
     		(uint8_t *) malloc(sizeof(uint8_t)*BOT_SIZE);
-      if(fread(top, TOP_SIZE, 1, dumpFile) != 1){
+      if(dumpFile == NULL || fread(top, TOP_SIZE, 1, dumpFile) != 1){
          free(top);
          break;
       } else {
@@ -82,6 +101,13 @@ void DumpReader::run() {
 			 blackboard->write(&(blackboard->mask), mask);
 			 writeTo(vision, topFrame, (const uint8_t*) top);
 			 writeTo(vision, botFrame, (const uint8_t*) bot);
+			 if (hasHeaders) {
+			    SensorValues sensors;
+			    for (int i = 0; i < Joints::NUMBER_OF_JOINTS; ++i) {
+			       sensors.joints.angles[i] = header.jointAngles[i];
+			    }
+			    writeTo(kinematics, sensorsLagged, sensors);
+			 }
 			 frame.blackboard = blackboard;
 			 naoData.appendFrame(frame);
 			 std::stringstream s;
@@ -36,6 +36,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <QStringList>
 #include <QInputDialog>
 #include <cmath>
+#include <cstring>
 #include <string>
 #include <sstream>
 #include <boost/serialization/list.hpp>
@@ -92,13 +93,10 @@ void NetworkReader::handle_connect(const boost::system::error_code& e,
 
    if (!e) {
       /* Successfully established connection. Start operation to read the list
-       * of Blackboards. The connection::async_read() function will
-       * automatically decode the data that is read from the underlying socket.
+       * of Blackboards, each decoded from a WireFrame by handle_read.
        */
-      received.blackboard = new Blackboard(config);
-      connection_->async_read(*received.blackboard,
-            boost::bind(&NetworkReader::handle_read, this,
-               boost::asio::placeholders::error));
+      baseline_.reset();
+      start_read();
 
       // if (!(rand() % 10))
       write(mask);
@@ -120,6 +118,36 @@ void NetworkReader::handle_connect(const boost::system::error_code& e,
    }
 }
 
+void NetworkReader::start_read() {
+   boost::asio::async_read(connection_->socket(),
+         boost::asio::buffer(&inbound_header_, sizeof(inbound_header_)),
+         boost::bind(&NetworkReader::handle_read_header, this,
+            boost::asio::placeholders::error));
+}
+
+/// Handle completion of a frame header read.
+void NetworkReader::handle_read_header(const boost::system::error_code& e) {
+   if (!isAlive) {
+      return;  // this class has already been destroyed.
+   }
+   if (e) {
+      handle_read(e);
+   } else if (!isWireFrameHeader(inbound_header_)) {
+      qDebug("Received a frame in a wire format offnao can not read");
+      emit showMessage("Robot is streaming a different wire format. "
+                       "Disconnected...");
+   } else {
+      inbound_frame_.resize(sizeof(inbound_header_) +
+                            wireFrameBodyLength(inbound_header_));
+      memcpy(&inbound_frame_[0], &inbound_header_, sizeof(inbound_header_));
+      boost::asio::async_read(connection_->socket(),
+            boost::asio::buffer(&inbound_frame_[sizeof(inbound_header_)],
+                                wireFrameBodyLength(inbound_header_)),
+            boost::bind(&NetworkReader::handle_read, this,
+               boost::asio::placeholders::error));
+   }
+}
+
 /// Handle completion of a read operation.
 void NetworkReader::handle_read(const boost::system::error_code& e) {
    if (Thread::name == NULL) {
@@ -134,6 +162,19 @@ void NetworkReader::handle_read(const boost::system::error_code& e) {
       emit showMessage(QString("average ms per packets: ") +
             QString::number(t.elapsed_ms()/++counter));
 
+      received.blackboard = new Blackboard(config);
+      std::string error;
+      if (!decodeWireFrame(&inbound_frame_[0], inbound_frame_.size(),
+                           received.blackboard, &baseline_, &error)) {
+         qDebug() << "Error in decoding wireless data. " <<
+               error.c_str() << endl;
+         emit showMessage(QString::fromStdString(error));
+         delete received.blackboard;
+         received.blackboard = NULL;
+         start_read();
+         return;
+      }
+
       try{
          naoData.appendFrame(received);
          if(!naoData.getIsPaused()) {
@@ -148,10 +189,7 @@ void NetworkReader::handle_read(const boost::system::error_code& e) {
             emit newNaoData(&naoData);
             lastnew = now2;
          }
-         received.blackboard = new Blackboard(config);
-         connection_->async_read(*received.blackboard,
-                                 boost::bind(&NetworkReader::handle_read, this,
-                                             boost::asio::placeholders::error));
+         start_read();
       } catch(boost::system::system_error &se) {
          qDebug() << "Error in receiving wireless data. " <<
                se.what() << endl;
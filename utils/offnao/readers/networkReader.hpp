@@ -36,6 +36,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "readers/reader.hpp"
 #include "utils/Connection.hpp"
 #include "transmitter/TransmitterDefs.hpp"
+#include "transmitter/WireFormat.hpp"
 
 typedef int64_t msg_t;
 typedef std::deque<msg_t> chat_message_queue;
@@ -66,8 +67,15 @@ class NetworkReader : public Reader {
 
       void handle_connect(const boost::system::error_code& e,
             boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
+      /* Reads the next WireFrame, header first so its length is known */
+      void start_read();
+      void handle_read_header(const boost::system::error_code& e);
       void handle_read(const boost::system::error_code& e);
       Connection *connection_;
+      WireFrameHeader inbound_header_;
+      std::vector<char> inbound_frame_;
+      /* The stream so far, which delta frames are decoded against */
+      WireBaseline baseline_;
 
       boost::thread *cthread;
       Frame received;
@@ -0,0 +1,152 @@
+/*
+Copyright 2010 The University of New South Wales (UNSW).
+
+This file is part of the 2010 team rUNSWift RoboCup entry. You may
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version as
+modified below. As the original licensors, we add the following
+conditions to that license:
+
+In paragraph 2.b), the phrase "distribute or publish" should be
+interpreted to include entry into a competition, and hence the source
+of any derived work entered into a competition must be made available
+to all parties involved in that competition under the terms of this
+license.
+
+In addition, if the authors of a derived work publish any conference
+proceedings, journal articles or other academic papers describing that
+derived work, then appropriate academic citations to the original work
+must be included in that publication.
+
+This rUNSWift source is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this source code; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include <QDebug>
+#include <QString>
+#include <sys/time.h>
+#include <string>
+
+#include "readers/shmReader.hpp"
+#include "progopts.hpp"
+#include "blackboard/Blackboard.hpp"
+#include "thread/Thread.hpp"
+
+/* How long to wait for a frame, and how long without one before attaching
+ * again, in case runswift restarted and made a new ring
+ */
+static const int WAIT_MS = 100;
+static const int REATTACH_MS = 2000;
+
+/* Frees a blackboard next() failed to fill, with any images it decoded */
+static void discard(Blackboard *blackboard) {
+   delete[] blackboard->vision.topFrame;
+   delete[] blackboard->vision.botFrame;
+   delete[] blackboard->vision.topSaliency;
+   delete[] blackboard->vision.botSaliency;
+   delete blackboard;
+}
+
+ShmReader::ShmReader(OffNaoMask_t mask) : isRecording(false) {
+   this->mask = mask;
+   this->naoData.setPaused(false);
+   isAlive = true;
+}
+
+ShmReader::ShmReader(OffNaoMask_t mask, const NaoData &naoData) :
+   Reader(naoData), isRecording(false) {
+   this->mask = mask;
+   this->naoData.setPaused(false);
+   isAlive = true;
+}
+
+ShmReader::~ShmReader() {
+   isAlive = false;
+}
+
+void ShmReader::run() {
+   if (Thread::name == NULL) {
+      Thread::name = "ShmReader";
+   }
+   emit showMessage(
+        tr("Started session with runswift. Hit record to begin stream..."));
+
+   int idleMs = 0;
+   uint64_t lastnew = 0;
+   while (isAlive) {
+      if (!isRecording) {
+         ring.close();
+         msleep(200);
+         continue;
+      }
+      if (!ring.isOpen()) {
+         std::string error;
+         if (!ring.open(&error)) {
+            emit showMessage(QString::fromStdString(error));
+            msleep(1000);
+            continue;
+         }
+         emit showMessage(QString("Attached! Now streaming"));
+         idleMs = 0;
+      }
+
+      if (!ring.wait(WAIT_MS)) {
+         idleMs += WAIT_MS;
+         if (idleMs >= REATTACH_MS) {
+            ring.close();
+         }
+         continue;
+      }
+      idleMs = 0;
+
+      // decode as many frames as are new
+      for (;;) {
+         Frame received;
+         received.blackboard = new Blackboard(config);
+         std::string error;
+         if (!ring.next(received.blackboard, &error)) {
+            discard(received.blackboard);
+            if (error.empty()) {
+               break;
+            }
+            qDebug() << "Error in decoding shared memory data. " <<
+                  error.c_str();
+            continue;
+         }
+         naoData.appendFrame(received);
+         if (!naoData.getIsPaused()) {
+            naoData.setCurrentFrame(naoData.getFramesTotal() - 1);
+         }
+      }
+
+      struct timeval now;
+      gettimeofday(&now, NULL);
+      uint64_t now2 = now.tv_sec * 1000000ull + now.tv_usec;
+      if (now2 >= lastnew + 250000) {
+         emit newNaoData(&naoData);
+         emit showMessage(QString("Frames dropped: ") +
+                          QString::number(ring.dropped()));
+         lastnew = now2;
+      }
+   }
+   ring.close();
+   emit newNaoData(NULL);
+}
+
+void ShmReader::stopMediaTrigger() {
+   isRecording = false;
+   naoData.setPaused(true);
+   emit showMessage(QString("Detached. Hit record to continue."));
+}
+
+void ShmReader::recordMediaTrigger() {
+   isRecording = true;
+   naoData.setPaused(false);
+}
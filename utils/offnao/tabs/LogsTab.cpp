@@ -103,10 +103,24 @@ void LogsTab::openLogs(const QString &dirName) {
    if (ltCurrent)
       sCurrent = ltCurrent->name();
    clear();
-   vTabs.push_back(new LogTab("Perception",
-                              "ssh nao@"+naoName+" \"until sleep 1 && [ -r /var/volatile/runswift/"+dirName+"/Perception ]; do true; done; tail -f /var/volatile/runswift/"+dirName+"/Perception\""));
+   // The logs are binary, so each thread's is followed on its own and decoded
+   // here. All pipes every thread's log into a fifo of its own, and logdecode
+   // merges the fifos by time.
+   const char *threads[] = { "Perception", "Motion", "GameController",
+                             "OffnaoTransmitter", "TeamTransmitter",
+                             "TeamReceiver" };
+   QString fifos;
+   QString followAll;
+   for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+      QString log = "/var/volatile/runswift/" + dirName + "/" + threads[i];
+      QString tail = "ssh nao@"+naoName+" 'until sleep 1 && [ -r "+log+" ]; do true; done; tail -c +1 -f "+log+"'";
+      vTabs.push_back(new LogTab(threads[i],
+                                 "sh -c \""+tail+" | $RUNSWIFT_CHECKOUT_DIR/utils/logdecode/logdecode -f -\""));
+      fifos += QString(" ") + threads[i];
+      followAll += tail + " > " + threads[i] + " & ";
+   }
    vTabs.push_back(new LogTab("All",
-                              "ssh nao@"+naoName+" \"tail -f /var/volatile/runswift/"+dirName+"/*\""));
+                              "sh -c \"d=`mktemp -d` && cd $d && mkfifo"+fifos+" && { "+followAll+"$RUNSWIFT_CHECKOUT_DIR/utils/logdecode/logdecode -f"+fifos+"; cd / && rm -r $d; }\""));
    //TODO:allow tabs to be closed
    /* Set up the tabs */
    foreach (LogTab *t, vTabs) {
@@ -162,8 +162,8 @@ void GraphTab::newNaoData(NaoData *naoData) {
                emptyS.sensors[i] = 0.0f;
          for (int i = new_frame - PLOT_SIZE + 1; i <= new_frame; ++i) {
             if (i >= 0) {
-               s.push_back(naoData->getFrame(i).blackboard->motion.sensors);
-               o.push_back(naoData->getFrame(i).blackboard->motion.odometry);
+               s.push_back(naoData->getFrame(i).blackboard->motion.sensors.read());
+               o.push_back(naoData->getFrame(i).blackboard->motion.odometry.read());
             } else {
                s.push_back(emptyS);
                o.push_back(emptyO);
@@ -181,8 +181,8 @@ void GraphTab::newNaoData(NaoData *naoData) {
                 emptyS.sensors[i] = 0.0f;
           for (int i = new_frame - PLOT_SIZE + 1; i <= new_frame; ++i) {
              if (i >= 0) {
-                s.push_back(naoData->getFrame(i).blackboard->motion.sensors);
-                o.push_back(naoData->getFrame(i).blackboard->motion.odometry);
+                s.push_back(naoData->getFrame(i).blackboard->motion.sensors.read());
+                o.push_back(naoData->getFrame(i).blackboard->motion.odometry.read());
              } else {
                 s.push_back(emptyS);
                 o.push_back(emptyO);
@@ -195,8 +195,8 @@ void GraphTab::newNaoData(NaoData *naoData) {
          std::vector<SensorValues> s;
          std::vector<Odometry> o;
          for (int i = last_frame + 1; i <= new_frame; ++i) {
-            s.push_back(naoData->getFrame(i).blackboard->motion.sensors);
-            o.push_back(naoData->getFrame(i).blackboard->motion.odometry);
+            s.push_back(naoData->getFrame(i).blackboard->motion.sensors.read());
+            o.push_back(naoData->getFrame(i).blackboard->motion.odometry.read());
          }
          updatePlots(s, o);
       }
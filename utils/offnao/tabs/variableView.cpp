@@ -128,6 +128,12 @@ VariableView::VariableView() {
                      QStringList(QString("gameController.team_red = ")), 1);
    gameControllerHeading->setExpanded(true);
 
+   threadHeading = new QTreeWidgetItem(this,
+                                       QStringList(QString("Threads")), 1);
+   threadTimings = new QTreeWidgetItem(threadHeading,
+                     QStringList(QString("No thread timings")), 1);
+   threadHeading->setExpanded(true);
+
    this->addTopLevelItem(visionHeading);
    this->addTopLevelItem(localisationHeading);
    this->addTopLevelItem(motionHeading);
@@ -164,6 +170,7 @@ void VariableView::redraw(NaoData *naoData) {
 
    updateVision(naoData);
    updateBehaviour(naoData);
+   updateThreads(naoData);
    stringstream steam;
    steam << "gamecontroller.team_red = " << readFrom(gameController, team_red) << endl;
    gameControllerTeam->setText(0, steam.str().c_str());
@@ -210,6 +217,26 @@ void VariableView::updateBehaviour(NaoData *naoData) {
                                                   actionName, ""));
 }
 
+void VariableView::updateThreads(NaoData *naoData) {
+   Blackboard *blackboard = (naoData->getCurrentFrame().blackboard);
+   if (!blackboard) return;
+
+   stringstream s;
+   for (int i = 0; i < blackboard->thread.numTimings; ++i) {
+      const ThreadTiming timing = readFrom(thread, timings[i]);
+      if (i > 0) s << endl;
+      s << timing.name << ": " << timing.ticks << " ticks, "
+        << timing.overruns << " overruns" << endl;
+      s << "   tick " << timing.lastTick << "us, max " << timing.maxTick
+        << "us" << endl;
+      s << "   late " << timing.meanLateness << " +- "
+        << timing.latenessDeviation << "us, max " << timing.maxLateness
+        << "us";
+   }
+   if (blackboard->thread.numTimings == 0) s << "No thread timings";
+   threadTimings->setText(0, s.str().c_str());
+}
+
 void VariableView::updateVision(NaoData *naoData) {
    Blackboard *blackboard = (naoData->getCurrentFrame().blackboard);
    if (!blackboard) return;
@@ -94,8 +94,12 @@ class VariableView : public QTreeWidget {
 
       QTreeWidgetItem *localisationHeading;
       QTreeWidgetItem *localisationRobotPos;
+
+      QTreeWidgetItem *threadHeading;
+      QTreeWidgetItem *threadTimings;
       std::deque<int> times;
       void updateVision(NaoData *naoData);
       void updateBehaviour(NaoData *naoData);
+      void updateThreads(NaoData *naoData);
 
 };
@@ -120,7 +120,7 @@ void ZMPTab::newNaoData(NaoData *naoData) {
          }
          for (int i = new_frame - PLOT_SIZE + 1; i <= new_frame; ++i) {
             if (i >= 0) {
-               s.push_back(naoData->getFrame(i).blackboard->motion.sensors);
+               s.push_back(naoData->getFrame(i).blackboard->motion.sensors.read());
                coms.push_back(naoData->getFrame(i).blackboard->motion.com);
             } else {
                s.push_back(null);
@@ -149,7 +149,7 @@ void ZMPTab::newNaoData(NaoData *naoData) {
                s.push_back(null);
                coms.push_back(temp);
             } else {
-               s.push_back(naoData->getFrame(i).blackboard->motion.sensors);
+               s.push_back(naoData->getFrame(i).blackboard->motion.sensors.read());
                coms.push_back(naoData->getFrame(i).blackboard->motion.com);
             }
          }
@@ -162,7 +162,7 @@ void ZMPTab::newNaoData(NaoData *naoData) {
          std::vector<SensorValues> s;
          std::vector<XYZ_Coord> coms;
          for (int i = last_frame + 1; i <= new_frame; ++i) {
-            s.push_back(naoData->getFrame(i).blackboard->motion.sensors);
+            s.push_back(naoData->getFrame(i).blackboard->motion.sensors.read());
             coms.push_back(naoData->getFrame(i).blackboard->motion.com);
          }
          coronal_plot->push(s);
@@ -43,6 +43,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "ui_visualiser.h"
 #include "readers/recordReader.hpp"
 #include "readers/bbdReader.hpp"
+#include "readers/shmReader.hpp"
 #include <utils/Logger.hpp>
 #include <thread/Thread.hpp>
 #include <stdlib.h>
@@ -402,6 +403,10 @@ OffNaoMask_t Visualiser::transmissionMask(const QAbstractButton *) {
 }
 
 void Visualiser::connectToNao(const QString &naoName) {
+   if (naoName == "shm") {
+      reconnect<ShmReader, OffNaoMask_t>(transmissionMask(NULL));
+      return;
+   }
 	QString newnaoName = naoName;
 	string strNao = naoName.toStdString();
 	if (strNao.find('.') != string::npos){
@@ -437,9 +442,9 @@ void Visualiser::connectToNao(const QString &naoName) {
 }
 
 void Visualiser::writeToNao(QAbstractButton *qab) {
-   if (reader)
-      // TODO(jayen): check reader is a networkreader
-      ((NetworkReader*)reader)->write(transmissionMask(qab));
+   NetworkReader *networkReader = dynamic_cast<NetworkReader *>(reader);
+   if (networkReader)
+      networkReader->write(transmissionMask(qab));
 }
    
 void Visualiser::connectToNao() {
@@ -0,0 +1,56 @@
+/**
+ * Converts a text RL planner table (controller.rl) into the binary format
+ * RLPlanner loads without parsing, or describes a table of either format.
+ *
+ * Usage: plannertable -o controller.rlb controller.rl
+ *        plannertable -l controller.rlb
+ *
+ * The grid along each axis is taken from the states in the text file, so a
+ * finer or wider table only needs its dimensions line to match its data.
+ */
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "motion/generator/PlannerTable.hpp"
+
+using namespace std;
+
+static const char *AXIS_NAMES[PlannerTable::NUM_AXES] = {"x", "dx", "t"};
+
+static int list(const string &file) {
+   PlannerTable table;
+   string error;
+   if (!table.load(file, &error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   cout << table.numGoals() << " goals" << endl;
+   for (int a = 0; a < PlannerTable::NUM_AXES; ++a) {
+      const PlannerTable::Axis &axis = table.axis((PlannerTable::AxisIndex)a);
+      cout << AXIS_NAMES[a] << ": " << axis.count << " values from "
+           << axis.min << " step " << axis.step << endl;
+   }
+   return 0;
+}
+
+int main(int argc, char **argv) {
+   if (argc == 3 && strcmp(argv[1], "-l") == 0) {
+      return list(argv[2]);
+   }
+   if (argc != 4 || strcmp(argv[1], "-o") != 0) {
+      cerr << "Usage: " << argv[0] << " -o controller.rlb controller.rl" << endl
+           << "       " << argv[0] << " -l controller.rlb" << endl;
+      return 1;
+   }
+
+   PlannerTable table;
+   string error;
+   if (!table.load(argv[3], &error) || !table.save(argv[2], &error)) {
+      cerr << error << endl;
+      return 1;
+   }
+   cout << "Wrote " << argv[2] << endl;
+   return 0;
+}